@@ -0,0 +1,79 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace Benchmark
+{
+
+/**
+ * Keeps the compiler from optimizing away a result that is otherwise unused.
+ */
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Calls function "iterations" times after one warm up call and returns the mean time per call in nanoseconds.
+ */
+inline double measure(size_t iterations, const std::function<void()>& function)
+{
+	function();
+	auto start = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < iterations; i++)
+	{
+		function();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / iterations;
+}
+
+/**
+ * Prints one result line. "bytes" is the amount of data processed per call and only used for the throughput column.
+ */
+inline void print(const std::string& name, double nanoseconds, size_t bytes = 0)
+{
+	if(bytes > 0) printf("%-56s %12.0f ns %10.1f MiB/s\n", name.c_str(), nanoseconds, ((double)bytes / (1024 * 1024)) / (nanoseconds / 1000000000.0));
+	else printf("%-56s %12.0f ns\n", name.c_str(), nanoseconds);
+}
+
+}
+
+#endif
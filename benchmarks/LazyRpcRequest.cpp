@@ -0,0 +1,115 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "Benchmark.h"
+#include "BaseLib.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+/**
+ * putParamset("1234", 3, "MASTER", {...}) with a paramset of the given size as sent by UIs.
+ */
+PArray buildPutParamset(int32_t parameterCount)
+{
+	PVariable paramset = std::make_shared<Variable>(VariableType::tStruct);
+	for(int32_t i = 0; i < parameterCount; i++)
+	{
+		PVariable value = i % 3 == 0 ? std::make_shared<Variable>(std::string("some string value")) : std::make_shared<Variable>(i * 1.5);
+		paramset->structValue->emplace("PARAMETER_" + std::to_string(i), value);
+	}
+	PArray parameters = std::make_shared<Array>();
+	parameters->push_back(std::make_shared<Variable>(1234));
+	parameters->push_back(std::make_shared<Variable>(3));
+	parameters->push_back(std::make_shared<Variable>(std::string("MASTER")));
+	parameters->push_back(paramset);
+	return parameters;
+}
+
+/**
+ * setValue(1234, 3, "STATE", true)
+ */
+PArray buildSetValue()
+{
+	PArray parameters = std::make_shared<Array>();
+	parameters->push_back(std::make_shared<Variable>(1234));
+	parameters->push_back(std::make_shared<Variable>(3));
+	parameters->push_back(std::make_shared<Variable>(std::string("STATE")));
+	parameters->push_back(std::make_shared<Variable>(true));
+	return parameters;
+}
+
+/**
+ * Compares decoding the complete request with reading only peer ID and channel, which is all a router needs.
+ */
+void run(const std::string& methodName, const PArray& parameters, size_t iterations)
+{
+	Rpc::RpcEncoder encoder;
+	auto packet = std::make_shared<std::vector<char>>();
+	encoder.encodeRequest(methodName, parameters, *packet);
+	std::shared_ptr<const std::vector<char>> constPacket = packet;
+	std::string name = methodName + " (" + std::to_string(packet->size()) + " bytes)";
+
+	Rpc::RpcDecoder decoder;
+	double nanoseconds = Benchmark::measure(iterations, [&decoder, &packet]()
+	{
+		std::string decodedMethodName;
+		auto decodedParameters = decoder.decodeRequest(*packet, decodedMethodName);
+		Benchmark::doNotOptimize(decodedParameters->at(0)->integerValue + decodedParameters->at(1)->integerValue);
+	});
+	Benchmark::print(name + ", full decode", nanoseconds, packet->size());
+
+	nanoseconds = Benchmark::measure(iterations, [&constPacket]()
+	{
+		Rpc::LazyRpcRequest request(constPacket);
+		Benchmark::doNotOptimize(request.getParameter(0).decode()->integerValue + request.getParameter(1).decode()->integerValue);
+	});
+	Benchmark::print(name + ", lazy peer ID and channel", nanoseconds, packet->size());
+
+	nanoseconds = Benchmark::measure(iterations, [&constPacket]()
+	{
+		Rpc::LazyRpcRequest request(constPacket);
+		auto decodedParameters = request.decodeParameters();
+		Benchmark::doNotOptimize(decodedParameters);
+	});
+	Benchmark::print(name + ", lazy decodeParameters()", nanoseconds, packet->size());
+}
+
+}
+
+int main()
+{
+	run("setValue", buildSetValue(), 1000000);
+	run("putParamset", buildPutParamset(10), 200000);
+	run("putParamset", buildPutParamset(50), 100000);
+	return 0;
+}
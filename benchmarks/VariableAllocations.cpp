@@ -0,0 +1,177 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "Benchmark.h"
+#include "BaseLib.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<size_t> allocations{0};
+}
+
+void* operator new(size_t size)
+{
+	allocations++;
+	void* memory = malloc(size);
+	if(!memory) throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	free(memory);
+}
+
+using namespace BaseLib;
+
+namespace
+{
+
+/**
+ * Builds a structure similar to the result of getAllValues for the given number of peers.
+ */
+PVariable buildAllValues(int32_t peers)
+{
+	PVariable result = std::make_shared<Variable>(VariableType::tArray);
+	for(int32_t i = 0; i < peers; i++)
+	{
+		PVariable peer = std::make_shared<Variable>(VariableType::tStruct);
+		peer->structValue->insert(StructElement("ID", std::make_shared<Variable>(i)));
+		peer->structValue->insert(StructElement("NAME", std::make_shared<Variable>(std::string("Peer"))));
+		PVariable channels = std::make_shared<Variable>(VariableType::tArray);
+		for(int32_t j = 0; j < 4; j++)
+		{
+			PVariable channel = std::make_shared<Variable>(VariableType::tStruct);
+			channel->structValue->insert(StructElement("INDEX", std::make_shared<Variable>(j)));
+			PVariable parameters = std::make_shared<Variable>(VariableType::tStruct);
+			for(const char* name : {"STATE", "LEVEL", "TEMPERATURE", "HUMIDITY"})
+			{
+				PVariable parameter = std::make_shared<Variable>(VariableType::tStruct);
+				parameter->structValue->insert(StructElement("VALUE", std::make_shared<Variable>(21.5)));
+				parameter->structValue->insert(StructElement("READABLE", std::make_shared<Variable>(true)));
+				parameter->structValue->insert(StructElement("WRITEABLE", std::make_shared<Variable>(false)));
+				parameter->structValue->insert(StructElement("TYPE", std::make_shared<Variable>(std::string("FLOAT"))));
+				parameters->structValue->insert(StructElement(name, parameter));
+			}
+			channel->structValue->insert(StructElement("PARAMSET", parameters));
+			channels->arrayValue->push_back(channel);
+		}
+		peer->structValue->insert(StructElement("CHANNELS", channels));
+		result->arrayValue->push_back(peer);
+	}
+	return result;
+}
+
+/**
+ * Prints time and heap allocations per call of function.
+ */
+void run(const std::string& name, size_t iterations, const std::function<void()>& function)
+{
+	function();
+	size_t allocationsBefore = allocations;
+	double nanoseconds = Benchmark::measure(iterations, function);
+	//measure() calls function once more for warm up.
+	double allocationsPerCall = (double)(allocations - allocationsBefore) / (iterations + 1);
+	printf("%-56s %12.0f ns %12.1f allocations\n", name.c_str(), nanoseconds, allocationsPerCall);
+}
+
+}
+
+int main()
+{
+	const int32_t peers = 100;
+
+	run("Scalar Variable", 1000000, []()
+	{
+		PVariable variable = std::make_shared<Variable>(42);
+		Benchmark::doNotOptimize(variable);
+	});
+
+	PVariable scalar = std::make_shared<Variable>(std::string("Scalar"));
+	run("Scalar Variable copy", 1000000, [&scalar]()
+	{
+		PVariable variable = std::make_shared<Variable>(*scalar);
+		Benchmark::doNotOptimize(variable);
+	});
+
+	run("getAllValues-like tree (" + std::to_string(peers) + " peers)", 100, [peers]()
+	{
+		PVariable tree = buildAllValues(peers);
+		Benchmark::doNotOptimize(tree);
+	});
+
+	PVariable tree = buildAllValues(peers);
+	run("Tree copy", 100, [&tree]()
+	{
+		PVariable copy = std::make_shared<Variable>(*tree);
+		Benchmark::doNotOptimize(copy);
+	});
+
+	run("Tree copyOnWrite", 100, [&tree]()
+	{
+		PVariable copy = tree->copyOnWrite();
+		Benchmark::doNotOptimize(copy);
+	});
+
+	Rpc::RpcEncoder encoder;
+	std::vector<char> packet;
+	encoder.encodeResponse(tree, packet);
+	run("RpcEncoder::encodeResponse", 100, [&encoder, &tree]()
+	{
+		std::vector<char> encodedPacket;
+		encoder.encodeResponse(tree, encodedPacket);
+		Benchmark::doNotOptimize(encodedPacket);
+	});
+
+	Rpc::RpcDecoder decoder;
+	run("RpcDecoder::decodeResponse (" + std::to_string(packet.size()) + " bytes)", 100, [&decoder, &packet]()
+	{
+		PVariable response = decoder.decodeResponse(packet);
+		Benchmark::doNotOptimize(response);
+	});
+
+	run("RpcDecoder::decodeResponse in MemoryArena::Scope", 100, [&decoder, &packet]()
+	{
+		MemoryArena::Scope arenaScope;
+		PVariable response = decoder.decodeResponse(packet);
+		Benchmark::doNotOptimize(response);
+	});
+
+	return 0;
+}
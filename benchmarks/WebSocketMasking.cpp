@@ -0,0 +1,140 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "Benchmark.h"
+#include "BaseLib.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+const char maskingKey[4] = { 0x12, 0x34, 0x56, 0x78 };
+
+/**
+ * Appends a client frame with the payload. The payload is masked with maskingKey when "masked" is true.
+ */
+void appendFrame(std::vector<char>& frame, const char* payload, size_t size, WebSocket::Header::Opcode::Enum opcode, bool fin, bool masked)
+{
+	frame.push_back((char)((fin ? 0x80 : 0) | opcode));
+	char maskBit = masked ? (char)0x80 : 0;
+	if(size < 126) frame.push_back(maskBit | (char)size);
+	else if(size <= 0xFFFF)
+	{
+		frame.push_back(maskBit | 126);
+		frame.push_back((char)(size >> 8));
+		frame.push_back((char)(size & 0xFF));
+	}
+	else
+	{
+		frame.push_back(maskBit | 127);
+		for(int32_t i = 7; i >= 0; i--) frame.push_back((char)((size >> (8 * i)) & 0xFF));
+	}
+	if(masked) frame.insert(frame.end(), maskingKey, maskingKey + 4);
+	for(size_t i = 0; i < size; i++)
+	{
+		frame.push_back(masked ? payload[i] ^ maskingKey[i % 4] : payload[i]);
+	}
+}
+
+/**
+ * The byte-wise loop WebSocket used before masking word-wise.
+ */
+void applyMaskBytewise(char* data, size_t size)
+{
+	for(size_t i = 0; i < size; i++)
+	{
+		data[i] ^= maskingKey[i % 4];
+	}
+}
+
+/**
+ * Decodes the frames and checks the content.
+ */
+void decode(std::vector<char>& frames, const std::vector<char>& payload)
+{
+	WebSocket webSocket;
+	size_t position = 0;
+	while(position < frames.size() && !webSocket.isFinished())
+	{
+		uint32_t processedBytes = webSocket.process(frames.data() + position, (int32_t)(frames.size() - position));
+		if(processedBytes == 0) break;
+		position += processedBytes;
+	}
+	if(!webSocket.isFinished() || webSocket.getContent() != payload)
+	{
+		printf("Error: Decoded content differs from payload.\n");
+		exit(1);
+	}
+}
+
+}
+
+int main()
+{
+	for(size_t size : { (size_t)1024, (size_t)16384, (size_t)131072, (size_t)1048576 })
+	{
+		std::vector<char> payload(size);
+		for(size_t i = 0; i < size; i++) payload[i] = (char)(i * 7);
+		size_t iterations = (size_t)256 * 1024 * 1024 / size / 8;
+		std::string name = std::to_string(size / 1024) + " KiB";
+
+		std::vector<char> buffer(payload);
+		double nanoseconds = Benchmark::measure(iterations, [&buffer]()
+		{
+			applyMaskBytewise(buffer.data(), buffer.size());
+			Benchmark::doNotOptimize(buffer.data());
+		});
+		Benchmark::print(name + ", byte-wise mask only", nanoseconds, size);
+
+		std::vector<char> unmaskedFrame;
+		appendFrame(unmaskedFrame, payload.data(), size, WebSocket::Header::Opcode::binary, true, false);
+		nanoseconds = Benchmark::measure(iterations, [&unmaskedFrame, &payload]() { decode(unmaskedFrame, payload); });
+		Benchmark::print(name + ", process() unmasked frame", nanoseconds, size);
+
+		std::vector<char> maskedFrame;
+		appendFrame(maskedFrame, payload.data(), size, WebSocket::Header::Opcode::binary, true, true);
+		nanoseconds = Benchmark::measure(iterations, [&maskedFrame, &payload]() { decode(maskedFrame, payload); });
+		Benchmark::print(name + ", process() masked frame", nanoseconds, size);
+
+		//Fragment sizes not divisible by 4, so the masking key position differs between message and frame.
+		std::vector<char> fragmentedFrames;
+		size_t fragmentSize = size / 3 + 1;
+		for(size_t position = 0; position < size; position += fragmentSize)
+		{
+			size_t length = std::min(fragmentSize, size - position);
+			appendFrame(fragmentedFrames, payload.data() + position, length, position == 0 ? WebSocket::Header::Opcode::binary : WebSocket::Header::Opcode::continuation, position + length == size, true);
+		}
+		nanoseconds = Benchmark::measure(iterations, [&fragmentedFrames, &payload]() { decode(fragmentedFrames, payload); });
+		Benchmark::print(name + ", process() 3 masked fragments", nanoseconds, size);
+	}
+
+	return 0;
+}
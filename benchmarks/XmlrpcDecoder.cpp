@@ -0,0 +1,134 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "Benchmark.h"
+#include "BaseLib.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+/**
+ * Response similar to listDevices for the given number of devices.
+ */
+PVariable buildListDevices(int32_t devices)
+{
+	PVariable result = std::make_shared<Variable>(VariableType::tArray);
+	for(int32_t i = 0; i < devices; i++)
+	{
+		PVariable device = std::make_shared<Variable>(VariableType::tStruct);
+		device->structValue->emplace("ADDRESS", std::make_shared<Variable>("ABC" + std::to_string(i) + ":1"));
+		device->structValue->emplace("TYPE", std::make_shared<Variable>(std::string("HM-CC-RT-DN")));
+		device->structValue->emplace("ID", std::make_shared<Variable>(i));
+		device->structValue->emplace("FLAGS", std::make_shared<Variable>(1));
+		device->structValue->emplace("VERSION", std::make_shared<Variable>(10));
+		device->structValue->emplace("FIRMWARE", std::make_shared<Variable>(std::string("1.4")));
+		device->structValue->emplace("PARENT", std::make_shared<Variable>(std::string("")));
+		PVariable children = std::make_shared<Variable>(VariableType::tArray);
+		for(int32_t j = 0; j < 5; j++)
+		{
+			children->arrayValue->push_back(std::make_shared<Variable>("ABC" + std::to_string(i) + ":" + std::to_string(j)));
+		}
+		device->structValue->emplace("CHILDREN", children);
+		device->structValue->emplace("PARAMSETS", std::make_shared<Variable>(VariableType::tArray));
+		device->structValue->emplace("RX_MODE", std::make_shared<Variable>(1.5));
+		result->arrayValue->push_back(device);
+	}
+	return result;
+}
+
+/**
+ * putParamset("ABC0001:1", "MASTER", {...}) with 20 parameters.
+ */
+std::shared_ptr<std::vector<PVariable>> buildPutParamset()
+{
+	PVariable paramset = std::make_shared<Variable>(VariableType::tStruct);
+	for(int32_t i = 0; i < 20; i++)
+	{
+		paramset->structValue->emplace("PARAM_" + std::to_string(i), i % 2 ? std::make_shared<Variable>(true) : std::make_shared<Variable>(21.5));
+	}
+	auto parameters = std::make_shared<std::vector<PVariable>>();
+	parameters->push_back(std::make_shared<Variable>(std::string("ABC0001:1")));
+	parameters->push_back(std::make_shared<Variable>(std::string("MASTER")));
+	parameters->push_back(paramset);
+	return parameters;
+}
+
+/**
+ * The DOM based decoder copied the packet and parsed it with rapidxml before converting the document to variables. The
+ * parse alone is a lower bound for its cost.
+ */
+void runDom(const std::string& name, const std::vector<char>& packet, size_t iterations)
+{
+	double nanoseconds = Benchmark::measure(iterations, [&packet]()
+	{
+		std::vector<char> copy(packet);
+		copy.push_back(0);
+		xml_document document;
+		document.parse<parse_no_entity_translation>(copy.data());
+		Benchmark::doNotOptimize(document.first_node());
+	});
+	Benchmark::print(name + ", rapidxml DOM parse only", nanoseconds, packet.size());
+}
+
+}
+
+int main()
+{
+	SharedObjects baseLib;
+	Rpc::XmlrpcEncoder encoder(&baseLib);
+	Rpc::XmlrpcDecoder decoder(&baseLib);
+
+	std::vector<char> response;
+	encoder.encodeResponse(buildListDevices(400), response);
+	std::string responseName = "listDevices response (" + std::to_string(response.size()) + " bytes)";
+	double nanoseconds = Benchmark::measure(200, [&decoder, &response]()
+	{
+		PVariable result = decoder.decodeResponse(response);
+		Benchmark::doNotOptimize(result);
+	});
+	Benchmark::print(responseName + ", XmlrpcDecoder", nanoseconds, response.size());
+	runDom(responseName, response, 200);
+
+	std::vector<char> request;
+	encoder.encodeRequest("putParamset", buildPutParamset(), request);
+	std::string requestName = "putParamset request (" + std::to_string(request.size()) + " bytes)";
+	nanoseconds = Benchmark::measure(20000, [&decoder, &request]()
+	{
+		std::string methodName;
+		auto parameters = decoder.decodeRequest(request, methodName);
+		Benchmark::doNotOptimize(parameters);
+	});
+	Benchmark::print(requestName + ", XmlrpcDecoder", nanoseconds, request.size());
+	runDom(requestName, request, 20000);
+
+	return 0;
+}
@@ -37,10 +37,15 @@
 #include "Encoding/XmlrpcEncoder.h"
 #include "Encoding/RpcDecoder.h"
 #include "Encoding/RpcEncoder.h"
+#include "Encoding/RpcStreamDecoder.h"
+#include "Encoding/LazyRpcRequest.h"
 #include "Encoding/RpcMethod.h"
 #include "Encoding/BinaryRpc.h"
 #include "Encoding/JsonDecoder.h"
 #include "Encoding/JsonEncoder.h"
+#include "Encoding/JsonScanner.h"
+#include "Encoding/JsonStreamDecoder.h"
+#include "Encoding/LazyJsonDocument.h"
 #include "Encoding/Http.h"
 #include "Encoding/Html.h"
 #include "Encoding/WebSocket.h"
@@ -51,6 +56,7 @@
 #include "HelperFunctions/HelperFunctions.h"
 #include "HelperFunctions/Color.h"
 #include "HelperFunctions/Math.h"
+#include "HelperFunctions/MemoryArena.h"
 #include "HelperFunctions/Base64.h"
 #include "HelperFunctions/Net.h"
 #include "HelperFunctions/Pid.h"
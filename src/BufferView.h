@@ -0,0 +1,82 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LIBHOMEGEAR_BASE_BUFFERVIEW_H_
+#define LIBHOMEGEAR_BASE_BUFFERVIEW_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace BaseLib
+{
+
+/**
+ * Read-only, reference counted slice of a buffer. The view keeps the buffer alive, so it stays valid after the
+ * decoder that created it returned. The owner of the buffer must not modify it while views exist.
+ */
+class BufferView
+{
+public:
+	BufferView() = default;
+	BufferView(std::shared_ptr<const void> owner, const uint8_t* data, size_t size) : _owner(std::move(owner)), _data(data), _size(size) {}
+
+	/**
+	 * Creates a view owning the string.
+	 */
+	static BufferView fromString(std::string&& value)
+	{
+		auto owner = std::make_shared<std::string>(std::move(value));
+		return BufferView(owner, (const uint8_t*)owner->data(), owner->size());
+	}
+
+	const uint8_t* data() const { return _data; }
+	size_t size() const { return _size; }
+	bool empty() const { return _size == 0; }
+
+	/**
+	 * Returns true when the view references a buffer (also when the slice is empty).
+	 */
+	bool isSet() const { return (bool)_owner; }
+
+	std::string toString() const { return _size == 0 ? std::string() : std::string((const char*)_data, _size); }
+	std::vector<uint8_t> toVector() const { return std::vector<uint8_t>(_data, _data + _size); }
+
+	void reset() { _owner.reset(); _data = nullptr; _size = 0; }
+private:
+	std::shared_ptr<const void> _owner;
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+};
+
+}
+
+#endif
@@ -511,7 +511,7 @@ void ParameterConversion::toPacket(PVariable value)
 				std::vector<std::string> arrayElements = HelperFunctions::splitAll(value->stringValue, ';');
 				for(std::vector<std::string>::iterator i = arrayElements.begin(); i != arrayElements.end(); ++i)
 				{
-					value->arrayValue->push_back(std::shared_ptr<Variable>(new Variable(Math::getDouble(*i))));
+					value->mutableArray().push_back(std::shared_ptr<Variable>(new Variable(Math::getDouble(*i))));
 				}
 				value->type = VariableType::tArray;
 				value->stringValue = "";
@@ -864,8 +864,9 @@ void HomeMaticParameter::convertToPacket(const std::shared_ptr<Variable> value,
 	{
 		convertedValue.clear();
 		if(!value) return;
-		PVariable variable(new Variable());
-		*variable = *value;
+		//Conversions only modify scalars or use the explicit copy on write methods, so arrays and structs don't need a deep
+		//copy.
+		PVariable variable = value->copyOnWrite();
 		if(logicalParameter->type == LogicalParameter::Type::Enum::typeEnum && conversion.empty())
 		{
 			LogicalParameterEnum* parameter = (LogicalParameterEnum*)logicalParameter.get();
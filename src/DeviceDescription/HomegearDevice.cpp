@@ -1294,6 +1294,13 @@ void HomegearDevice::saveParameter(xml_document* doc, xml_node* parentNode, PPar
 				propertiesNode->append_node(node);
 			}
 
+			if(parameter->suppressUnchangedEvents)
+			{
+				tempString = "true";
+				xml_node* node = doc->allocate_node(node_element, "suppressUnchangedEvents", doc->allocate_string(tempString.c_str(), tempString.size() + 1));
+				propertiesNode->append_node(node);
+			}
+
 			xml_node* node = nullptr;
 			if(!parameter->casts.empty())
 			{
@@ -89,6 +89,7 @@ void Parameter::parseXml(xml_node *node) {
         else if (propertyName == "formPosition") formPosition = Math::getNumber(propertyValue);
         else if (propertyName == "metadata") metadata = propertyValue;
         else if (propertyName == "resetAfterRestart") { resetAfterRestart = (propertyValue == "true"); }
+        else if (propertyName == "suppressUnchangedEvents") { suppressUnchangedEvents = (propertyValue == "true"); }
         else if (propertyName == "ccu2Visible") { ccu2Visible = (propertyValue == "true"); }
         else if (propertyName == "linkedParameter") { linkedParameter = propertyValue; }
         else if (propertyName == "casts") {
@@ -441,8 +442,8 @@ void Parameter::convertToPacket(const PVariable &value, const Role &role, std::v
   try {
     convertedValue.clear();
     if (!value) return;
-    PVariable variable(new Variable());
-    *variable = *value;
+    //Casts only modify scalars or use the explicit copy on write methods, so arrays and structs don't need a deep copy.
+    PVariable variable = value->copyOnWrite();
     if (logical->type == ILogical::Type::Enum::tAction && casts.empty()) {
       variable->integerValue = (int32_t)variable->booleanValue;
     } else if (logical->type == ILogical::Type::Enum::tString && casts.empty()) {
@@ -121,6 +121,16 @@ class Parameter : public std::enable_shared_from_this<Parameter> {
   std::string metadata;
   bool resetAfterRestart = false;
 
+  /**
+   * Only raise events for this variable when its value changed since the last event. Variable::hash() is only a quick
+   * pre-check, equality is confirmed with Variable::operator==, so a hash collision never suppresses a changed value.
+   * Ignored for actions like PRESS_SHORT, which are raised every time.
+   *
+   * To compare against, the peer keeps a deep copy of the last delivered value per channel, so each parameter with this
+   * flag costs the memory of one copy of its value (plus the hash) for as long as the peer exists.
+   */
+  bool suppressUnchangedEvents = false;
+
   /**
    * Deprecated. Remove beginning of 2021.
    * Visible on the HomeMatic CCU2.
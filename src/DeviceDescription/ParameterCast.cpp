@@ -748,7 +748,7 @@ void StringJsonArrayDecimal::toPacket(PVariable &value) {
   if (parameter->logical->type == ILogical::Type::Enum::tString) {
     std::vector<std::string> arrayElements = HelperFunctions::splitAll(value->stringValue, ';');
     for (auto &arrayElement : arrayElements) {
-      value->arrayValue->push_back(std::make_shared<Variable>(Math::getDouble(arrayElement)));
+      value->mutableArray().push_back(std::make_shared<Variable>(Math::getDouble(arrayElement)));
     }
     value->type = VariableType::tArray;
     value->stringValue = "";
@@ -63,6 +63,12 @@ public:
 
 	virtual bool needsBinaryPacketData() { return false; }
 	virtual void fromPacket(PVariable& value);
+
+	/**
+	 * Converts value in place. value is a copy on write copy of the caller's variable (see Variable::copyOnWrite()), so
+	 * arrays and structs must only be modified through Variable::mutableArray(), Variable::mutableStruct(), ... or be
+	 * replaced.
+	 */
 	virtual void toPacket(PVariable& value);
 protected:
 	BaseLib::SharedObjects* _bl = nullptr;
@@ -55,7 +55,7 @@ int32_t BinaryDecoder::decodeInteger(const std::vector<char>& encodedData, uint3
     {
         if(position + 1 > encodedData.size()) throw BinaryDecoderException("Unexpected end of data.");
         //IP-Symcon encodes integers as string => Difficult to interpret. This works for numbers up to 3 digits:
-        std::string string(&encodedData.at(position), encodedData.size());
+        std::string string(&encodedData.at(position), encodedData.size() - position);
         position = encodedData.size();
         integer = Math::getNumber(string);
         return integer;
@@ -72,7 +72,7 @@ int32_t BinaryDecoder::decodeInteger(const std::vector<uint8_t>& encodedData, ui
     {
         if(position + 1 > encodedData.size()) throw BinaryDecoderException("Unexpected end of data.");
         //IP-Symcon encodes integers as string => Difficult to interpret. This works for numbers up to 3 digits:
-        std::string string((char*)&encodedData.at(position), encodedData.size());
+        std::string string((char*)&encodedData.at(position), encodedData.size() - position);
         position = encodedData.size();
         integer = Math::getNumber(string);
         return integer;
@@ -176,6 +176,24 @@ std::vector<uint8_t> BinaryDecoder::decodeBinary(const std::vector<uint8_t>& enc
     return data;
 }
 
+BufferView BinaryDecoder::decodeBinaryView(const std::vector<char>& encodedData, uint32_t& position, const std::shared_ptr<const void>& owner)
+{
+    int32_t length = decodeInteger(encodedData, position);
+    if(length < 0 || position + (uint64_t)length > encodedData.size()) throw BinaryDecoderException("Unexpected end of data.");
+    BufferView view(owner, (const uint8_t*)encodedData.data() + position, (size_t)length);
+    position += length;
+    return view;
+}
+
+BufferView BinaryDecoder::decodeBinaryView(const std::vector<uint8_t>& encodedData, uint32_t& position, const std::shared_ptr<const void>& owner)
+{
+    int32_t length = decodeInteger(encodedData, position);
+    if(length < 0 || position + (uint64_t)length > encodedData.size()) throw BinaryDecoderException("Unexpected end of data.");
+    BufferView view(owner, encodedData.data() + position, (size_t)length);
+    position += length;
+    return view;
+}
+
 double BinaryDecoder::decodeFloat(const std::vector<char>& encodedData, uint32_t& position)
 {
     if(position + 8 > encodedData.size()) throw BinaryDecoderException("Unexpected end of data.");
@@ -33,6 +33,7 @@
 
 #include "Ansi.h"
 #include "../Exception.h"
+#include "../BufferView.h"
 
 #include <memory>
 #include <cstring>
@@ -77,6 +78,18 @@ public:
 	std::string decodeString(const std::vector<uint8_t>& encodedData, uint32_t& position);
     static std::vector<uint8_t> decodeBinary(const std::vector<char>& encodedData, uint32_t& position);
     static std::vector<uint8_t> decodeBinary(const std::vector<uint8_t>& encodedData, uint32_t& position);
+
+    /**
+     * Decodes a length prefixed string or binary without copying it. The returned view points into encodedData and keeps
+     * owner alive. Strings are returned as is, so this must not be used when ANSI conversion is needed.
+     *
+     * @param encodedData The encoded data. Must not be modified while the returned view exists.
+     * @param position The position to start decoding at. Will point behind the decoded data on return.
+     * @param owner The object owning encodedData.
+     * @return Returns a view of the decoded data.
+     */
+    static BufferView decodeBinaryView(const std::vector<char>& encodedData, uint32_t& position, const std::shared_ptr<const void>& owner);
+    static BufferView decodeBinaryView(const std::vector<uint8_t>& encodedData, uint32_t& position, const std::shared_ptr<const void>& owner);
     static bool decodeBoolean(const std::vector<char>& encodedData, uint32_t& position);
     static bool decodeBoolean(const std::vector<uint8_t>& encodedData, uint32_t& position);
     static double decodeFloat(const std::vector<char>& encodedData, uint32_t& position);
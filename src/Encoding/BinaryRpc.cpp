@@ -117,7 +117,31 @@ int32_t BinaryRpc::process(char* buffer, int32_t bufferLength)
 		}
 
 		_dataProcessingStarted = true;
-		_data.reserve(8 + _dataSize);
+		if(_streamDecoder) _streamDecoder->reset(_type == Type::request, (uint8_t)_data[3] == 0xFF, (8 + _dataSize) - _data.size());
+		else _data.reserve(8 + _dataSize);
+	}
+
+	if(_streamDecoder)
+	{
+		uint32_t sizeToDecode = (8 + _dataSize) - _data.size() - _decodedSize;
+		if((uint32_t)bufferLength < sizeToDecode) sizeToDecode = bufferLength;
+		try
+		{
+			_streamDecoder->process(buffer, sizeToDecode);
+		}
+		catch(const Exception& ex)
+		{
+			_finished = true;
+			throw BinaryRpcException(std::string("Error decoding packet: ") + ex.what());
+		}
+		_decodedSize += sizeToDecode;
+		bufferLength -= sizeToDecode;
+		if(_data.size() + _decodedSize == 8 + _dataSize)
+		{
+			_finished = true;
+			if(!_streamDecoder->isFinished()) throw BinaryRpcException("Packet ended before all data was decoded.");
+		}
+		return initialBufferLength - bufferLength;
 	}
 
 	if(_data.size() + bufferLength < _dataSize + 8)
@@ -132,6 +156,14 @@ int32_t BinaryRpc::process(char* buffer, int32_t bufferLength)
 	return initialBufferLength - bufferLength;
 }
 
+std::shared_ptr<std::vector<char>> BinaryRpc::takeData()
+{
+	auto data = std::make_shared<std::vector<char>>(std::move(_data));
+	_data = std::vector<char>();
+	reset();
+	return data;
+}
+
 void BinaryRpc::reset()
 {
 	_data.clear();
@@ -144,6 +176,7 @@ void BinaryRpc::reset()
 	_hasHeader = false;
 	_headerSize = 0;
 	_dataSize = 0;
+	_decodedSize = 0;
 }
 
 }
@@ -33,6 +33,7 @@
 
 #include "../Variable.h"
 #include "../Exception.h"
+#include "RpcStreamDecoder.h"
 
 namespace BaseLib
 {
@@ -78,6 +79,23 @@ public:
 	bool isFinished() { return _finished; }
 	std::vector<char>& getData() { return _data; }
 
+	/**
+	 * Decodes the packet body while it is received instead of storing it. getData() then only contains the packet
+	 * start and the header, the decoded request or response is returned by the decoder once isFinished() is true.
+	 *
+	 * @param decoder The decoder to use or nullptr to store the body in getData() again.
+	 */
+	void setStreamDecoder(const std::shared_ptr<RpcStreamDecoder>& decoder) { _streamDecoder = decoder; }
+	std::shared_ptr<RpcStreamDecoder> getStreamDecoder() { return _streamDecoder; }
+
+	/**
+	 * Moves the packet out of this object without copying it and resets the object. The returned buffer can be passed
+	 * to the RpcDecoder overloads taking shared packets, so decoded variables can reference it.
+	 *
+	 * @return The packet. Only complete when isFinished() returned true.
+	 */
+	std::shared_ptr<std::vector<char>> takeData();
+
 	void reset();
 
 	/**
@@ -100,6 +118,8 @@ private:
 	uint32_t _headerSize = 0;
 	uint32_t _dataSize = 0;
 	std::vector<char> _data;
+	std::shared_ptr<RpcStreamDecoder> _streamDecoder;
+	uint32_t _decodedSize = 0;
 };
 }
 }
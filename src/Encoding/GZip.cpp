@@ -31,6 +31,7 @@
 #include "GZip.h"
 
 #include <array>
+#include <climits>
 
 namespace BaseLib
 {
@@ -72,43 +73,132 @@ template<typename DataOut, typename DataIn> DataOut GZip::compress(const DataIn&
 
 template<typename DataOut, typename DataIn> DataOut GZip::uncompress(const DataIn& data)
 {
-    z_stream zStream{};
-    zStream.zalloc = Z_NULL;
-    zStream.zfree = Z_NULL;
-    zStream.opaque = Z_NULL;
-    zStream.avail_in = 0;
-    zStream.next_in = Z_NULL;
-    if (inflateInit2(&zStream, 16 + MAX_WBITS) != Z_OK)
+    DataOut uncompressedData;
+    uncompressedData.reserve(data.size() * 2);
+    Decompressor decompressor;
+    decompressor.decompress(data.data(), data.size(), uncompressedData);
+    return uncompressedData;
+}
+
+GZip::Compressor::Compressor(int32_t compressionLevel)
+{
+    if(deflateInit2(&_stream, compressionLevel, Z_DEFLATED, 0x1F, 8, Z_DEFAULT_STRATEGY) != Z_OK)
     {
         throw GZipException("Error initializing GZip stream.");
     }
+}
 
-    zStream.avail_in = data.size();
-    zStream.next_in = (unsigned char*)data.data();
-
-    DataOut uncompressedData;
-    uncompressedData.reserve(data.size() * 2);
-    std::array<uint8_t, 16384> uncompressedChunk{};
-    int result = 0;
+GZip::Compressor::~Compressor()
+{
+    deflateEnd(&_stream);
+}
 
+template<typename DataOut> int GZip::Compressor::write(int flush, DataOut& out)
+{
+    std::array<uint8_t, 16384> compressedChunk; //Not initialized, as zlib writes it before it is read
+    int result = Z_OK;
     do
     {
-        zStream.avail_out = uncompressedChunk.size();
-        zStream.next_out = uncompressedChunk.data();
-        result = inflate(&zStream, Z_NO_FLUSH);
-        switch (result) {
-            case Z_NEED_DICT:
-            case Z_DATA_ERROR:
-            case Z_MEM_ERROR:
-                inflateEnd(&zStream);
-                throw GZipException("Error during uncompression.");
+        _stream.avail_out = compressedChunk.size();
+        _stream.next_out = compressedChunk.data();
+        result = deflate(&_stream, flush);
+        if(result == Z_STREAM_ERROR) throw GZipException("Error during compression.");
+        out.insert(out.end(), compressedChunk.begin(), compressedChunk.begin() + (compressedChunk.size() - _stream.avail_out));
+    } while(_stream.avail_out == 0 && result != Z_STREAM_END);
+    return result;
+}
+
+template<typename DataOut> void GZip::Compressor::compress(const char* data, size_t size, DataOut& out)
+{
+    //avail_in is an unsigned int, so larger inputs are passed in slices.
+    while(size > 0)
+    {
+        unsigned int sliceSize = size > UINT_MAX ? UINT_MAX : (unsigned int)size;
+        _stream.next_in = (unsigned char*)data;
+        _stream.avail_in = sliceSize;
+        write(Z_NO_FLUSH, out);
+        size_t processedBytes = sliceSize - _stream.avail_in;
+        data += processedBytes;
+        size -= processedBytes;
+    }
+}
+
+template<typename DataOut> void GZip::Compressor::flush(DataOut& out)
+{
+    _stream.avail_in = 0;
+    write(Z_SYNC_FLUSH, out);
+}
+
+template<typename DataOut> void GZip::Compressor::finish(DataOut& out)
+{
+    _stream.avail_in = 0;
+    while(write(Z_FINISH, out) != Z_STREAM_END);
+    reset();
+}
+
+void GZip::Compressor::reset()
+{
+    deflateReset(&_stream);
+}
+
+GZip::Decompressor::Decompressor()
+{
+    if(inflateInit2(&_stream, 16 + MAX_WBITS) != Z_OK)
+    {
+        throw GZipException("Error initializing GZip stream.");
+    }
+}
+
+GZip::Decompressor::~Decompressor()
+{
+    inflateEnd(&_stream);
+}
+
+template<typename DataOut> void GZip::Decompressor::decompress(const char* data, size_t size, DataOut& out)
+{
+    std::array<uint8_t, 16384> uncompressedChunk; //Not initialized, as zlib writes it before it is read
+    //avail_in is an unsigned int, so larger inputs are passed in slices.
+    while(size > 0)
+    {
+        //A GZip file can consist of several members (e. g. "cat a.gz b.gz"). Their data is concatenated.
+        if(_finished)
+        {
+            inflateReset(&_stream);
+            _finished = false;
         }
-        uncompressedData.insert(uncompressedData.end(), uncompressedChunk.begin(), uncompressedChunk.begin() + (uncompressedChunk.size() - zStream.avail_out));
-    } while (zStream.avail_out == 0);
 
-    if (inflateEnd(&zStream) != Z_OK) throw GZipException("Error during uncompression finalization.");
+        unsigned int sliceSize = size > UINT_MAX ? UINT_MAX : (unsigned int)size;
+        _stream.next_in = (unsigned char*)data;
+        _stream.avail_in = sliceSize;
 
-    return uncompressedData;
+        int result = Z_OK;
+        do
+        {
+            _stream.avail_out = uncompressedChunk.size();
+            _stream.next_out = uncompressedChunk.data();
+            result = inflate(&_stream, Z_NO_FLUSH);
+            switch(result)
+            {
+                case Z_NEED_DICT:
+                case Z_DATA_ERROR:
+                case Z_MEM_ERROR:
+                case Z_STREAM_ERROR:
+                    throw GZipException("Error during uncompression.");
+            }
+            out.insert(out.end(), uncompressedChunk.begin(), uncompressedChunk.begin() + (uncompressedChunk.size() - _stream.avail_out));
+        } while(_stream.avail_out == 0 && result != Z_STREAM_END);
+
+        if(result == Z_STREAM_END) _finished = true;
+        size_t processedBytes = sliceSize - _stream.avail_in;
+        data += processedBytes;
+        size -= processedBytes;
+    }
+}
+
+void GZip::Decompressor::reset()
+{
+    inflateReset(&_stream);
+    _finished = false;
 }
 
 #ifndef DOXYGEN_SKIP
@@ -120,6 +210,14 @@ template std::vector<char> GZip::uncompress(const std::vector<char>& data);
 template std::string GZip::uncompress(const std::string& data);
 template std::vector<char> GZip::uncompress(const std::string& data);
 template std::string GZip::uncompress(const std::vector<char>& data);
+template void GZip::Compressor::compress(const char* data, size_t size, std::vector<char>& out);
+template void GZip::Compressor::compress(const char* data, size_t size, std::string& out);
+template void GZip::Compressor::flush(std::vector<char>& out);
+template void GZip::Compressor::flush(std::string& out);
+template void GZip::Compressor::finish(std::vector<char>& out);
+template void GZip::Compressor::finish(std::string& out);
+template void GZip::Decompressor::decompress(const char* data, size_t size, std::vector<char>& out);
+template void GZip::Decompressor::decompress(const char* data, size_t size, std::string& out);
 #endif
 
 }
\ No newline at end of file
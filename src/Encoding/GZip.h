@@ -54,6 +54,98 @@ public:
     template<typename DataOut, typename DataIn> static DataOut compress(const DataIn& data, int32_t compressionLevel);
 
     template<typename DataOut, typename DataIn> static DataOut uncompress(const DataIn& data);
+
+    /**
+     * Compresses a GZip stream chunk by chunk. The zlib context is created once and reset by finish(), so one object
+     * can be used for many streams without the cost of deflateInit() for each of them.
+     */
+    class Compressor
+    {
+    public:
+        /**
+         * @param compressionLevel The zlib compression level (0 to 9 or Z_DEFAULT_COMPRESSION).
+         * @throws GZipException
+         */
+        explicit Compressor(int32_t compressionLevel = Z_DEFAULT_COMPRESSION);
+        virtual ~Compressor();
+        Compressor(const Compressor&) = delete;
+        Compressor& operator=(const Compressor&) = delete;
+
+        /**
+         * Compresses the next chunk. zlib buffers data internally, so the output might be empty.
+         *
+         * @param data The data to compress.
+         * @param size The size of "data".
+         * @param[out] out The container the compressed data is appended to.
+         * @throws GZipException
+         */
+        template<typename DataOut> void compress(const char* data, size_t size, DataOut& out);
+
+        /**
+         * Appends all data compressed so far (Z_SYNC_FLUSH), so the receiver can decompress it without waiting for the
+         * end of the stream. Flushing too often worsens compression.
+         *
+         * @throws GZipException
+         */
+        template<typename DataOut> void flush(DataOut& out);
+
+        /**
+         * Appends the remaining compressed data and the GZip trailer. Afterwards the compressor starts a new stream.
+         *
+         * @throws GZipException
+         */
+        template<typename DataOut> void finish(DataOut& out);
+
+        /**
+         * Discards the current stream and starts a new one.
+         */
+        void reset();
+    private:
+        z_stream _stream{};
+
+        template<typename DataOut> int write(int flush, DataOut& out);
+    };
+
+    /**
+     * Decompresses a GZip stream chunk by chunk. The zlib context is created once and can be reused with reset().
+     * Streams of several concatenated GZip members are decompressed completely, like gunzip does. Data after the last
+     * member that is no GZip member is an error.
+     */
+    class Decompressor
+    {
+    public:
+        /**
+         * @throws GZipException
+         */
+        Decompressor();
+        virtual ~Decompressor();
+        Decompressor(const Decompressor&) = delete;
+        Decompressor& operator=(const Decompressor&) = delete;
+
+        /**
+         * Returns "true" when all data passed so far ended with a complete GZip member. Further input starts the next
+         * member.
+         */
+        bool isFinished() { return _finished; }
+
+        /**
+         * Decompresses the next chunk.
+         *
+         * @param data The compressed data.
+         * @param size The size of "data".
+         * @param[out] out The container the uncompressed data is appended to.
+         * @throws GZipException
+         */
+        template<typename DataOut> void decompress(const char* data, size_t size, DataOut& out);
+
+        /**
+         * Discards the current stream and starts a new one.
+         */
+        void reset();
+    private:
+        z_stream _stream{};
+        bool _finished = false;
+    };
 private:
     GZip() = default;
 };
@@ -32,11 +32,178 @@
 #include "../HelperFunctions/Math.h"
 #include "../HelperFunctions/HelperFunctions.h"
 
+#include <algorithm>
 #include <iomanip>
 
 namespace BaseLib
 {
 
+namespace
+{
+
+struct KnownHeaderFieldName
+{
+	const char* name;
+	uint32_t size;
+	Http::KnownHeaderField::Enum field;
+};
+
+const KnownHeaderFieldName knownHeaderFieldNames[] =
+{
+	{ "accept", 6, Http::KnownHeaderField::accept },
+	{ "accept-encoding", 15, Http::KnownHeaderField::acceptEncoding },
+	{ "authorization", 13, Http::KnownHeaderField::authorization },
+	{ "connection", 10, Http::KnownHeaderField::connection },
+	{ "content-encoding", 16, Http::KnownHeaderField::contentEncoding },
+	{ "content-length", 14, Http::KnownHeaderField::contentLength },
+	{ "content-type", 12, Http::KnownHeaderField::contentType },
+	{ "cookie", 6, Http::KnownHeaderField::cookie },
+	{ "host", 4, Http::KnownHeaderField::host },
+	{ "origin", 6, Http::KnownHeaderField::origin },
+	{ "sec-websocket-key", 17, Http::KnownHeaderField::secWebSocketKey },
+	{ "sec-websocket-protocol", 22, Http::KnownHeaderField::secWebSocketProtocol },
+	{ "sec-websocket-version", 21, Http::KnownHeaderField::secWebSocketVersion },
+	{ "te", 2, Http::KnownHeaderField::te },
+	{ "transfer-encoding", 17, Http::KnownHeaderField::transferEncoding },
+	{ "upgrade", 7, Http::KnownHeaderField::upgrade },
+	{ "user-agent", 10, Http::KnownHeaderField::userAgent }
+};
+
+/**
+ * Compares case-insensitively. "lowercaseName" needs to be lower case.
+ */
+bool equalsIgnoreCase(const char* data, size_t size, const char* lowercaseName, size_t lowercaseNameSize)
+{
+	if(size != lowercaseNameSize) return false;
+	for(size_t i = 0; i < size; i++)
+	{
+		if(std::tolower((unsigned char)data[i]) != lowercaseName[i]) return false;
+	}
+	return true;
+}
+
+template<size_t size>
+inline bool equalsIgnoreCase(const char* data, size_t dataSize, const char (&lowercaseName)[size])
+{
+	return equalsIgnoreCase(data, dataSize, lowercaseName, size - 1);
+}
+
+Http::KnownHeaderField::Enum getKnownHeaderField(const char* name, uint32_t nameSize)
+{
+	for(auto& knownName : knownHeaderFieldNames)
+	{
+		if(equalsIgnoreCase(name, nameSize, knownName.name, knownName.size)) return knownName.field;
+	}
+	return Http::KnownHeaderField::count;
+}
+
+/**
+ * Calls "function" for each comma separated element of a header field value up to the first ";". Whitespace around
+ * the elements is removed. An empty element at the end is skipped.
+ */
+template<typename Function>
+void forEachElement(const char* value, uint32_t valueSize, Function function)
+{
+	const char* end = (const char*)memchr(value, ';', valueSize);
+	if(!end) end = value + valueSize;
+	const char* start = value;
+	while(start != end)
+	{
+		const char* comma = (const char*)memchr(start, ',', end - start);
+		const char* elementStart = start;
+		const char* elementEnd = comma ? comma : end;
+		while(elementStart < elementEnd && std::isspace((unsigned char)*elementStart)) elementStart++;
+		while(elementEnd > elementStart && std::isspace((unsigned char)*(elementEnd - 1))) elementEnd--;
+		function(elementStart, (size_t)(elementEnd - elementStart));
+		if(!comma) break;
+		start = comma + 1;
+	}
+}
+
+/**
+ * Appends the status line and the header fields constructHeader() and constructChunkedHeader() have in common.
+ */
+void constructHeaderStart(const std::string& contentType, int32_t code, std::string codeDescription, const std::vector<std::string>& additionalHeaders, std::string& header)
+{
+	std::string additionalHeader;
+	additionalHeader.reserve(1024);
+	for(auto& entry : additionalHeaders)
+	{
+		if(entry.find("Location: ") == 0)
+		{
+			code = 301;
+			codeDescription = "Moved Permanently";
+		}
+		if(additionalHeader.size() + entry.size() > additionalHeader.capacity()) additionalHeader.reserve(additionalHeader.size() + entry.size() + 1024);
+		if(!entry.empty()) additionalHeader.append(entry + "\r\n");
+	}
+
+	header.reserve(1024);
+	header.append("HTTP/1.1 " + std::to_string(code) + " " + codeDescription + "\r\n");
+	if(!contentType.empty()) header.append("Content-Type: " + contentType + "\r\n");
+	header.append(additionalHeader);
+}
+
+/**
+ * Writes the chunk size in hexadecimal followed by CRLF in front of "end".
+ *
+ * @return Returns the length of the line.
+ */
+size_t writeChunkSizeLine(size_t size, char* end)
+{
+	static const char hexDigits[] = "0123456789abcdef";
+	char* start = end - 2;
+	start[0] = '\r';
+	start[1] = '\n';
+	do
+	{
+		*(--start) = hexDigits[size & 0xF];
+		size >>= 4;
+	} while(size > 0);
+	return end - start;
+}
+
+/**
+ * Stores a header field of a multipart block in "formData".
+ */
+void processFormDataHeaderField(Http::FormData& formData, std::string& name, const std::string& value)
+{
+	HelperFunctions::toLower(name);
+	formData.header.emplace(name, value);
+	if(name == "content-disposition")
+	{
+		formData.contentDisposition = value;
+
+		std::vector<std::string> parts;
+		std::string args = HelperFunctions::splitFirst(value, ';').second;
+		if(args.empty())
+		{
+			args = HelperFunctions::splitFirst(value, ',').second;
+			parts = HelperFunctions::splitAll(value, ',');
+		}
+		else parts = HelperFunctions::splitAll(value, ';');
+
+		for(auto& part : parts)
+		{
+			auto arg = HelperFunctions::splitFirst(part, '=');
+			HelperFunctions::trim(arg.first);
+			HelperFunctions::toLower(arg.first);
+			HelperFunctions::trim(arg.second);
+			if(arg.second.size() > 1 && arg.second.front() == '"' && arg.second.back() == '"') arg.second = arg.second.substr(1, arg.second.size() - 2);
+			if(arg.first == "name") formData.name = arg.second;
+			if(arg.first == "filename") formData.filename = arg.second;
+		}
+	}
+	else if(name == "content-type")
+	{
+		formData.contentTypeFull = value;
+		formData.contentType = HelperFunctions::splitFirst(value, ';').first;
+		HelperFunctions::toLower(formData.contentType);
+	}
+}
+
+}
+
 const std::map <std::string, std::string> Http::_extMimeTypeMap = {
     {"html", "text/html"},
     {"htm", "text/html"},
@@ -168,27 +335,156 @@ std::set<std::shared_ptr<Http::FormData>> Http::decodeMultipartFormdata()
 	std::set<std::shared_ptr<FormData>> formData;
 	if(_header.contentType != "multipart/form-data") return formData;
 
-	std::string temp(_content.data(), _content.size());
+	std::string boundary = MultipartDecoder::getBoundary(_header.contentTypeFull);
+	if(boundary.empty()) return formData;
 
-	std::string boundary;
-	std::vector<std::string> parts = HelperFunctions::splitAll(_header.contentTypeFull, ';');
+	char* pos = _content.data();
+	formData = decodeMultipartMixed(boundary, _content.data(), _content.size(), &pos);
+
+	return formData;
+}
+
+Http::MultipartDecoder::MultipartDecoder(const std::string& boundary, std::function<void(Event::Enum event, const FormData& part, const char* data, size_t size)> callback) : _callback(std::move(callback))
+{
+	//The delimiter search relies on '\r' only being at the start of the delimiter. Boundaries can't contain line breaks (RFC 2046).
+	if(boundary.empty() || boundary.find_first_of("\r\n") != std::string::npos) throw HttpException("Invalid multipart boundary.");
+	_delimiter = "\r\n--" + boundary;
+	reset();
+}
+
+std::string Http::MultipartDecoder::getBoundary(const std::string& contentTypeFull)
+{
+	std::vector<std::string> parts = HelperFunctions::splitAll(contentTypeFull, ';');
 	for(auto& part : parts)
 	{
 		auto arg = HelperFunctions::splitFirst(part, '=');
 		HelperFunctions::trim(arg.first);
-		if(arg.first == "boundary")
-		{
-			boundary = HelperFunctions::trim(arg.second);
-			break;
-		}
+		if(arg.first == "boundary") return HelperFunctions::trim(arg.second);
 	}
+	return "";
+}
 
-	if(boundary.empty()) return formData;
+void Http::MultipartDecoder::reset()
+{
+	_state = State::preamble;
+	_matchedSize = 2; //The first delimiter doesn't need to be preceded by a line break.
+	_line.clear();
+	_headerSize = 0;
+	_part = FormData();
+}
 
-	char* pos = _content.data();
-	formData = decodeMultipartMixed(boundary, _content.data(), _content.size(), &pos);
+void Http::MultipartDecoder::decode(const char* data, size_t size)
+{
+	const char* end = data + size;
+	while(data < end && _state != State::finished)
+	{
+		if(_state == State::preamble || _state == State::data)
+		{
+			if(_matchedSize > 0)
+			{
+				//Continue the match from the previous buffer.
+				size_t compareSize = std::min((size_t)(end - data), _delimiter.size() - _matchedSize);
+				if(memcmp(data, _delimiter.data() + _matchedSize, compareSize) == 0)
+				{
+					_matchedSize += compareSize;
+					data += compareSize;
+					if(_matchedSize < _delimiter.size()) break;
+					if(_state == State::data) _callback(Event::partEnd, _part, nullptr, 0);
+					_matchedSize = 0;
+					_state = State::boundaryLine;
+					continue;
+				}
+				//No delimiter, so the held back characters are content.
+				if(_state == State::data) _callback(Event::partData, _part, _delimiter.data(), _matchedSize);
+				_matchedSize = 0;
+			}
 
-	return formData;
+			const char* contentStart = data;
+			const char* delimiterPos = nullptr;
+			while(data < end)
+			{
+				data = (const char*)memchr(data, '\r', end - data);
+				if(!data)
+				{
+					data = end;
+					break;
+				}
+				size_t compareSize = std::min((size_t)(end - data), _delimiter.size());
+				if(memcmp(data, _delimiter.data(), compareSize) == 0)
+				{
+					delimiterPos = data;
+					break;
+				}
+				data++;
+			}
+
+			const char* contentEnd = delimiterPos ? delimiterPos : end;
+			if(_state == State::data && contentEnd > contentStart) _callback(Event::partData, _part, contentStart, contentEnd - contentStart);
+			if(!delimiterPos) break;
+			size_t delimiterSize = std::min((size_t)(end - delimiterPos), _delimiter.size());
+			data = delimiterPos + delimiterSize;
+			if(delimiterSize < _delimiter.size())
+			{
+				//The delimiter might be split between buffers. Its start is held back.
+				_matchedSize = delimiterSize;
+				break;
+			}
+			if(_state == State::data) _callback(Event::partEnd, _part, nullptr, 0);
+			_state = State::boundaryLine;
+		}
+		else
+		{
+			//Boundary line or header line
+			const char* newlinePos = (const char*)memchr(data, '\n', end - data);
+			const char* lineEnd = newlinePos ? newlinePos : end;
+			if(_state == State::boundaryLine)
+			{
+				//Only the first two characters are needed to detect the final boundary.
+				if(_line.size() < 2) _line.append(data, std::min((size_t)(lineEnd - data), 2 - _line.size()));
+				if(_line.size() == 2 && _line[0] == '-' && _line[1] == '-')
+				{
+					_state = State::finished;
+					break;
+				}
+			}
+			else
+			{
+				_headerSize += lineEnd - data;
+				if(_headerSize > 102400) throw HttpException("Multipart header is too large.");
+				_line.append(data, lineEnd);
+			}
+			if(!newlinePos)
+			{
+				data = end;
+				break;
+			}
+			data = newlinePos + 1;
+			if(_state == State::boundaryLine)
+			{
+				_state = State::header;
+				_headerSize = 0;
+				_part = FormData();
+			}
+			else if(_line.empty() || _line == "\r")
+			{
+				_state = State::data;
+				_callback(Event::partBegin, _part, nullptr, 0);
+			}
+			else processHeaderLine();
+			_line.clear();
+		}
+	}
+}
+
+void Http::MultipartDecoder::processHeaderLine()
+{
+	if(_line.back() == '\r') _line.pop_back();
+	auto colonPos = _line.find(':');
+	if(colonPos == std::string::npos || colonPos == 0) return;
+	std::string name = _line.substr(0, colonPos);
+	std::string value = _line.substr(colonPos + 1);
+	HelperFunctions::trim(value);
+	processFormDataHeaderField(_part, name, value);
 }
 
 char* Http::findNextString(std::string& needle, char* buffer, size_t bufferSize)
@@ -266,41 +562,8 @@ std::set<std::shared_ptr<Http::FormData>> Http::decodeMultipartMixed(std::string
 					}
 
 					std::string name(*pos, (uint32_t)(colonPos - *pos));
-					HelperFunctions::toLower(name);
 					std::string value(valuePos, valueSize);
-
-					blockData->header.emplace(name, value);
-					if(name == "content-disposition")
-					{
-						blockData->contentDisposition = value;
-
-						std::vector<std::string> parts;
-						std::string args = HelperFunctions::splitFirst(value, ';').second;
-						if(args.empty())
-						{
-							args = HelperFunctions::splitFirst(value, ',').second;
-							parts = HelperFunctions::splitAll(value, ',');
-						}
-						else parts = HelperFunctions::splitAll(value, ';');
-
-						for(auto& part : parts)
-						{
-							auto arg = HelperFunctions::splitFirst(part, '=');
-							HelperFunctions::trim(arg.first);
-							HelperFunctions::toLower(arg.first);
-							HelperFunctions::trim(arg.second);
-							if(arg.second.size() > 1 && arg.second.front() == '"' && arg.second.back() == '"') arg.second = arg.second.substr(1, arg.second.size() - 2);
-							if(arg.first == "name") blockData->name = arg.second;
-							if(arg.first == "filename") blockData->filename = arg.second;
-						}
-					}
-					else if(name == "content-type")
-					{
-						blockData->contentTypeFull = value;
-						blockData->contentType = HelperFunctions::splitFirst(value, ',').first;
-						blockData->contentType = HelperFunctions::splitFirst(value, ';').first;
-						HelperFunctions::toLower(blockData->contentType);
-					}
+					processFormDataHeaderField(*blockData, name, value);
 				}
 
 				*pos = newlinePos + crlfOffset;
@@ -349,28 +612,102 @@ std::set<std::shared_ptr<Http::FormData>> Http::decodeMultipartMixed(std::string
 
 void Http::constructHeader(uint32_t contentLength, std::string contentType, int32_t code, std::string codeDescription, const std::vector<std::string>& additionalHeaders, std::string& header)
 {
-	std::string additionalHeader;
-	additionalHeader.reserve(1024);
-	for(auto& entry : additionalHeaders)
+	constructHeaderStart(contentType, code, codeDescription, additionalHeaders, header);
+	header.append("Content-Length: ").append(std::to_string(contentLength)).append("\r\n\r\n");
+}
+
+void Http::constructChunkedHeader(std::string contentType, int32_t code, std::string codeDescription, const std::vector<std::string>& additionalHeaders, std::string& header)
+{
+	constructHeaderStart(contentType, code, codeDescription, additionalHeaders, header);
+	header.append("Transfer-Encoding: chunked\r\n\r\n");
+}
+
+constexpr size_t Http::ChunkedWriter::_sizeLineSpace;
+
+Http::ChunkedWriter::ChunkedWriter(std::function<void(const char* data, size_t size)> send, size_t chunkSize) : _send(std::move(send)), _chunkSize(chunkSize == 0 ? 1 : chunkSize)
+{
+	_packet.reserve(_sizeLineSpace + _chunkSize + 2);
+	_packet.resize(_sizeLineSpace);
+}
+
+void Http::ChunkedWriter::writeHeader(int32_t code, const std::string& contentType, const std::vector<std::string>& additionalHeaders)
+{
+	if(_headerWritten) throw HttpException("The header was already written.");
+	auto statusIterator = _statusCodeMap.find(code);
+	std::string header;
+	constructChunkedHeader(contentType, code, statusIterator == _statusCodeMap.end() ? "" : statusIterator->second, additionalHeaders, header);
+	_send(header.data(), header.size());
+	_headerWritten = true;
+	_finished = false;
+}
+
+void Http::ChunkedWriter::write(const char* data, size_t size)
+{
+	if(!_headerWritten) throw HttpException("The header needs to be written first.");
+	while(size > 0)
 	{
-		if(entry.find("Location: ") == 0)
+		if(contentSize() == 0 && size >= _chunkSize)
 		{
-			code = 301;
-			codeDescription = "Moved Permanently";
+			//Nothing to combine with, so send the data as it is.
+			std::array<char, _sizeLineSpace> sizeLine;
+			size_t sizeLineLength = writeChunkSizeLine(_chunkSize, sizeLine.data() + sizeLine.size());
+			_send(sizeLine.data() + sizeLine.size() - sizeLineLength, sizeLineLength);
+			_send(data, _chunkSize);
+			_send("\r\n", 2);
+			data += _chunkSize;
+			size -= _chunkSize;
+			continue;
 		}
-		if(additionalHeader.size() + entry.size() > additionalHeader.capacity()) additionalHeader.reserve(additionalHeader.size() + entry.size() + 1024);
-		if(!entry.empty()) additionalHeader.append(entry + "\r\n");
+		size_t sizeToInsert = std::min(size, _chunkSize - contentSize());
+		_packet.insert(_packet.end(), data, data + sizeToInsert);
+		data += sizeToInsert;
+		size -= sizeToInsert;
+		if(contentSize() >= _chunkSize) flush();
 	}
+}
 
-	header.reserve(1024);
-	header.append("HTTP/1.1 " + std::to_string(code) + " " + codeDescription + "\r\n");
-	if(!contentType.empty()) header.append("Content-Type: " + contentType + "\r\n");
-	header.append(additionalHeader);
-	header.append("Content-Length: ").append(std::to_string(contentLength)).append("\r\n\r\n");
+size_t Http::ChunkedWriter::encodeChunk()
+{
+	size_t sizeLineLength = writeChunkSizeLine(contentSize(), _packet.data() + _sizeLineSpace);
+	_packet.push_back('\r');
+	_packet.push_back('\n');
+	return _sizeLineSpace - sizeLineLength;
+}
+
+void Http::ChunkedWriter::flush()
+{
+	if(contentSize() == 0) return; //An empty chunk would end the content.
+	size_t offset = encodeChunk();
+	_send(_packet.data() + offset, _packet.size() - offset);
+	_packet.resize(_sizeLineSpace);
+}
+
+void Http::ChunkedWriter::finish(const std::vector<std::string>& trailers)
+{
+	if(!_headerWritten) throw HttpException("The header needs to be written first.");
+	//The last chunk is sent together with the remaining content.
+	size_t offset = contentSize() == 0 ? _sizeLineSpace : encodeChunk();
+	_packet.push_back('0');
+	_packet.push_back('\r');
+	_packet.push_back('\n');
+	for(auto& trailer : trailers)
+	{
+		if(trailer.empty()) continue;
+		_packet.insert(_packet.end(), trailer.begin(), trailer.end());
+		_packet.push_back('\r');
+		_packet.push_back('\n');
+	}
+	_packet.push_back('\r');
+	_packet.push_back('\n');
+	_send(_packet.data() + offset, _packet.size() - offset);
+	_packet.resize(_sizeLineSpace);
+	_headerWritten = false;
+	_finished = true;
 }
 
 Http::Http()
 {
+	_knownHeaderFields.fill(-1);
 }
 
 Http::~Http()
@@ -418,12 +755,34 @@ void Http::unserialize(PVariable data)
 int32_t Http::process(char* buffer, int32_t bufferLength, bool checkForChunkedXml, bool checkForChunkedJson)
 {
 	if(bufferLength <= 0) return 0;
-	if(_finished) reset();
-	_headerProcessingStarted = true;
+	if(_finished) resetMessage();
 	int32_t processedBytes = 0;
-	if(!_header.parsed) processedBytes = processHeader(&buffer, bufferLength);
+	if(_rawHeader.empty())
+	{
+		if(_skipTrailer)
+		{
+			char* bufferStart = buffer;
+			skipTrailer(&buffer, bufferLength);
+			processedBytes = buffer - bufferStart;
+			if(bufferLength == 0) return processedBytes;
+		}
+
+		//Skip empty lines in front of the start line, e. g. the end of the previous message when the connection is persistent.
+		if(_rawHeader.empty())
+		{
+			int32_t emptyLineBytes = 0;
+			while(emptyLineBytes < bufferLength && (buffer[emptyLineBytes] == '\r' || buffer[emptyLineBytes] == '\n')) emptyLineBytes++;
+			processedBytes += emptyLineBytes;
+			if(emptyLineBytes == bufferLength) return processedBytes;
+			buffer += emptyLineBytes;
+			bufferLength -= emptyLineBytes;
+		}
+	}
+	_headerProcessingStarted = true;
+	if(!_header.parsed) processedBytes += processHeader(&buffer, bufferLength);
 	if(!_header.parsed) return processedBytes;
-	if((_header.method == "GET" && _header.contentLength == 0) || (_header.method == "DELETE" && _header.contentLength == 0) || _header.method == "M-SEARCH" || (_header.method == "NOTIFY" && _header.contentLength == 0) || (_contentLengthSet && _header.contentLength == 0))
+	if((_header.method == "GET" && _header.contentLength == 0) || (_header.method == "DELETE" && _header.contentLength == 0) || _header.method == "M-SEARCH" || (_header.method == "NOTIFY" && _header.contentLength == 0) || (_contentLengthSet && _header.contentLength == 0) ||
+		(_type == Type::Enum::response && (_header.responseCode == 204 || _header.responseCode == 304))) //Responses without body. Otherwise the content is read until the connection is closed.
 	{
 		_dataProcessingStarted = true;
 		setFinished();
@@ -462,63 +821,88 @@ int32_t Http::process(char* buffer, int32_t bufferLength, bool checkForChunkedXm
 	return processedBytes;
 }
 
+uint32_t Http::processAll(char* buffer, int32_t bufferLength, const std::function<void(Http& message)>& messageCallback)
+{
+	uint32_t messageCount = 0;
+	while(bufferLength > 0)
+	{
+		int32_t processedBytes = process(buffer, bufferLength);
+		if(_finished)
+		{
+			messageCount++;
+			messageCallback(*this);
+			resetMessage();
+		}
+		if(processedBytes <= 0) break;
+		buffer += processedBytes;
+		bufferLength -= processedBytes;
+	}
+	return messageCount;
+}
+
 int32_t Http::processHeader(char** buffer, int32_t& bufferLength)
 {
-	char* end = (char*)memmem(*buffer, bufferLength, "\r\n\r\n", 4);
 	uint32_t headerSize = 0;
 	int32_t crlfOffset = 2;
-	if(!end || ((end + 3) - *buffer) + 1 > bufferLength)
+	//Check for the split case first. Otherwise an empty line in the content or in a following message would be taken for the end of the header.
+	char first = **buffer;
+	char second = bufferLength > 1 ? *(*buffer + 1) : 0;
+	char third = bufferLength > 2 ? *(*buffer + 2) : 0;
+	if(_rawHeader.size() > 2 && (
+			(_rawHeader.back() == '\n' && first == '\n') ||
+			(_rawHeader.back() == '\r' && first == '\n' && second == '\r') ||
+			(_rawHeader.at(_rawHeader.size() - 2) == '\r' && _rawHeader.back() == '\n' && first == '\r') ||
+			(_rawHeader.at(_rawHeader.size() - 2) == '\n' && _rawHeader.back() == '\r' && first == '\n')
+	))
 	{
-		end = (char*)memmem(*buffer, bufferLength, "\n\n", 2);
-		if(!end || ((end + 1) - *buffer) + 1 > bufferLength)
+		//Special case: The two new lines are split between _rawHeader and buffer
+		//Cases:
+		//	For crlf:
+		//		rawHeader = ...\n, buffer = \n...
+		//	For lf:
+		//		rawHeader = ...\r, buffer = \n\r\n...
+		//		rawHeader = ...\r\n, buffer = \r\n...
+		//		rawHeader = ...\r\n\r, buffer = \n...
+		if(first == '\n' && second != '\r') //rawHeader = ...\r\n\r, buffer = \n... or rawHeader = ...\n, buffer = \n...
 		{
-			if(_rawHeader.size() > 2 && (
-					(_rawHeader.back() == '\n' && **buffer == '\n') ||
-					(_rawHeader.back() == '\r' && **buffer == '\n' && *(*buffer + 1) == '\r') ||
-					(_rawHeader.at(_rawHeader.size() - 2) == '\r' && _rawHeader.back() == '\n' && **buffer == '\r') ||
-					(_rawHeader.at(_rawHeader.size() - 2) == '\n' && _rawHeader.back() == '\r' && **buffer == '\n')
-			))
-			{
-				//Special case: The two new lines are split between _rawHeader and buffer
-				//Cases:
-				//	For crlf:
-				//		rawHeader = ...\n, buffer = \n...
-				//	For lf:
-				//		rawHeader = ...\r, buffer = \n\r\n...
-				//		rawHeader = ...\r\n, buffer = \r\n...
-				//		rawHeader = ...\r\n\r, buffer = \n...
-				if(**buffer == '\n' && *(*buffer + 1) != '\r') //rawHeader = ...\r\n\r, buffer = \n... or rawHeader = ...\n, buffer = \n...
-				{
-					headerSize = 1;
-					if(_rawHeader.back() == '\r') crlfOffset = 2;
-					else crlfOffset = 1;
-				}
-				else if(**buffer == '\n' && *(*buffer + 1) == '\r' && *(*buffer + 2) == '\n') //rawHeader = ...\r, buffer = \n\r\n...
-				{
-					headerSize = 3;
-					crlfOffset = 2;
-				}
-				else if(**buffer == '\r' && *(*buffer + 1) == '\n') //rawHeader = ...\r\n, buffer = \r\n...
-				{
-					headerSize = 2;
-					crlfOffset = 2;
-				}
-			}
-			else
+			headerSize = 1;
+			if(_rawHeader.back() == '\r') crlfOffset = 2;
+			else crlfOffset = 1;
+		}
+		else if(first == '\n' && second == '\r' && third == '\n') //rawHeader = ...\r, buffer = \n\r\n...
+		{
+			headerSize = 3;
+			crlfOffset = 2;
+		}
+		else if(first == '\r' && second == '\n') //rawHeader = ...\r\n, buffer = \r\n...
+		{
+			headerSize = 2;
+			crlfOffset = 2;
+		}
+	}
+
+	char* end = nullptr;
+	if(headerSize == 0)
+	{
+		end = (char*)memmem(*buffer, bufferLength, "\r\n\r\n", 4);
+		if(!end || ((end + 3) - *buffer) + 1 > bufferLength)
+		{
+			end = (char*)memmem(*buffer, bufferLength, "\n\n", 2);
+			if(!end || ((end + 1) - *buffer) + 1 > bufferLength)
 			{
 				if(_rawHeader.size() + bufferLength > _maxHeaderSize)  throw HttpException("Header is larger than " + std::to_string(_maxHeaderSize) + " bytes.");
 				_rawHeader.insert(_rawHeader.end(), *buffer, *buffer + bufferLength);
 				return bufferLength;
 			}
+			else
+			{
+				crlfOffset = 1;
+				_crlf = false;
+				headerSize = ((end + 1) - *buffer) + 1;
+			}
 		}
-		else
-		{
-			crlfOffset = 1;
-			_crlf = false;
-			headerSize = ((end + 1) - *buffer) + 1;
-		}
+		else headerSize = ((end + 3) - *buffer) + 1;
 	}
-	else headerSize = ((end + 3) - *buffer) + 1;
 
 	if(_rawHeader.size() + headerSize > _maxHeaderSize)  throw HttpException("Header is larger than " + std::to_string(_maxHeaderSize) + " bytes.");
 	_rawHeader.insert(_rawHeader.end(), *buffer, *buffer + headerSize);
@@ -611,94 +995,72 @@ void Http::processHeaderField(char* name, uint32_t nameSize, char* value, uint32
 		value++;
 		valueSize--;
 	}
-	if(nameSize == 14 && !strnaicmp(name, "content-length", nameSize))
+
+	KnownHeaderField::Enum knownField = getKnownHeaderField(name, nameSize);
+	if(knownField == KnownHeaderField::contentLength)
 	{
 		//Ignore Content-Length when Transfer-Encoding is present. See: http://greenbytes.de/tech/webdav/rfc2616.html#rfc.section.4.4
 		if(_header.transferEncoding == TransferEncoding::Enum::none)
 		{
 			_contentLengthSet = true;
-			_header.contentLength = strtol(value, nullptr, 10);
+			_header.contentLength = strtol(std::string(value, valueSize).c_str(), nullptr, 10); //Copy, so parsing can't run past the end of the raw header
 		}
 	}
-	else if(nameSize == 4 && !strnaicmp(name, "host", nameSize))
+	else if(knownField == KnownHeaderField::host)
 	{
 		_header.host = std::string(value, valueSize);
 		HelperFunctions::toLower(_header.host);
 		HelperFunctions::stringReplace(_header.host, "../", "");
 	}
-	else if(nameSize == 12 && !strnaicmp(name, "content-type", nameSize))
+	else if(knownField == KnownHeaderField::contentType)
 	{
-		_header.contentType = std::string(value, valueSize);
-		_header.contentTypeFull = _header.contentType;
-		_header.contentType = HelperFunctions::splitFirst(_header.contentType, ';').first;
+		_header.contentTypeFull.assign(value, valueSize);
+		const char* semicolon = (const char*)memchr(value, ';', valueSize);
+		_header.contentType.assign(value, semicolon ? (size_t)(semicolon - value) : valueSize);
 		HelperFunctions::toLower(_header.contentType);
 	}
-    else if(nameSize == 15 && !strnaicmp(name, "accept-encoding", nameSize))
-    {
-        std::string s(value, valueSize);
-        s = s.substr(0, s.find(';'));
-        int32_t pos = 0;
-        while ((pos = s.find(',')) != (signed)std::string::npos || !s.empty())
-        {
-            std::string ae = (pos == (signed)std::string::npos) ? s : s.substr(0, pos);
-            HelperFunctions::trim(BaseLib::HelperFunctions::toLower(ae));
-            if(ae == "br") _header.acceptEncoding = (AcceptEncoding::Enum)(_header.acceptEncoding | AcceptEncoding::Enum::br);
-            else if(ae == "gzip") _header.acceptEncoding = (AcceptEncoding::Enum)(_header.acceptEncoding | AcceptEncoding::Enum::gzip);
-            else if(ae == "deflate") _header.acceptEncoding = (AcceptEncoding::Enum)(_header.acceptEncoding | AcceptEncoding::Enum::deflate);
-            if(pos == (signed)std::string::npos) s.clear(); else s.erase(0, pos + 1);
-        }
-    }
-	else if(nameSize == 16 && !strnaicmp(name, "content-encoding", nameSize))
+	else if(knownField == KnownHeaderField::acceptEncoding)
+	{
+		forEachElement(value, valueSize, [&](const char* element, size_t elementSize)
+		{
+			if(equalsIgnoreCase(element, elementSize, "br")) _header.acceptEncoding = (AcceptEncoding::Enum)(_header.acceptEncoding | AcceptEncoding::Enum::br);
+			else if(equalsIgnoreCase(element, elementSize, "gzip")) _header.acceptEncoding = (AcceptEncoding::Enum)(_header.acceptEncoding | AcceptEncoding::Enum::gzip);
+			else if(equalsIgnoreCase(element, elementSize, "deflate")) _header.acceptEncoding = (AcceptEncoding::Enum)(_header.acceptEncoding | AcceptEncoding::Enum::deflate);
+		});
+	}
+	else if(knownField == KnownHeaderField::contentEncoding)
 	{
-		std::string s(value, valueSize);
-		s = s.substr(0, s.find(';'));
-		int32_t pos = 0;
-		while ((pos = s.find(',')) != (signed)std::string::npos || !s.empty())
+		forEachElement(value, valueSize, [&](const char* element, size_t elementSize)
 		{
-			std::string ce = (pos == (signed)std::string::npos) ? s : s.substr(0, pos);
-			HelperFunctions::trim(BaseLib::HelperFunctions::toLower(ce));
-			if(ce == "gzip") _header.contentEncoding = (ContentEncoding::Enum)(_header.contentEncoding | ContentEncoding::Enum::gzip);
+			if(equalsIgnoreCase(element, elementSize, "gzip")) _header.contentEncoding = (ContentEncoding::Enum)(_header.contentEncoding | ContentEncoding::Enum::gzip);
 			else throw HttpException("Unknown value for HTTP header \"Content-Encoding\": " + std::string(value, valueSize));
-			if(pos == (signed)std::string::npos) s.clear(); else s.erase(0, pos + 1);
-		}
+		});
 	}
-	else if((nameSize == 17 && !strnaicmp(name, "transfer-encoding", nameSize)) || (nameSize == 2 && !strnaicmp(name, "te", nameSize)))
+	else if(knownField == KnownHeaderField::transferEncoding || knownField == KnownHeaderField::te)
 	{
 		if(_header.contentLength > 0) _header.contentLength = 0; //Ignore Content-Length when Transfer-Encoding is present. See: http://greenbytes.de/tech/webdav/rfc2616.html#rfc.section.4.4
-		std::string s(value, valueSize);
-		s = s.substr(0, s.find(';'));
-		int32_t pos = 0;
-		while ((pos = s.find(',')) != (signed)std::string::npos || !s.empty())
-		{
-		    std::string te = (pos == (signed)std::string::npos) ? s : s.substr(0, pos);
-		    HelperFunctions::trim(BaseLib::HelperFunctions::toLower(te));
-		    if(te == "chunked") _header.transferEncoding = (TransferEncoding::Enum)(_header.transferEncoding | TransferEncoding::Enum::chunked);
-			else if(te == "compress") _header.transferEncoding = (TransferEncoding::Enum)(_header.transferEncoding | TransferEncoding::Enum::compress | TransferEncoding::Enum::chunked);
-			else if(te == "deflate") _header.transferEncoding = (TransferEncoding::Enum)(_header.transferEncoding | TransferEncoding::Enum::deflate | TransferEncoding::Enum::chunked);
-			else if(te == "gzip") _header.transferEncoding = (TransferEncoding::Enum)(_header.transferEncoding | TransferEncoding::Enum::gzip | TransferEncoding::Enum::chunked);
-			else if(te == "identity") _header.transferEncoding = (TransferEncoding::Enum)(_header.transferEncoding | TransferEncoding::Enum::identity);
+		forEachElement(value, valueSize, [&](const char* element, size_t elementSize)
+		{
+			if(equalsIgnoreCase(element, elementSize, "chunked")) _header.transferEncoding = (TransferEncoding::Enum)(_header.transferEncoding | TransferEncoding::Enum::chunked);
+			else if(equalsIgnoreCase(element, elementSize, "compress")) _header.transferEncoding = (TransferEncoding::Enum)(_header.transferEncoding | TransferEncoding::Enum::compress | TransferEncoding::Enum::chunked);
+			else if(equalsIgnoreCase(element, elementSize, "deflate")) _header.transferEncoding = (TransferEncoding::Enum)(_header.transferEncoding | TransferEncoding::Enum::deflate | TransferEncoding::Enum::chunked);
+			else if(equalsIgnoreCase(element, elementSize, "gzip")) _header.transferEncoding = (TransferEncoding::Enum)(_header.transferEncoding | TransferEncoding::Enum::gzip | TransferEncoding::Enum::chunked);
+			else if(equalsIgnoreCase(element, elementSize, "identity")) _header.transferEncoding = (TransferEncoding::Enum)(_header.transferEncoding | TransferEncoding::Enum::identity);
 			else throw HttpException("Unknown value for HTTP header \"Transfer-Encoding\": " + std::string(value, valueSize));
-		    if(pos == (signed)std::string::npos) s.clear(); else s.erase(0, pos + 1);
-		}
+		});
 	}
-	else if(nameSize == 10 && !strnaicmp(name, "connection", nameSize))
+	else if(knownField == KnownHeaderField::connection)
 	{
-		std::string s(value, valueSize);
-		s = s.substr(0, s.find(';'));
-		int32_t pos = 0;
-		while ((pos = s.find(',')) != (signed)std::string::npos || !s.empty())
+		forEachElement(value, valueSize, [&](const char* element, size_t elementSize)
 		{
-			std::string c = (pos == (signed)std::string::npos) ? s : s.substr(0, pos);
-			HelperFunctions::trim(BaseLib::HelperFunctions::toLower(c));
-			if(c == "keep-alive") _header.connection = (Connection::Enum)(_header.connection | Connection::Enum::keepAlive);
-			else if(c == "close") _header.connection = (Connection::Enum)(_header.connection | Connection::Enum::close);
-			else if(c == "upgrade") _header.connection = (Connection::Enum)(_header.connection | Connection::Enum::upgrade);
-			else if(c == "te") {} //ignore
+			if(equalsIgnoreCase(element, elementSize, "keep-alive")) _header.connection = (Connection::Enum)(_header.connection | Connection::Enum::keepAlive);
+			else if(equalsIgnoreCase(element, elementSize, "close")) _header.connection = (Connection::Enum)(_header.connection | Connection::Enum::close);
+			else if(equalsIgnoreCase(element, elementSize, "upgrade")) _header.connection = (Connection::Enum)(_header.connection | Connection::Enum::upgrade);
+			else if(equalsIgnoreCase(element, elementSize, "te")) {} //ignore
 			else throw HttpException("Unknown value for HTTP header \"Connection\": " + std::string(value, valueSize));
-			if(pos == (signed)std::string::npos) s.clear(); else s.erase(0, pos + 1);
-		}
+		});
 	}
-	else if(nameSize == 6 && !strnaicmp(name, "cookie", nameSize))
+	else if(knownField == KnownHeaderField::cookie)
 	{
 		_header.cookie = std::string(value, valueSize);
 		std::vector<std::string> cookies = HelperFunctions::splitAll(_header.cookie, ';');
@@ -708,10 +1070,57 @@ void Http::processHeaderField(char* name, uint32_t nameSize, char* value, uint32
 			_header.cookies.emplace(HelperFunctions::trim(data.first), HelperFunctions::trim(data.second));
 		}
 	}
-	else if(nameSize == 13 && !strnaicmp(name, "authorization", nameSize)) _header.authorization = std::string(value, valueSize);
-	std::string lowercaseName(name, nameSize);
-	HelperFunctions::toLower(lowercaseName);
-	_header.fields[lowercaseName] = std::string(value, valueSize);
+	else if(knownField == KnownHeaderField::authorization) _header.authorization = std::string(value, valueSize);
+
+	HeaderField headerField;
+	headerField.nameOffset = (uint32_t)(name - _rawHeader.data());
+	headerField.nameSize = nameSize;
+	headerField.valueOffset = (uint32_t)(value - _rawHeader.data());
+	headerField.valueSize = valueSize;
+	_headerFields.push_back(headerField);
+	if(knownField != KnownHeaderField::count) _knownHeaderFields[knownField] = (int32_t)_headerFields.size() - 1;
+}
+
+Http::Header& Http::getHeader()
+{
+	for(; _copiedHeaderFields < _headerFields.size(); _copiedHeaderFields++)
+	{
+		const HeaderField& headerField = _headerFields[_copiedHeaderFields];
+		std::string lowercaseName(_rawHeader.data() + headerField.nameOffset, headerField.nameSize);
+		HelperFunctions::toLower(lowercaseName);
+		_header.fields[lowercaseName] = std::string(_rawHeader.data() + headerField.valueOffset, headerField.valueSize);
+	}
+	return _header;
+}
+
+Http::HeaderFieldValue Http::getHeaderField(KnownHeaderField::Enum field) const
+{
+	HeaderFieldValue value;
+	if(field >= KnownHeaderField::count || _knownHeaderFields[field] == -1) return value;
+	const HeaderField& headerField = _headerFields[_knownHeaderFields[field]];
+	value.data = _rawHeader.data() + headerField.valueOffset;
+	value.size = headerField.valueSize;
+	return value;
+}
+
+Http::HeaderFieldValue Http::getHeaderField(const std::string& name) const
+{
+	HeaderFieldValue value;
+	for(auto i = _headerFields.rbegin(); i != _headerFields.rend(); ++i)
+	{
+		if(i->nameSize != name.size()) continue;
+		const char* fieldName = _rawHeader.data() + i->nameOffset;
+		size_t j = 0;
+		for(; j < name.size(); j++)
+		{
+			if(std::tolower((unsigned char)fieldName[j]) != std::tolower((unsigned char)name[j])) break;
+		}
+		if(j != name.size()) continue;
+		value.data = _rawHeader.data() + i->valueOffset;
+		value.size = i->valueSize;
+		break;
+	}
+	return value;
 }
 
 int32_t Http::strnaicmp(char const *a, char const *b, uint32_t size)
@@ -726,15 +1135,29 @@ int32_t Http::strnaicmp(char const *a, char const *b, uint32_t size)
 }
 
 void Http::reset()
+{
+	resetMessage();
+	_skipTrailer = false;
+	_skipTrailerLine = false;
+	_trailerLineStart.clear();
+}
+
+void Http::resetMessage()
 {
 	_header = Header();
+	_headerFields.clear();
+	_knownHeaderFields.fill(-1);
+	_copiedHeaderFields = 0;
 	_content.clear();
 	_rawHeader.clear();
-	_chunk.clear();
 	_content.shrink_to_fit();
 	_rawHeader.shrink_to_fit();
-	_chunk.shrink_to_fit();
-	_chunkNewLineMissing = false;
+	_contentLengthSet = false;
+	_crlf = true;
+	_chunkSize = -1;
+	_partialChunkSize.clear();
+	_streamPos = 0;
+	_contentStreamPos = 0;
 	_type = Type::Enum::none;
 	_finished = false;
 	_dataProcessingStarted = false;
@@ -774,110 +1197,132 @@ int32_t Http::processContent(char* buffer, int32_t bufferLength)
 int32_t Http::processChunkedContent(char* buffer, int32_t bufferLength)
 {
 	int32_t initialBufferLength = bufferLength;
-	while(true)
+	while(bufferLength > 0)
 	{
-		if(_content.size() + bufferLength > _maxContentSize) throw HttpException("Data is larger than " + std::to_string(_maxContentSize) + " bytes.");
 		if(_chunkSize == -1)
 		{
-			if(_chunkNewLineMissing)
-			{
-				if(*buffer == '\r' && bufferLength > 0)
-				{
-					buffer++;
-					bufferLength--;
-				}
-				if(*buffer == '\n' && bufferLength > 0)
-				{
-					buffer++;
-					bufferLength--;
-				}
-			}
 			readChunkSize(&buffer, bufferLength);
 			if(_chunkSize == -1) break;
-		}
-		else
-		{
-			if(_chunkSize == 0)
+			if(_chunkSize == 0) //Last chunk
 			{
+				//Don't wait for the trailer, a client might not send it until it gets the response.
 				setFinished();
+				_skipTrailer = true;
+				skipTrailer(&buffer, bufferLength);
 				break;
 			}
-			if(bufferLength <= 0) break;
-			int32_t sizeToInsert = bufferLength;
-			if((signed)_chunk.size() + sizeToInsert > _chunkSize) sizeToInsert -= (_chunk.size() + sizeToInsert) - _chunkSize;
-			_chunk.insert(_chunk.end(), buffer, buffer + sizeToInsert);
-			if((signed)_chunk.size() == _chunkSize)
-			{
-				_content.insert(_content.end(), _chunk.begin(), _chunk.end());
-				_chunk.clear();
-				_chunkSize = -1;
-			}
-			bufferLength -= _crlf ? sizeToInsert + 2 : sizeToInsert + 1;
-			if(bufferLength < 0)
-			{
-				_chunkNewLineMissing = true;
-				break;
-			}
-			buffer = _crlf ? buffer + sizeToInsert + 2 : buffer + sizeToInsert + 1;
+		}
+		else
+		{
+			int32_t sizeToInsert = bufferLength < _chunkSize ? bufferLength : _chunkSize;
+			if(_content.size() + sizeToInsert > _maxContentSize) throw HttpException("Data is larger than " + std::to_string(_maxContentSize) + " bytes.");
+			_content.insert(_content.end(), buffer, buffer + sizeToInsert);
+			buffer += sizeToInsert;
+			bufferLength -= sizeToInsert;
+			_chunkSize -= sizeToInsert;
+			if(_chunkSize == 0) _chunkSize = -1; //The line break behind the chunk is skipped by readChunkSize().
 		}
 	}
-	if(bufferLength < 0) bufferLength = 0;
-	while(bufferLength > 0 && (*buffer == '\r' || *buffer == '\n' || *buffer == '\0'))
+	if(_finished)
 	{
-		buffer++;
-		bufferLength--;
+		while(bufferLength > 0 && (*buffer == '\r' || *buffer == '\n' || *buffer == '\0'))
+		{
+			buffer++;
+			bufferLength--;
+		}
 	}
 	return initialBufferLength - bufferLength;
 }
 
 void Http::readChunkSize(char** buffer, int32_t& bufferLength)
 {
-	char* newlinePos;
-	if(_chunkSize == -1 && _endChunkSizeBytes == 0)
+	if(_partialChunkSize.empty())
 	{
-		newlinePos = strchr(*buffer, '\n');
-		if(_partialChunkSize.empty() && newlinePos == *buffer) newlinePos = strchr(*buffer + 1, '\n'); //\n is first character
-		if(_partialChunkSize.empty() && newlinePos == *buffer + 1 && **buffer == '\r') newlinePos = strchr(*buffer + 2, '\n'); //\r is first character
-		if(!newlinePos || newlinePos >= *buffer + bufferLength) throw BaseLib::Exception("Could not parse chunk size (1).");
-		std::string chunkSize = _partialChunkSize + std::string(*buffer, newlinePos - *buffer);
-		HelperFunctions::trim(_partialChunkSize);
-		if(!Math::isNumber(chunkSize, true)) throw BaseLib::Exception("Chunk size is no number.");
-		_chunkSize = Math::getNumber(chunkSize, true);
-		_partialChunkSize = "";
-		bufferLength -= (newlinePos + 1) - *buffer;
-		*buffer = newlinePos + 1;
+		//Skip the line break behind the previous chunk. It might have been in the previous buffer.
+		while(bufferLength > 0 && (**buffer == '\r' || **buffer == '\n'))
+		{
+			(*buffer)++;
+			bufferLength--;
+		}
+		if(bufferLength == 0) return;
 	}
-	_endChunkSizeBytes = -1;
-	if(_chunkSize > -1) return;
 
-	newlinePos = strchr(*buffer, '\n');
-	if(!newlinePos || newlinePos >= *buffer + bufferLength)
+	char* newlinePos = (char*)memchr(*buffer, '\n', bufferLength);
+	if(!newlinePos)
 	{
-		_endChunkSizeBytes = 0;
-		char* semicolonPos;
-		semicolonPos = strchr(*buffer, ';');
-		if(!semicolonPos || semicolonPos >= *buffer + bufferLength)
+		//The chunk size line is split between packets.
+		_partialChunkSize.append(*buffer, bufferLength);
+		if(_partialChunkSize.size() > 1024) throw HttpException("Could not parse chunk size (2).");
+		*buffer += bufferLength;
+		bufferLength = 0;
+		return;
+	}
+
+	_partialChunkSize.append(*buffer, newlinePos - *buffer);
+	bufferLength -= (newlinePos + 1) - *buffer;
+	*buffer = newlinePos + 1;
+
+	//Chunk extensions behind ";" are ignored by strtol.
+	_chunkSize = strtol(_partialChunkSize.c_str(), NULL, 16);
+	_partialChunkSize.clear();
+	if(_chunkSize < 0) throw HttpException("Could not parse chunk size. Chunk size is negative.");
+}
+
+void Http::skipTrailer(char** buffer, int32_t& bufferLength)
+{
+	while(_skipTrailer && bufferLength > 0)
+	{
+		if(_skipTrailerLine)
 		{
-			_partialChunkSize = std::string(*buffer, bufferLength);
-			if(_partialChunkSize.size() > 8) throw HttpException("Could not parse chunk size (2).");
+			//The rest of a header field.
+			char* newlinePos = (char*)memchr(*buffer, '\n', bufferLength);
+			if(!newlinePos)
+			{
+				*buffer += bufferLength;
+				bufferLength = 0;
+				return;
+			}
+			bufferLength -= (newlinePos + 1) - *buffer;
+			*buffer = newlinePos + 1;
+			_skipTrailerLine = false;
+			continue;
 		}
-		else
+
+		if(_trailerLineStart.empty() && **buffer == '\r')
 		{
-			_chunkSize = strtol(*buffer, NULL, 16);
-			if(_chunkSize < 0) throw HttpException("Could not parse chunk size. Chunk size is negative.");
+			(*buffer)++;
+			bufferLength--;
+			continue;
 		}
-	}
-	else
-	{
-		_chunkSize = strtol(*buffer, NULL, 16);
-		if(_chunkSize < 0) throw HttpException("Could not parse chunk size. Chunk size is negative.");
-		bufferLength -= (newlinePos + 1) - *buffer;
-		if(bufferLength == -1)
+		if(_trailerLineStart.empty() && **buffer == '\n')
+		{
+			//The empty line ending the trailer.
+			(*buffer)++;
+			bufferLength--;
+			_skipTrailer = false;
+			return;
+		}
+
+		//Header fields have a colon in front of the first space, start lines don't. When the line is cut before either, its
+		//beginning is kept until the rest arrives.
+		int32_t i = 0;
+		while(i < bufferLength && (*buffer)[i] != ':' && (*buffer)[i] != ' ' && (*buffer)[i] != '\r' && (*buffer)[i] != '\n') i++;
+		if(i == bufferLength)
 		{
+			if(_trailerLineStart.size() + bufferLength > _maxHeaderSize) throw HttpException("Header is larger than " + std::to_string(_maxHeaderSize) + " bytes.");
+			_trailerLineStart.append(*buffer, bufferLength);
+			*buffer += bufferLength;
 			bufferLength = 0;
-			_endChunkSizeBytes = 1;
+			return;
+		}
+		if((*buffer)[i] == ':') _skipTrailerLine = true;
+		else
+		{
+			//The start line of the next message.
+			_rawHeader.insert(_rawHeader.end(), _trailerLineStart.begin(), _trailerLineStart.end());
+			_skipTrailer = false;
 		}
-		*buffer = newlinePos + 1;
+		_trailerLineStart.clear();
 	}
 }
 
@@ -35,6 +35,8 @@
 #include "../Exception.h"
 #include "../HelperFunctions/Math.h"
 
+#include <array>
+#include <functional>
 #include <string>
 #include <map>
 #include <cstring>
@@ -107,6 +109,37 @@ public:
 		std::map<std::string, std::string> fields;
 	};
 
+	/**
+	 * Header fields with a fixed slot. See getHeaderField().
+	 */
+	struct KnownHeaderField
+	{
+		enum Enum { accept, acceptEncoding, authorization, connection, contentEncoding, contentLength, contentType, cookie, host, origin, secWebSocketKey, secWebSocketProtocol, secWebSocketVersion, te, transferEncoding, upgrade, userAgent, count };
+	};
+
+	/**
+	 * Position of a header field in the raw header (see getRawHeader()). The value is stored without leading spaces.
+	 */
+	struct HeaderField
+	{
+		uint32_t nameOffset = 0;
+		uint32_t nameSize = 0;
+		uint32_t valueOffset = 0;
+		uint32_t valueSize = 0;
+	};
+
+	/**
+	 * Reference to a header field value in the raw header. It is valid until reset() is called.
+	 */
+	struct HeaderFieldValue
+	{
+		const char* data = nullptr;
+		size_t size = 0;
+
+		bool empty() const { return size == 0; }
+		std::string toString() const { return size == 0 ? std::string() : std::string(data, size); }
+	};
+
 	struct FormData
 	{
 		std::string contentDisposition;
@@ -119,6 +152,156 @@ public:
 		std::set<std::shared_ptr<FormData>> multipartMixed;
 	};
 
+	/**
+	 * Writes a response with chunked transfer encoding, so it can be sent while it is generated. Small writes are
+	 * collected until "chunkSize" bytes are available and then passed to "send" as one chunk including its size line.
+	 * Writes of at least "chunkSize" bytes are passed to "send" without copying them. Peak memory therefore doesn't
+	 * depend on the size of the response. Only use it for HTTP/1.1 clients.
+	 *
+	 * Example (see also HttpServer::createChunkedWriter()):
+	 *
+	 *     BaseLib::Http::ChunkedWriter writer([&](const char* data, size_t size) { socket.proofwrite(data, size); });
+	 *     writer.writeHeader(200, "application/json", {});
+	 *     for(auto& line : lines) writer.write(line);
+	 *     writer.finish();
+	 */
+	class ChunkedWriter
+	{
+	public:
+		/**
+		 * @param send Called with the encoded header and chunks in the order they need to be sent. "data" is only valid
+		 * during the call.
+		 * @param chunkSize The size of the chunks to send. write() calls with less data are combined.
+		 */
+		explicit ChunkedWriter(std::function<void(const char* data, size_t size)> send, size_t chunkSize = 16384);
+		virtual ~ChunkedWriter() = default;
+
+		bool isFinished() { return _finished; }
+
+		/**
+		 * Sends the response header. It has the same format as the header returned by constructHeader(), but with
+		 * "Transfer-Encoding: chunked" instead of "Content-Length". Announce trailers with a "Trailer" field in
+		 * "additionalHeaders".
+		 */
+		void writeHeader(int32_t code, const std::string& contentType, const std::vector<std::string>& additionalHeaders);
+
+		/**
+		 * Appends content. Full chunks are sent immediately.
+		 */
+		void write(const char* data, size_t size);
+		void write(const std::string& data) { write(data.data(), data.size()); }
+		void write(const std::vector<char>& data) { write(data.data(), data.size()); }
+
+		/**
+		 * Sends the collected content as one chunk, e. g. to make the client see progress.
+		 */
+		void flush();
+
+		/**
+		 * Sends the remaining content and the last chunk. Afterwards the writer can be used for the next response.
+		 *
+		 * @param trailers Header fields to send behind the content (e. g. "Content-MD5: ..."), without line breaks.
+		 */
+		void finish(const std::vector<std::string>& trailers = std::vector<std::string>());
+	private:
+		//Space for the longest chunk size line in front of the collected content.
+		static constexpr size_t _sizeLineSpace = sizeof(size_t) * 2 + 2;
+
+		std::function<void(const char* data, size_t size)> _send;
+		size_t _chunkSize = 16384;
+
+		//The chunk size line is written in front of the content when the chunk is sent, so it is copied only once.
+		std::vector<char> _packet;
+		bool _headerWritten = false;
+		bool _finished = false;
+
+		size_t contentSize() { return _packet.size() - _sizeLineSpace; }
+
+		/**
+		 * Writes the size line in front of the collected content and appends the line break behind it.
+		 *
+		 * @return Returns the offset of the chunk in _packet.
+		 */
+		size_t encodeChunk();
+	};
+
+	/**
+	 * Decodes "multipart/form-data" content incrementally, so uploads don't need to be held in memory. Part headers and
+	 * data are passed to a callback as they arrive. Parts of type "multipart/mixed" are passed on undecoded.
+	 *
+	 * Example writing file parts to disk:
+	 *
+	 *     std::ofstream file;
+	 *     BaseLib::Http::MultipartDecoder decoder(BaseLib::Http::MultipartDecoder::getBoundary(http.getHeader().contentTypeFull),
+	 *         [&](BaseLib::Http::MultipartDecoder::Event::Enum event, const BaseLib::Http::FormData& part, const char* data, size_t size)
+	 *     {
+	 *         if(part.filename.empty()) return;
+	 *         if(event == BaseLib::Http::MultipartDecoder::Event::partBegin) file.open("/tmp/upload", std::ios::binary);
+	 *         else if(event == BaseLib::Http::MultipartDecoder::Event::partData) file.write(data, size);
+	 *         else file.close();
+	 *     });
+	 *     decoder.decode(buffer, bufferSize); //For each received buffer
+	 */
+	class MultipartDecoder
+	{
+	public:
+		/**
+		 * "partBegin" is raised when the header of a part is complete, "partData" for each received piece of its data and
+		 * "partEnd" when the part is complete. "data" is only set for "partData".
+		 */
+		struct Event
+		{
+			enum Enum { partBegin, partData, partEnd };
+		};
+
+		/**
+		 * @param boundary The boundary of the content (see getBoundary()).
+		 * @param callback Called for each event. "part" contains the header of the current part. Its member "data" is not set.
+		 * @throws HttpException
+		 */
+		MultipartDecoder(const std::string& boundary, std::function<void(Event::Enum event, const FormData& part, const char* data, size_t size)> callback);
+		virtual ~MultipartDecoder() = default;
+
+		/**
+		 * Returns the boundary from a "Content-Type" header field value (see Header::contentTypeFull).
+		 *
+		 * @return The boundary or an empty string if there is none.
+		 */
+		static std::string getBoundary(const std::string& contentTypeFull);
+
+		/**
+		 * Returns "true" when the final boundary was found. Data behind it is ignored.
+		 */
+		bool isFinished() { return _state == State::finished; }
+
+		/**
+		 * Decodes the next part of the content.
+		 *
+		 * @throws HttpException
+		 */
+		void decode(const char* data, size_t size);
+
+		/**
+		 * Resets the decoder, so it can be used for the next content with the same boundary.
+		 */
+		void reset();
+	private:
+		struct State
+		{
+			enum Enum { preamble, boundaryLine, header, data, finished };
+		};
+
+		std::string _delimiter;
+		std::function<void(Event::Enum event, const FormData& part, const char* data, size_t size)> _callback;
+		State::Enum _state = State::preamble;
+		size_t _matchedSize = 0;
+		std::string _line;
+		size_t _headerSize = 0;
+		FormData _part;
+
+		void processHeaderLine();
+	};
+
 	Http();
 	virtual ~Http();
 
@@ -147,8 +330,37 @@ public:
 	const std::vector<char>& getRawHeader() const { return _rawHeader; }
 	const std::vector<char>& getContent() const { return _content; }
 	uint32_t getContentSize() const { return _content.empty() ? 0 : (_finished ? _content.size() - 1 : _content.size()); }
-	Header& getHeader() { return _header; }
+
+	/**
+	 * Returns the parsed header. Header::fields is only filled when this method is called, as this requires
+	 * allocations for every field. Use getHeaderField() to read fields without copying them.
+	 */
+	Header& getHeader();
+
+	/**
+	 * Returns the value of a header field without copying it. When a field occurs more than once, the last occurrence
+	 * is returned like in Header::fields.
+	 *
+	 * @return Returns an empty value when the field doesn't exist.
+	 */
+	HeaderFieldValue getHeaderField(KnownHeaderField::Enum field) const;
+
+	/**
+	 * Same as above for any field. The name is compared case-insensitively.
+	 */
+	HeaderFieldValue getHeaderField(const std::string& name) const;
+
+	/**
+	 * Returns all header fields in the order of the raw header.
+	 */
+	const std::vector<HeaderField>& getHeaderFields() const { return _headerFields; }
+
 	std::unordered_map<std::string, std::string> getParsedQueryString();
+
+	/**
+	 * Discards the current message and all state of the connection, e. g. to resynchronize after an error. Between
+	 * messages process() and processAll() reset the object themselves.
+	 */
 	void reset();
 
 	/**
@@ -161,6 +373,18 @@ public:
 	 * @return The number of processed bytes.
 	 */
 	int32_t process(char* buffer, int32_t bufferLength, bool checkForChunkedXml = false, bool checkForChunkedJson = false);
+
+	/**
+	 * Parses consecutive messages from a buffer, e. g. pipelined HTTP/1.1 requests or back-to-back responses on a
+	 * keep-alive connection. "messageCallback" is called for every complete message. The object is reset afterwards.
+	 * An incomplete message at the end of the buffer is kept until the next call.
+	 *
+	 * @param buffer The buffer to parse
+	 * @param bufferLength The size of the buffer
+	 * @param messageCallback Called with this object for each complete message.
+	 * @return The number of complete messages.
+	 */
+	uint32_t processAll(char* buffer, int32_t bufferLength, const std::function<void(Http& message)>& messageCallback);
 	bool headerProcessingStarted() { return _headerProcessingStarted; }
 	bool dataProcessingStarted() { return _dataProcessingStarted; }
 	static std::string encodeURL(const std::string& url);
@@ -173,6 +397,11 @@ public:
 	std::set<std::shared_ptr<FormData>> decodeMultipartFormdata();
 	std::set<std::shared_ptr<FormData>> decodeMultipartMixed(std::string& boundary, char* buffer, size_t bufferSize, char** pos);
 	static void constructHeader(uint32_t contentLength, std::string contentType, int32_t code, std::string codeDescription, const std::vector<std::string>& additionalHeaders, std::string& header);
+
+	/**
+	 * Like constructHeader(), but for content with chunked transfer encoding (see ChunkedWriter).
+	 */
+	static void constructChunkedHeader(std::string contentType, int32_t code, std::string codeDescription, const std::vector<std::string>& additionalHeaders, std::string& header);
 	PVariable serialize();
 	void unserialize(PVariable data);
 private:
@@ -182,14 +411,21 @@ private:
 	bool _crlf = true;
 	Header _header;
 	std::vector<char> _rawHeader;
+	std::vector<HeaderField> _headerFields;
+	std::array<int32_t, KnownHeaderField::count> _knownHeaderFields;
+	size_t _copiedHeaderFields = 0;
 	Type::Enum _type = Type::Enum::none;
 	std::vector<char> _content;
-	std::vector<char> _chunk;
-	bool _chunkNewLineMissing = false;
 	bool _finished = false;
 	int32_t _chunkSize = -1;
-	int32_t _endChunkSizeBytes = -1;
 	std::string _partialChunkSize;
+
+	//A chunked message is finished with its last chunk. The trailer behind it (header fields and an empty line) is skipped
+	//in front of the next message. Not cleared by resetMessage(), as the trailer belongs to the connection, not to the
+	//message.
+	bool _skipTrailer = false;
+	bool _skipTrailerLine = false;
+	std::string _trailerLineStart;
 	size_t _streamPos = 0;
 	size_t _contentStreamPos = 0;
 	static const std::map <std::string, std::string> _extMimeTypeMap;
@@ -200,12 +436,24 @@ private:
 	size_t _maxHeaderSize = 102400;
 	size_t _maxContentSize = 104857600;
 
+	/**
+	 * Prepares for the next message on the same connection. Unlike reset() it keeps the state needed to skip the trailer
+	 * of the previous message.
+	 */
+	void resetMessage();
+
 	int32_t processHeader(char** buffer, int32_t& bufferLength);
 	void processHeaderField(char* name, uint32_t nameSize, char* value, uint32_t valueSize);
 	int32_t processContent(char* buffer, int32_t bufferLength);
 	int32_t processChunkedContent(char* buffer, int32_t bufferLength);
 	void readChunkSize(char** buffer, int32_t& bufferLength);
 
+	/**
+	 * Skips the trailer as far as it is in "buffer". Stops at the empty line ending it or at the first line that is no
+	 * header field, i. e. the start line of the next message when the empty line is missing.
+	 */
+	void skipTrailer(char** buffer, int32_t& bufferLength);
+
 	char* findNextString(std::string& needle, char* buffer, size_t bufferSize);
 
 	int32_t strnaicmp(char const *a, char const *b, uint32_t size);
@@ -33,21 +33,80 @@
 */
 
 #include "JsonDecoder.h"
+#include "JsonScanner.h"
 #include "../HelperFunctions/Math.h"
 #include "../BaseLib.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 namespace BaseLib
 {
 namespace Rpc
 {
 
+namespace
+{
+
+/**
+ * Scanning costs more than it saves on short input. JsonScanner's positions are 32 bit, so larger input is decoded byte by
+ * byte as well.
+ */
+inline bool useStructuralDecoding(size_t size)
+{
+    return size >= 256 && size <= JsonScanner::maximumSize;
+}
+
+#if __GNUC__ > 4
+/**
+ * Parses the four hexadecimal digits of "\\uXXXX". Returns "false" if one of them is no hexadecimal digit.
+ */
+inline bool parseUtf16CodeUnit(const char* hex, char16_t& codeUnit)
+{
+    uint32_t value = 0;
+    for(int32_t i = 0; i < 4; i++)
+    {
+        const char c = hex[i];
+        value <<= 4;
+        if(c >= '0' && c <= '9') value |= (uint32_t)(c - '0');
+        else if(c >= 'a' && c <= 'f') value |= (uint32_t)(c - 'a' + 10);
+        else if(c >= 'A' && c <= 'F') value |= (uint32_t)(c - 'A' + 10);
+        else return false;
+    }
+    codeUnit = (char16_t)value;
+    return true;
+}
+
+/**
+ * Appends a UTF-16 code unit, which is no surrogate, as UTF-8.
+ */
+inline void appendUtf8(std::string& s, char16_t codeUnit)
+{
+    const uint32_t c = (uint16_t)codeUnit;
+    if(c < 0x80) s.push_back((char)c);
+    else if(c < 0x800)
+    {
+        s.push_back((char)(0xC0 | (c >> 6)));
+        s.push_back((char)(0x80 | (c & 0x3F)));
+    }
+    else
+    {
+        s.push_back((char)(0xE0 | (c >> 12)));
+        s.push_back((char)(0x80 | ((c >> 6) & 0x3F)));
+        s.push_back((char)(0x80 | (c & 0x3F)));
+    }
+}
+#endif
+
+}
+
 std::shared_ptr<Variable> JsonDecoder::decode(const std::string& json)
 {
-    uint32_t pos = 0;
-    auto variable = std::make_shared<Variable>();
+    uint64_t pos = 0;
+    auto variable = MemoryArena::makeShared<Variable>();
     skipWhitespace(json, pos);
     if(!posValid(json, pos)) return variable;
-    if(!decodeValue(json, pos, variable))
+    if(!(useStructuralDecoding(json.size()) ? decodeStructural(json, pos, variable) : decodeValue(json, pos, variable)))
     {
         variable->type = VariableType::tString;
         variable->stringValue = decodeString(std::string(json.begin(), json.end()));
@@ -56,22 +115,32 @@ std::shared_ptr<Variable> JsonDecoder::decode(const std::string& json)
 }
 
 std::shared_ptr<Variable> JsonDecoder::decode(const std::string& json, uint32_t& bytesRead)
+{
+    uint64_t pos = 0;
+    bytesRead = 0;
+    auto variable = decode(json, pos);
+    if(pos > 0xFFFFFFFFull) throw JsonDecoderException("JSON is too large for a 32 bit position.");
+    bytesRead = (uint32_t)pos;
+    return variable;
+}
+
+std::shared_ptr<Variable> JsonDecoder::decode(const std::string& json, uint64_t& bytesRead)
 {
     bytesRead = 0;
-    auto variable = std::make_shared<Variable>();
+    auto variable = MemoryArena::makeShared<Variable>();
     skipWhitespace(json, bytesRead);
     if(!posValid(json, bytesRead)) return variable;
-    if(!decodeValue(json, bytesRead, variable)) throw JsonDecoderException("Invalid JSON.");
+    if(!(useStructuralDecoding(json.size()) ? decodeStructural(json, bytesRead, variable) : decodeValue(json, bytesRead, variable))) throw JsonDecoderException("Invalid JSON.");
     return variable;
 }
 
 std::shared_ptr<Variable> JsonDecoder::decode(const std::vector<char>& json)
 {
-    uint32_t pos = 0;
-    auto variable = std::make_shared<Variable>();
+    uint64_t pos = 0;
+    auto variable = MemoryArena::makeShared<Variable>();
     skipWhitespace(json, pos);
     if(!posValid(json, pos)) return variable;
-    if(!decodeValue(json, pos, variable))
+    if(!(useStructuralDecoding(json.size()) ? decodeStructural(json, pos, variable) : decodeValue(json, pos, variable)))
     {
         variable->type = VariableType::tString;
         variable->stringValue = decodeString(std::string(json.begin(), json.end()));
@@ -81,25 +150,158 @@ std::shared_ptr<Variable> JsonDecoder::decode(const std::vector<char>& json)
 
 std::shared_ptr<Variable> JsonDecoder::decode(const std::vector<char>& json, uint32_t& bytesRead)
 {
+    uint64_t pos = 0;
     bytesRead = 0;
-    auto variable = std::make_shared<Variable>();
+    auto variable = decode(json, pos);
+    if(pos > 0xFFFFFFFFull) throw JsonDecoderException("JSON is too large for a 32 bit position.");
+    bytesRead = (uint32_t)pos;
+    return variable;
+}
+
+std::shared_ptr<Variable> JsonDecoder::decode(const std::vector<char>& json, uint64_t& bytesRead)
+{
+    bytesRead = 0;
+    auto variable = MemoryArena::makeShared<Variable>();
     skipWhitespace(json, bytesRead);
     if(!posValid(json, bytesRead)) return variable;
-    if(!decodeValue(json, bytesRead, variable)) throw JsonDecoderException("Invalid JSON.");
+    if(!(useStructuralDecoding(json.size()) ? decodeStructural(json, bytesRead, variable) : decodeValue(json, bytesRead, variable))) throw JsonDecoderException("Invalid JSON.");
     return variable;
 }
 
-bool JsonDecoder::posValid(const std::string& json, uint32_t pos)
+std::shared_ptr<Variable> JsonDecoder::decodeScanned(const std::string& json, const std::vector<uint32_t>& structuralIndices, uint64_t& pos)
+{
+    return decodeScannedValue(json, structuralIndices, pos);
+}
+
+std::shared_ptr<Variable> JsonDecoder::decodeScanned(const std::vector<char>& json, const std::vector<uint32_t>& structuralIndices, uint64_t& pos)
+{
+    return decodeScannedValue(json, structuralIndices, pos);
+}
+
+std::vector<JsonRpcRequest> JsonDecoder::decodeBatchRequest(const std::string& json)
+{
+    return getBatchRequest(decode(json));
+}
+
+std::vector<JsonRpcRequest> JsonDecoder::decodeBatchRequest(const std::vector<char>& json)
+{
+    return getBatchRequest(decode(json));
+}
+
+PArray JsonDecoder::decodeBatchResponse(const std::string& json, const std::vector<int32_t>& ids)
+{
+    return getBatchResponse(decode(json), ids);
+}
+
+PArray JsonDecoder::decodeBatchResponse(const std::vector<char>& json, const std::vector<int32_t>& ids)
+{
+    return getBatchResponse(decode(json), ids);
+}
+
+std::vector<JsonRpcRequest> JsonDecoder::getBatchRequest(const std::shared_ptr<Variable>& batch)
+{
+    std::vector<JsonRpcRequest> requests;
+    if(batch->type != VariableType::tArray)
+    {
+        auto array = std::make_shared<Variable>(VariableType::tArray);
+        array->arrayValue->push_back(batch);
+        return getBatchRequest(array);
+    }
+
+    requests.reserve(batch->arrayValue->size());
+    for(auto& call : *batch->arrayValue)
+    {
+        requests.emplace_back();
+        JsonRpcRequest& request = requests.back();
+        request.parameters = std::make_shared<Array>();
+        if(call->type != VariableType::tStruct) continue;
+
+        auto idIterator = call->structValue->find("id");
+        if(idIterator == call->structValue->end()) request.isNotification = true;
+        else request.id = idIterator->second;
+
+        auto methodIterator = call->structValue->find("method");
+        if(methodIterator == call->structValue->end() || methodIterator->second->type != VariableType::tString) continue;
+
+        auto paramsIterator = call->structValue->find("params");
+        if(paramsIterator != call->structValue->end())
+        {
+            if(paramsIterator->second->type == VariableType::tArray) *request.parameters = *paramsIterator->second->arrayValue;
+            else if(paramsIterator->second->type == VariableType::tStruct) request.parameters->push_back(paramsIterator->second);
+            else continue;
+        }
+        request.methodName = methodIterator->second->stringValue;
+    }
+    return requests;
+}
+
+PArray JsonDecoder::getBatchResponse(const std::shared_ptr<Variable>& batch, const std::vector<int32_t>& ids)
+{
+    std::unordered_map<int64_t, PVariable> responses;
+    auto addResponse = [&responses](const PVariable& response)
+    {
+        if(response->type != VariableType::tStruct) return;
+        auto idIterator = response->structValue->find("id");
+        if(idIterator == response->structValue->end()) return;
+        //The calls have integer ids. Reading "integerValue" of other types would match string ids to call 0.
+        auto& id = idIterator->second;
+        if(id->type != VariableType::tInteger && id->type != VariableType::tInteger64) return;
+
+        PVariable result;
+        auto errorIterator = response->structValue->find("error");
+        if(errorIterator != response->structValue->end())
+        {
+            int32_t code = -32500;
+            std::string message = "Unknown application error.";
+            auto& error = errorIterator->second;
+            if(error->type == VariableType::tStruct)
+            {
+                auto codeIterator = error->structValue->find("code");
+                if(codeIterator != error->structValue->end()) code = codeIterator->second->integerValue;
+                auto messageIterator = error->structValue->find("message");
+                if(messageIterator != error->structValue->end()) message = messageIterator->second->stringValue;
+            }
+            result = Variable::createError(code, message);
+        }
+        else
+        {
+            auto resultIterator = response->structValue->find("result");
+            result = resultIterator == response->structValue->end() ? std::make_shared<Variable>() : resultIterator->second;
+        }
+        responses.emplace(id->integerValue64, result);
+    };
+
+    if(batch->type == VariableType::tArray)
+    {
+        for(auto& response : *batch->arrayValue)
+        {
+            addResponse(response);
+        }
+    }
+    else addResponse(batch);
+
+    auto results = std::make_shared<Array>();
+    results->reserve(ids.size());
+    for(auto id : ids)
+    {
+        auto responseIterator = responses.find(id);
+        if(responseIterator == responses.end()) results->push_back(Variable::createError(-32500, "No response received."));
+        else results->push_back(responseIterator->second);
+    }
+    return results;
+}
+
+bool JsonDecoder::posValid(const std::string& json, uint64_t pos)
 {
     return pos < json.length();
 }
 
-bool JsonDecoder::posValid(const std::vector<char>& json, uint32_t pos)
+bool JsonDecoder::posValid(const std::vector<char>& json, uint64_t pos)
 {
     return pos < json.size();
 }
 
-void JsonDecoder::skipWhitespace(const std::string& json, uint32_t& pos)
+void JsonDecoder::skipWhitespace(const std::string& json, uint64_t& pos)
 {
     while(pos < json.length() && (json[pos] == ' ' || json[pos] == '\n' || json[pos] == '\r' || json[pos] == '\t'))
     {
@@ -107,7 +309,7 @@ void JsonDecoder::skipWhitespace(const std::string& json, uint32_t& pos)
     }
 }
 
-void JsonDecoder::skipWhitespace(const std::vector<char>& json, uint32_t& pos)
+void JsonDecoder::skipWhitespace(const std::vector<char>& json, uint64_t& pos)
 {
     while(pos < json.size() && (json[pos] == ' ' || json[pos] == '\n' || json[pos] == '\r' || json[pos] == '\t'))
     {
@@ -115,7 +317,7 @@ void JsonDecoder::skipWhitespace(const std::vector<char>& json, uint32_t& pos)
     }
 }
 
-void JsonDecoder::decodeObject(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& variable)
+void JsonDecoder::decodeObject(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& variable)
 {
     variable->type = VariableType::tStruct;
     if(!posValid(json, pos)) return;
@@ -132,6 +334,7 @@ void JsonDecoder::decodeObject(const std::string& json, uint32_t& pos, std::shar
         return; //Empty object
     }
 
+    variable->structValue = MemoryArena::makeShared<Struct>();
     while(pos < json.length())
     {
         if(json[pos] != '"') throw JsonDecoderException("Object element has no name.");
@@ -141,7 +344,7 @@ void JsonDecoder::decodeObject(const std::string& json, uint32_t& pos, std::shar
         if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
         if(json[pos] != ':')
         {
-            variable->structValue->insert(StructElement(name, std::make_shared<Variable>()));
+            variable->structValue->emplace_hint(variable->structValue->end(), std::move(name), MemoryArena::makeShared<Variable>());
             if(json[pos] == ',')
             {
                 pos++;
@@ -159,9 +362,9 @@ void JsonDecoder::decodeObject(const std::string& json, uint32_t& pos, std::shar
         pos++;
         skipWhitespace(json, pos);
         if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
-        auto element = std::make_shared<Variable>();
+        auto element = MemoryArena::makeShared<Variable>();
         if(!decodeValue(json, pos,element)) throw JsonDecoderException("Invalid JSON.");
-        variable->structValue->insert(StructElement(name, element));
+        variable->structValue->emplace_hint(variable->structValue->end(), std::move(name), std::move(element));
         skipWhitespace(json, pos);
         if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
         if(json[pos] == ',')
@@ -180,7 +383,7 @@ void JsonDecoder::decodeObject(const std::string& json, uint32_t& pos, std::shar
     }
 }
 
-void JsonDecoder::decodeObject(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& variable)
+void JsonDecoder::decodeObject(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& variable)
 {
     variable->type = VariableType::tStruct;
     if(!posValid(json, pos)) return;
@@ -197,6 +400,7 @@ void JsonDecoder::decodeObject(const std::vector<char>& json, uint32_t& pos, std
         return; //Empty object
     }
 
+    variable->structValue = MemoryArena::makeShared<Struct>();
     while(pos < json.size())
     {
         if(json[pos] != '"') throw JsonDecoderException("Object element has no name.");
@@ -206,7 +410,7 @@ void JsonDecoder::decodeObject(const std::vector<char>& json, uint32_t& pos, std
         if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
         if(json[pos] != ':')
         {
-            variable->structValue->insert(StructElement(name, std::make_shared<Variable>()));
+            variable->structValue->emplace_hint(variable->structValue->end(), std::move(name), MemoryArena::makeShared<Variable>());
             if(json[pos] == ',')
             {
                 pos++;
@@ -224,9 +428,9 @@ void JsonDecoder::decodeObject(const std::vector<char>& json, uint32_t& pos, std
         pos++;
         skipWhitespace(json, pos);
         if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
-        auto  element = std::make_shared<Variable>();
+        auto element = MemoryArena::makeShared<Variable>();
         if(!decodeValue(json, pos,element)) throw JsonDecoderException("Invalid JSON.");
-        variable->structValue->insert(StructElement(name, element));
+        variable->structValue->emplace_hint(variable->structValue->end(), std::move(name), std::move(element));
         skipWhitespace(json, pos);
         if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
         if(json[pos] == ',')
@@ -245,7 +449,7 @@ void JsonDecoder::decodeObject(const std::vector<char>& json, uint32_t& pos, std
     }
 }
 
-void JsonDecoder::decodeArray(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& variable)
+void JsonDecoder::decodeArray(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& variable)
 {
     variable->type = VariableType::tArray;
     if(!posValid(json, pos)) return;
@@ -263,9 +467,10 @@ void JsonDecoder::decodeArray(const std::string& json, uint32_t& pos, std::share
         return; //Empty array
     }
 
+    variable->arrayValue = MemoryArena::makeShared<Array>();
     while(pos < json.length())
     {
-        auto element = std::make_shared<Variable>();
+        auto element = MemoryArena::makeShared<Variable>();
         if(!decodeValue(json, pos,element)) throw JsonDecoderException("Invalid JSON.");
         variable->arrayValue->push_back(element);
         skipWhitespace(json, pos);
@@ -286,7 +491,7 @@ void JsonDecoder::decodeArray(const std::string& json, uint32_t& pos, std::share
     }
 }
 
-void JsonDecoder::decodeArray(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& variable)
+void JsonDecoder::decodeArray(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& variable)
 {
     variable->type = VariableType::tArray;
     if(!posValid(json, pos)) return;
@@ -304,9 +509,10 @@ void JsonDecoder::decodeArray(const std::vector<char>& json, uint32_t& pos, std:
         return; //Empty array
     }
 
+    variable->arrayValue = MemoryArena::makeShared<Array>();
     while(pos < json.size())
     {
-        auto element = std::make_shared<Variable>();
+        auto element = MemoryArena::makeShared<Variable>();
         if(!decodeValue(json, pos,element)) throw JsonDecoderException("Invalid JSON.");
         variable->arrayValue->push_back(element);
         skipWhitespace(json, pos);
@@ -327,14 +533,14 @@ void JsonDecoder::decodeArray(const std::vector<char>& json, uint32_t& pos, std:
     }
 }
 
-void JsonDecoder::decodeString(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& value)
+void JsonDecoder::decodeString(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& value)
 {
     value->type = VariableType::tString;
     std::string s;
     decodeString(json, pos, value->stringValue);
 }
 
-void JsonDecoder::decodeString(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& value)
+void JsonDecoder::decodeString(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& value)
 {
     value->type = VariableType::tString;
     std::string s;
@@ -347,9 +553,20 @@ std::string JsonDecoder::decodeString(const std::string& s)
 {
     std::string utf8; //String is expected to be UTF-8, except "\uXXXX". This is how Webapps encode JSONs.
     utf8.reserve(s.size());
-    std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t > converter;
+    std::unique_ptr<std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>> converter; //Only needed for surrogate pairs, so it is created on first use.
     for(int32_t i = 0; i < (signed)s.size(); i++)
     {
+        const char* backslash = (const char*)memchr(s.data() + i, '\\', s.size() - i);
+        if(!backslash)
+        {
+            utf8.append(s.data() + i, s.size() - i);
+            break;
+        }
+        if(backslash != s.data() + i)
+        {
+            utf8.append(s.data() + i, backslash);
+            i = (int32_t)(backslash - s.data());
+        }
         char c = s[i];
         if(c == '\\')
         {
@@ -377,9 +594,13 @@ std::string JsonDecoder::decodeString(const std::string& s)
                 {
                     i += 4;
                     if(!posValid(s, i)) break;
-                    std::string hex1(s.data() + (i - 3), 2);
-                    std::string hex2(s.data() + (i - 1), 2);
-                    char16_t c16 = ((char16_t)(uint16_t)(BaseLib::Math::getNumber(hex1, true) << 8)) | ((char16_t)(uint16_t)BaseLib::Math::getNumber(hex2, true));
+                    char16_t c16 = 0;
+                    if(!parseUtf16CodeUnit(s.data() + (i - 3), c16))
+                    {
+                        std::string hex1(s.data() + (i - 3), 2);
+                        std::string hex2(s.data() + (i - 1), 2);
+                        c16 = ((char16_t)(uint16_t)(BaseLib::Math::getNumber(hex1, true) << 8)) | ((char16_t)(uint16_t)BaseLib::Math::getNumber(hex2, true));
+                    }
                     if(c16 != 0 && ((uint16_t)c16 < 0xDC00 || (uint16_t)c16 > 0xDFFF)) //Ignore low surrogates as first character
                     {
                         if((uint16_t)c16 >= 0xD800 && (uint16_t)c16 <= 0xDBFF) //High surrogate => a second character follows
@@ -394,14 +615,11 @@ std::string JsonDecoder::decodeString(const std::string& s)
                             std::string hex4(s.data() + (i - 1), 2);
                             c16 = ((char16_t)(uint16_t)(BaseLib::Math::getNumber(hex3, true) << 8)) | ((char16_t)(uint16_t)BaseLib::Math::getNumber(hex4, true));
                             utf16.push_back(c16);
-                            auto utf8Char = converter.to_bytes(utf16);
-                            if(!utf8Char.empty()) utf8.insert(utf8.end(), utf8Char.begin(), utf8Char.end());
-                        }
-                        else
-                        {
-                            auto utf8Char = converter.to_bytes(c16);
+                            if(!converter) converter.reset(new std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>());
+                            auto utf8Char = converter->to_bytes(utf16);
                             if(!utf8Char.empty()) utf8.insert(utf8.end(), utf8Char.begin(), utf8Char.end());
                         }
+                        else appendUtf8(utf8, c16);
                     }
                     break;
                 }
@@ -412,15 +630,13 @@ std::string JsonDecoder::decodeString(const std::string& s)
         else utf8.push_back(s[i]);
     }
 
-    utf8.shrink_to_fit();
     return utf8;
 }
 
-void JsonDecoder::decodeString(const std::string& json, uint32_t& pos, std::string& s)
+void JsonDecoder::decodeString(const std::string& json, uint64_t& pos, std::string& s)
 {
     s.clear(); //String is expected to be UTF-8, except "\uXXXX". This is how Webapps encode JSONs.
-    s.reserve(1024);
-    std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t > converter;
+    std::unique_ptr<std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>> converter; //Only needed for surrogate pairs, so it is created on first use.
     if(!posValid(json, pos)) throw JsonDecoderException("No closing '\"' found.");
     if(json[pos] == '"')
     {
@@ -429,6 +645,13 @@ void JsonDecoder::decodeString(const std::string& json, uint32_t& pos, std::stri
     }
     while(pos < json.length())
     {
+        const size_t length = JsonScanner::findQuoteOrBackslash(json.data() + pos, json.size() - pos);
+        if(length > 0)
+        {
+            s.append(json.data() + pos, length);
+            pos += length;
+            if(pos >= json.size()) break;
+        }
         char c = json[pos];
         if(c == '\\')
         {
@@ -456,9 +679,13 @@ void JsonDecoder::decodeString(const std::string& json, uint32_t& pos, std::stri
                 {
                     pos += 4;
                     if(!posValid(json, pos)) throw JsonDecoderException("No closing '\"' found.");
-                    std::string hex1(json.data() + (pos - 3), 2);
-                    std::string hex2(json.data() + (pos - 1), 2);
-                    char16_t c16 = ((char16_t)(uint16_t)(BaseLib::Math::getNumber(hex1, true) << 8)) | ((char16_t)(uint16_t)BaseLib::Math::getNumber(hex2, true));
+                    char16_t c16 = 0;
+                    if(!parseUtf16CodeUnit(json.data() + (pos - 3), c16))
+                    {
+                        std::string hex1(json.data() + (pos - 3), 2);
+                        std::string hex2(json.data() + (pos - 1), 2);
+                        c16 = ((char16_t)(uint16_t)(BaseLib::Math::getNumber(hex1, true) << 8)) | ((char16_t)(uint16_t)BaseLib::Math::getNumber(hex2, true));
+                    }
                     if(c16 != 0 && ((uint16_t)c16 < 0xDC00 || (uint16_t)c16 > 0xDFFF)) //Ignore low surrogates as first character
                     {
                         if((uint16_t)c16 >= 0xD800 && (uint16_t)c16 <= 0xDBFF) //High surrogate => a second character follows
@@ -473,14 +700,11 @@ void JsonDecoder::decodeString(const std::string& json, uint32_t& pos, std::stri
                             std::string hex4(json.data() + (pos - 1), 2);
                             c16 = ((char16_t)(uint16_t)(BaseLib::Math::getNumber(hex3, true) << 8)) | ((char16_t)(uint16_t)BaseLib::Math::getNumber(hex4, true));
                             utf16.push_back(c16);
-                            auto utf8Char = converter.to_bytes(utf16);
-                            if(!utf8Char.empty()) s.insert(s.end(), utf8Char.begin(), utf8Char.end());
-                        }
-                        else
-                        {
-                            auto utf8Char = converter.to_bytes(c16);
+                            if(!converter) converter.reset(new std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>());
+                            auto utf8Char = converter->to_bytes(utf16);
                             if(!utf8Char.empty()) s.insert(s.end(), utf8Char.begin(), utf8Char.end());
                         }
+                        else appendUtf8(s, c16);
                     }
                 }
                     break;
@@ -491,21 +715,17 @@ void JsonDecoder::decodeString(const std::string& json, uint32_t& pos, std::stri
         else if(c == '"')
         {
             pos++;
-            s.shrink_to_fit();
             return;
         }
-        else s.push_back(json[pos]);
         pos++;
-        if(s.size() + 4 > s.capacity()) s.reserve(s.capacity() + 1024);
     }
     throw JsonDecoderException("No closing '\"' found.");
 }
 
-void JsonDecoder::decodeString(const std::vector<char>& json, uint32_t& pos, std::string& s)
+void JsonDecoder::decodeString(const std::vector<char>& json, uint64_t& pos, std::string& s)
 {
     s.clear(); //String is expected to be UTF-8, except "\uXXXX". This is how Webapps encode JSONs.
-    s.reserve(1024);
-    std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t > converter;
+    std::unique_ptr<std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>> converter; //Only needed for surrogate pairs, so it is created on first use.
     if(!posValid(json, pos)) throw JsonDecoderException("No closing '\"' found.");
     if(json[pos] == '"')
     {
@@ -514,6 +734,13 @@ void JsonDecoder::decodeString(const std::vector<char>& json, uint32_t& pos, std
     }
     while(pos < json.size())
     {
+        const size_t length = JsonScanner::findQuoteOrBackslash(json.data() + pos, json.size() - pos);
+        if(length > 0)
+        {
+            s.append(json.data() + pos, length);
+            pos += length;
+            if(pos >= json.size()) break;
+        }
         char c = json[pos];
         if(c == '\\')
         {
@@ -541,9 +768,13 @@ void JsonDecoder::decodeString(const std::vector<char>& json, uint32_t& pos, std
                 {
                     pos += 4;
                     if(!posValid(json, pos)) throw JsonDecoderException("No closing '\"' found.");
-                    std::string hex1(json.data() + (pos - 3), 2);
-                    std::string hex2(json.data() + (pos - 1), 2);
-                    char16_t c16 = ((char16_t)(uint16_t)(BaseLib::Math::getNumber(hex1, true) << 8)) | ((char16_t)(uint16_t)BaseLib::Math::getNumber(hex2, true));
+                    char16_t c16 = 0;
+                    if(!parseUtf16CodeUnit(json.data() + (pos - 3), c16))
+                    {
+                        std::string hex1(json.data() + (pos - 3), 2);
+                        std::string hex2(json.data() + (pos - 1), 2);
+                        c16 = ((char16_t)(uint16_t)(BaseLib::Math::getNumber(hex1, true) << 8)) | ((char16_t)(uint16_t)BaseLib::Math::getNumber(hex2, true));
+                    }
                     if(c16 != 0 && ((uint16_t)c16 < 0xDC00 || (uint16_t)c16 > 0xDFFF)) //Ignore low surrogates as first character
                     {
                         if((uint16_t)c16 >= 0xD800 && (uint16_t)c16 <= 0xDBFF) //High surrogate => a second character follows
@@ -558,14 +789,11 @@ void JsonDecoder::decodeString(const std::vector<char>& json, uint32_t& pos, std
                             std::string hex4(json.data() + (pos - 1), 2);
                             c16 = ((char16_t)(uint16_t)(BaseLib::Math::getNumber(hex3, true) << 8)) | ((char16_t)(uint16_t)BaseLib::Math::getNumber(hex4, true));
                             utf16.push_back(c16);
-                            auto utf8Char = converter.to_bytes(utf16);
-                            if(!utf8Char.empty()) s.insert(s.end(), utf8Char.begin(), utf8Char.end());
-                        }
-                        else
-                        {
-                            auto utf8Char = converter.to_bytes(c16);
+                            if(!converter) converter.reset(new std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>());
+                            auto utf8Char = converter->to_bytes(utf16);
                             if(!utf8Char.empty()) s.insert(s.end(), utf8Char.begin(), utf8Char.end());
                         }
+                        else appendUtf8(s, c16);
                     }
                 }
                     break;
@@ -576,12 +804,9 @@ void JsonDecoder::decodeString(const std::vector<char>& json, uint32_t& pos, std
         else if(c == '"')
         {
             pos++;
-            s.shrink_to_fit();
             return;
         }
-        else s.push_back(json[pos]);
         pos++;
-        if(s.size() + 4 > s.capacity()) s.reserve(s.capacity() + 1024);
     }
     throw JsonDecoderException("No closing '\"' found.");
 }
@@ -638,7 +863,7 @@ std::string JsonDecoder::decodeString(const std::string& s)
 	return result;
 }
 
-void JsonDecoder::decodeString(const std::string& json, uint32_t& pos, std::string& s)
+void JsonDecoder::decodeString(const std::string& json, uint64_t& pos, std::string& s)
 {
 	s.clear();
 	if(!posValid(json, pos)) throw JsonDecoderException("No closing '\"' found.");
@@ -698,7 +923,7 @@ void JsonDecoder::decodeString(const std::string& json, uint32_t& pos, std::stri
 	throw JsonDecoderException("No closing '\"' found.");
 }
 
-void JsonDecoder::decodeString(const std::vector<char>& json, uint32_t& pos, std::string& s)
+void JsonDecoder::decodeString(const std::vector<char>& json, uint64_t& pos, std::string& s)
 {
 	s.clear();
 	if(!posValid(json, pos)) throw JsonDecoderException("No closing '\"' found.");
@@ -760,7 +985,7 @@ void JsonDecoder::decodeString(const std::vector<char>& json, uint32_t& pos, std
 
 #endif
 
-bool JsonDecoder::decodeValue(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& value)
+bool JsonDecoder::decodeValue(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& value)
 {
     if(!posValid(json, pos)) return false;
     switch (json[pos])
@@ -792,7 +1017,7 @@ bool JsonDecoder::decodeValue(const std::string& json, uint32_t& pos, std::share
     return true;
 }
 
-bool JsonDecoder::decodeValue(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& value)
+bool JsonDecoder::decodeValue(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& value)
 {
     if(!posValid(json, pos)) return false;
     switch (json[pos])
@@ -824,7 +1049,7 @@ bool JsonDecoder::decodeValue(const std::vector<char>& json, uint32_t& pos, std:
     return true;
 }
 
-void JsonDecoder::decodeBoolean(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& value)
+void JsonDecoder::decodeBoolean(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& value)
 {
     value->type = VariableType::tBoolean;
     if(!posValid(json, pos)) return;
@@ -840,7 +1065,7 @@ void JsonDecoder::decodeBoolean(const std::string& json, uint32_t& pos, std::sha
     }
 }
 
-void JsonDecoder::decodeBoolean(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& value)
+void JsonDecoder::decodeBoolean(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& value)
 {
     value->type = VariableType::tBoolean;
     if(!posValid(json, pos)) return;
@@ -856,19 +1081,19 @@ void JsonDecoder::decodeBoolean(const std::vector<char>& json, uint32_t& pos, st
     }
 }
 
-void JsonDecoder::decodeNull(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& value)
+void JsonDecoder::decodeNull(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& value)
 {
     value->type = VariableType::tVoid;
     pos += 4;
 }
 
-void JsonDecoder::decodeNull(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& value)
+void JsonDecoder::decodeNull(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& value)
 {
     value->type = VariableType::tVoid;
     pos += 4;
 }
 
-bool JsonDecoder::decodeNumber(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& value)
+bool JsonDecoder::decodeNumber(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& value)
 {
     value->type = VariableType::tInteger;
     if(!posValid(json, pos)) return false;
@@ -1000,7 +1225,7 @@ bool JsonDecoder::decodeNumber(const std::string& json, uint32_t& pos, std::shar
     return true;
 }
 
-bool JsonDecoder::decodeNumber(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& value)
+bool JsonDecoder::decodeNumber(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& value)
 {
     value->type = VariableType::tInteger;
     if(!posValid(json, pos)) return false;
@@ -1133,5 +1358,209 @@ bool JsonDecoder::decodeNumber(const std::vector<char>& json, uint32_t& pos, std
     return true;
 }
 
+
+template<typename Container>
+bool JsonDecoder::decodeStructural(const Container& json, uint64_t& pos, std::shared_ptr<Variable>& variable)
+{
+    std::vector<uint32_t> positions;
+    JsonScanner::scan(json.data(), json.size(), positions);
+    StructuralIndices indices(positions);
+    return decodeStructuralValue(json, indices, pos, variable);
+}
+
+template<typename Container>
+std::shared_ptr<Variable> JsonDecoder::decodeScannedValue(const Container& json, const std::vector<uint32_t>& structuralIndices, uint64_t& pos)
+{
+    StructuralIndices indices(structuralIndices);
+    indices.index = std::lower_bound(structuralIndices.begin(), structuralIndices.end(), pos) - structuralIndices.begin();
+    auto variable = MemoryArena::makeShared<Variable>();
+    if(!decodeStructuralValue(json, indices, pos, variable)) return std::shared_ptr<Variable>();
+    return variable;
+}
+
+template<typename Container>
+void JsonDecoder::skipToStructural(const Container& json, StructuralIndices& indices, uint64_t& pos)
+{
+    if(!indices.synchronized)
+    {
+        skipWhitespace(json, pos);
+        return;
+    }
+    if(!posValid(json, pos)) return;
+    char c = json[pos];
+    if(c != ' ' && c != '\n' && c != '\r' && c != '\t') return;
+    //Everything up to the next entry is whitespace, because all other characters outside of strings either are an entry or
+    //follow one without whitespace in between.
+    const std::vector<uint32_t>& positions = indices.positions;
+    while(indices.index < positions.size() && positions[indices.index] < pos) indices.index++;
+    pos = indices.index < positions.size() ? positions[indices.index] : json.size();
+}
+
+template<typename Container>
+bool JsonDecoder::decodeStructuralValue(const Container& json, StructuralIndices& indices, uint64_t& pos, std::shared_ptr<Variable>& value)
+{
+    if(!posValid(json, pos)) return false;
+    switch(json[pos])
+    {
+        case '"':
+            value->type = VariableType::tString;
+            decodeStructuralString(json, indices, pos, value->stringValue);
+            return true;
+        case '{':
+            decodeStructuralObject(json, indices, pos, value);
+            return true;
+        case '[':
+            decodeStructuralArray(json, indices, pos, value);
+            return true;
+        default:
+        {
+            const uint64_t start = pos;
+            if(!decodeValue(json, pos, value)) return false;
+            //Numbers, "true", "false" and "null" contain no entries except their first character. The functions above might
+            //read past the end of an invalid one though, e. g. into a string.
+            const std::vector<uint32_t>& positions = indices.positions;
+            while(indices.index < positions.size() && positions[indices.index] <= start) indices.index++;
+            if(indices.index < positions.size() && positions[indices.index] < pos) indices.synchronized = false;
+            return true;
+        }
+    }
+}
+
+template<typename Container>
+void JsonDecoder::decodeStructuralObject(const Container& json, StructuralIndices& indices, uint64_t& pos, std::shared_ptr<Variable>& variable)
+{
+    variable->type = VariableType::tStruct;
+    pos++;
+    if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
+    skipToStructural(json, indices, pos);
+    if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
+    if(json[pos] == '}')
+    {
+        pos++;
+        return; //Empty object
+    }
+
+    variable->structValue = MemoryArena::makeShared<Struct>();
+    while(pos < json.size())
+    {
+        if(json[pos] != '"') throw JsonDecoderException("Object element has no name.");
+        std::string name;
+        decodeStructuralString(json, indices, pos, name);
+        skipToStructural(json, indices, pos);
+        if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
+        if(json[pos] != ':')
+        {
+            variable->structValue->emplace_hint(variable->structValue->end(), std::move(name), MemoryArena::makeShared<Variable>());
+            if(json[pos] == ',')
+            {
+                pos++;
+                skipToStructural(json, indices, pos);
+                if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
+                continue;
+            }
+            if(json[pos] == '}')
+            {
+                pos++;
+                return;
+            }
+            throw JsonDecoderException("Invalid data after object name.");
+        }
+        pos++;
+        skipToStructural(json, indices, pos);
+        if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
+        auto element = MemoryArena::makeShared<Variable>();
+        if(!decodeStructuralValue(json, indices, pos, element)) throw JsonDecoderException("Invalid JSON.");
+        variable->structValue->emplace_hint(variable->structValue->end(), std::move(name), std::move(element));
+        skipToStructural(json, indices, pos);
+        if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
+        if(json[pos] == ',')
+        {
+            pos++;
+            skipToStructural(json, indices, pos);
+            if(!posValid(json, pos)) throw JsonDecoderException("No closing '}' found.");
+            continue;
+        }
+        if(json[pos] == '}')
+        {
+            pos++;
+            return;
+        }
+        throw JsonDecoderException("No closing '}' found.");
+    }
+}
+
+template<typename Container>
+void JsonDecoder::decodeStructuralArray(const Container& json, StructuralIndices& indices, uint64_t& pos, std::shared_ptr<Variable>& variable)
+{
+    variable->type = VariableType::tArray;
+    pos++;
+    if(!posValid(json, pos)) throw JsonDecoderException("No closing ']' found.");
+    skipToStructural(json, indices, pos);
+    if(!posValid(json, pos)) throw JsonDecoderException("No closing ']' found.");
+    if(json[pos] == ']')
+    {
+        pos++;
+        return; //Empty array
+    }
+
+    variable->arrayValue = MemoryArena::makeShared<Array>();
+    while(pos < json.size())
+    {
+        auto element = MemoryArena::makeShared<Variable>();
+        if(!decodeStructuralValue(json, indices, pos, element)) throw JsonDecoderException("Invalid JSON.");
+        variable->arrayValue->push_back(element);
+        skipToStructural(json, indices, pos);
+        if(!posValid(json, pos)) throw JsonDecoderException("No closing ']' found.");
+        if(json[pos] == ',')
+        {
+            pos++;
+            skipToStructural(json, indices, pos);
+            if(!posValid(json, pos)) throw JsonDecoderException("No closing ']' found.");
+            continue;
+        }
+        if(json[pos] == ']')
+        {
+            pos++;
+            return;
+        }
+        throw JsonDecoderException("No closing ']' found.");
+    }
+}
+
+template<typename Container>
+void JsonDecoder::decodeStructuralString(const Container& json, StructuralIndices& indices, uint64_t& pos, std::string& s)
+{
+    uint64_t end = 0;
+    if(indices.synchronized)
+    {
+        //"pos" is the opening quote, so the next entry is the closing one.
+        const std::vector<uint32_t>& positions = indices.positions;
+        while(indices.index < positions.size() && positions[indices.index] <= pos) indices.index++;
+        if(indices.index < positions.size() && json[positions[indices.index]] == '"')
+        {
+            end = positions[indices.index];
+            const char* begin = json.data() + pos + 1;
+            const size_t length = end - pos - 1;
+            bool copy = std::memchr(begin, '\\', length) == nullptr;
+#if __GNUC__ <= 4
+            for(size_t i = 0; copy && i < length; i++)
+            {
+                if((unsigned)begin[i] < 0x20) copy = false;
+            }
+#endif
+            if(copy)
+            {
+                s.assign(begin, length);
+                pos = end + 1;
+                return;
+            }
+        }
+        else indices.synchronized = false;
+    }
+
+    decodeString(json, pos, s);
+    if(pos != end + 1) indices.synchronized = false;
+}
+
 }
 }
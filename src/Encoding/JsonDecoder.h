@@ -50,6 +50,28 @@ public:
 	explicit JsonDecoderException(std::string message) : BaseLib::Exception(message) {}
 };
 
+/**
+ * One call of a JSON-RPC request as returned by JsonDecoder::decodeBatchRequest().
+ */
+struct JsonRpcRequest
+{
+	/**
+	 * Empty when the call is invalid.
+	 */
+	std::string methodName;
+	PArray parameters;
+
+	/**
+	 * The id as received, a number or a string. Pass to JsonEncoder::encodeBatchResponse(). nullptr for notifications.
+	 */
+	PVariable id;
+
+	/**
+	 * Notifications have no id and must not be answered.
+	 */
+	bool isNotification = false;
+};
+
 class JsonDecoder
 {
 public:
@@ -59,31 +81,97 @@ public:
 
 	static std::shared_ptr<Variable> decode(const std::string& json);
     static std::shared_ptr<Variable> decode(const std::string& json, uint32_t& bytesRead);
+    static std::shared_ptr<Variable> decode(const std::string& json, uint64_t& bytesRead);
     static std::shared_ptr<Variable> decode(const std::vector<char>& json);
     static std::shared_ptr<Variable> decode(const std::vector<char>& json, uint32_t& bytesRead);
+    static std::shared_ptr<Variable> decode(const std::vector<char>& json, uint64_t& bytesRead);
+
+    /**
+     * Decodes the value at "pos" of a document that was already scanned with JsonScanner::scan() (e. g. by
+     * LazyJsonDocument). The positions are reused and nothing is copied. Same result as decode() on the part of the
+     * document starting at "pos".
+     *
+     * @param structuralIndices The result of JsonScanner::scan() for all of "json".
+     * @param[in,out] pos The position of the first character of the value. Set to the position behind the value.
+     * @return Returns nullptr when there is no JSON value at "pos". decode() returns the input as string then.
+     */
+    static std::shared_ptr<Variable> decodeScanned(const std::string& json, const std::vector<uint32_t>& structuralIndices, uint64_t& pos);
+    static std::shared_ptr<Variable> decodeScanned(const std::vector<char>& json, const std::vector<uint32_t>& structuralIndices, uint64_t& pos);
 
     static std::string decodeString(const std::string& s);
+
+    /**
+     * Decodes a JSON-RPC 2.0 batch request, i. e. an array of calls. A single call that is no array is returned as a batch of one.
+     * Named parameters ("params" is an object) are returned as one struct parameter.
+     *
+     * @return Returns the calls in the order of the request.
+     */
+    static std::vector<JsonRpcRequest> decodeBatchRequest(const std::string& json);
+    static std::vector<JsonRpcRequest> decodeBatchRequest(const std::vector<char>& json);
+
+    /**
+     * Decodes a JSON-RPC 2.0 batch response and matches its elements to the calls by id, as the server may answer in any order.
+     *
+     * @param ids The ids returned by JsonEncoder::encodeBatchRequest().
+     * @return Returns one value per id in the order of "ids". Errors are returned as error structs (see Variable::createError()),
+     * calls without response as well. Responses with ids that are no integers can't belong to one of the calls and are
+     * ignored.
+     */
+    static PArray decodeBatchResponse(const std::string& json, const std::vector<int32_t>& ids);
+    static PArray decodeBatchResponse(const std::vector<char>& json, const std::vector<int32_t>& ids);
 private:
-	static inline bool posValid(const std::string& json, uint32_t pos);
-	static inline bool posValid(const std::vector<char>& json, uint32_t pos);
-    static void skipWhitespace(const std::string& json, uint32_t& pos);
-    static void skipWhitespace(const std::vector<char>& json, uint32_t& pos);
-    static void decodeObject(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& variable);
-    static void decodeObject(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& variable);
-    static void decodeArray(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& variable);
-    static void decodeArray(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& variable);
-    static void decodeString(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& value);
-    static void decodeString(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& value);
-    static void decodeString(const std::string& json, uint32_t& pos, std::string& s);
-    static void decodeString(const std::vector<char>& json, uint32_t& pos, std::string& s);
-    static bool decodeValue(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& value);
-    static bool decodeValue(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& value);
-    static void decodeBoolean(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& value);
-    static void decodeBoolean(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& value);
-    static void decodeNull(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& value);
-    static void decodeNull(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& value);
-    static bool decodeNumber(const std::string& json, uint32_t& pos, std::shared_ptr<Variable>& value);
-    static bool decodeNumber(const std::vector<char>& json, uint32_t& pos, std::shared_ptr<Variable>& value);
+	static std::vector<JsonRpcRequest> getBatchRequest(const std::shared_ptr<Variable>& batch);
+	static PArray getBatchResponse(const std::shared_ptr<Variable>& batch, const std::vector<int32_t>& ids);
+	static inline bool posValid(const std::string& json, uint64_t pos);
+	static inline bool posValid(const std::vector<char>& json, uint64_t pos);
+    static void skipWhitespace(const std::string& json, uint64_t& pos);
+    static void skipWhitespace(const std::vector<char>& json, uint64_t& pos);
+    static void decodeObject(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& variable);
+    static void decodeObject(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& variable);
+    static void decodeArray(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& variable);
+    static void decodeArray(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& variable);
+    static void decodeString(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& value);
+    static void decodeString(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& value);
+    static void decodeString(const std::string& json, uint64_t& pos, std::string& s);
+    static void decodeString(const std::vector<char>& json, uint64_t& pos, std::string& s);
+    static bool decodeValue(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& value);
+    static bool decodeValue(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& value);
+    static void decodeBoolean(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& value);
+    static void decodeBoolean(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& value);
+    static void decodeNull(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& value);
+    static void decodeNull(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& value);
+    static bool decodeNumber(const std::string& json, uint64_t& pos, std::shared_ptr<Variable>& value);
+    static bool decodeNumber(const std::vector<char>& json, uint64_t& pos, std::shared_ptr<Variable>& value);
+
+    /**
+     * The positions found by JsonScanner and the next one to look at.
+     */
+    struct StructuralIndices
+    {
+        explicit StructuralIndices(const std::vector<uint32_t>& positions) : positions(positions) {}
+
+        const std::vector<uint32_t>& positions;
+        size_t index = 0;
+
+        /**
+         * "false" once the decoder finds a string end JsonScanner didn't (e. g. "\u" followed by less than four
+         * characters). The positions can't be used from then on and the rest is decoded byte by byte.
+         */
+        bool synchronized = true;
+    };
+
+    /**
+     * Decodes "json" using the positions found by JsonScanner, so whitespace and string contents don't need to be looked at
+     * byte by byte. Follows the same rules and throws the same exceptions as decodeValue() and the functions it calls, so
+     * the result is the same.
+     */
+    template<typename Container> static bool decodeStructural(const Container& json, uint64_t& pos, std::shared_ptr<Variable>& variable);
+    template<typename Container> static std::shared_ptr<Variable> decodeScannedValue(const Container& json, const std::vector<uint32_t>& structuralIndices, uint64_t& pos);
+    template<typename Container> static void skipToStructural(const Container& json, StructuralIndices& indices, uint64_t& pos);
+    template<typename Container> static bool decodeStructuralValue(const Container& json, StructuralIndices& indices, uint64_t& pos, std::shared_ptr<Variable>& value);
+    template<typename Container> static void decodeStructuralObject(const Container& json, StructuralIndices& indices, uint64_t& pos, std::shared_ptr<Variable>& variable);
+    template<typename Container> static void decodeStructuralArray(const Container& json, StructuralIndices& indices, uint64_t& pos, std::shared_ptr<Variable>& variable);
+    template<typename Container> static void decodeStructuralString(const Container& json, StructuralIndices& indices, uint64_t& pos, std::string& s);
 };
 }
 }
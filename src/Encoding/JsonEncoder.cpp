@@ -29,31 +29,576 @@
 */
 
 #include "JsonEncoder.h"
+#include "JsonScanner.h"
 #include "../BaseLib.h"
 
-#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace BaseLib
 {
 namespace Rpc
 {
 
+namespace
+{
+
+//Number formatting based on https://github.com/miloyip/rapidjson/blob/master/include/rapidjson/internal/dtoa.h (Grisu2 by
+//Florian Loitsch). The output is the shortest (in practically all cases) digit string that parses back to the same double.
+//The tables, DiyFp, grisu2(), digitGen(), grisuRound(), prettify() and writeExponent() are derived from RapidJSON, which is
+//licensed under the MIT license:
+//
+//Tencent is pleased to support the open source community by making RapidJSON available.
+//
+//Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+//Licensed under the MIT License (the "License"); you may not use this file except in compliance with the License. You may
+//obtain a copy of the License at
+//
+//http://opensource.org/licenses/MIT
+//
+//Unless required by applicable law or agreed to in writing, software distributed under the License is distributed on an
+//"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the License for the specific
+//language governing permissions and limitations under the License.
+//
+//The MIT License: Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+//associated documentation files (the "Software"), to deal in the Software without restriction, including without
+//limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+//and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above
+//copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+//WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+//COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+//OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+const char gDigitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+//Normalized 64 bit approximations of 10^k for k = -348, -340, ..., 340 and their binary exponents
+const uint64_t gCachedPowersF[] =
+{
+    0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull,
+    0xcf42894a5dce35eaull, 0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull,
+    0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full, 0xbe5691ef416bd60cull,
+    0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+    0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull,
+    0xc21094364dfb5637ull, 0x9096ea6f3848984full, 0xd77485cb25823ac7ull,
+    0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull, 0xb23867fb2a35b28eull,
+    0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+    0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull,
+    0xb5b5ada8aaff80b8ull, 0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull,
+    0x964e858c91ba2655ull, 0xdff9772470297ebdull, 0xa6dfbd9fb8e5b88full,
+    0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+    0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull,
+    0xaa242499697392d3ull, 0xfd87b5f28300ca0eull, 0xbce5086492111aebull,
+    0x8cbccc096f5088ccull, 0xd1b71758e219652cull, 0x9c40000000000000ull,
+    0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+    0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull,
+    0x9f4f2726179a2245ull, 0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull,
+    0x83c7088e1aab65dbull, 0xc45d1df942711d9aull, 0x924d692ca61be758ull,
+    0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+    0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull,
+    0x952ab45cfa97a0b3ull, 0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull,
+    0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull, 0x88fcf317f22241e2ull,
+    0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+    0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull,
+    0x8bab8eefb6409c1aull, 0xd01fef10a657842cull, 0x9b10a4e5e9913129ull,
+    0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull, 0x80444b5e7aa7cf85ull,
+    0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+    0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull
+};
+
+const int16_t gCachedPowersE[] =
+{
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066
+};
+
+const uint64_t gPow10[] = { 1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull };
+
+struct DiyFp
+{
+    static const int kSignificandSize = 52;
+    static const int kExponentBias = 0x3FF + kSignificandSize;
+    static const int kMinExponent = -kExponentBias;
+    static const uint64_t kExponentMask = 0x7FF0000000000000ull;
+    static const uint64_t kSignificandMask = 0x000FFFFFFFFFFFFFull;
+    static const uint64_t kHiddenBit = 0x0010000000000000ull;
+
+    uint64_t f = 0;
+    int32_t e = 0;
+
+    DiyFp(uint64_t f, int32_t e) : f(f), e(e) {}
+
+    explicit DiyFp(double value)
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        int32_t biasedExponent = (int32_t)((bits & kExponentMask) >> kSignificandSize);
+        uint64_t significand = bits & kSignificandMask;
+        if(biasedExponent != 0)
+        {
+            f = significand + kHiddenBit;
+            e = biasedExponent - kExponentBias;
+        }
+        else
+        {
+            f = significand;
+            e = kMinExponent + 1;
+        }
+    }
+
+    DiyFp operator-(const DiyFp& rhs) const
+    {
+        return DiyFp(f - rhs.f, e);
+    }
+
+    DiyFp operator*(const DiyFp& rhs) const
+    {
+        const uint64_t mask32 = 0xFFFFFFFFull;
+        const uint64_t a = f >> 32;
+        const uint64_t b = f & mask32;
+        const uint64_t c = rhs.f >> 32;
+        const uint64_t d = rhs.f & mask32;
+        const uint64_t ac = a * c;
+        const uint64_t bc = b * c;
+        const uint64_t ad = a * d;
+        const uint64_t bd = b * d;
+        uint64_t tmp = (bd >> 32) + (ad & mask32) + (bc & mask32);
+        tmp += 1ull << 31; //Round
+        return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + rhs.e + 64);
+    }
+
+    DiyFp normalize() const
+    {
+        int32_t shift = __builtin_clzll(f);
+        return DiyFp(f << shift, e - shift);
+    }
+
+    void normalizedBoundaries(DiyFp& minus, DiyFp& plus) const
+    {
+        DiyFp upper((f << 1) + 1, e - 1);
+        while(!(upper.f & (kHiddenBit << 1)))
+        {
+            upper.f <<= 1;
+            upper.e--;
+        }
+        upper.f <<= 64 - kSignificandSize - 2;
+        upper.e -= 64 - kSignificandSize - 2;
+        DiyFp lower = (f == kHiddenBit) ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
+        lower.f <<= lower.e - upper.e;
+        lower.e = upper.e;
+        plus = upper;
+        minus = lower;
+    }
+};
+
+DiyFp getCachedPower(int32_t e, int32_t& k)
+{
+    double dk = (-61 - e) * 0.30102999566398114 + 347; //dk must be positive, so can do ceiling in positive
+    int32_t kInt = (int32_t)dk;
+    if(dk - kInt > 0.0) kInt++;
+    uint32_t index = (uint32_t)((kInt >> 3) + 1);
+    k = -(-348 + (int32_t)(index << 3)); //Decimal exponent no need lookup table
+    return DiyFp(gCachedPowersF[index], gCachedPowersE[index]);
+}
+
+void grisuRound(char* buffer, int32_t length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+    while(rest < distance && delta - rest >= tenKappa && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance))
+    {
+        buffer[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+int32_t countDecimalDigits(uint32_t n)
+{
+    if(n < 10) return 1;
+    if(n < 100) return 2;
+    if(n < 1000) return 3;
+    if(n < 10000) return 4;
+    if(n < 100000) return 5;
+    if(n < 1000000) return 6;
+    if(n < 10000000) return 7;
+    if(n < 100000000) return 8;
+    if(n < 1000000000) return 9;
+    return 10;
+}
+
+void digitGen(const DiyFp& w, const DiyFp& mp, uint64_t delta, char* buffer, int32_t& length, int32_t& k)
+{
+    const DiyFp one(1ull << -mp.e, mp.e);
+    const DiyFp distance = mp - w;
+    uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+    int32_t kappa = countDecimalDigits(p1);
+    length = 0;
+
+    while(kappa > 0)
+    {
+        uint32_t divisor = (uint32_t)gPow10[kappa - 1];
+        uint32_t digit = p1 / divisor;
+        p1 %= divisor;
+        if(digit || length) buffer[length++] = (char)('0' + digit);
+        kappa--;
+        uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+        if(rest <= delta)
+        {
+            k += kappa;
+            grisuRound(buffer, length, delta, rest, gPow10[kappa] << -one.e, distance.f);
+            return;
+        }
+    }
+
+    while(true)
+    {
+        p2 *= 10;
+        delta *= 10;
+        char digit = (char)(p2 >> -one.e);
+        if(digit || length) buffer[length++] = (char)('0' + digit);
+        p2 &= one.f - 1;
+        kappa--;
+        if(p2 < delta)
+        {
+            k += kappa;
+            int32_t index = -kappa;
+            grisuRound(buffer, length, delta, p2, one.f, distance.f * (index < 20 ? gPow10[index] : 0));
+            return;
+        }
+    }
+}
+
+/**
+ * Writes the shortest digits of a finite positive double to "buffer" and returns the decimal exponent "k", so that
+ * value = digits * 10^k.
+ */
+void grisu2(double value, char* buffer, int32_t& length, int32_t& k)
+{
+    const DiyFp v(value);
+    DiyFp minus(0, 0);
+    DiyFp plus(0, 0);
+    v.normalizedBoundaries(minus, plus);
+
+    const DiyFp cachedPower = getCachedPower(plus.e, k);
+    const DiyFp w = v.normalize() * cachedPower;
+    DiyFp upper = plus * cachedPower;
+    DiyFp lower = minus * cachedPower;
+    lower.f++;
+    upper.f--;
+    digitGen(w, upper, upper.f - lower.f, buffer, length, k);
+}
+
+char* writeExponent(int32_t exponent, char* buffer)
+{
+    if(exponent < 0)
+    {
+        *buffer++ = '-';
+        exponent = -exponent;
+    }
+    if(exponent >= 100)
+    {
+        *buffer++ = (char)('0' + exponent / 100);
+        exponent %= 100;
+        *buffer++ = gDigitPairs[exponent * 2];
+        *buffer++ = gDigitPairs[exponent * 2 + 1];
+    }
+    else if(exponent >= 10)
+    {
+        *buffer++ = gDigitPairs[exponent * 2];
+        *buffer++ = gDigitPairs[exponent * 2 + 1];
+    }
+    else *buffer++ = (char)('0' + exponent);
+    return buffer;
+}
+
+/**
+ * Formats the digits returned by grisu2(). The result always contains a decimal point, so JsonDecoder reads the number
+ * back as a float.
+ */
+char* prettify(char* buffer, int32_t length, int32_t k)
+{
+    const int32_t kk = length + k; //10^(kk - 1) <= value < 10^kk
+
+    if(k >= 0 && kk <= 21)
+    {
+        //1234e7 -> 12340000000.0
+        for(int32_t i = length; i < kk; i++) buffer[i] = '0';
+        buffer[kk] = '.';
+        buffer[kk + 1] = '0';
+        return &buffer[kk + 2];
+    }
+    else if(kk > 0 && kk <= 21)
+    {
+        //1234e-2 -> 12.34
+        std::memmove(&buffer[kk + 1], &buffer[kk], length - kk);
+        buffer[kk] = '.';
+        return &buffer[length + 1];
+    }
+    else if(kk > -6 && kk <= 0)
+    {
+        //1234e-6 -> 0.001234
+        const int32_t offset = 2 - kk;
+        std::memmove(&buffer[offset], &buffer[0], length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        for(int32_t i = 2; i < offset; i++) buffer[i] = '0';
+        return &buffer[length + offset];
+    }
+    else if(length == 1)
+    {
+        //1e30 -> 1.0e30
+        buffer[1] = '.';
+        buffer[2] = '0';
+        buffer[3] = 'e';
+        return writeExponent(kk - 1, &buffer[4]);
+    }
+    else
+    {
+        //1234e30 -> 1.234e33
+        std::memmove(&buffer[2], &buffer[1], length - 1);
+        buffer[1] = '.';
+        buffer[length + 1] = 'e';
+        return writeExponent(kk - 1, &buffer[length + 2]);
+    }
+}
+
+/**
+ * Writes the shortest representation of "value" that round-trips. "buffer" needs to hold at least 32 characters.
+ *
+ * @return Returns a pointer to the character after the last one written.
+ */
+char* writeDouble(double value, char* buffer)
+{
+    if(std::signbit(value))
+    {
+        *buffer++ = '-';
+        value = -value;
+    }
+    if(value == 0)
+    {
+        *buffer++ = '0';
+        *buffer++ = '.';
+        *buffer++ = '0';
+        return buffer;
+    }
+    int32_t length = 0;
+    int32_t k = 0;
+    grisu2(value, buffer, length, k);
+    return prettify(buffer, length, k);
+}
+
+/**
+ * Writes "value" two digits at a time. "buffer" needs to hold at least 20 characters.
+ *
+ * @return Returns a pointer to the character after the last one written.
+ */
+char* writeInteger(int64_t value, char* buffer)
+{
+    uint64_t unsignedValue = (uint64_t)value;
+    if(value < 0)
+    {
+        *buffer++ = '-';
+        unsignedValue = 0 - unsignedValue;
+    }
+
+    char digits[20];
+    char* position = digits + sizeof(digits);
+    while(unsignedValue >= 100)
+    {
+        const uint32_t pair = (uint32_t)(unsignedValue % 100) * 2;
+        unsignedValue /= 100;
+        *--position = gDigitPairs[pair + 1];
+        *--position = gDigitPairs[pair];
+    }
+    if(unsignedValue >= 10)
+    {
+        const uint32_t pair = (uint32_t)unsignedValue * 2;
+        *--position = gDigitPairs[pair + 1];
+        *--position = gDigitPairs[pair];
+    }
+    else *--position = (char)('0' + unsignedValue);
+
+    const size_t length = digits + sizeof(digits) - position;
+    std::memcpy(buffer, position, length);
+    return buffer + length;
+}
+
+/**
+ * Appends "data" escaped like JsonEncoder::encodeString() does: Characters that need no escaping are copied in bulk, all
+ * others are written as "\\uXXXX" (or as short escape). Returns "false" when "data" is not well-formed UTF-8. Those
+ * strings are handled by the conversion in JsonEncoder::encodeString(). "output" might be partially written then.
+ */
+template<typename Output>
+bool appendEscaped(const char* data, size_t size, Output& output)
+{
+    static const char hexDigits[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+    static const char shortEscapes[0x60] =
+    {
+        //0 1 2 3 4 5 6 7 8 9 A B C D E F
+        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u', // 00-0F
+        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // 10-1F
+        0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 20-2F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 30-4F
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,'\\', 0, 0, 0 // 50-5F
+    };
+
+    auto appendUtf16 = [&output](uint32_t c)
+    {
+        const char escaped[6] = { '\\', 'u', hexDigits[(c >> 12) & 0x0F], hexDigits[(c >> 8) & 0x0F], hexDigits[(c >> 4) & 0x0F], hexDigits[c & 0x0F] };
+        output.insert(output.end(), escaped, escaped + 6);
+    };
+
+    size_t i = 0;
+    while(i < size)
+    {
+        const size_t length = JsonScanner::findCharacterToEscape(data + i, size - i);
+        if(length > 0)
+        {
+            output.insert(output.end(), data + i, data + i + length);
+            i += length;
+            if(i == size) break;
+        }
+
+        const uint8_t c = (uint8_t)data[i];
+        if(c < 0x80)
+        {
+            if(shortEscapes[c] == 'u') appendUtf16(c);
+            else
+            {
+                output.push_back('\\');
+                output.push_back(shortEscapes[c]);
+            }
+            i++;
+            continue;
+        }
+
+        //Only accept well-formed UTF-8 (no overlong forms, no surrogates, nothing above U+10FFFF).
+        uint32_t codePoint = 0;
+        size_t sequenceLength = 0;
+        if(c >= 0xC2 && c <= 0xDF)
+        {
+            codePoint = c & 0x1F;
+            sequenceLength = 2;
+        }
+        else if((c & 0xF0) == 0xE0)
+        {
+            codePoint = c & 0x0F;
+            sequenceLength = 3;
+        }
+        else if(c >= 0xF0 && c <= 0xF4)
+        {
+            codePoint = c & 0x07;
+            sequenceLength = 4;
+        }
+        else return false;
+        if(i + sequenceLength > size) return false;
+        for(size_t j = 1; j < sequenceLength; j++)
+        {
+            const uint8_t continuation = (uint8_t)data[i + j];
+            if((continuation & 0xC0) != 0x80) return false;
+            codePoint = (codePoint << 6) | (continuation & 0x3F);
+        }
+        if((sequenceLength == 3 && (codePoint < 0x800 || (codePoint >= 0xD800 && codePoint <= 0xDFFF))) || (sequenceLength == 4 && (codePoint < 0x10000 || codePoint > 0x10FFFF))) return false;
+        i += sequenceLength;
+
+        if(codePoint < 0x10000) appendUtf16(codePoint);
+        else
+        {
+            codePoint -= 0x10000;
+            appendUtf16(0xD800 + (codePoint >> 10));
+            appendUtf16(0xDC00 + (codePoint & 0x3FF));
+        }
+    }
+    return true;
+}
+
+/**
+ * Makes sure "output" can take "needed" characters. The capacity is at least doubled, so appending stays amortized
+ * constant for large documents.
+ */
+template<typename Output>
+void reserve(Output& output, size_t needed)
+{
+    if(needed > output.capacity()) output.reserve(std::max(output.capacity() * 2, needed));
+}
+
+}
+
 void JsonEncoder::encodeRequest(std::string& methodName, std::shared_ptr<std::list<std::shared_ptr<Variable>>>& parameters, std::vector<char>& encodedData)
 {
-    std::shared_ptr<Variable> methodCall(new Variable(VariableType::tStruct));
-    methodCall->structValue->insert(StructElement("jsonrpc", std::shared_ptr<Variable>(new Variable(std::string("2.0")))));
-    methodCall->structValue->insert(StructElement("method", std::shared_ptr<Variable>(new Variable(methodName))));
     std::shared_ptr<Variable> params(new Variable(VariableType::tArray));
     for(std::list<std::shared_ptr<Variable>>::iterator i = parameters->begin(); i != parameters->end(); ++i)
     {
         params->arrayValue->push_back(*i);
     }
-    methodCall->structValue->insert(StructElement("params", params));
-    methodCall->structValue->insert(StructElement("id", std::shared_ptr<Variable>(new Variable(_requestId++))));
-    encode(methodCall, encodedData);
+    encode(createRequest(methodName, params, _requestId++), encodedData);
+}
+
+void JsonEncoder::encodeBatchRequest(const std::vector<std::pair<std::string, PArray>>& calls, std::vector<char>& encodedData, std::vector<int32_t>& ids)
+{
+    ids.clear();
+    ids.reserve(calls.size());
+    std::shared_ptr<Variable> batch(new Variable(VariableType::tArray));
+    batch->arrayValue->reserve(calls.size());
+    for(auto& call : calls)
+    {
+        std::shared_ptr<Variable> params(new Variable(VariableType::tArray));
+        if(call.second) *params->arrayValue = *call.second;
+        ids.push_back(_requestId);
+        batch->arrayValue->push_back(createRequest(call.first, params, _requestId++));
+    }
+    encode(batch, encodedData);
 }
 
 void JsonEncoder::encodeResponse(const std::shared_ptr<Variable>& variable, int32_t id, std::vector<char>& json)
+{
+    encode(createResponse(variable, id), json);
+}
+
+void JsonEncoder::encodeBatchResponse(const std::vector<std::pair<std::shared_ptr<Variable>, std::shared_ptr<Variable>>>& responses, std::vector<char>& json)
+{
+    std::shared_ptr<Variable> batch(new Variable(VariableType::tArray));
+    batch->arrayValue->reserve(responses.size());
+    for(auto& response : responses)
+    {
+        batch->arrayValue->push_back(createResponse(response.second, response.first));
+    }
+    encode(batch, json);
+}
+
+std::shared_ptr<Variable> JsonEncoder::createRequest(const std::string& methodName, const std::shared_ptr<Variable>& params, int32_t id)
+{
+    std::shared_ptr<Variable> methodCall(new Variable(VariableType::tStruct));
+    methodCall->structValue->insert(StructElement("jsonrpc", std::shared_ptr<Variable>(new Variable(std::string("2.0")))));
+    methodCall->structValue->insert(StructElement("method", std::shared_ptr<Variable>(new Variable(methodName))));
+    methodCall->structValue->insert(StructElement("params", params));
+    methodCall->structValue->insert(StructElement("id", std::shared_ptr<Variable>(new Variable(id))));
+    return methodCall;
+}
+
+std::shared_ptr<Variable> JsonEncoder::createResponse(const std::shared_ptr<Variable>& variable, int32_t id)
+{
+    return createResponse(variable, std::make_shared<Variable>(id));
+}
+
+std::shared_ptr<Variable> JsonEncoder::createResponse(const std::shared_ptr<Variable>& variable, const std::shared_ptr<Variable>& id)
 {
     std::shared_ptr<Variable> response(new Variable(VariableType::tStruct));
     response->structValue->insert(StructElement("jsonrpc", std::shared_ptr<Variable>(new Variable(std::string("2.0")))));
@@ -65,8 +610,8 @@ void JsonEncoder::encodeResponse(const std::shared_ptr<Variable>& variable, int3
         response->structValue->insert(StructElement("error", error));
     }
     else response->structValue->insert(StructElement("result", variable));
-    response->structValue->insert(StructElement("id", std::shared_ptr<Variable>(new Variable(id))));
-    encode(response, json);
+    response->structValue->insert(StructElement("id", id ? id : std::make_shared<Variable>()));
+    return response;
 }
 
 void JsonEncoder::encodeMQTTResponse(const std::string& methodName, const std::shared_ptr<Variable>& variable, int32_t id, std::vector<char>& json)
@@ -87,26 +632,16 @@ void JsonEncoder::encodeMQTTResponse(const std::string& methodName, const std::s
 
 void JsonEncoder::encode(const std::shared_ptr<Variable>& variable, std::string& json)
 {
-	if(!variable) return;
-	std::ostringstream s;
-	switch(variable->type)
-	{
-	case VariableType::tStruct:
-		encodeStruct(variable, s);
-		break;
-	case VariableType::tArray:
-		encodeArray(variable, s);
-		break;
-	default:
-		s << '[';
-		encodeValue(variable, s);
-		s << ']';
-		break;
-	}
-	json = s.str();
+	encodeDocument(variable, json);
 }
 
 void JsonEncoder::encode(const std::shared_ptr<Variable>& variable, std::vector<char>& json)
+{
+	encodeDocument(variable, json);
+}
+
+template<typename Output>
+void JsonEncoder::encodeDocument(const std::shared_ptr<Variable>& variable, Output& json)
 {
 	if(!variable) return;
 	json.clear();
@@ -127,8 +662,10 @@ void JsonEncoder::encode(const std::shared_ptr<Variable>& variable, std::vector<
 	}
 }
 
-void JsonEncoder::encodeValue(const std::shared_ptr<Variable>& variable, std::ostringstream& s)
+template<typename Output>
+void JsonEncoder::encodeValue(const std::shared_ptr<Variable>& variable, Output& s)
 {
+	reserve(s, s.size() + 128);
 	switch(variable->type)
 	{
 	case VariableType::tArray:
@@ -167,63 +704,8 @@ void JsonEncoder::encodeValue(const std::shared_ptr<Variable>& variable, std::os
 	}
 }
 
-void JsonEncoder::encodeValue(const std::shared_ptr<Variable>& variable, std::vector<char>& s)
-{
-	if(s.size() + 128 > s.capacity()) s.reserve(s.capacity() + 1024);
-	switch(variable->type)
-	{
-	case VariableType::tArray:
-		encodeArray(variable, s);
-		break;
-	case VariableType::tStruct:
-		encodeStruct(variable, s);
-		break;
-	case VariableType::tBoolean:
-		encodeBoolean(variable, s);
-		break;
-	case VariableType::tInteger:
-		encodeInteger(variable, s);
-		break;
-	case VariableType::tInteger64:
-		encodeInteger64(variable, s);
-		break;
-	case VariableType::tFloat:
-		encodeFloat(variable, s);
-		break;
-	case VariableType::tBase64:
-		encodeString(variable, s);
-		break;
-	case VariableType::tString:
-		encodeString(variable, s);
-		break;
-	case VariableType::tVoid:
-		encodeVoid(variable, s);
-		break;
-	case VariableType::tVariant:
-		encodeVoid(variable, s);
-		break;
-	case VariableType::tBinary:
-		encodeVoid(variable, s);
-		break;
-	}
-}
-
-void JsonEncoder::encodeArray(const std::shared_ptr<Variable>& variable, std::ostringstream& s)
-{
-	s << '[';
-	if(!variable->arrayValue->empty())
-	{
-		encodeValue(variable->arrayValue->at(0), s);
-		for(std::vector<std::shared_ptr<Variable>>::iterator i = ++variable->arrayValue->begin(); i != variable->arrayValue->end(); ++i)
-		{
-			s << ',';
-			encodeValue(*i, s);
-		}
-	}
-	s << ']';
-}
-
-void JsonEncoder::encodeArray(const std::shared_ptr<Variable>& variable, std::vector<char>& s)
+template<typename Output>
+void JsonEncoder::encodeArray(const std::shared_ptr<Variable>& variable, Output& s)
 {
 	s.push_back('[');
 	if(!variable->arrayValue->empty())
@@ -238,28 +720,8 @@ void JsonEncoder::encodeArray(const std::shared_ptr<Variable>& variable, std::ve
 	s.push_back(']');
 }
 
-void JsonEncoder::encodeStruct(const std::shared_ptr<Variable>& variable, std::ostringstream& s)
-{
-    s << '{';
-    if(!variable->structValue->empty())
-    {
-        s << '"';
-        s << variable->structValue->begin()->first;
-        s << "\":";
-        encodeValue(variable->structValue->begin()->second, s);
-        for(std::map<std::string, std::shared_ptr<Variable>>::iterator i = ++variable->structValue->begin(); i != variable->structValue->end(); ++i)
-        {
-            s << ',';
-            s << '"';
-            s << encodeString(i->first);
-            s << "\":";
-            encodeValue(i->second, s);
-        }
-    }
-    s << '}';
-}
-
-void JsonEncoder::encodeStruct(const std::shared_ptr<Variable>& variable, std::vector<char>& s)
+template<typename Output>
+void JsonEncoder::encodeStruct(const std::shared_ptr<Variable>& variable, Output& s)
 {
     s.push_back('{');
     if(!variable->structValue->empty())
@@ -283,12 +745,8 @@ void JsonEncoder::encodeStruct(const std::shared_ptr<Variable>& variable, std::v
     s.push_back('}');
 }
 
-void JsonEncoder::encodeBoolean(const std::shared_ptr<Variable>& variable, std::ostringstream& s)
-{
-	s << ((variable->booleanValue) ? "true" : "false");
-}
-
-void JsonEncoder::encodeBoolean(const std::shared_ptr<Variable>& variable, std::vector<char>& s)
+template<typename Output>
+void JsonEncoder::encodeBoolean(const std::shared_ptr<Variable>& variable, Output& s)
 {
 	if(variable->booleanValue)
 	{
@@ -307,44 +765,46 @@ void JsonEncoder::encodeBoolean(const std::shared_ptr<Variable>& variable, std::
 	}
 }
 
-void JsonEncoder::encodeInteger(const std::shared_ptr<Variable>& variable, std::ostringstream& s)
+template<typename Output>
+void JsonEncoder::encodeInteger(const std::shared_ptr<Variable>& variable, Output& s)
 {
-	s << std::to_string(variable->integerValue);
+	char buffer[32];
+	char* end = writeInteger(variable->integerValue, buffer);
+	s.insert(s.end(), buffer, end);
 }
 
-void JsonEncoder::encodeInteger(const std::shared_ptr<Variable>& variable, std::vector<char>& s)
+template<typename Output>
+void JsonEncoder::encodeInteger64(const std::shared_ptr<Variable>& variable, Output& s)
 {
-	std::string value(std::to_string(variable->integerValue));
-	s.insert(s.end(), value.begin(), value.end());
+	char buffer[32];
+	char* end = writeInteger(variable->integerValue64, buffer);
+	s.insert(s.end(), buffer, end);
 }
 
-void JsonEncoder::encodeInteger64(const std::shared_ptr<Variable>& variable, std::ostringstream& s)
+template<typename Output>
+void JsonEncoder::encodeFloat(const std::shared_ptr<Variable>& variable, Output& s)
 {
-	s << std::to_string(variable->integerValue64);
-}
-
-void JsonEncoder::encodeInteger64(const std::shared_ptr<Variable>& variable, std::vector<char>& s)
-{
-	std::string value(std::to_string(variable->integerValue64));
-	s.insert(s.end(), value.begin(), value.end());
-}
-
-void JsonEncoder::encodeFloat(const std::shared_ptr<Variable>& variable, std::ostringstream& s)
-{
-	s << std::fixed << std::setprecision(15) << variable->floatValue << std::setprecision(6);
-	s.unsetf(std::ios_base::floatfield);
-}
-
-void JsonEncoder::encodeFloat(const std::shared_ptr<Variable>& variable, std::vector<char>& s)
-{
-	std::string value(Math::toString(variable->floatValue));
-	s.insert(s.end(), value.begin(), value.end());
+	if(!std::isfinite(variable->floatValue))
+	{
+		//JSON has no representation for NaN and infinity
+		encodeVoid(variable, s);
+		return;
+	}
+	char buffer[32];
+	char* end = writeDouble(variable->floatValue, buffer);
+	s.insert(s.end(), buffer, end);
 }
 
 #if __GNUC__ > 4
 
 std::string JsonEncoder::encodeString(const std::string& s)
 {
+    {
+        std::string result;
+        result.reserve(s.size() + 16);
+        if(appendEscaped(s.data(), s.size(), result)) return result;
+    }
+
     std::u16string utf16;
     try
     {
@@ -486,285 +946,20 @@ std::string JsonEncoder::encodeString(const std::string& s)
 	return result;
 }
 
-void JsonEncoder::encodeString(const std::shared_ptr<Variable>& variable, std::ostringstream& s)
+template<typename Output>
+void JsonEncoder::encodeString(const std::shared_ptr<Variable>& variable, Output& s)
 {
-    std::u16string utf16;
-    try
-    {
-        utf16 = std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>{}.from_bytes(variable->stringValue);
-    }
-    catch(const std::exception&)
+    const BufferView view = variable->getDataView();
+    reserve(s, s.size() + view.size() + 128);
+    s.push_back('"');
+    const size_t start = s.size();
+    if(!appendEscaped((const char*)view.data(), view.size(), s))
     {
-        //Fallback: Try converting byte by byte
-        utf16.clear();
-        utf16.reserve(variable->stringValue.size());
-
-        /*
-         * 0000 0000 – 0000 007F => 0xxxxxxx //UTF-8 = ASCII //First bit is always 0
-         * 0000 0080 – 0000 07FF => 110xxxxx 10xxxxxx //First thre bits of the first byte are always 110, the first two bits of the following bytes are always 10
-         * 0000 0800 – 0000 FFFF => 1110xxxx 10xxxxxx 10xxxxxx //First four bits of the first byte are always 1110, the first two bits of the following bytes are always 10
-         * 0001 0000 – 0010 FFFF => 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx //First five bits of the first byte are always 11110, the first two bits of the following bytes are always 10
-         */
-
-        for(int32_t i = 0; i < (signed)variable->stringValue.size(); i++)
-        {
-            uint8_t b1 = (uint8_t)variable->stringValue.at(i);
-			if(b1 & 0x80) //> 1 byte or invalid
-			{
-				std::string utf8String;
-				bool invalid = false;
-				if((b1 & 0xE0) == 0xC0) //Two bytes
-				{
-					if(i + 1 >= (signed)variable->stringValue.size()) invalid = true;
-					else
-					{
-						auto b2 = (uint8_t)variable->stringValue.at(i + 1);
-						if((b2 & 0xC0) == 0x80)
-						{
-							i++;
-							utf8String = std::string{(char) b1, (char) b2};
-						}
-						else invalid = true;
-					}
-				}
-				else if((b1 & 0xF0) == 0xE0) //Three bytes
-				{
-					if(i + 2 >= (signed)variable->stringValue.size()) invalid = true;
-					else
-					{
-						auto b2 = (uint8_t) variable->stringValue.at(i + 1);
-						auto b3 = (uint8_t) variable->stringValue.at(i + 2);
-						if((b2 & 0xC0) == 0x80 && (b3 & 0xC0) == 0x80)
-						{
-							i += 2;
-							utf8String = std::string{(char) b1, (char) b2, (char) b3};
-						}
-						else invalid = true;
-					}
-				}
-				else if((b1 & 0xF8) == 0xF0) //Four bytes
-				{
-					if(i + 3 >= (signed)variable->stringValue.size()) invalid = true;
-					else
-					{
-						auto b2 = (uint8_t) variable->stringValue.at(i + 1);
-						auto b3 = (uint8_t) variable->stringValue.at(i + 2);
-						auto b4 = (uint8_t) variable->stringValue.at(i + 3);
-						if((b2 & 0xC0) == 0x80 && (b3 & 0xC0) == 0x80 && (b4 & 0xC0) == 0x80)
-						{
-							i += 3;
-							utf8String = std::string{(char) b1, (char) b2, (char) b3, (char) b4};
-						}
-						else invalid = true;
-					}
-				}
-				else invalid = true;
-				if(invalid) //Assume ANSI
-				{
-					Ansi ansi(true, false);
-					utf8String = ansi.toUtf8(std::string((char*)&b1, 1));
-				}
-				if(!utf8String.empty())
-				{
-					utf16.append(std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>{}.from_bytes(utf8String));
-				}
-			}
-			else
-			{
-				utf16.append(std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>{}.from_bytes((char)b1));
-			}
-        }
-    }
-
-	//The RFC says: "All Unicode characters may be placed within the quotation marks except for the characters that must
-	//be escaped: quotation mark, reverse solidus, and the control characters (U+0000 through U+001F)."
-
-	//Source: https://github.com/miloyip/rapidjson/blob/master/include/rapidjson/writer.h
-	static const char hexDigits[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-	static const char escape[256] =
-	{
-		//0 1 2 3 4 5 6 7 8 9 A B C D E F
-		'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u', // 00-0F
-		'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // 10-1F
-		0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 20-2F
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 30-4F
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,'\\', 0, 0, 0, // 50-5F
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 60-7F
-        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // 80-9F
-        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // A0-BF
-        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // C0-DF
-        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u'  // E0-FF
-	};
-	s << "\"";
-	for(std::u16string::iterator i = utf16.begin(); i != utf16.end(); ++i)
-	{
-		if((uint16_t)*i < 256 && escape[(uint8_t)*i])
-		{
-			if (escape[(uint8_t)*i] == 'u')
-			{
-                s << '\\' << escape[(uint8_t)*i];
-				s << '0' << '0' << hexDigits[((uint8_t)*i) >> 4] << hexDigits[((uint8_t)*i) & 0xF];
-			}
-			else s << '\\' << escape[(uint8_t)*i];
-		}
-		else
-        {
-            if((uint16_t)*i < 256) s << (char)(uint8_t)*i;
-            else
-            {
-                s << '\\' << 'u' << hexDigits[(uint8_t)(*i >> 12)] << hexDigits[(uint8_t)((*i >> 8) & 0x0F)] << hexDigits[(uint8_t)((*i >> 4) & 0x0F)] << hexDigits[(uint8_t) (*i & 0x0F)];
-            }
-        }
-	}
-	s << "\"";
-}
-
-void JsonEncoder::encodeString(const std::shared_ptr<Variable>& variable, std::vector<char>& s)
-{
-    std::u16string utf16;
-    try
-    {
-        utf16 = std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>{}.from_bytes(variable->stringValue);
-    }
-    catch(const std::exception&)
-    {
-        //Fallback: Try converting byte by byte
-        utf16.clear();
-        utf16.reserve(variable->stringValue.size());
-
-        /*
-         * 0000 0000 – 0000 007F => 0xxxxxxx //UTF-8 = ASCII //First bit is always 0
-         * 0000 0080 – 0000 07FF => 110xxxxx 10xxxxxx //First thre bits of the first byte are always 110, the first two bits of the following bytes are always 10
-         * 0000 0800 – 0000 FFFF => 1110xxxx 10xxxxxx 10xxxxxx //First four bits of the first byte are always 1110, the first two bits of the following bytes are always 10
-         * 0001 0000 – 0010 FFFF => 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx //First five bits of the first byte are always 11110, the first two bits of the following bytes are always 10
-         */
-
-        for(int32_t i = 0; i < (signed)variable->stringValue.size(); i++)
-        {
-            uint8_t b1 = (uint8_t)variable->stringValue.at(i);
-			if(b1 & 0x80) //> 1 byte or invalid
-			{
-				std::string utf8String;
-				bool invalid = false;
-				if((b1 & 0xE0) == 0xC0) //Two bytes
-				{
-					if(i + 1 >= (signed)variable->stringValue.size()) invalid = true;
-					else
-					{
-						auto b2 = (uint8_t)variable->stringValue.at(i + 1);
-						if((b2 & 0xC0) == 0x80)
-						{
-							i++;
-							utf8String = std::string{(char) b1, (char) b2};
-						}
-						else invalid = true;
-					}
-				}
-				else if((b1 & 0xF0) == 0xE0) //Three bytes
-				{
-					if(i + 2 >= (signed)variable->stringValue.size()) invalid = true;
-					else
-					{
-						auto b2 = (uint8_t) variable->stringValue.at(i + 1);
-						auto b3 = (uint8_t) variable->stringValue.at(i + 2);
-						if((b2 & 0xC0) == 0x80 && (b3 & 0xC0) == 0x80)
-						{
-							i += 2;
-							utf8String = std::string{(char) b1, (char) b2, (char) b3};
-						}
-						else invalid = true;
-					}
-				}
-				else if((b1 & 0xF8) == 0xF0) //Four bytes
-				{
-					if(i + 3 >= (signed)variable->stringValue.size()) invalid = true;
-					else
-					{
-						auto b2 = (uint8_t) variable->stringValue.at(i + 1);
-						auto b3 = (uint8_t) variable->stringValue.at(i + 2);
-						auto b4 = (uint8_t) variable->stringValue.at(i + 3);
-						if((b2 & 0xC0) == 0x80 && (b3 & 0xC0) == 0x80 && (b4 & 0xC0) == 0x80)
-						{
-							i += 3;
-							utf8String = std::string{(char) b1, (char) b2, (char) b3, (char) b4};
-						}
-						else invalid = true;
-					}
-				}
-				else invalid = true;
-				if(invalid) //Assume ANSI
-				{
-					Ansi ansi(true, false);
-					utf8String = ansi.toUtf8(std::string((char*)&b1, 1));
-				}
-				if(!utf8String.empty())
-				{
-					utf16.append(std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>{}.from_bytes(utf8String));
-				}
-			}
-			else
-			{
-				utf16.append(std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>{}.from_bytes((char)b1));
-			}
-        }
+        s.resize(start);
+        std::string escaped = encodeString(std::string((const char*)view.data(), view.size()));
+        s.insert(s.end(), escaped.begin(), escaped.end());
     }
-
-	if(s.size() + (utf16.size() * 2) + 128 > s.capacity())
-	{
-		int32_t factor = (utf16.size() * 2) / 1024;
-		uint32_t neededSize = s.size() + (factor * 1024) + 1024;
-		if(neededSize > s.capacity()) s.reserve(neededSize);
-	}
-
-	//The RFC says: "All Unicode characters may be placed within the quotation marks except for the characters that must
-	//be escaped: quotation mark, reverse solidus, and the control characters (U+0000 through U+001F)."
-
-	//Source: https://github.com/miloyip/rapidjson/blob/master/include/rapidjson/writer.h
-	static const char hexDigits[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-	static const char escape[256] =
-	{
-		//0 1 2 3 4 5 6 7 8 9 A B C D E F
-		'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u', // 00-0F
-		'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // 10-1F
-		0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 20-2F
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 30-4F
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,'\\', 0, 0, 0, // 50-5F
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 60-7F
-        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // 80-9F
-        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // A0-BF
-        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // C0-DF
-        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u'  // E0-FF
-	};
-	s.push_back('"');
-	for(const char16_t c : utf16)
-	{
-		if((uint16_t)c < 256 && escape[(uint8_t)c])
-		{
-			s.push_back('\\');
-			s.push_back(escape[(uint8_t)c]);
-			if (escape[(uint8_t)c] == 'u')
-			{
-				s.push_back('0');
-				s.push_back('0');
-				s.push_back(hexDigits[(uint8_t)c >> 4]);
-				s.push_back(hexDigits[(uint8_t)c & 0xF]);
-			}
-		}
-		else
-        {
-            if((uint16_t)c < 256) s.push_back((char)(uint8_t)c);
-            else
-            {
-                s.push_back('\\');
-                s.push_back('u');
-                s.push_back(hexDigits[(uint8_t)(c >> 12)]);
-                s.push_back(hexDigits[(uint8_t)((c >> 8) & 0x0F)]);
-                s.push_back(hexDigits[(uint8_t)((c >> 4) & 0x0F)]);
-                s.push_back(hexDigits[(uint8_t) (c & 0x0F)]);
-            }
-        }
-	}
-	s.push_back('"');
+    s.push_back('"');
 }
 
 #else
@@ -816,49 +1011,12 @@ std::string JsonEncoder::encodeString(const std::string& s)
 	return result;
 }
 
-void JsonEncoder::encodeString(const std::shared_ptr<Variable>& variable, std::ostringstream& s)
+template<typename Output>
+void JsonEncoder::encodeString(const std::shared_ptr<Variable>& variable, Output& s)
 {
-	//Source: https://github.com/miloyip/rapidjson/blob/master/include/rapidjson/writer.h
-	static const char hexDigits[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-	static const char escape[256] =
-	{
-		//0 1 2 3 4 5 6 7 8 9 A B C D E F
-		'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u', // 00-0F
-		'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', // 10-1F
-		0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 20-2F
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 30-4F
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,'\\', 0, 0, 0, // 50-5F
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 60-7F
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 80-9F
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // A0-BF
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // C0-DF
-		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0  // E0-FF
-	};
-	s << "\"";
-	for(std::string::iterator i = variable->stringValue.begin(); i != variable->stringValue.end(); ++i)
-	{
-		if(escape[(uint8_t)*i])
-		{
-			s << '\\' << escape[(uint8_t)*i];
-			if (escape[(uint8_t)*i] == 'u')
-			{
-				s << '0' << '0' << hexDigits[((uint8_t)*i) >> 4] << hexDigits[((uint8_t)*i) & 0xF];
-			}
-		}
-		else s << *i;
-	}
-	s << "\"";
-}
-
-void JsonEncoder::encodeString(const std::shared_ptr<Variable>& variable, std::vector<char>& s)
-{
-	if(s.size() + variable->stringValue.size() + 128 > s.capacity())
-
-	{
-		int32_t factor = variable->stringValue.size() / 1024;
-		uint32_t neededSize = s.size() + (factor * 1024) + 1024;
-		if(neededSize > s.capacity()) s.reserve(neededSize);
-	}
+	//Values decoded from binary RPC might only reference the packet, so the string is read from the view.
+	const BufferView view = variable->getDataView();
+	reserve(s, s.size() + view.size() + 128);
 
 	//Source: https://github.com/miloyip/rapidjson/blob/master/include/rapidjson/writer.h
 	static const char hexDigits[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
@@ -877,33 +1035,29 @@ void JsonEncoder::encodeString(const std::shared_ptr<Variable>& variable, std::v
 		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0  // E0-FF
 	};
 	s.push_back('"');
-	for(const uint8_t& c : variable->stringValue)
+	for(const uint8_t* c = view.data(); c != view.data() + view.size(); ++c)
 	{
-		if(escape[c])
+		if(escape[*c])
 		{
 			s.push_back('\\');
-			s.push_back(escape[c]);
-			if (escape[c] == 'u')
+			s.push_back(escape[*c]);
+			if (escape[*c] == 'u')
 			{
 				s.push_back('0');
 				s.push_back('0');
-				s.push_back(hexDigits[c >> 4]);
-				s.push_back(hexDigits[c & 0xF]);
+				s.push_back(hexDigits[*c >> 4]);
+				s.push_back(hexDigits[*c & 0xF]);
 			}
 		}
-		else s.push_back(c);
+		else s.push_back((char)*c);
 	}
 	s.push_back('"');
 }
 
 #endif
 
-void JsonEncoder::encodeVoid(const std::shared_ptr<Variable>& variable, std::ostringstream& s)
-{
-	s << "null";
-}
-
-void JsonEncoder::encodeVoid(const std::shared_ptr<Variable>& variable, std::vector<char>& s)
+template<typename Output>
+void JsonEncoder::encodeVoid(const std::shared_ptr<Variable>& variable, Output& s)
 {
 	s.push_back('n');
 	s.push_back('u');
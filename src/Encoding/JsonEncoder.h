@@ -54,34 +54,66 @@ public:
     explicit JsonEncoder(BaseLib::SharedObjects* dummy) {}
     virtual ~JsonEncoder() = default;
 
+    /**
+     * Encodes "variable" as JSON document. Structs and arrays are encoded as they are, all other values are wrapped in an
+     * array. "json" is replaced.
+     *
+     * Floats are written in the shortest form that reads back to the same double and always contain a decimal point or
+     * an exponent, so integral values keep their type (1.0 is written as "1.0", not as "1"). NaN and infinity have no
+     * JSON representation and are written as "null".
+     */
     static void encode(const std::shared_ptr<Variable>& variable, std::string& json);
     static void encode(const std::shared_ptr<Variable>& variable, std::vector<char>& json);
     void encodeRequest(std::string& methodName, std::shared_ptr<std::list<std::shared_ptr<Variable>>>& parameters, std::vector<char>& encodedData);
+
+    /**
+     * Encodes several method calls as one JSON-RPC 2.0 batch request.
+     *
+     * @param calls The method names and parameters.
+     * @param[out] encodedData The encoded batch request.
+     * @param[out] ids The ids assigned to the calls in the order of "calls". Pass them to JsonDecoder::decodeBatchResponse() to match the responses.
+     */
+    void encodeBatchRequest(const std::vector<std::pair<std::string, PArray>>& calls, std::vector<char>& encodedData, std::vector<int32_t>& ids);
+
     static void encodeResponse(const std::shared_ptr<Variable>& variable, int32_t id, std::vector<char>& json);
+
+    /**
+     * Encodes the answer to a JSON-RPC 2.0 batch request. Each response is encoded like encodeResponse() does.
+     *
+     * @param responses The request ids as returned in JsonRpcRequest::id (numbers or strings) and the return values of the calls.
+     * @param[out] json The encoded batch response.
+     */
+    static void encodeBatchResponse(const std::vector<std::pair<std::shared_ptr<Variable>, std::shared_ptr<Variable>>>& responses, std::vector<char>& json);
     static void encodeMQTTResponse(const std::string& methodName, const std::shared_ptr<Variable>& variable, int32_t id, std::vector<char>& json);
 
     static std::string encodeString(const std::string& s);
 private:
     int32_t _requestId = 1;
 
-    static void encodeValue(const std::shared_ptr<Variable>& variable, std::ostringstream& s);
-    static void encodeValue(const std::shared_ptr<Variable>& variable, std::vector<char>& s);
-    static void encodeArray(const std::shared_ptr<Variable>& variable, std::ostringstream& s);
-    static void encodeArray(const std::shared_ptr<Variable>& variable, std::vector<char>& s);
-    static void encodeStruct(const std::shared_ptr<Variable>& variable, std::ostringstream& s);
-    static void encodeStruct(const std::shared_ptr<Variable>& variable, std::vector<char>& s);
-    static void encodeBoolean(const std::shared_ptr<Variable>& variable, std::ostringstream& s);
-    static void encodeBoolean(const std::shared_ptr<Variable>& variable, std::vector<char>& s);
-    static void encodeInteger( const std::shared_ptr<Variable>& variable, std::ostringstream& s);
-    static void encodeInteger( const std::shared_ptr<Variable>& variable, std::vector<char>& s);
-    static void encodeInteger64( const std::shared_ptr<Variable>& variable, std::ostringstream& s);
-    static void encodeInteger64( const std::shared_ptr<Variable>& variable, std::vector<char>& s);
-    static void encodeFloat(const std::shared_ptr<Variable>& variable, std::ostringstream& s);
-    static void encodeFloat(const std::shared_ptr<Variable>& variable, std::vector<char>& s);
-    static void encodeString(const std::shared_ptr<Variable>& variable, std::ostringstream& s);
-    static void encodeString(const std::shared_ptr<Variable>& variable, std::vector<char>& s);
-    static void encodeVoid(const std::shared_ptr<Variable>& variable, std::ostringstream& s);
-    static void encodeVoid(const std::shared_ptr<Variable>& variable, std::vector<char>& s);
+    static std::shared_ptr<Variable> createRequest(const std::string& methodName, const std::shared_ptr<Variable>& params, int32_t id);
+    static std::shared_ptr<Variable> createResponse(const std::shared_ptr<Variable>& variable, int32_t id);
+    static std::shared_ptr<Variable> createResponse(const std::shared_ptr<Variable>& variable, const std::shared_ptr<Variable>& id);
+
+    template<typename Output>
+    static void encodeDocument(const std::shared_ptr<Variable>& variable, Output& json);
+    template<typename Output>
+    static void encodeValue(const std::shared_ptr<Variable>& variable, Output& s);
+    template<typename Output>
+    static void encodeArray(const std::shared_ptr<Variable>& variable, Output& s);
+    template<typename Output>
+    static void encodeStruct(const std::shared_ptr<Variable>& variable, Output& s);
+    template<typename Output>
+    static void encodeBoolean(const std::shared_ptr<Variable>& variable, Output& s);
+    template<typename Output>
+    static void encodeInteger(const std::shared_ptr<Variable>& variable, Output& s);
+    template<typename Output>
+    static void encodeInteger64(const std::shared_ptr<Variable>& variable, Output& s);
+    template<typename Output>
+    static void encodeFloat(const std::shared_ptr<Variable>& variable, Output& s);
+    template<typename Output>
+    static void encodeString(const std::shared_ptr<Variable>& variable, Output& s);
+    template<typename Output>
+    static void encodeVoid(const std::shared_ptr<Variable>& variable, Output& s);
 };
 }
 }
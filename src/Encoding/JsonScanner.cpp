@@ -0,0 +1,291 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "JsonScanner.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace BaseLib
+{
+namespace Rpc
+{
+
+namespace
+{
+
+struct BlockMasks
+{
+	uint64_t backslash = 0;
+	uint64_t quote = 0;
+	uint64_t whitespace = 0;
+	uint64_t structural = 0;
+};
+
+#if defined(__SSE2__)
+
+void classify(const char* block, BlockMasks& masks)
+{
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i lineFeed = _mm_set1_epi8('\n');
+	const __m128i carriageReturn = _mm_set1_epi8('\r');
+	const __m128i caseBit = _mm_set1_epi8(0x20);
+	const __m128i openingBracket = _mm_set1_epi8('{'); //"[" | 0x20 == "{"
+	const __m128i closingBracket = _mm_set1_epi8('}'); //"]" | 0x20 == "}"
+	const __m128i colon = _mm_set1_epi8(':');
+	const __m128i comma = _mm_set1_epi8(',');
+
+	for(int32_t i = 0; i < 4; i++)
+	{
+		const __m128i data = _mm_loadu_si128((const __m128i*)(block + (i * 16)));
+		const __m128i folded = _mm_or_si128(data, caseBit);
+		const int32_t shift = i * 16;
+		masks.backslash |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(data, backslash)) << shift;
+		masks.quote |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(data, quote)) << shift;
+		masks.whitespace |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(data, space), _mm_cmpeq_epi8(data, tab)), _mm_or_si128(_mm_cmpeq_epi8(data, lineFeed), _mm_cmpeq_epi8(data, carriageReturn)))) << shift;
+		masks.structural |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, openingBracket), _mm_cmpeq_epi8(folded, closingBracket)), _mm_or_si128(_mm_cmpeq_epi8(data, colon), _mm_cmpeq_epi8(data, comma)))) << shift;
+	}
+}
+
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+
+inline uint64_t toBitmask(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3)
+{
+	const uint8x16_t bitWeights = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+	uint8x16_t sum0 = vpaddq_u8(vandq_u8(m0, bitWeights), vandq_u8(m1, bitWeights));
+	uint8x16_t sum1 = vpaddq_u8(vandq_u8(m2, bitWeights), vandq_u8(m3, bitWeights));
+	sum0 = vpaddq_u8(sum0, sum1);
+	sum0 = vpaddq_u8(sum0, sum0);
+	return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+void classify(const char* block, BlockMasks& masks)
+{
+	uint8x16_t backslash[4];
+	uint8x16_t quote[4];
+	uint8x16_t whitespace[4];
+	uint8x16_t structural[4];
+	for(int32_t i = 0; i < 4; i++)
+	{
+		const uint8x16_t data = vld1q_u8((const uint8_t*)block + (i * 16));
+		const uint8x16_t folded = vorrq_u8(data, vdupq_n_u8(0x20));
+		backslash[i] = vceqq_u8(data, vdupq_n_u8('\\'));
+		quote[i] = vceqq_u8(data, vdupq_n_u8('"'));
+		whitespace[i] = vorrq_u8(vorrq_u8(vceqq_u8(data, vdupq_n_u8(' ')), vceqq_u8(data, vdupq_n_u8('\t'))), vorrq_u8(vceqq_u8(data, vdupq_n_u8('\n')), vceqq_u8(data, vdupq_n_u8('\r'))));
+		structural[i] = vorrq_u8(vorrq_u8(vceqq_u8(folded, vdupq_n_u8('{')), vceqq_u8(folded, vdupq_n_u8('}'))), vorrq_u8(vceqq_u8(data, vdupq_n_u8(':')), vceqq_u8(data, vdupq_n_u8(','))));
+	}
+	masks.backslash = toBitmask(backslash[0], backslash[1], backslash[2], backslash[3]);
+	masks.quote = toBitmask(quote[0], quote[1], quote[2], quote[3]);
+	masks.whitespace = toBitmask(whitespace[0], whitespace[1], whitespace[2], whitespace[3]);
+	masks.structural = toBitmask(structural[0], structural[1], structural[2], structural[3]);
+}
+
+#else
+
+void classify(const char* block, BlockMasks& masks)
+{
+	for(int32_t i = 0; i < 64; i++)
+	{
+		const uint64_t bit = 1ull << i;
+		switch(block[i])
+		{
+			case '\\':
+				masks.backslash |= bit;
+				break;
+			case '"':
+				masks.quote |= bit;
+				break;
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				masks.whitespace |= bit;
+				break;
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case ':':
+			case ',':
+				masks.structural |= bit;
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+#endif
+
+/**
+ * Returns a mask with all bits set from an odd to the next even set bit of "quotes", i. e. the string contents including
+ * the opening but excluding the closing quote.
+ */
+inline uint64_t prefixXor(uint64_t quotes)
+{
+	quotes ^= quotes << 1;
+	quotes ^= quotes << 2;
+	quotes ^= quotes << 4;
+	quotes ^= quotes << 8;
+	quotes ^= quotes << 16;
+	quotes ^= quotes << 32;
+	return quotes;
+}
+
+}
+
+bool JsonScanner::scan(const char* json, size_t size, std::vector<uint32_t>& structuralIndices)
+{
+	structuralIndices.clear();
+	structuralIndices.reserve(size / 8 + 64);
+
+	uint64_t escapeCarry = 0; //1 when the first character of the next block is escaped
+	uint64_t stringCarry = 0; //All bits set when the next block starts inside of a string
+	uint64_t tokenCarry = 0; //1 when the last character of the previous block belongs to a token
+
+	char lastBlock[64];
+	for(size_t blockStart = 0; blockStart < size; blockStart += 64)
+	{
+		const char* block = json + blockStart;
+		if(size - blockStart < 64)
+		{
+			//Pad with whitespace, which doesn't produce any entries.
+			std::memset(lastBlock, ' ', sizeof(lastBlock));
+			std::memcpy(lastBlock, block, size - blockStart);
+			block = lastBlock;
+		}
+
+		BlockMasks masks;
+		classify(block, masks);
+
+		//Find escaped characters. Backslashes are rare, so just walk them.
+		uint64_t escaped = escapeCarry;
+		uint64_t backslash = masks.backslash & ~escapeCarry;
+		escapeCarry = 0;
+		while(backslash)
+		{
+			const int32_t position = __builtin_ctzll(backslash);
+			if(position == 63)
+			{
+				escapeCarry = 1;
+				break;
+			}
+			escaped |= 2ull << position;
+			backslash &= ~(3ull << position);
+		}
+
+		const uint64_t quotes = masks.quote & ~escaped;
+		const uint64_t inString = prefixXor(quotes) ^ stringCarry;
+		stringCarry = 0 - (inString >> 63);
+
+		const uint64_t structural = masks.structural & ~inString;
+		const uint64_t token = ~(masks.whitespace | masks.structural | masks.quote | inString);
+		const uint64_t tokenStart = token & ~((token << 1) | tokenCarry);
+		tokenCarry = token >> 63;
+
+		uint64_t indices = structural | quotes | tokenStart;
+		while(indices)
+		{
+			structuralIndices.push_back((uint32_t)(blockStart + __builtin_ctzll(indices)));
+			indices &= indices - 1;
+		}
+	}
+
+	return stringCarry == 0;
+}
+
+
+size_t JsonScanner::findQuoteOrBackslash(const char* data, size_t size)
+{
+	size_t i = 0;
+#if defined(__SSE2__)
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	for(; i + 16 <= size; i += 16)
+	{
+		const __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+		const int32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+		if(mask) return i + __builtin_ctz(mask);
+	}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+	for(; i + 16 <= size; i += 16)
+	{
+		const uint8x16_t chunk = vld1q_u8((const uint8_t*)data + i);
+		if(vmaxvq_u8(vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('"')), vceqq_u8(chunk, vdupq_n_u8('\\'))))) break; //Found, locate below
+	}
+#endif
+	for(; i < size; i++)
+	{
+		if(data[i] == '"' || data[i] == '\\') return i;
+	}
+	return size;
+}
+
+size_t JsonScanner::findCharacterToEscape(const char* data, size_t size)
+{
+	size_t i = 0;
+#if defined(__SSE2__)
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i space = _mm_set1_epi8(0x20);
+	for(; i + 16 <= size; i += 16)
+	{
+		const __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+		//The comparison is signed, so bytes >= 0x80 are less than 0x20, too.
+		const __m128i special = _mm_or_si128(_mm_cmplt_epi8(chunk, space), _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+		const int32_t mask = _mm_movemask_epi8(special);
+		if(mask) return i + __builtin_ctz(mask);
+	}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+	for(; i + 16 <= size; i += 16)
+	{
+		const uint8x16_t chunk = vld1q_u8((const uint8_t*)data + i);
+		const uint8x16_t special = vorrq_u8(vorrq_u8(vcltq_u8(chunk, vdupq_n_u8(0x20)), vcgeq_u8(chunk, vdupq_n_u8(0x80))), vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('"')), vceqq_u8(chunk, vdupq_n_u8('\\'))));
+		if(vmaxvq_u8(special)) break; //Found, locate below
+	}
+#endif
+	for(; i < size; i++)
+	{
+		const uint8_t c = (uint8_t)data[i];
+		if(c < 0x20 || c >= 0x80 || c == '"' || c == '\\') return i;
+	}
+	return size;
+}
+
+}
+}
@@ -0,0 +1,92 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef JSONSCANNER_H_
+#define JSONSCANNER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace BaseLib
+{
+namespace Rpc
+{
+
+/**
+ * Stage 1 of JSON decoding: Classifies the input in blocks of 64 bytes using SSE2 or NEON (there is a scalar fallback for
+ * all other targets) and records the positions of everything a parser needs to look at. JsonDecoder uses the result to
+ * skip whitespace and string contents in bulk.
+ *
+ * Also provides the vectorized searches JsonEncoder and JsonDecoder use to copy string contents that need no escaping
+ * or unescaping in bulk.
+ */
+class JsonScanner
+{
+public:
+	JsonScanner() = delete;
+
+	/**
+	 * Collects the positions of
+	 *
+	 * - all structural characters ("{", "}", "[", "]", ":" and ",") outside of strings,
+	 * - the opening and the closing quote of every string, so a string always occupies two consecutive entries,
+	 * - the first character of all other tokens (numbers, "true", "false" and "null").
+	 *
+	 * Whitespace and string contents are never included. The input does not need to be valid JSON.
+	 *
+	 * @param json The data to scan.
+	 * @param size The number of bytes in json. Must not be larger than maximumSize.
+	 * @param[out] structuralIndices The positions in ascending order. The vector is cleared first.
+	 * @return Returns "false" when the input ends inside of a string, otherwise "true".
+	 */
+	static bool scan(const char* json, size_t size, std::vector<uint32_t>& structuralIndices);
+
+	/**
+	 * The largest input scan() accepts, so positions fit into 32 bits.
+	 */
+	static constexpr size_t maximumSize = 0xFFFFFFFF;
+
+	/**
+	 * Returns the position of the first quote or backslash in "data" or "size" if there is none.
+	 */
+	static size_t findQuoteOrBackslash(const char* data, size_t size);
+
+	/**
+	 * Returns the position of the first character JsonEncoder can't copy as is, i. e. a quote, a backslash, a control
+	 * character or a non-ASCII byte, or "size" if there is none.
+	 */
+	static size_t findCharacterToEscape(const char* data, size_t size);
+};
+
+}
+}
+
+#endif
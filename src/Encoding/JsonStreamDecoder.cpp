@@ -0,0 +1,290 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "JsonStreamDecoder.h"
+#include "../HelperFunctions/MemoryArena.h"
+
+#include <stdexcept>
+
+namespace BaseLib
+{
+namespace Rpc
+{
+
+namespace
+{
+
+inline bool isWhitespace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool isDelimiter(char c)
+{
+	return isWhitespace(c) || c == ',' || c == ':' || c == '[' || c == ']' || c == '{' || c == '}' || c == '"';
+}
+
+}
+
+void JsonStreamDecoder::reset()
+{
+	_state = State::value;
+	_containers.clear();
+	_values = std::queue<PVariable>();
+	_token.clear();
+	_stringIsKey = false;
+	_stringHasEscapes = false;
+	_escape = false;
+}
+
+PVariable JsonStreamDecoder::getValue()
+{
+	if(_values.empty()) return PVariable();
+	PVariable value = std::move(_values.front());
+	_values.pop();
+	return value;
+}
+
+size_t JsonStreamDecoder::process(const char* data, size_t length)
+{
+	const size_t valueCount = _values.size();
+	const char* end = data + length;
+	while(data < end)
+	{
+		if(_state == State::string)
+		{
+			if(readString(data, end)) finishString();
+			continue;
+		}
+		if(_state == State::scalar)
+		{
+			const char* start = data;
+			while(data < end && !isDelimiter(*data)) data++;
+			_token.append(start, data - start);
+			if(data < end) finishScalar();
+			continue;
+		}
+
+		const char c = *data;
+		if(isWhitespace(c))
+		{
+			data++;
+			continue;
+		}
+
+		switch(_state)
+		{
+			case State::arrayValueOrEnd:
+				if(c == ']')
+				{
+					data++;
+					closeContainer();
+					break;
+				}
+				_state = State::value;
+				//Falls through
+			case State::value:
+				if(c == '{')
+				{
+					_containers.emplace_back(Container{MemoryArena::makeShared<Variable>(VariableType::tStruct), std::string()});
+					_state = State::objectKeyOrEnd;
+				}
+				else if(c == '[')
+				{
+					_containers.emplace_back(Container{MemoryArena::makeShared<Variable>(VariableType::tArray), std::string()});
+					_state = State::arrayValueOrEnd;
+				}
+				else if(c == '"') startString(false);
+				else if(c == ',' || c == ':' || c == ']' || c == '}') throw JsonDecoderException(std::string("Unexpected '") + c + "', expected value.");
+				else
+				{
+					_token.clear();
+					_state = State::scalar;
+					continue; //Read the first character as part of the token.
+				}
+				data++;
+				break;
+			case State::objectKeyOrEnd:
+				if(c == '}')
+				{
+					data++;
+					closeContainer();
+					break;
+				}
+				//Falls through
+			case State::objectKey:
+				if(c != '"') throw JsonDecoderException("Object element has no name.");
+				startString(true);
+				data++;
+				break;
+			case State::colon:
+				if(c != ':') throw JsonDecoderException("Expected ':' after object element name.");
+				_state = State::value;
+				data++;
+				break;
+			case State::separator:
+			{
+				const bool isStruct = _containers.back().variable->type == VariableType::tStruct;
+				if(c == ',') _state = isStruct ? State::objectKey : State::value;
+				else if(c == (isStruct ? '}' : ']'))
+				{
+					closeContainer();
+				}
+				else throw JsonDecoderException(isStruct ? "No closing '}' found." : "No closing ']' found.");
+				data++;
+				break;
+			}
+			default:
+				break;
+		}
+	}
+	return _values.size() - valueCount;
+}
+
+size_t JsonStreamDecoder::finish()
+{
+	const size_t valueCount = _values.size();
+	if(_state == State::scalar) finishScalar();
+	if(!isIdle()) throw JsonDecoderException("Unexpected end of JSON.");
+	return _values.size() - valueCount;
+}
+
+void JsonStreamDecoder::startString(bool isKey)
+{
+	_token.clear();
+	_stringIsKey = isKey;
+	_stringHasEscapes = false;
+	_escape = false;
+	_state = State::string;
+}
+
+bool JsonStreamDecoder::readString(const char*& data, const char* end)
+{
+	const char* start = data;
+	while(data < end)
+	{
+		const char c = *data;
+		if(_escape) _escape = false;
+		else if(c == '\\')
+		{
+			_escape = true;
+			_stringHasEscapes = true;
+		}
+		else if(c == '"')
+		{
+			_token.append(start, data - start);
+			data++; //Skip the closing quote
+			return true;
+		}
+		data++;
+	}
+	_token.append(start, data - start);
+	return false;
+}
+
+void JsonStreamDecoder::finishString()
+{
+	std::string value;
+	if(_stringHasEscapes)
+	{
+		try
+		{
+			value = JsonDecoder::decodeString(_token);
+		}
+		catch(const std::range_error&)
+		{
+			//Thrown by std::wstring_convert for unpaired surrogates
+			throw JsonDecoderException("Invalid UTF-16 in JSON.");
+		}
+	}
+	else value = std::move(_token);
+	_token.clear();
+	if(_stringIsKey)
+	{
+		_containers.back().key = std::move(value);
+		_state = State::colon;
+	}
+	else
+	{
+		//Like JsonDecoder, don't use the string constructor, which also tries to interpret the string as a number.
+		auto variable = MemoryArena::makeShared<Variable>();
+		variable->type = VariableType::tString;
+		variable->stringValue = std::move(value);
+		completeValue(std::move(variable));
+	}
+}
+
+void JsonStreamDecoder::finishScalar()
+{
+	PVariable value;
+	if(_token == "true") value = MemoryArena::makeShared<Variable>(true);
+	else if(_token == "false") value = MemoryArena::makeShared<Variable>(false);
+	else if(_token == "null") value = MemoryArena::makeShared<Variable>();
+	else
+	{
+		uint64_t bytesRead = 0;
+		value = JsonDecoder::decode(_token, bytesRead);
+		if(bytesRead != _token.size() || (value->type != VariableType::tInteger && value->type != VariableType::tInteger64 && value->type != VariableType::tFloat))
+		{
+			throw JsonDecoderException("Invalid JSON value: " + _token);
+		}
+	}
+	_token.clear();
+	completeValue(std::move(value));
+}
+
+void JsonStreamDecoder::completeValue(PVariable value)
+{
+	if(_containers.empty())
+	{
+		_values.push(std::move(value));
+		_state = State::value;
+		return;
+	}
+
+	Container& container = _containers.back();
+	if(container.variable->type == VariableType::tStruct)
+	{
+		container.variable->structValue->emplace_hint(container.variable->structValue->end(), std::move(container.key), std::move(value));
+		container.key.clear();
+	}
+	else container.variable->arrayValue->push_back(std::move(value));
+	_state = State::separator;
+}
+
+void JsonStreamDecoder::closeContainer()
+{
+	PVariable value = std::move(_containers.back().variable);
+	_containers.pop_back();
+	completeValue(std::move(value));
+}
+
+}
+}
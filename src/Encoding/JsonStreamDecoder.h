@@ -0,0 +1,135 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef JSONSTREAMDECODER_H_
+#define JSONSTREAMDECODER_H_
+
+#include "../Variable.h"
+#include "JsonDecoder.h"
+
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace BaseLib
+{
+namespace Rpc
+{
+
+/**
+ * Decodes JSON while it is received. Data can be passed in chunks of any size (e. g. HTTP chunks or WebSocket fragments)
+ * and every top-level value is made available as soon as it is closed, so newline-delimited JSON streams (and any other
+ * sequence of values separated by whitespace) can be processed without waiting for the end of the stream. Only the token
+ * currently being read is buffered; arrays and objects are built while their content arrives.
+ *
+ * Values are decoded like JsonDecoder::decode() does, but the stream decoder only accepts valid JSON. Throws
+ * JsonDecoderException on invalid data. The decoder needs to be reset() after an exception.
+ */
+class JsonStreamDecoder
+{
+public:
+	JsonStreamDecoder() = default;
+	~JsonStreamDecoder() = default;
+
+	/**
+	 * Discards all state, buffered data and values not taken yet.
+	 */
+	void reset();
+
+	/**
+	 * Decodes the next bytes of the stream.
+	 *
+	 * @param data The data to decode.
+	 * @param length The number of bytes in data.
+	 * @return Returns the number of top-level values completed by this call.
+	 */
+	size_t process(const char* data, size_t length);
+
+	/**
+	 * Signals the end of the stream. A number at the end of the stream is only complete after calling this method, because
+	 * more digits could follow otherwise.
+	 *
+	 * @return Returns the number of top-level values completed by this call.
+	 */
+	size_t finish();
+
+	/**
+	 * Returns "true" when no value is partially decoded, i. e. all data passed so far belongs to values that are complete.
+	 */
+	bool isIdle() const { return _state == State::value && _containers.empty(); }
+
+	/**
+	 * Returns "true" when a completed top-level value is waiting to be taken with getValue().
+	 */
+	bool valueAvailable() const { return !_values.empty(); }
+
+	/**
+	 * Returns and removes the oldest completed top-level value or nullptr when there is none.
+	 */
+	PVariable getValue();
+private:
+	enum class State
+	{
+		value,
+		arrayValueOrEnd,
+		objectKeyOrEnd,
+		objectKey,
+		colon,
+		separator,
+		string,
+		scalar
+	};
+
+	struct Container
+	{
+		PVariable variable;
+		std::string key;
+	};
+
+	State _state = State::value;
+	std::vector<Container> _containers;
+	std::queue<PVariable> _values;
+	std::string _token;
+	bool _stringIsKey = false;
+	bool _stringHasEscapes = false;
+	bool _escape = false;
+
+	void startString(bool isKey);
+	bool readString(const char*& data, const char* end);
+	void finishString();
+	void finishScalar();
+	void completeValue(PVariable value);
+	void closeContainer();
+};
+
+}
+}
+
+#endif
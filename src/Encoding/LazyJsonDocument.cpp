@@ -0,0 +1,290 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "LazyJsonDocument.h"
+#include "JsonDecoder.h"
+#include "JsonScanner.h"
+#include "../BaseLib.h"
+
+#include <unordered_map>
+
+namespace BaseLib
+{
+namespace Rpc
+{
+
+/**
+ * State shared by a LazyJsonDocument and its LazyJsonValues. Values are identified by the index of their first entry in
+ * "indices".
+ */
+class LazyJsonData
+{
+public:
+	std::vector<uint32_t> indices;
+
+	explicit LazyJsonData(std::shared_ptr<const std::string> json) : _string(std::move(json)), _json(_string->data()), _size(_string->size()) {}
+	explicit LazyJsonData(std::shared_ptr<const std::vector<char>> json) : _vector(std::move(json)), _json(_vector->data()), _size(_vector->size()) {}
+
+	/**
+	 * Scans the document and matches the brackets of the top-level value.
+	 */
+	void index();
+
+	char at(size_t index) const { return _json[indices[index]]; }
+
+	/**
+	 * Returns the index behind the value at index without decoding it.
+	 */
+	size_t skipValue(size_t index) const;
+
+	/**
+	 * Returns the indices of all elements of an array or of the names of all members of an object.
+	 */
+	const std::vector<size_t>& getElements(size_t containerIndex);
+
+	bool nameEquals(size_t nameIndex, const std::string& name) const;
+	PVariable decode(size_t index) const;
+private:
+	//Only one of the two is set. The document is never copied.
+	std::shared_ptr<const std::string> _string;
+	std::shared_ptr<const std::vector<char>> _vector;
+	const char* _json = nullptr;
+	size_t _size = 0;
+
+	//For "{" and "[": The index of the matching closing bracket.
+	std::vector<size_t> _ends;
+
+	//Elements of all accessed containers.
+	std::unordered_map<size_t, std::vector<size_t>> _elements;
+};
+
+void LazyJsonData::index()
+{
+	if(_size > JsonScanner::maximumSize) throw JsonDecoderException("JSON is larger than 4 GiB.");
+	if(!JsonScanner::scan(_json, _size, indices)) throw JsonDecoderException("No closing '\"' found.");
+	if(indices.empty()) return;
+
+	const char first = at(0);
+	if(first == '}' || first == ']' || first == ',' || first == ':') throw JsonDecoderException(std::string("Unexpected '") + first + "'.");
+	if(first != '{' && first != '[') return;
+
+	_ends.resize(indices.size(), 0);
+	std::vector<size_t> openBrackets;
+	for(size_t i = 0; i < indices.size(); i++)
+	{
+		const char c = at(i);
+		if(c == '{' || c == '[') openBrackets.push_back(i);
+		else if(c == '}' || c == ']')
+		{
+			if(at(openBrackets.back()) != (c == '}' ? '{' : '[')) throw JsonDecoderException(std::string("Unexpected '") + c + "'.");
+			_ends[openBrackets.back()] = i;
+			openBrackets.pop_back();
+			if(openBrackets.empty()) return;
+		}
+	}
+	throw JsonDecoderException("Unexpected end of JSON.");
+}
+
+size_t LazyJsonData::skipValue(size_t index) const
+{
+	switch(at(index))
+	{
+		case '{':
+		case '[':
+			return _ends[index] + 1;
+		case '"':
+			return index + 2;
+		case '}':
+		case ']':
+		case ',':
+		case ':':
+			throw JsonDecoderException(std::string("Unexpected '") + at(index) + "'.");
+		default:
+			return index + 1;
+	}
+}
+
+const std::vector<size_t>& LazyJsonData::getElements(size_t containerIndex)
+{
+	auto elementsIterator = _elements.find(containerIndex);
+	if(elementsIterator != _elements.end()) return elementsIterator->second;
+
+	std::vector<size_t>& elements = _elements[containerIndex];
+	const bool isObject = at(containerIndex) == '{';
+	const size_t end = _ends[containerIndex];
+	size_t i = containerIndex + 1;
+	if(i == end) return elements;
+	while(true)
+	{
+		elements.push_back(i);
+		if(isObject)
+		{
+			if(at(i) != '"') throw JsonDecoderException("Object member name is no string.");
+			i += 2;
+			if(i >= end || at(i) != ':') throw JsonDecoderException("No colon found after object member name.");
+			i++;
+		}
+		if(i >= end) throw JsonDecoderException("Value missing.");
+		i = skipValue(i);
+		if(i == end) break;
+		if(at(i) != ',') throw JsonDecoderException("No comma found.");
+		i++;
+		if(i >= end) throw JsonDecoderException("Value missing.");
+	}
+	return elements;
+}
+
+bool LazyJsonData::nameEquals(size_t nameIndex, const std::string& name) const
+{
+	const char* begin = _json + indices[nameIndex] + 1;
+	const size_t length = indices[nameIndex + 1] - indices[nameIndex] - 1;
+	if(std::memchr(begin, '\\', length)) return JsonDecoder::decodeString(std::string(begin, length)) == name;
+	return length == name.size() && std::memcmp(begin, name.data(), length) == 0;
+}
+
+PVariable LazyJsonData::decode(size_t index) const
+{
+	const char c = at(index);
+	//Everything else JsonDecoder would interpret as string.
+	if(c != '{' && c != '[' && c != '"' && c != 't' && c != 'f' && c != 'n' && c != '-' && (c < '0' || c > '9')) throw JsonDecoderException(std::string("Unexpected '") + c + "'.");
+
+	//Decode in place reusing the positions of the scan.
+	uint64_t pos = indices[index];
+	PVariable value = _string ? JsonDecoder::decodeScanned(*_string, indices, pos) : JsonDecoder::decodeScanned(*_vector, indices, pos);
+	if(value) return value;
+
+	//No valid literal. JsonDecoder::decode() returns the text as string then, for the root that's the whole document.
+	if(index == 0) return _string ? JsonDecoder::decode(*_string) : JsonDecoder::decode(*_vector);
+	uint64_t end = _size;
+	if(c == '{' || c == '[') end = indices[_ends[index]] + 1;
+	else if(c == '"') end = indices[index + 1] + 1;
+	else if(index + 1 < indices.size()) end = indices[index + 1];
+	return JsonDecoder::decode(std::string(_json + indices[index], end - indices[index]));
+}
+
+VariableType LazyJsonValue::getType() const
+{
+	if(!_data) return VariableType::tVoid;
+	switch(_data->at(_index))
+	{
+		case '{':
+			return VariableType::tStruct;
+		case '[':
+			return VariableType::tArray;
+		case '"':
+			return VariableType::tString;
+		default:
+			return _data->decode(_index)->type;
+	}
+}
+
+uint32_t LazyJsonValue::size() const
+{
+	if(!_data) return 0;
+	const char c = _data->at(_index);
+	if(c != '{' && c != '[') return 0;
+	return (uint32_t)_data->getElements(_index).size();
+}
+
+LazyJsonValue LazyJsonValue::at(uint32_t index) const
+{
+	if(!_data) return LazyJsonValue();
+	const char c = _data->at(_index);
+	if(c != '{' && c != '[') return LazyJsonValue();
+	const std::vector<size_t>& elements = _data->getElements(_index);
+	if(index >= elements.size()) return LazyJsonValue();
+	//Object members start with the name, the quotes and the colon are followed by the value.
+	return LazyJsonValue(_data, c == '{' ? elements[index] + 3 : elements[index]);
+}
+
+LazyJsonValue LazyJsonValue::at(const std::string& name) const
+{
+	if(!_data || _data->at(_index) != '{') return LazyJsonValue();
+	for(size_t element : _data->getElements(_index))
+	{
+		if(_data->nameEquals(element, name)) return LazyJsonValue(_data, element + 3);
+	}
+	return LazyJsonValue();
+}
+
+LazyJsonValue LazyJsonValue::at(const std::vector<std::string>& keyPath) const
+{
+	LazyJsonValue value = *this;
+	for(auto& key : keyPath)
+	{
+		if(!value._data) break;
+		const char c = value._data->at(value._index);
+		if(c == '{') value = value.at(key);
+		else if(c == '[')
+		{
+			if(key.empty() || key.size() > 9 || key.find_first_not_of("0123456789") != std::string::npos) return LazyJsonValue();
+			value = value.at((uint32_t)std::stoul(key));
+		}
+		else return LazyJsonValue();
+	}
+	return value;
+}
+
+PVariable LazyJsonValue::decode() const
+{
+	if(!_data) return PVariable();
+	return _data->decode(_index);
+}
+
+LazyJsonDocument::LazyJsonDocument(std::string json) : LazyJsonDocument(std::make_shared<const std::string>(std::move(json)))
+{
+}
+
+LazyJsonDocument::LazyJsonDocument(const std::vector<char>& json) : LazyJsonDocument(std::make_shared<const std::vector<char>>(json))
+{
+}
+
+LazyJsonDocument::LazyJsonDocument(std::shared_ptr<const std::string> json)
+{
+	if(!json) throw JsonDecoderException("JSON is nullptr.");
+	_data = std::make_shared<LazyJsonData>(std::move(json));
+	_data->index();
+}
+
+LazyJsonDocument::LazyJsonDocument(std::shared_ptr<const std::vector<char>> json)
+{
+	if(!json) throw JsonDecoderException("JSON is nullptr.");
+	_data = std::make_shared<LazyJsonData>(std::move(json));
+	_data->index();
+}
+
+LazyJsonValue LazyJsonDocument::getRoot() const
+{
+	if(_data->indices.empty()) return LazyJsonValue();
+	return LazyJsonValue(_data, 0);
+}
+
+}
+}
@@ -0,0 +1,144 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LAZYJSONDOCUMENT_H_
+#define LAZYJSONDOCUMENT_H_
+
+#include "../Variable.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace BaseLib
+{
+namespace Rpc
+{
+
+class LazyJsonData;
+
+/**
+ * A value inside a JSON document that is only decoded when decode() is called. Array elements and object members can
+ * be accessed without decoding their siblings.
+ */
+class LazyJsonValue
+{
+public:
+	LazyJsonValue() = default;
+	LazyJsonValue(std::shared_ptr<LazyJsonData> data, size_t index) : _data(std::move(data)), _index(index) {}
+
+	/**
+	 * Returns false for values returned for nonexistent elements.
+	 */
+	bool isValid() const { return (bool)_data; }
+
+	/**
+	 * Returns the type decode() would return. "null" is tVoid.
+	 */
+	VariableType getType() const;
+
+	/**
+	 * Returns the number of array elements or object members and "0" for all other types.
+	 */
+	uint32_t size() const;
+
+	/**
+	 * Returns the array element or object member at the given index or an invalid value if there is none.
+	 */
+	LazyJsonValue at(uint32_t index) const;
+
+	/**
+	 * Returns the object member with the given name or an invalid value if there is none. When a name occurs more than
+	 * once, the first member is returned like JsonDecoder does.
+	 */
+	LazyJsonValue at(const std::string& name) const;
+
+	/**
+	 * Follows a key path like DeviceDescription::JsonPayload::keyPath. Within arrays the key is interpreted as index.
+	 *
+	 * @return Returns the value at the end of the path or an invalid value if the path does not exist.
+	 */
+	LazyJsonValue at(const std::vector<std::string>& keyPath) const;
+
+	/**
+	 * Decodes the value including all of its elements. Same result as JsonDecoder::decode() for this part of the
+	 * document. Returns nullptr for invalid values.
+	 */
+	PVariable decode() const;
+private:
+	std::shared_ptr<LazyJsonData> _data;
+	size_t _index = 0;
+};
+
+/**
+ * Read-only view of a JSON document that only decodes the values which are accessed. The document is scanned once
+ * using JsonScanner; array elements and object members are located by skipping over the recorded structure and are
+ * indexed on first access. Not thread safe.
+ *
+ * Throws JsonDecoderException on invalid JSON. Accessing elements is stricter than JsonDecoder, which for example
+ * accepts object members without value.
+ */
+class LazyJsonDocument
+{
+public:
+	/**
+	 * Scans the document. Only the first JSON value is used, everything behind it is ignored.
+	 */
+	explicit LazyJsonDocument(std::string json);
+
+	/**
+	 * Copies the buffer once. Use the shared pointer overload to avoid the copy.
+	 */
+	explicit LazyJsonDocument(const std::vector<char>& json);
+
+	/**
+	 * Keeps a reference to the buffer instead of copying it. Values are decoded in place, so the buffer must not be
+	 * modified while the document or any of its values exist.
+	 */
+	explicit LazyJsonDocument(std::shared_ptr<const std::string> json);
+	explicit LazyJsonDocument(std::shared_ptr<const std::vector<char>> json);
+	~LazyJsonDocument() = default;
+
+	/**
+	 * Returns the top-level value or an invalid value if the document is empty.
+	 */
+	LazyJsonValue getRoot() const;
+
+	/**
+	 * Same as getRoot().at(keyPath).
+	 */
+	LazyJsonValue at(const std::vector<std::string>& keyPath) const { return getRoot().at(keyPath); }
+private:
+	std::shared_ptr<LazyJsonData> _data;
+};
+
+}
+}
+#endif
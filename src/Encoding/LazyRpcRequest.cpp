@@ -0,0 +1,217 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "LazyRpcRequest.h"
+#include "../BaseLib.h"
+
+#include <unordered_map>
+
+namespace BaseLib
+{
+namespace Rpc
+{
+
+/**
+ * State shared by a LazyRpcRequest and its LazyRpcValues.
+ */
+class LazyRpcPacket
+{
+public:
+	std::shared_ptr<const std::vector<char>> packet;
+	RpcDecoder decoder;
+	BinaryDecoder binaryDecoder;
+
+	LazyRpcPacket(const std::shared_ptr<const std::vector<char>>& packet, bool ansi, bool setInteger32) : packet(packet), decoder(ansi, setInteger32), binaryDecoder(ansi) {}
+
+	/**
+	 * Returns the position of the element at index. For structs this is the position of the member name.
+	 *
+	 * @param containerPosition Unique position identifying the container.
+	 * @param firstPosition The position of the first element.
+	 */
+	uint32_t getElementPosition(uint32_t containerPosition, uint32_t firstPosition, uint32_t index, bool isStruct);
+
+	/**
+	 * Returns the position behind the value at position without decoding it.
+	 */
+	uint32_t skipValue(uint32_t position);
+
+	uint32_t skipString(uint32_t position);
+	uint32_t readCount(uint32_t& position);
+private:
+	//Element positions of all accessed containers, filled up to the highest accessed index.
+	std::unordered_map<uint32_t, std::vector<uint32_t>> _elementPositions;
+};
+
+uint32_t LazyRpcPacket::getElementPosition(uint32_t containerPosition, uint32_t firstPosition, uint32_t index, bool isStruct)
+{
+	std::vector<uint32_t>& positions = _elementPositions[containerPosition];
+	if(positions.empty()) positions.push_back(firstPosition);
+	while(positions.size() <= index)
+	{
+		uint32_t position = positions.back();
+		if(isStruct) position = skipString(position);
+		positions.push_back(skipValue(position));
+	}
+	return positions.at(index);
+}
+
+uint32_t LazyRpcPacket::skipString(uint32_t position)
+{
+	int32_t length = BinaryDecoder::decodeInteger(*packet, position);
+	if(length < 0 || position + (uint64_t)length > packet->size()) throw RpcDecoderException("Unexpected end of data.");
+	return position + length;
+}
+
+uint32_t LazyRpcPacket::readCount(uint32_t& position)
+{
+	int32_t count = BinaryDecoder::decodeInteger(*packet, position);
+	//Every element needs at least 4 bytes
+	if(count < 0 || position + (uint64_t)count * 4 > packet->size()) throw RpcDecoderException("Invalid element count.");
+	return (uint32_t)count;
+}
+
+uint32_t LazyRpcPacket::skipValue(uint32_t position)
+{
+	//Iterative, so deeply nested packets can't exhaust the stack
+	std::vector<std::pair<uint32_t, bool>> containers; //Remaining elements and "is struct"
+	while(true)
+	{
+		auto type = (VariableType)BinaryDecoder::decodeInteger(*packet, position);
+		if(type == VariableType::tInteger) position += 4;
+		else if(type == VariableType::tInteger64 || type == VariableType::tFloat) position += 8;
+		else if(type == VariableType::tBoolean) position += 1;
+		else if(type == VariableType::tString || type == VariableType::tBase64 || type == VariableType::tBinary) position = skipString(position);
+		else if(type == VariableType::tArray || type == VariableType::tStruct)
+		{
+			uint32_t count = readCount(position);
+			if(count > 0)
+			{
+				containers.emplace_back(count, type == VariableType::tStruct);
+				if(type == VariableType::tStruct) position = skipString(position);
+				continue;
+			}
+		}
+		if(position > packet->size()) throw RpcDecoderException("Unexpected end of data.");
+
+		while(!containers.empty())
+		{
+			auto& container = containers.back();
+			container.first--;
+			if(container.first > 0)
+			{
+				if(container.second) position = skipString(position);
+				break;
+			}
+			containers.pop_back();
+		}
+		if(containers.empty()) return position;
+	}
+}
+
+VariableType LazyRpcValue::getType() const
+{
+	if(!_packet) return VariableType::tVoid;
+	uint32_t position = _position;
+	return (VariableType)BinaryDecoder::decodeInteger(*_packet->packet, position);
+}
+
+uint32_t LazyRpcValue::size() const
+{
+	VariableType type = getType();
+	if(type != VariableType::tArray && type != VariableType::tStruct) return 0;
+	uint32_t position = _position + 4;
+	return _packet->readCount(position);
+}
+
+LazyRpcValue LazyRpcValue::at(uint32_t index) const
+{
+	if(index >= size()) return LazyRpcValue();
+	bool isStruct = getType() == VariableType::tStruct;
+	uint32_t position = _packet->getElementPosition(_position, _position + 8, index, isStruct);
+	if(isStruct) position = _packet->skipString(position);
+	return LazyRpcValue(_packet, position);
+}
+
+LazyRpcValue LazyRpcValue::at(const std::string& name) const
+{
+	if(getType() != VariableType::tStruct) return LazyRpcValue();
+	uint32_t count = size();
+	for(uint32_t i = 0; i < count; i++)
+	{
+		uint32_t position = _packet->getElementPosition(_position, _position + 8, i, true);
+		std::string memberName = _packet->binaryDecoder.decodeString(*_packet->packet, position);
+		if(memberName == name) return LazyRpcValue(_packet, position);
+	}
+	return LazyRpcValue();
+}
+
+PVariable LazyRpcValue::decode() const
+{
+	if(!_packet) return PVariable();
+	uint32_t position = _position;
+	return _packet->decoder.decodeValue(_packet->packet, position);
+}
+
+LazyRpcRequest::LazyRpcRequest(const std::shared_ptr<const std::vector<char>>& packet, bool ansi, bool setInteger32)
+{
+	if(!packet || packet->size() < 8) throw RpcDecoderException("Invalid packet.");
+	_packet = std::make_shared<LazyRpcPacket>(packet, ansi, setInteger32);
+	uint32_t position = 4;
+	uint32_t headerSize = 0;
+	if(packet->at(3) == 0x40 || packet->at(3) == 0x41) headerSize = BinaryDecoder::decodeInteger(*packet, position) + 4;
+	position = 8 + headerSize;
+	_methodName = _packet->binaryDecoder.decodeString(*packet, position);
+	_parameterCountPosition = position;
+	int32_t parameterCount = BinaryDecoder::decodeInteger(*packet, position);
+	if(parameterCount < 0) throw RpcDecoderException("Invalid parameter count.");
+	if(parameterCount > 100) throw RpcDecoderException("Parameter count of RPC request is larger than 100.");
+	_parameterCount = parameterCount;
+}
+
+LazyRpcValue LazyRpcRequest::getParameter(uint32_t index) const
+{
+	if(index >= _parameterCount) return LazyRpcValue();
+	return LazyRpcValue(_packet, _packet->getElementPosition(_parameterCountPosition, _parameterCountPosition + 4, index, false));
+}
+
+PArray LazyRpcRequest::decodeParameters() const
+{
+	PArray parameters = std::make_shared<Array>();
+	parameters->reserve(_parameterCount);
+	for(uint32_t i = 0; i < _parameterCount; i++)
+	{
+		parameters->push_back(getParameter(i).decode());
+	}
+	return parameters;
+}
+
+}
+}
@@ -0,0 +1,130 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LAZYRPCREQUEST_H_
+#define LAZYRPCREQUEST_H_
+
+#include "../Variable.h"
+#include "RpcDecoder.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace BaseLib
+{
+namespace Rpc
+{
+
+class LazyRpcPacket;
+
+/**
+ * A value inside a binary RPC packet that is only decoded when decode() is called. Array elements and struct members
+ * can be accessed without decoding their siblings.
+ */
+class LazyRpcValue
+{
+public:
+	LazyRpcValue() = default;
+	LazyRpcValue(std::shared_ptr<LazyRpcPacket> packet, uint32_t position) : _packet(std::move(packet)), _position(position) {}
+
+	/**
+	 * Returns false for values returned for nonexistent elements.
+	 */
+	bool isValid() const { return (bool)_packet; }
+
+	VariableType getType() const;
+
+	/**
+	 * Returns the number of array elements or struct members and "0" for all other types.
+	 */
+	uint32_t size() const;
+
+	/**
+	 * Returns the array element or struct member at the given index or an invalid value if there is none.
+	 */
+	LazyRpcValue at(uint32_t index) const;
+
+	/**
+	 * Returns the struct member with the given name or an invalid value if there is none.
+	 */
+	LazyRpcValue at(const std::string& name) const;
+
+	/**
+	 * Decodes the value including all of its elements. Returns nullptr for invalid values.
+	 */
+	PVariable decode() const;
+private:
+	std::shared_ptr<LazyRpcPacket> _packet;
+	uint32_t _position = 0;
+};
+
+/**
+ * Binary RPC request that only decodes the parameters which are accessed. Offsets of array elements and struct members
+ * are indexed on first access, so e. g. the peer ID and channel of a putParamset request can be read without decoding
+ * the paramset. Not thread safe.
+ *
+ * Throws RpcDecoderException or BinaryDecoderException on invalid data.
+ */
+class LazyRpcRequest
+{
+public:
+	/**
+	 * Reads the method name and the parameter count.
+	 *
+	 * @param packet The complete packet as returned by BinaryRpc::takeData(). Must not be modified afterwards.
+	 * @param ansi Set to "true" to convert strings from ANSI to UTF-8.
+	 * @param setInteger32 Set to "true" to decode 64 bit integers fitting into 32 bits as tInteger.
+	 */
+	explicit LazyRpcRequest(const std::shared_ptr<const std::vector<char>>& packet, bool ansi = false, bool setInteger32 = true);
+	~LazyRpcRequest() = default;
+
+	const std::string& getMethodName() const { return _methodName; }
+	uint32_t getParameterCount() const { return _parameterCount; }
+
+	/**
+	 * Returns the parameter at the given index or an invalid value if there is none.
+	 */
+	LazyRpcValue getParameter(uint32_t index) const;
+
+	/**
+	 * Decodes all parameters. Same result as RpcDecoder::decodeRequest().
+	 */
+	PArray decodeParameters() const;
+private:
+	std::shared_ptr<LazyRpcPacket> _packet;
+	std::string _methodName;
+	uint32_t _parameterCount = 0;
+	uint32_t _parameterCountPosition = 0;
+};
+
+}
+}
+#endif
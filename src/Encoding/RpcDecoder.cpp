@@ -36,11 +36,32 @@ namespace BaseLib
 namespace Rpc
 {
 
+namespace
+{
+
+/**
+ * Same as Math::getNumber64() on the content of the view. Only the leading number, which std::stoll parses, is copied.
+ */
+int64_t getNumber64(const BufferView& view)
+{
+    const char* data = (const char*)view.data();
+    const char* end = data + view.size();
+    bool isHex = std::memchr(data, 'x', view.size()) != nullptr;
+    const char* numberEnd = data;
+    while(numberEnd != end && std::isspace((unsigned char)*numberEnd)) numberEnd++;
+    if(numberEnd != end && (*numberEnd == '-' || *numberEnd == '+')) numberEnd++;
+    if(isHex && end - numberEnd >= 2 && numberEnd[0] == '0' && (numberEnd[1] == 'x' || numberEnd[1] == 'X')) numberEnd += 2;
+    while(numberEnd != end && (isHex ? std::isxdigit((unsigned char)*numberEnd) : std::isdigit((unsigned char)*numberEnd))) numberEnd++;
+    return Math::getNumber64(std::string(data, numberEnd), isHex);
+}
+
+}
+
 RpcDecoder::RpcDecoder() : RpcDecoder(false)
 {
 }
 
-RpcDecoder::RpcDecoder(bool ansi, bool setInteger32) : _setInteger32(setInteger32)
+RpcDecoder::RpcDecoder(bool ansi, bool setInteger32) : _ansi(ansi), _setInteger32(setInteger32)
 {
     _decoder = std::unique_ptr<BinaryDecoder>(new BinaryDecoder(ansi));
 }
@@ -93,6 +114,17 @@ std::shared_ptr<RpcHeader> RpcDecoder::decodeHeader(const std::vector<uint8_t>&
 }
 
 std::shared_ptr<std::vector<std::shared_ptr<Variable>>> RpcDecoder::decodeRequest(const std::vector<char>& packet, std::string& methodName)
+{
+    return decodeRequest(packet, methodName, std::shared_ptr<const void>());
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<Variable>>> RpcDecoder::decodeRequest(const std::shared_ptr<const std::vector<char>>& packet, std::string& methodName)
+{
+    if(!packet) throw RpcDecoderException("Packet is nullptr.");
+    return decodeRequest(*packet, methodName, _minimumViewSize > 0 ? std::shared_ptr<const void>(packet) : std::shared_ptr<const void>());
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<Variable>>> RpcDecoder::decodeRequest(const std::vector<char>& packet, std::string& methodName, const std::shared_ptr<const void>& viewOwner)
 {
     uint32_t position = 4;
     uint32_t headerSize = 0;
@@ -104,12 +136,23 @@ std::shared_ptr<std::vector<std::shared_ptr<Variable>>> RpcDecoder::decodeReques
     if(parameterCount > 100) throw RpcDecoderException("Parameter count of RPC request is larger than 100.");
     for(uint32_t i = 0; i < parameterCount; i++)
     {
-        parameters->push_back(decodeParameter(packet, position));
+        parameters->push_back(decodeParameter(packet, position, viewOwner));
     }
     return parameters;
 }
 
 std::shared_ptr<std::vector<std::shared_ptr<Variable>>> RpcDecoder::decodeRequest(const std::vector<uint8_t>& packet, std::string& methodName)
+{
+    return decodeRequest(packet, methodName, std::shared_ptr<const void>());
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<Variable>>> RpcDecoder::decodeRequest(const std::shared_ptr<const std::vector<uint8_t>>& packet, std::string& methodName)
+{
+    if(!packet) throw RpcDecoderException("Packet is nullptr.");
+    return decodeRequest(*packet, methodName, _minimumViewSize > 0 ? std::shared_ptr<const void>(packet) : std::shared_ptr<const void>());
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<Variable>>> RpcDecoder::decodeRequest(const std::vector<uint8_t>& packet, std::string& methodName, const std::shared_ptr<const void>& viewOwner)
 {
     uint32_t position = 4;
     uint32_t headerSize = 0;
@@ -121,16 +164,28 @@ std::shared_ptr<std::vector<std::shared_ptr<Variable>>> RpcDecoder::decodeReques
     if(parameterCount > 100) throw RpcDecoderException("Parameter count of RPC request is larger than 100.");
     for(uint32_t i = 0; i < parameterCount; i++)
     {
-        parameters->push_back(decodeParameter(packet, position));
+        parameters->push_back(decodeParameter(packet, position, viewOwner));
     }
     return parameters;
 }
 
 std::shared_ptr<Variable> RpcDecoder::decodeResponse(const std::vector<char>& packet, uint32_t offset)
+{
+    return decodeResponse(packet, offset, std::shared_ptr<const void>());
+}
+
+std::shared_ptr<Variable> RpcDecoder::decodeResponse(const std::shared_ptr<const std::vector<char>>& packet, uint32_t offset)
+{
+    if(!packet) throw RpcDecoderException("Packet is nullptr.");
+    return decodeResponse(*packet, offset, _minimumViewSize > 0 ? std::shared_ptr<const void>(packet) : std::shared_ptr<const void>());
+}
+
+std::shared_ptr<Variable> RpcDecoder::decodeResponse(const std::vector<char>& packet, uint32_t offset, const std::shared_ptr<const void>& viewOwner)
 {
     uint32_t position = offset + 8;
-    std::shared_ptr<Variable> response = decodeParameter(packet, position);
-    if(packet.size() < 4) throw RpcDecoderException("Invalid packet."); //response is Void when packet is empty.
+    if(packet.size() >= 4 && position >= packet.size()) return std::make_shared<Variable>(); //response is Void when packet is empty.
+    std::shared_ptr<Variable> response = decodeParameter(packet, position, viewOwner);
+    if(packet.size() < 4) throw RpcDecoderException("Invalid packet.");
     if(packet.at(3) == 0xFF)
     {
         response->errorStruct = true;
@@ -141,10 +196,22 @@ std::shared_ptr<Variable> RpcDecoder::decodeResponse(const std::vector<char>& pa
 }
 
 std::shared_ptr<Variable> RpcDecoder::decodeResponse(const std::vector<uint8_t>& packet, uint32_t offset)
+{
+    return decodeResponse(packet, offset, std::shared_ptr<const void>());
+}
+
+std::shared_ptr<Variable> RpcDecoder::decodeResponse(const std::shared_ptr<const std::vector<uint8_t>>& packet, uint32_t offset)
+{
+    if(!packet) throw RpcDecoderException("Packet is nullptr.");
+    return decodeResponse(*packet, offset, _minimumViewSize > 0 ? std::shared_ptr<const void>(packet) : std::shared_ptr<const void>());
+}
+
+std::shared_ptr<Variable> RpcDecoder::decodeResponse(const std::vector<uint8_t>& packet, uint32_t offset, const std::shared_ptr<const void>& viewOwner)
 {
     uint32_t position = offset + 8;
-    std::shared_ptr<Variable> response = decodeParameter(packet, position);
-    if(packet.size() < 4) throw RpcDecoderException("Invalid packet."); //response is Void when packet is empty.
+    if(packet.size() >= 4 && position >= packet.size()) return std::make_shared<Variable>(); //response is Void when packet is empty.
+    std::shared_ptr<Variable> response = decodeParameter(packet, position, viewOwner);
+    if(packet.size() < 4) throw RpcDecoderException("Invalid packet.");
     if(packet.at(3) == 0xFF)
     {
         response->errorStruct = true;
@@ -154,6 +221,34 @@ std::shared_ptr<Variable> RpcDecoder::decodeResponse(const std::vector<uint8_t>&
     return response;
 }
 
+std::shared_ptr<Variable> RpcDecoder::decodeValue(const std::vector<char>& packet, uint32_t& position)
+{
+    return decodeParameter(packet, position, std::shared_ptr<const void>());
+}
+
+std::shared_ptr<Variable> RpcDecoder::decodeValue(const std::vector<uint8_t>& packet, uint32_t& position)
+{
+    return decodeParameter(packet, position, std::shared_ptr<const void>());
+}
+
+std::shared_ptr<Variable> RpcDecoder::decodeValue(const std::shared_ptr<const std::vector<char>>& packet, uint32_t& position)
+{
+    if(!packet) throw RpcDecoderException("Packet is nullptr.");
+    return decodeParameter(*packet, position, _minimumViewSize > 0 ? std::shared_ptr<const void>(packet) : std::shared_ptr<const void>());
+}
+
+bool RpcDecoder::useView(const std::vector<char>& packet, uint32_t position, const std::shared_ptr<const void>& viewOwner)
+{
+    if(!viewOwner) return false;
+    return (uint32_t)_decoder->decodeInteger(packet, position) >= _minimumViewSize;
+}
+
+bool RpcDecoder::useView(const std::vector<uint8_t>& packet, uint32_t position, const std::shared_ptr<const void>& viewOwner)
+{
+    if(!viewOwner) return false;
+    return (uint32_t)_decoder->decodeInteger(packet, position) >= _minimumViewSize;
+}
+
 VariableType RpcDecoder::decodeType(const std::vector<char>& packet, uint32_t& position)
 {
     return (VariableType)_decoder->decodeInteger(packet, position);
@@ -164,14 +259,22 @@ VariableType RpcDecoder::decodeType(const std::vector<uint8_t>& packet, uint32_t
     return (VariableType)_decoder->decodeInteger(packet, position);
 }
 
-std::shared_ptr<Variable> RpcDecoder::decodeParameter(const std::vector<char>& packet, uint32_t& position)
+std::shared_ptr<Variable> RpcDecoder::decodeParameter(const std::vector<char>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner)
 {
     VariableType type = decodeType(packet, position);
-    std::shared_ptr<Variable> variable = std::make_shared<Variable>(type);
+    std::shared_ptr<Variable> variable = MemoryArena::makeShared<Variable>(type);
     if(type == VariableType::tVoid)
     {
         //Nothing
     }
+    else if((type == VariableType::tString || type == VariableType::tBase64) && !_ansi && useView(packet, position, viewOwner))
+    {
+        variable->dataView = _decoder->decodeBinaryView(packet, position, viewOwner);
+        const BufferView& view = variable->dataView;
+        variable->integerValue64 = getNumber64(view);
+        variable->integerValue = (int32_t)variable->integerValue64;
+        variable->booleanValue = !view.empty() && !(view.size() == 1 && (view.data()[0] == '0' || view.data()[0] == 'f')) && !(view.size() == 5 && std::memcmp(view.data(), "false", 5) == 0);
+    }
     else if(type == VariableType::tString || type == VariableType::tBase64)
     {
         variable->stringValue = _decoder->decodeString(packet, position);
@@ -208,17 +311,21 @@ std::shared_ptr<Variable> RpcDecoder::decodeParameter(const std::vector<char>& p
         variable->integerValue = (int32_t)variable->booleanValue;
         variable->integerValue64 = (int64_t)variable->booleanValue;
     }
+    else if(type == VariableType::tBinary && useView(packet, position, viewOwner))
+    {
+        variable->dataView = _decoder->decodeBinaryView(packet, position, viewOwner);
+    }
     else if(type == VariableType::tBinary)
     {
         variable->binaryValue = _decoder->decodeBinary(packet, position);
     }
     else if(type == VariableType::tArray)
     {
-        variable->arrayValue = decodeArray(packet, position);
+        variable->arrayValue = decodeArray(packet, position, viewOwner);
     }
     else if(type == VariableType::tStruct)
     {
-        variable->structValue = decodeStruct(packet, position);
+        variable->structValue = decodeStruct(packet, position, viewOwner);
         if(variable->structValue->size() == 2 && variable->structValue->find("faultCode") != variable->structValue->end() && variable->structValue->find("faultString") != variable->structValue->end())
         {
             variable->errorStruct = true;
@@ -227,14 +334,22 @@ std::shared_ptr<Variable> RpcDecoder::decodeParameter(const std::vector<char>& p
     return variable;
 }
 
-std::shared_ptr<Variable> RpcDecoder::decodeParameter(const std::vector<uint8_t>& packet, uint32_t& position)
+std::shared_ptr<Variable> RpcDecoder::decodeParameter(const std::vector<uint8_t>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner)
 {
     VariableType type = decodeType(packet, position);
-    std::shared_ptr<Variable> variable = std::make_shared<Variable>(type);
+    std::shared_ptr<Variable> variable = MemoryArena::makeShared<Variable>(type);
     if(type == VariableType::tVoid)
     {
         //Nothing
     }
+    else if((type == VariableType::tString || type == VariableType::tBase64) && !_ansi && useView(packet, position, viewOwner))
+    {
+        variable->dataView = _decoder->decodeBinaryView(packet, position, viewOwner);
+        const BufferView& view = variable->dataView;
+        variable->integerValue64 = getNumber64(view);
+        variable->integerValue = (int32_t)variable->integerValue64;
+        variable->booleanValue = !view.empty() && !(view.size() == 1 && (view.data()[0] == '0' || view.data()[0] == 'f')) && !(view.size() == 5 && std::memcmp(view.data(), "false", 5) == 0);
+    }
     else if(type == VariableType::tString || type == VariableType::tBase64)
     {
         variable->stringValue = _decoder->decodeString(packet, position);
@@ -271,17 +386,21 @@ std::shared_ptr<Variable> RpcDecoder::decodeParameter(const std::vector<uint8_t>
         variable->integerValue = (int32_t)variable->booleanValue;
         variable->integerValue64 = (int64_t)variable->booleanValue;
     }
+    else if(type == VariableType::tBinary && useView(packet, position, viewOwner))
+    {
+        variable->dataView = _decoder->decodeBinaryView(packet, position, viewOwner);
+    }
     else if(type == VariableType::tBinary)
     {
         variable->binaryValue = _decoder->decodeBinary(packet, position);
     }
     else if(type == VariableType::tArray)
     {
-        variable->arrayValue = decodeArray(packet, position);
+        variable->arrayValue = decodeArray(packet, position, viewOwner);
     }
     else if(type == VariableType::tStruct)
     {
-        variable->structValue = decodeStruct(packet, position);
+        variable->structValue = decodeStruct(packet, position, viewOwner);
         if(variable->structValue->size() == 2 && variable->structValue->find("faultCode") != variable->structValue->end() && variable->structValue->find("faultString") != variable->structValue->end())
         {
             variable->errorStruct = true;
@@ -290,48 +409,50 @@ std::shared_ptr<Variable> RpcDecoder::decodeParameter(const std::vector<uint8_t>
     return variable;
 }
 
-PArray RpcDecoder::decodeArray(const std::vector<char>& packet, uint32_t& position)
+PArray RpcDecoder::decodeArray(const std::vector<char>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner)
 {
     uint32_t arrayLength = _decoder->decodeInteger(packet, position);
-    PArray array = std::make_shared<Array>();
+    PArray array = MemoryArena::makeShared<Array>();
     for(uint32_t i = 0; i < arrayLength; i++)
     {
-        array->push_back(decodeParameter(packet, position));
+        array->push_back(decodeParameter(packet, position, viewOwner));
     }
     return array;
 }
 
-PArray RpcDecoder::decodeArray(const std::vector<uint8_t>& packet, uint32_t& position)
+PArray RpcDecoder::decodeArray(const std::vector<uint8_t>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner)
 {
     uint32_t arrayLength = _decoder->decodeInteger(packet, position);
-    PArray array = std::make_shared<Array>();
+    PArray array = MemoryArena::makeShared<Array>();
     for(uint32_t i = 0; i < arrayLength; i++)
     {
-        array->push_back(decodeParameter(packet, position));
+        array->push_back(decodeParameter(packet, position, viewOwner));
     }
     return array;
 }
 
-PStruct RpcDecoder::decodeStruct(const std::vector<char>& packet, uint32_t& position)
+PStruct RpcDecoder::decodeStruct(const std::vector<char>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner)
 {
     uint32_t structLength = _decoder->decodeInteger(packet, position);
-    PStruct rpcStruct = std::make_shared<Struct>();
+    PStruct rpcStruct = MemoryArena::makeShared<Struct>();
     for(uint32_t i = 0; i < structLength; i++)
     {
         std::string name = _decoder->decodeString(packet, position);
-        rpcStruct->insert(StructElement(name, decodeParameter(packet, position)));
+        //Encoders write struct members in key order, so inserting at the end is amortized constant time.
+        rpcStruct->emplace_hint(rpcStruct->end(), std::move(name), decodeParameter(packet, position, viewOwner));
     }
     return rpcStruct;
 }
 
-PStruct RpcDecoder::decodeStruct(const std::vector<uint8_t>& packet, uint32_t& position)
+PStruct RpcDecoder::decodeStruct(const std::vector<uint8_t>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner)
 {
     uint32_t structLength = _decoder->decodeInteger(packet, position);
-    PStruct rpcStruct = std::make_shared<Struct>();
+    PStruct rpcStruct = MemoryArena::makeShared<Struct>();
     for(uint32_t i = 0; i < structLength; i++)
     {
         std::string name = _decoder->decodeString(packet, position);
-        rpcStruct->insert(StructElement(name, decodeParameter(packet, position)));
+        //Encoders write struct members in key order, so inserting at the end is amortized constant time.
+        rpcStruct->emplace_hint(rpcStruct->end(), std::move(name), decodeParameter(packet, position, viewOwner));
     }
     return rpcStruct;
 }
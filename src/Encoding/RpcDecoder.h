@@ -78,19 +78,58 @@ public:
 	std::shared_ptr<std::vector<std::shared_ptr<Variable>>> decodeRequest(const std::vector<uint8_t>& packet, std::string& methodName);
 	std::shared_ptr<Variable> decodeResponse(const std::vector<char>& packet, uint32_t offset = 0);
 	std::shared_ptr<Variable> decodeResponse(const std::vector<uint8_t>& packet, uint32_t offset = 0);
+
+	/**
+	 * Same as the overloads above, but strings and binaries with a length of at least the minimum view size (see
+	 * setMinimumViewSize()) are not copied. Instead Variable::dataView references the packet, which is kept alive by the
+	 * returned variables. The packet must not be modified afterwards.
+	 */
+	std::shared_ptr<std::vector<std::shared_ptr<Variable>>> decodeRequest(const std::shared_ptr<const std::vector<char>>& packet, std::string& methodName);
+	std::shared_ptr<std::vector<std::shared_ptr<Variable>>> decodeRequest(const std::shared_ptr<const std::vector<uint8_t>>& packet, std::string& methodName);
+	std::shared_ptr<Variable> decodeResponse(const std::shared_ptr<const std::vector<char>>& packet, uint32_t offset = 0);
+	std::shared_ptr<Variable> decodeResponse(const std::shared_ptr<const std::vector<uint8_t>>& packet, uint32_t offset = 0);
+
+	/**
+	 * Decodes a single value, e. g. one element of an array.
+	 *
+	 * @param packet The packet.
+	 * @param position The position of the value's type field. Will point behind the value on return.
+	 * @return Returns the decoded value.
+	 */
+	std::shared_ptr<Variable> decodeValue(const std::vector<char>& packet, uint32_t& position);
+	std::shared_ptr<Variable> decodeValue(const std::vector<uint8_t>& packet, uint32_t& position);
+	std::shared_ptr<Variable> decodeValue(const std::shared_ptr<const std::vector<char>>& packet, uint32_t& position);
+
+	/**
+	 * Sets the minimum length of strings and binaries to reference in the packet instead of copying them. Short values
+	 * are cheaper to copy. Only used by the overloads taking shared packets and never for strings when ANSI conversion
+	 * is enabled.
+	 *
+	 * @param value The minimum size in bytes. "0" disables views (the default).
+	 */
+	void setMinimumViewSize(uint32_t value) { _minimumViewSize = value; }
+	uint32_t getMinimumViewSize() { return _minimumViewSize; }
 private:
 	bool _ansi = false;
 	std::unique_ptr<BinaryDecoder> _decoder;
 	bool _setInteger32 = true;
+	uint32_t _minimumViewSize = 0;
+
+	std::shared_ptr<std::vector<std::shared_ptr<Variable>>> decodeRequest(const std::vector<char>& packet, std::string& methodName, const std::shared_ptr<const void>& viewOwner);
+	std::shared_ptr<std::vector<std::shared_ptr<Variable>>> decodeRequest(const std::vector<uint8_t>& packet, std::string& methodName, const std::shared_ptr<const void>& viewOwner);
+	std::shared_ptr<Variable> decodeResponse(const std::vector<char>& packet, uint32_t offset, const std::shared_ptr<const void>& viewOwner);
+	std::shared_ptr<Variable> decodeResponse(const std::vector<uint8_t>& packet, uint32_t offset, const std::shared_ptr<const void>& viewOwner);
 
-	std::shared_ptr<Variable> decodeParameter(const std::vector<char>& packet, uint32_t& position);
-	std::shared_ptr<Variable> decodeParameter(const std::vector<uint8_t>& packet, uint32_t& position);
+	std::shared_ptr<Variable> decodeParameter(const std::vector<char>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner);
+	std::shared_ptr<Variable> decodeParameter(const std::vector<uint8_t>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner);
 	VariableType decodeType(const std::vector<char>& packet, uint32_t& position);
 	VariableType decodeType(const std::vector<uint8_t>& packet, uint32_t& position);
-	std::shared_ptr<Array> decodeArray(const std::vector<char>& packet, uint32_t& position);
-	std::shared_ptr<Array> decodeArray(const std::vector<uint8_t>& packet, uint32_t& position);
-	std::shared_ptr<Struct> decodeStruct(const std::vector<char>& packet, uint32_t& position);
-	std::shared_ptr<Struct> decodeStruct(const std::vector<uint8_t>& packet, uint32_t& position);
+	std::shared_ptr<Array> decodeArray(const std::vector<char>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner);
+	std::shared_ptr<Array> decodeArray(const std::vector<uint8_t>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner);
+	std::shared_ptr<Struct> decodeStruct(const std::vector<char>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner);
+	std::shared_ptr<Struct> decodeStruct(const std::vector<uint8_t>& packet, uint32_t& position, const std::shared_ptr<const void>& viewOwner);
+	bool useView(const std::vector<char>& packet, uint32_t position, const std::shared_ptr<const void>& viewOwner);
+	bool useView(const std::vector<uint8_t>& packet, uint32_t position, const std::shared_ptr<const void>& viewOwner);
 };
 }
 }
@@ -64,15 +64,25 @@ RpcEncoder::RpcEncoder(BaseLib::SharedObjects* baseLib, bool forceInteger64, boo
 void RpcEncoder::encodeRequest(const std::string& methodName, const std::shared_ptr<std::list<std::shared_ptr<Variable>>>& parameters, std::vector<char>& encodedData, const std::shared_ptr<RpcHeader>& header)
 {
 	//The "Bin", the type byte after that and the length itself are not part of the length
+    uint32_t headerSize = header ? getHeaderSize(*header) : 0;
+    size_t dataSize = 4 + methodName.size() + 4;
+    if(parameters)
+    {
+        for(auto& parameter : *parameters)
+        {
+            dataSize += getEncodedSize(parameter);
+        }
+    }
+
     encodedData.clear();
-    encodedData.reserve(1024);
-    encodedData.insert(encodedData.begin(), _packetStartRequest, _packetStartRequest + 4);
-    uint32_t headerSize = 0;
-    if(header)
+    encodedData.reserve(4 + headerSize + 4 + dataSize);
+    encodedData.insert(encodedData.end(), _packetStartRequest, _packetStartRequest + 4);
+    if(headerSize > 0)
     {
-        headerSize = encodeHeader(encodedData, *header) + 4;
-        if(headerSize > 0) encodedData.at(3) |= 0x40;
+        encodedData.at(3) |= 0x40;
+        encodeHeader(encodedData, *header);
     }
+    BinaryEncoder::encodeInteger(encodedData, (int32_t)dataSize);
     BinaryEncoder::encodeString(encodedData, methodName);
     if(!parameters) BinaryEncoder::encodeInteger(encodedData, 0);
     else BinaryEncoder::encodeInteger(encodedData, parameters->size());
@@ -83,25 +93,30 @@ void RpcEncoder::encodeRequest(const std::string& methodName, const std::shared_
             encodeVariable(encodedData, parameter);
         }
     }
-
-    uint32_t dataSize = encodedData.size() - 4 - headerSize;
-    char result[4];
-    HelperFunctions::memcpyBigEndian(result, (char*)&dataSize, 4);
-    encodedData.insert(encodedData.begin() + 4 + headerSize, result, result + 4);
 }
 
 void RpcEncoder::encodeRequest(const std::string& methodName, const std::shared_ptr<std::list<std::shared_ptr<Variable>>>& parameters, std::vector<uint8_t>& encodedData, const std::shared_ptr<RpcHeader>& header)
 {
 	//The "Bin", the type byte after that and the length itself are not part of the length
+    uint32_t headerSize = header ? getHeaderSize(*header) : 0;
+    size_t dataSize = 4 + methodName.size() + 4;
+    if(parameters)
+    {
+        for(auto& parameter : *parameters)
+        {
+            dataSize += getEncodedSize(parameter);
+        }
+    }
+
     encodedData.clear();
-    encodedData.reserve(1024);
-    encodedData.insert(encodedData.begin(), _packetStartRequest, _packetStartRequest + 4);
-    uint32_t headerSize = 0;
-    if(header)
+    encodedData.reserve(4 + headerSize + 4 + dataSize);
+    encodedData.insert(encodedData.end(), _packetStartRequest, _packetStartRequest + 4);
+    if(headerSize > 0)
     {
-        headerSize = encodeHeader(encodedData, *header) + 4;
-        if(headerSize > 0) encodedData.at(3) |= 0x40;
+        encodedData.at(3) |= 0x40;
+        encodeHeader(encodedData, *header);
     }
+    BinaryEncoder::encodeInteger(encodedData, (int32_t)dataSize);
     BinaryEncoder::encodeString(encodedData, methodName);
     if(!parameters) BinaryEncoder::encodeInteger(encodedData, 0);
     else BinaryEncoder::encodeInteger(encodedData, parameters->size());
@@ -112,25 +127,30 @@ void RpcEncoder::encodeRequest(const std::string& methodName, const std::shared_
             encodeVariable(encodedData, parameter);
         }
     }
-
-    uint32_t dataSize = encodedData.size() - 4 - headerSize;
-    char result[4];
-    HelperFunctions::memcpyBigEndian(result, (char*)&dataSize, 4);
-    encodedData.insert(encodedData.begin() + 4 + headerSize, result, result + 4);
 }
 
 void RpcEncoder::encodeRequest(const std::string& methodName, const PArray& parameters, std::vector<char>& encodedData, const std::shared_ptr<RpcHeader>& header)
 {
 	//The "Bin", the type byte after that and the length itself are not part of the length
+    uint32_t headerSize = header ? getHeaderSize(*header) : 0;
+    size_t dataSize = 4 + methodName.size() + 4;
+    if(parameters)
+    {
+        for(auto& parameter : *parameters)
+        {
+            dataSize += getEncodedSize(parameter);
+        }
+    }
+
     encodedData.clear();
-    encodedData.reserve(1024);
-    encodedData.insert(encodedData.begin(), _packetStartRequest, _packetStartRequest + 4);
-    uint32_t headerSize = 0;
-    if(header)
+    encodedData.reserve(4 + headerSize + 4 + dataSize);
+    encodedData.insert(encodedData.end(), _packetStartRequest, _packetStartRequest + 4);
+    if(headerSize > 0)
     {
-        headerSize = encodeHeader(encodedData, *header) + 4;
-        if(headerSize > 0) encodedData.at(3) |= 0x40;
+        encodedData.at(3) |= 0x40;
+        encodeHeader(encodedData, *header);
     }
+    BinaryEncoder::encodeInteger(encodedData, (int32_t)dataSize);
     BinaryEncoder::encodeString(encodedData, methodName);
     if(!parameters) BinaryEncoder::encodeInteger(encodedData, 0);
     else BinaryEncoder::encodeInteger(encodedData, parameters->size());
@@ -141,25 +161,30 @@ void RpcEncoder::encodeRequest(const std::string& methodName, const PArray& para
             encodeVariable(encodedData, parameter);
         }
     }
-
-    uint32_t dataSize = encodedData.size() - 4 - headerSize;
-    char result[4];
-    HelperFunctions::memcpyBigEndian(result, (char*)&dataSize, 4);
-    encodedData.insert(encodedData.begin() + 4 + headerSize, result, result + 4);
 }
 
 void RpcEncoder::encodeRequest(const std::string& methodName, const PArray& parameters, std::vector<uint8_t>& encodedData, const std::shared_ptr<RpcHeader>& header)
 {
 	//The "Bin", the type byte after that and the length itself are not part of the length
+    uint32_t headerSize = header ? getHeaderSize(*header) : 0;
+    size_t dataSize = 4 + methodName.size() + 4;
+    if(parameters)
+    {
+        for(auto& parameter : *parameters)
+        {
+            dataSize += getEncodedSize(parameter);
+        }
+    }
+
     encodedData.clear();
-    encodedData.reserve(1024);
-    encodedData.insert(encodedData.begin(), _packetStartRequest, _packetStartRequest + 4);
-    uint32_t headerSize = 0;
-    if(header)
+    encodedData.reserve(4 + headerSize + 4 + dataSize);
+    encodedData.insert(encodedData.end(), _packetStartRequest, _packetStartRequest + 4);
+    if(headerSize > 0)
     {
-        headerSize = encodeHeader(encodedData, *header) + 4;
-        if(headerSize > 0) encodedData.at(3) |= 0x40;
+        encodedData.at(3) |= 0x40;
+        encodeHeader(encodedData, *header);
     }
+    BinaryEncoder::encodeInteger(encodedData, (int32_t)dataSize);
     BinaryEncoder::encodeString(encodedData, methodName);
     if(!parameters) BinaryEncoder::encodeInteger(encodedData, 0);
     else BinaryEncoder::encodeInteger(encodedData, parameters->size());
@@ -170,123 +195,132 @@ void RpcEncoder::encodeRequest(const std::string& methodName, const PArray& para
             encodeVariable(encodedData, parameter);
         }
     }
-
-    uint32_t dataSize = encodedData.size() - 4 - headerSize;
-    char result[4];
-    HelperFunctions::memcpyBigEndian(result, (char*)&dataSize, 4);
-    encodedData.insert(encodedData.begin() + 4 + headerSize, result, result + 4);
 }
 
 void RpcEncoder::encodeResponse(const std::shared_ptr<Variable>& variable, std::vector<char>& encodedData)
 {
 	//The "Bin", the type byte after that and the length itself are not part of the length
-    encodedData.clear();
-    encodedData.reserve(1024);
-    if(variable && variable->errorStruct) encodedData.insert(encodedData.begin(), _packetStartError, _packetStartError + 4);
-    else encodedData.insert(encodedData.begin(), _packetStartResponse, _packetStartResponse + 4);
+    std::shared_ptr<Variable> response = variable ? variable : std::make_shared<Variable>();
+    size_t dataSize = getEncodedSize(response);
 
-    encodeVariable(encodedData, variable ? variable : std::make_shared<Variable>());
+    encodedData.clear();
+    encodedData.reserve(4 + 4 + dataSize);
+    if(response->errorStruct) encodedData.insert(encodedData.end(), _packetStartError, _packetStartError + 4);
+    else encodedData.insert(encodedData.end(), _packetStartResponse, _packetStartResponse + 4);
+    BinaryEncoder::encodeInteger(encodedData, (int32_t)dataSize);
 
-    uint32_t dataSize = encodedData.size() - 4;
-    char result[4];
-    HelperFunctions::memcpyBigEndian(result, (char*)&dataSize, 4);
-    encodedData.insert(encodedData.begin() + 4, result, result + 4);
+    encodeVariable(encodedData, response);
 }
 
 void RpcEncoder::encodeResponse(const std::shared_ptr<Variable>& variable, std::vector<uint8_t>& encodedData)
 {
 	//The "Bin", the type byte after that and the length itself are not part of the length
-    encodedData.clear();
-    encodedData.reserve(1024);
-    if(variable && variable->errorStruct) encodedData.insert(encodedData.begin(), _packetStartError, _packetStartError + 4);
-    else encodedData.insert(encodedData.begin(), _packetStartResponse, _packetStartResponse + 4);
+    std::shared_ptr<Variable> response = variable ? variable : std::make_shared<Variable>();
+    size_t dataSize = getEncodedSize(response);
 
-    encodeVariable(encodedData, variable ? variable : std::make_shared<Variable>());
+    encodedData.clear();
+    encodedData.reserve(4 + 4 + dataSize);
+    if(response->errorStruct) encodedData.insert(encodedData.end(), _packetStartError, _packetStartError + 4);
+    else encodedData.insert(encodedData.end(), _packetStartResponse, _packetStartResponse + 4);
+    BinaryEncoder::encodeInteger(encodedData, (int32_t)dataSize);
 
-    uint32_t dataSize = encodedData.size() - 4;
-    char result[4];
-    HelperFunctions::memcpyBigEndian(result, (char*)&dataSize, 4);
-    encodedData.insert(encodedData.begin() + 4, result, result + 4);
+    encodeVariable(encodedData, response);
 }
 
 void RpcEncoder::insertHeader(std::vector<char>& packet, const RpcHeader& header)
 {
+	uint32_t headerSize = getHeaderSize(header);
+	if(headerSize == 0) return;
 	std::vector<char> headerData;
-	headerData.reserve(1024);
-	uint32_t headerSize = encodeHeader(headerData, header);
-	if(headerSize > 0)
-	{
-		packet.at(3) |= 0x40;
-		packet.insert(packet.begin() + 4, headerData.begin(), headerData.end());
-	}
+	headerData.reserve(headerSize);
+	encodeHeader(headerData, header);
+	packet.at(3) |= 0x40;
+	packet.insert(packet.begin() + 4, headerData.begin(), headerData.end());
 }
 
 void RpcEncoder::insertHeader(std::vector<uint8_t>& packet, const RpcHeader& header)
 {
+	uint32_t headerSize = getHeaderSize(header);
+	if(headerSize == 0) return;
 	std::vector<uint8_t> headerData;
-    headerData.reserve(1024);
-	uint32_t headerSize = encodeHeader(headerData, header);
-	if(headerSize > 0)
-	{
-		packet.at(3) |= 0x40;
-		packet.insert(packet.begin() + 4, headerData.begin(), headerData.end());
-	}
+	headerData.reserve(headerSize);
+	encodeHeader(headerData, header);
+	packet.at(3) |= 0x40;
+	packet.insert(packet.begin() + 4, headerData.begin(), headerData.end());
 }
 
-uint32_t RpcEncoder::encodeHeader(std::vector<char>& packet, const RpcHeader& header)
+uint32_t RpcEncoder::getHeaderSize(const RpcHeader& header)
 {
-	uint32_t oldPacketSize = packet.size();
-	uint32_t parameterCount = 0;
-	if(!header.authorization.empty())
-	{
-		parameterCount++;
-		std::string temp("Authorization");
-		BinaryEncoder::encodeString(packet, temp);
-		std::string authorization = header.authorization;
-		BinaryEncoder::encodeString(packet, authorization);
-	}
-	else return 0; //No header
-	char result[4];
-	HelperFunctions::memcpyBigEndian(result, (char*)&parameterCount, 4);
-	packet.insert(packet.begin() + oldPacketSize, result, result + 4);
-
-	uint32_t headerSize = packet.size() - oldPacketSize;
-	HelperFunctions::memcpyBigEndian(result, (char*)&headerSize, 4);
-	packet.insert(packet.begin() + oldPacketSize, result, result + 4);
-	return headerSize;
+	if(header.authorization.empty()) return 0;
+	//Size, parameter count, "Authorization" and the authorization string
+	return 4 + 4 + 4 + 13 + 4 + header.authorization.size();
 }
 
-uint32_t RpcEncoder::encodeHeader(std::vector<uint8_t>& packet, const RpcHeader& header)
+uint32_t RpcEncoder::encodeHeader(std::vector<char>& packet, const RpcHeader& header)
 {
-	uint32_t oldPacketSize = packet.size();
-	uint32_t parameterCount = 0;
-	if(!header.authorization.empty())
-	{
-		parameterCount++;
-		std::string temp("Authorization");
-		BinaryEncoder::encodeString(packet, temp);
-		std::string authorization = header.authorization;
-		BinaryEncoder::encodeString(packet, authorization);
-	}
-	else return 0; //No header
-	char result[4];
-	HelperFunctions::memcpyBigEndian(result, (char*)&parameterCount, 4);
-	packet.insert(packet.begin() + oldPacketSize, result, result + 4);
-
-	uint32_t headerSize = packet.size() - oldPacketSize;
-	HelperFunctions::memcpyBigEndian(result, (char*)&headerSize, 4);
-	packet.insert(packet.begin() + oldPacketSize, result, result + 4);
+	uint32_t headerSize = getHeaderSize(header);
+	if(headerSize == 0) return 0; //No header
+	headerSize -= 4; //The size field itself is not part of the header size
+	BinaryEncoder::encodeInteger(packet, headerSize);
+	BinaryEncoder::encodeInteger(packet, 1); //Parameter count
+	BinaryEncoder::encodeString(packet, std::string("Authorization"));
+	BinaryEncoder::encodeString(packet, header.authorization);
 	return headerSize;
 }
 
-void RpcEncoder::expandPacket(std::vector<char>& packet, size_t sizeToInsert)
+uint32_t RpcEncoder::encodeHeader(std::vector<uint8_t>& packet, const RpcHeader& header)
 {
-    if(packet.size() + sizeToInsert > packet.capacity()) packet.reserve(packet.size() + sizeToInsert + 1024);
+	uint32_t headerSize = getHeaderSize(header);
+	if(headerSize == 0) return 0; //No header
+	headerSize -= 4; //The size field itself is not part of the header size
+	BinaryEncoder::encodeInteger(packet, headerSize);
+	BinaryEncoder::encodeInteger(packet, 1); //Parameter count
+	BinaryEncoder::encodeString(packet, std::string("Authorization"));
+	BinaryEncoder::encodeString(packet, header.authorization);
+	return headerSize;
 }
 
-void RpcEncoder::expandPacket(std::vector<uint8_t>& packet, size_t sizeToInsert)
-{
-    if(packet.size() + sizeToInsert > packet.capacity()) packet.reserve(packet.size() + sizeToInsert + 1024);
+size_t RpcEncoder::getEncodedSize(const std::shared_ptr<Variable>& variable)
+{
+    if(!variable) return _encodeVoid ? 4 : 8;
+    switch(variable->type)
+    {
+    case VariableType::tVoid:
+        return _encodeVoid ? 4 : 8;
+    case VariableType::tInteger:
+        return _forceInteger64 ? 4 + 8 : 4 + 4;
+    case VariableType::tInteger64:
+    case VariableType::tFloat:
+        return 4 + 8;
+    case VariableType::tBoolean:
+        return 4 + 1;
+    case VariableType::tString:
+    case VariableType::tBase64:
+    case VariableType::tBinary:
+        return 4 + 4 + variable->getDataView().size();
+    case VariableType::tStruct:
+    {
+        size_t size = 4 + 4;
+        if(variable->structValue.isEmpty()) return size;
+        for(auto& element : *variable->structValue)
+        {
+            size += 4 + (element.first.empty() ? 9 : element.first.size()) + getEncodedSize(element.second);
+        }
+        return size;
+    }
+    case VariableType::tArray:
+    {
+        size_t size = 4 + 4;
+        if(variable->arrayValue.isEmpty()) return size;
+        for(auto& element : *variable->arrayValue)
+        {
+            size += getEncodedSize(element);
+        }
+        return size;
+    }
+    default:
+        return 0;
+    }
 }
 
 void RpcEncoder::encodeVariable(std::vector<char>& packet, const std::shared_ptr<Variable>& variable)
@@ -389,35 +423,30 @@ void RpcEncoder::encodeVariable(std::vector<uint8_t>& packet, const std::shared_
 
 void RpcEncoder::encodeStruct(std::vector<char>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4);
     encodeType(packet, VariableType::tStruct);
     BinaryEncoder::encodeInteger(packet, variable->structValue->size());
     for(auto& element : *variable->structValue)
     {
-        std::string name = element.first.empty() ? "UNDEFINED" : element.first;
-        expandPacket(packet, 4 + name.size());
-        BinaryEncoder::encodeString(packet, name);
+        if(element.first.empty()) BinaryEncoder::encodeString(packet, std::string("UNDEFINED"));
+        else BinaryEncoder::encodeString(packet, element.first);
         encodeVariable(packet, element.second ? element.second : std::make_shared<Variable>());
     }
 }
 
 void RpcEncoder::encodeStruct(std::vector<uint8_t>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4);
     encodeType(packet, VariableType::tStruct);
     BinaryEncoder::encodeInteger(packet, variable->structValue->size());
     for(auto& element : *variable->structValue)
     {
-        std::string name = element.first.empty() ? "UNDEFINED" : element.first;
-        expandPacket(packet, 4 + name.size());
-        BinaryEncoder::encodeString(packet, name);
+        if(element.first.empty()) BinaryEncoder::encodeString(packet, std::string("UNDEFINED"));
+        else BinaryEncoder::encodeString(packet, element.first);
         encodeVariable(packet, element.second ? element.second : std::make_shared<Variable>());
     }
 }
 
 void RpcEncoder::encodeArray(std::vector<char>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4);
     encodeType(packet, VariableType::tArray);
     BinaryEncoder::encodeInteger(packet, variable->arrayValue->size());
     for(auto& element : *variable->arrayValue)
@@ -428,7 +457,6 @@ void RpcEncoder::encodeArray(std::vector<char>& packet, const std::shared_ptr<Va
 
 void RpcEncoder::encodeArray(std::vector<uint8_t>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4);
     encodeType(packet, VariableType::tArray);
     BinaryEncoder::encodeInteger(packet, variable->arrayValue->size());
     for(auto& element : *variable->arrayValue)
@@ -449,133 +477,124 @@ void RpcEncoder::encodeType(std::vector<uint8_t>& packet, VariableType type)
 
 void RpcEncoder::encodeInteger(std::vector<char>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4);
 	encodeType(packet, VariableType::tInteger);
 	BinaryEncoder::encodeInteger(packet, variable->integerValue);
 }
 
 void RpcEncoder::encodeInteger(std::vector<uint8_t>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4);
 	encodeType(packet, VariableType::tInteger);
 	BinaryEncoder::encodeInteger(packet, variable->integerValue);
 }
 
 void RpcEncoder::encodeInteger64(std::vector<char>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 8);
 	encodeType(packet, VariableType::tInteger64);
 	BinaryEncoder::encodeInteger64(packet, variable->integerValue64);
 }
 
 void RpcEncoder::encodeInteger64(std::vector<uint8_t>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 8);
 	encodeType(packet, VariableType::tInteger64);
 	BinaryEncoder::encodeInteger64(packet, variable->integerValue64);
 }
 
 void RpcEncoder::encodeFloat(std::vector<char>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 8);
     encodeType(packet, VariableType::tFloat);
     BinaryEncoder::encodeFloat(packet, variable->floatValue);
 }
 
 void RpcEncoder::encodeFloat(std::vector<uint8_t>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 8);
     encodeType(packet, VariableType::tFloat);
     BinaryEncoder::encodeFloat(packet, variable->floatValue);
 }
 
 void RpcEncoder::encodeBoolean(std::vector<char>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 1);
 	encodeType(packet, VariableType::tBoolean);
 	BinaryEncoder::encodeBoolean(packet, variable->booleanValue);
 }
 
 void RpcEncoder::encodeBoolean(std::vector<uint8_t>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 1);
 	encodeType(packet, VariableType::tBoolean);
 	BinaryEncoder::encodeBoolean(packet, variable->booleanValue);
 }
 
 void RpcEncoder::encodeString(std::vector<char>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4 + variable->stringValue.size());
+    BufferView data = variable->getDataView();
     encodeType(packet, VariableType::tString);
     //We could call encodeRawString here, but then the string would have to be copied and that would cost time.
-    BinaryEncoder::encodeInteger(packet, variable->stringValue.size());
-    if(!variable->stringValue.empty())
+    BinaryEncoder::encodeInteger(packet, data.size());
+    if(!data.empty())
     {
-        packet.insert(packet.end(), variable->stringValue.begin(), variable->stringValue.end());
+        packet.insert(packet.end(), data.data(), data.data() + data.size());
     }
 }
 
 void RpcEncoder::encodeString(std::vector<uint8_t>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4 + variable->stringValue.size());
+    BufferView data = variable->getDataView();
     encodeType(packet, VariableType::tString);
     //We could call encodeRawString here, but then the string would have to be copied and that would cost time.
-    BinaryEncoder::encodeInteger(packet, variable->stringValue.size());
-    if(!variable->stringValue.empty())
+    BinaryEncoder::encodeInteger(packet, data.size());
+    if(!data.empty())
     {
-        packet.insert(packet.end(), variable->stringValue.begin(), variable->stringValue.end());
+        packet.insert(packet.end(), data.data(), data.data() + data.size());
     }
 }
 
 void RpcEncoder::encodeBase64(std::vector<char>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4 + variable->stringValue.size());
+    BufferView data = variable->getDataView();
     encodeType(packet, VariableType::tBase64);
     //We could call encodeRawString here, but then the string would have to be copied and that would cost time.
-    BinaryEncoder::encodeInteger(packet, variable->stringValue.size());
-    if(!variable->stringValue.empty())
+    BinaryEncoder::encodeInteger(packet, data.size());
+    if(!data.empty())
     {
-        packet.insert(packet.end(), variable->stringValue.begin(), variable->stringValue.end());
+        packet.insert(packet.end(), data.data(), data.data() + data.size());
     }
 }
 
 void RpcEncoder::encodeBase64(std::vector<uint8_t>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4 + variable->stringValue.size());
+    BufferView data = variable->getDataView();
     encodeType(packet, VariableType::tBase64);
     //We could call encodeRawString here, but then the string would have to be copied and that would cost time.
-    BinaryEncoder::encodeInteger(packet, variable->stringValue.size());
-    if(!variable->stringValue.empty())
+    BinaryEncoder::encodeInteger(packet, data.size());
+    if(!data.empty())
     {
-        packet.insert(packet.end(), variable->stringValue.begin(), variable->stringValue.end());
+        packet.insert(packet.end(), data.data(), data.data() + data.size());
     }
 }
 
 void RpcEncoder::encodeBinary(std::vector<char>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4 + variable->binaryValue.size());
+    BufferView data = variable->getDataView();
     encodeType(packet, VariableType::tBinary);
-    BinaryEncoder::encodeInteger(packet, variable->binaryValue.size());
-    if(!variable->binaryValue.empty())
+    BinaryEncoder::encodeInteger(packet, data.size());
+    if(!data.empty())
     {
-        packet.insert(packet.end(), variable->binaryValue.begin(), variable->binaryValue.end());
+        packet.insert(packet.end(), data.data(), data.data() + data.size());
     }
 }
 
 void RpcEncoder::encodeBinary(std::vector<uint8_t>& packet, const std::shared_ptr<Variable>& variable)
 {
-    expandPacket(packet, 4 + 4 + variable->binaryValue.size());
+    BufferView data = variable->getDataView();
     encodeType(packet, VariableType::tBinary);
-    BinaryEncoder::encodeInteger(packet, variable->binaryValue.size());
-    if(!variable->binaryValue.empty())
+    BinaryEncoder::encodeInteger(packet, data.size());
+    if(!data.empty())
     {
-        packet.insert(packet.end(), variable->binaryValue.begin(), variable->binaryValue.end());
+        packet.insert(packet.end(), data.data(), data.data() + data.size());
     }
 }
 
 void RpcEncoder::encodeVoid(std::vector<char>& packet)
 {
-    expandPacket(packet, 4 + 4);
 	if(_encodeVoid) encodeType(packet, VariableType::tVoid);
 	else
 	{
@@ -586,7 +605,6 @@ void RpcEncoder::encodeVoid(std::vector<char>& packet)
 
 void RpcEncoder::encodeVoid(std::vector<uint8_t>& packet)
 {
-    expandPacket(packet, 4 + 4);
 	if(_encodeVoid) encodeType(packet, VariableType::tVoid);
 	else
 	{
@@ -65,6 +65,10 @@ public:
 
 	~RpcEncoder() = default;
 
+	/**
+	 * Inserts a header into an already encoded packet. This moves the whole payload, so prefer passing the header to
+	 * encodeRequest().
+	 */
 	static void insertHeader(std::vector<char>& packet, const RpcHeader& header);
 	static void insertHeader(std::vector<uint8_t>& packet, const RpcHeader& header);
 	void encodeRequest(const std::string& methodName, const std::shared_ptr<std::list<std::shared_ptr<Variable>>>& parameters, std::vector<char>& encodedData, const std::shared_ptr<RpcHeader>& header = nullptr);
@@ -73,6 +77,12 @@ public:
 	void encodeRequest(const std::string& methodName, const PArray& parameters, std::vector<uint8_t>& encodedData, const std::shared_ptr<RpcHeader>& header = nullptr);
 	void encodeResponse(const std::shared_ptr<Variable>& variable, std::vector<char>& encodedData);
 	void encodeResponse(const std::shared_ptr<Variable>& variable, std::vector<uint8_t>& encodedData);
+
+	/**
+	 * Returns the number of bytes encodeVariable() writes for the variable. The encode methods use this to allocate
+	 * the packet once with its final size and to write the length fields before the data.
+	 */
+	size_t getEncodedSize(const std::shared_ptr<Variable>& variable);
 private:
 	bool _forceInteger64 = false;
 	bool _encodeVoid = false;
@@ -80,8 +90,7 @@ private:
 	char _packetStartResponse[5];
 	char _packetStartError[5];
 
-	static void expandPacket(std::vector<char>& packet, size_t sizeToInsert);
-    static void expandPacket(std::vector<uint8_t>& packet, size_t sizeToInsert);
+	static uint32_t getHeaderSize(const RpcHeader& header);
 	static uint32_t encodeHeader(std::vector<char>& packet, const RpcHeader& header);
 	static uint32_t encodeHeader(std::vector<uint8_t>& packet, const RpcHeader& header);
 	void encodeVariable(std::vector<char>& packet, const std::shared_ptr<Variable>& variable);
@@ -0,0 +1,350 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "RpcStreamDecoder.h"
+#include "../BaseLib.h"
+
+namespace BaseLib
+{
+namespace Rpc
+{
+
+RpcStreamDecoder::RpcStreamDecoder() : RpcStreamDecoder(false)
+{
+}
+
+RpcStreamDecoder::RpcStreamDecoder(bool ansi, bool setInteger32) : _setInteger32(setInteger32)
+{
+	if(ansi) _ansi.reset(new Ansi(true, false));
+	_scratch.reserve(8);
+}
+
+void RpcStreamDecoder::reset(bool request, bool error, uint32_t size)
+{
+	_request = request;
+	_error = error;
+	_remainingSize = size;
+	_state = request ? State::methodNameLength : State::type;
+	_scratch.clear();
+	std::string().swap(_string);
+	std::vector<uint8_t>().swap(_binary);
+	_stringLength = 0;
+	_type = VariableType::tVoid;
+	_remainingParameters = 0;
+	_containers.clear();
+	_methodName.clear();
+	_parameters = request ? MemoryArena::makeShared<Array>() : PArray();
+	_response.reset();
+	if(!request && size == 0)
+	{
+		//Same as RpcDecoder: The response is Void when the packet is empty.
+		_response = std::make_shared<Variable>();
+		_state = State::finished;
+	}
+}
+
+size_t RpcStreamDecoder::process(const char* data, size_t length)
+{
+	if(_state == State::finished) return 0;
+	if(length > _remainingSize) length = _remainingSize;
+	size_t processableLength = length;
+	while(length > 0 && _state != State::finished)
+	{
+		switch(_state)
+		{
+		case State::methodNameLength:
+			if(!readFixed(data, length, 4)) break;
+			_stringLength = getLength(1);
+			_state = State::methodName;
+			reserveString();
+			if(_stringLength == 0) finishString();
+			break;
+		case State::methodName:
+		case State::string:
+		case State::structKey:
+			if(readString(data, length)) finishString();
+			break;
+		case State::parameterCount:
+		{
+			if(!readFixed(data, length, 4)) break;
+			int32_t parameterCount = getInteger();
+			if(parameterCount < 0) throw RpcDecoderException("Invalid parameter count.");
+			if(parameterCount > 100) throw RpcDecoderException("Parameter count of RPC request is larger than 100.");
+			_remainingParameters = parameterCount;
+			if(_remainingParameters == 0) _state = State::finished;
+			else startValue();
+			break;
+		}
+		case State::type:
+			if(!readFixed(data, length, 4)) break;
+			_type = (VariableType)getInteger();
+			if(_type == VariableType::tInteger) _state = State::integer;
+			else if(_type == VariableType::tInteger64) _state = State::integer64;
+			else if(_type == VariableType::tFloat) _state = State::floatValue;
+			else if(_type == VariableType::tBoolean) _state = State::boolean;
+			else if(_type == VariableType::tString || _type == VariableType::tBase64 || _type == VariableType::tBinary) _state = State::stringLength;
+			else if(_type == VariableType::tArray || _type == VariableType::tStruct) _state = State::containerLength;
+			else finishValue(MemoryArena::makeShared<Variable>(_type)); //Void and unknown types have no data
+			break;
+		case State::integer:
+		{
+			if(!readFixed(data, length, 4)) break;
+			PVariable variable = MemoryArena::makeShared<Variable>(VariableType::tInteger);
+			variable->integerValue = getInteger();
+			variable->integerValue64 = variable->integerValue;
+			variable->booleanValue = (bool)variable->integerValue;
+			variable->floatValue = variable->integerValue;
+			finishValue(std::move(variable));
+			break;
+		}
+		case State::integer64:
+		{
+			if(!readFixed(data, length, 8)) break;
+			uint32_t position = 0;
+			PVariable variable = MemoryArena::makeShared<Variable>(VariableType::tInteger64);
+			variable->integerValue64 = BinaryDecoder::decodeInteger64(_scratch, position);
+			_scratch.clear();
+			variable->integerValue = (int32_t)variable->integerValue64;
+			variable->booleanValue = (bool)variable->integerValue64;
+			variable->floatValue = variable->integerValue64;
+			if(_setInteger32 && (int64_t)variable->integerValue == variable->integerValue64) variable->type = VariableType::tInteger;
+			finishValue(std::move(variable));
+			break;
+		}
+		case State::floatValue:
+		{
+			if(!readFixed(data, length, 8)) break;
+			uint32_t position = 0;
+			PVariable variable = MemoryArena::makeShared<Variable>(VariableType::tFloat);
+			variable->floatValue = BinaryDecoder::decodeFloat(_scratch, position);
+			_scratch.clear();
+			variable->integerValue = (int32_t)std::lround(variable->floatValue);
+			variable->integerValue64 = std::llround(variable->floatValue);
+			variable->booleanValue = (bool)variable->floatValue;
+			finishValue(std::move(variable));
+			break;
+		}
+		case State::boolean:
+		{
+			if(!readFixed(data, length, 1)) break;
+			uint32_t position = 0;
+			PVariable variable = MemoryArena::makeShared<Variable>(VariableType::tBoolean);
+			variable->booleanValue = BinaryDecoder::decodeBoolean(_scratch, position);
+			_scratch.clear();
+			variable->integerValue = (int32_t)variable->booleanValue;
+			variable->integerValue64 = (int64_t)variable->booleanValue;
+			finishValue(std::move(variable));
+			break;
+		}
+		case State::stringLength:
+		case State::structKeyLength:
+			if(!readFixed(data, length, 4)) break;
+			_stringLength = getLength(1);
+			_state = _state == State::stringLength ? State::string : State::structKey;
+			reserveString();
+			if(_stringLength == 0) finishString();
+			break;
+		case State::containerLength:
+		{
+			if(!readFixed(data, length, 4)) break;
+			//Every array element needs at least 4 bytes, every struct member at least 8
+			uint32_t elementCount = getLength(_type == VariableType::tStruct ? 8 : 4);
+			PVariable variable = MemoryArena::makeShared<Variable>(_type);
+			if(_type == VariableType::tArray)
+			{
+				variable->arrayValue = MemoryArena::makeShared<Array>();
+				variable->arrayValue->reserve(elementCount);
+			}
+			else variable->structValue = MemoryArena::makeShared<Struct>();
+			if(elementCount == 0)
+			{
+				finishValue(std::move(variable));
+				break;
+			}
+			Container container;
+			container.variable = std::move(variable);
+			container.remaining = elementCount;
+			_containers.push_back(std::move(container));
+			if(_type == VariableType::tStruct) _state = State::structKeyLength;
+			else startValue();
+			break;
+		}
+		case State::finished:
+			break;
+		}
+	}
+	return processableLength - length;
+}
+
+bool RpcStreamDecoder::readFixed(const char*& data, size_t& length, uint32_t size)
+{
+	size_t bytesToCopy = size - _scratch.size();
+	if(bytesToCopy > length) bytesToCopy = length;
+	_scratch.insert(_scratch.end(), data, data + bytesToCopy);
+	data += bytesToCopy;
+	length -= bytesToCopy;
+	_remainingSize -= bytesToCopy;
+	//IP-Symcon encodes integers as string. Like BinaryDecoder::decodeInteger(), the last 1 to 3 bytes of the packet are
+	//accepted as integer and interpreted by getInteger().
+	if(size == 4 && _remainingSize == 0 && !_scratch.empty()) return true;
+	return _scratch.size() == size;
+}
+
+bool RpcStreamDecoder::readString(const char*& data, size_t& length)
+{
+	//Binaries are read directly into their own buffer, which is then moved into the variable.
+	bool binary = _state == State::string && _type == VariableType::tBinary;
+	size_t size = binary ? _binary.size() : _string.size();
+	size_t bytesToCopy = _stringLength - size;
+	if(bytesToCopy > length) bytesToCopy = length;
+	if(binary) _binary.insert(_binary.end(), data, data + bytesToCopy);
+	else _string.append(data, bytesToCopy);
+	data += bytesToCopy;
+	length -= bytesToCopy;
+	_remainingSize -= bytesToCopy;
+	return size + bytesToCopy == _stringLength;
+}
+
+void RpcStreamDecoder::reserveString()
+{
+	if(_state == State::string && _type == VariableType::tBinary) _binary.reserve(_stringLength);
+	else _string.reserve(_stringLength);
+}
+
+int32_t RpcStreamDecoder::getInteger()
+{
+	uint32_t position = 0;
+	int32_t integer = BinaryDecoder::decodeInteger(_scratch, position);
+	_scratch.clear();
+	return integer;
+}
+
+uint32_t RpcStreamDecoder::getLength(uint32_t minimumElementSize)
+{
+	int32_t length = getInteger();
+	if(length < 0 || (uint64_t)length * minimumElementSize > _remainingSize) throw RpcDecoderException("Length is larger than the remaining packet.");
+	return (uint32_t)length;
+}
+
+std::string RpcStreamDecoder::getString()
+{
+	//Moving leaves _string without a buffer. After ANSI conversion the buffer of large values is released, so it isn't kept
+	//for the lifetime of the decoder.
+	std::string string = _ansi ? _ansi->toUtf8(_string.data(), _string.size()) : std::move(_string);
+	if(_string.capacity() > 1024) std::string().swap(_string);
+	else _string.clear();
+	return string;
+}
+
+void RpcStreamDecoder::startValue()
+{
+	_state = State::type;
+}
+
+void RpcStreamDecoder::finishString()
+{
+	if(_state == State::methodName)
+	{
+		_methodName = getString();
+		_state = State::parameterCount;
+	}
+	else if(_state == State::structKey)
+	{
+		_containers.back().key = getString();
+		startValue();
+	}
+	else
+	{
+		PVariable variable = MemoryArena::makeShared<Variable>(_type);
+		if(_type == VariableType::tBinary)
+		{
+			variable->binaryValue = std::move(_binary);
+			_binary.clear();
+		}
+		else
+		{
+			variable->stringValue = getString();
+			variable->integerValue64 = Math::getNumber64(variable->stringValue);
+			variable->integerValue = (int32_t)variable->integerValue64;
+			variable->booleanValue = !variable->stringValue.empty() && variable->stringValue != "0" && variable->stringValue != "false" && variable->stringValue != "f";
+		}
+		finishValue(std::move(variable));
+	}
+}
+
+void RpcStreamDecoder::finishValue(PVariable value)
+{
+	while(true)
+	{
+		if(_containers.empty())
+		{
+			if(_request)
+			{
+				_parameters->push_back(std::move(value));
+				_remainingParameters--;
+				if(_remainingParameters == 0) _state = State::finished;
+				else startValue();
+			}
+			else
+			{
+				if(_error)
+				{
+					value->errorStruct = true;
+					if(value->structValue->find("faultCode") == value->structValue->end()) value->structValue->emplace("faultCode", std::make_shared<Variable>(-1));
+					if(value->structValue->find("faultString") == value->structValue->end()) value->structValue->emplace("faultString", std::make_shared<Variable>(std::string("undefined")));
+				}
+				_response = std::move(value);
+				_state = State::finished;
+			}
+			return;
+		}
+
+		Container& container = _containers.back();
+		if(container.variable->type == VariableType::tArray) container.variable->arrayValue->push_back(std::move(value));
+		else container.variable->structValue->emplace_hint(container.variable->structValue->end(), std::move(container.key), std::move(value));
+		container.remaining--;
+		if(container.remaining > 0)
+		{
+			if(container.variable->type == VariableType::tStruct) _state = State::structKeyLength;
+			else startValue();
+			return;
+		}
+
+		value = std::move(container.variable);
+		_containers.pop_back();
+		if(value->type == VariableType::tStruct && value->structValue->size() == 2 && value->structValue->find("faultCode") != value->structValue->end() && value->structValue->find("faultString") != value->structValue->end())
+		{
+			value->errorStruct = true;
+		}
+	}
+}
+
+}
+}
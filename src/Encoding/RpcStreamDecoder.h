@@ -0,0 +1,151 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef RPCSTREAMDECODER_H_
+#define RPCSTREAMDECODER_H_
+
+#include "../Variable.h"
+#include "Ansi.h"
+#include "RpcDecoder.h"
+
+#include <memory>
+#include <vector>
+#include <string>
+
+namespace BaseLib
+{
+namespace Rpc
+{
+
+/**
+ * Decodes the body of a binary RPC packet while it is received. The bytes can be passed in chunks of any size, so
+ * decoding starts before the packet is complete and the packet never needs to be stored as a whole. Usually set on
+ * BinaryRpc with BinaryRpc::setStreamDecoder(), but can be used on its own as well.
+ *
+ * Throws RpcDecoderException on invalid data.
+ */
+class RpcStreamDecoder
+{
+public:
+	RpcStreamDecoder();
+	explicit RpcStreamDecoder(bool ansi, bool setInteger32 = true);
+	~RpcStreamDecoder() = default;
+
+	/**
+	 * Prepares the decoder for a new packet.
+	 *
+	 * @param request Set to "true" for requests and to "false" for responses.
+	 * @param error Set to "true" for error responses (packet type 0xFF).
+	 * @param size The size of the packet body, i. e. the value of the data length field.
+	 */
+	void reset(bool request, bool error, uint32_t size);
+
+	/**
+	 * Decodes the next bytes of the packet body.
+	 *
+	 * @param data The data to decode.
+	 * @param length The number of bytes in data.
+	 * @return Returns the number of processed bytes. This is less than length when the body is complete.
+	 */
+	size_t process(const char* data, size_t length);
+
+	bool isFinished() { return _state == State::finished; }
+
+	/**
+	 * The method name of the decoded request.
+	 */
+	const std::string& getMethodName() { return _methodName; }
+
+	/**
+	 * The parameters of the decoded request. Only complete when isFinished() returned true.
+	 */
+	PArray getParameters() { return _parameters; }
+
+	/**
+	 * The decoded response. Only set when isFinished() returned true.
+	 */
+	PVariable getResponse() { return _response; }
+private:
+	enum class State
+	{
+		methodNameLength,
+		methodName,
+		parameterCount,
+		type,
+		integer,
+		integer64,
+		floatValue,
+		boolean,
+		stringLength,
+		string,
+		containerLength,
+		structKeyLength,
+		structKey,
+		finished
+	};
+
+	struct Container
+	{
+		PVariable variable;
+		uint32_t remaining = 0;
+		std::string key;
+	};
+
+	bool _setInteger32 = true;
+	std::unique_ptr<Ansi> _ansi;
+	bool _request = true;
+	bool _error = false;
+	uint32_t _remainingSize = 0;
+	State _state = State::finished;
+	std::vector<char> _scratch;
+	std::string _string;
+	std::vector<uint8_t> _binary;
+	uint32_t _stringLength = 0;
+	VariableType _type = VariableType::tVoid;
+	uint32_t _remainingParameters = 0;
+	std::vector<Container> _containers;
+	std::string _methodName;
+	PArray _parameters;
+	PVariable _response;
+
+	bool readFixed(const char*& data, size_t& length, uint32_t size);
+	bool readString(const char*& data, size_t& length);
+	void reserveString();
+	int32_t getInteger();
+	uint32_t getLength(uint32_t minimumElementSize);
+	std::string getString();
+	void startValue();
+	void finishString();
+	void finishValue(PVariable value);
+};
+
+}
+}
+#endif
@@ -30,10 +30,63 @@
 
 #include "WebSocket.h"
 #include "../HelperFunctions/HelperFunctions.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace BaseLib
 {
+
+namespace
+{
+
+/**
+ * XORs "data" with the masking key. "offset" is the position of "data" in the frame's payload. The key is rotated by
+ * "offset" once, so the payload can be masked 16 or 8 bytes at a time.
+ */
+void applyMask(char* data, size_t size, const char* maskingKey, size_t offset)
+{
+    char rotatedMask[16];
+    for(size_t i = 0; i < sizeof(rotatedMask); i++) rotatedMask[i] = maskingKey[(offset + i) & 3];
+
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128i mask128 = _mm_loadu_si128((const __m128i*)rotatedMask);
+    for(; i + 16 <= size; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        _mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(block, mask128));
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    uint8x16_t mask128 = vld1q_u8((const uint8_t*)rotatedMask);
+    for(; i + 16 <= size; i += 16)
+    {
+        vst1q_u8((uint8_t*)(data + i), veorq_u8(vld1q_u8((const uint8_t*)(data + i)), mask128));
+    }
+#endif
+    uint64_t mask64;
+    std::memcpy(&mask64, rotatedMask, sizeof(mask64));
+    for(; i + 8 <= size; i += 8)
+    {
+        uint64_t block;
+        std::memcpy(&block, data + i, sizeof(block));
+        block ^= mask64;
+        std::memcpy(data + i, &block, sizeof(block));
+    }
+    for(; i < size; i++)
+    {
+        data[i] ^= rotatedMask[i & 3];
+    }
+}
+
+}
+
 WebSocket::WebSocket()
 {
 }
@@ -134,11 +187,8 @@ uint32_t WebSocket::processHeader(char** buffer, int32_t& bufferLength)
     }
     if(_header.hasMask)
     {
-        _header.maskingKey.reserve(4);
-        _header.maskingKey.push_back(_rawHeader.at(2 + lengthBytes));
-        _header.maskingKey.push_back(_rawHeader.at(2 + lengthBytes + 1));
-        _header.maskingKey.push_back(_rawHeader.at(2 + lengthBytes + 2));
-        _header.maskingKey.push_back(_rawHeader.at(2 + lengthBytes + 3));
+        //Assigned, because continuation frames have their own key.
+        _header.maskingKey.assign(_rawHeader.begin() + 2 + lengthBytes, _rawHeader.begin() + 2 + lengthBytes + 4);
     }
     _header.parsed = true;
     _rawHeader.clear();
@@ -157,12 +207,19 @@ uint32_t WebSocket::processHeader(char** buffer, int32_t& bufferLength)
 uint32_t WebSocket::processContent(char* buffer, int32_t bufferLength)
 {
     uint32_t currentContentSize = _content.size() - _oldContentSize;
-    if(currentContentSize + bufferLength > 10485760) throw WebSocketException("Data is larger than 10MiB.");
+    if(currentContentSize == 0)
+    {
+        //Reserve the announced frame length at once. The content of fragmented messages grows at least by factor 2.
+        if(_header.length > 10485760) throw WebSocketException("Data is larger than 10MiB.");
+        size_t requiredSize = _content.size() + _header.length;
+        if(_content.capacity() < requiredSize) _content.reserve(_oldContentSize == 0 ? requiredSize : std::max(requiredSize, _content.capacity() * 2));
+    }
     if(currentContentSize + bufferLength > _header.length) bufferLength -= (currentContentSize + bufferLength) - _header.length;
     _content.insert(_content.end(), buffer, buffer + bufferLength);
+    //Unmask while the data is still in the cache. The mask position is relative to the start of the frame.
+    if(_header.hasMask) applyMask(_content.data() + _oldContentSize + currentContentSize, bufferLength, _header.maskingKey.data(), currentContentSize);
     if(_content.size() - _oldContentSize == _header.length)
     {
-        applyMask();
         if(_header.fin) _finished = true;
         else
         {
@@ -173,15 +230,6 @@ uint32_t WebSocket::processContent(char* buffer, int32_t bufferLength)
     return bufferLength;
 }
 
-void WebSocket::applyMask()
-{
-    if(!_header.hasMask) return;
-    for(uint32_t i = _oldContentSize; i < _content.size(); i++)
-    {
-        _content.operator [](i) ^= _header.maskingKey[i % 4];
-    }
-}
-
 void WebSocket::encode(const std::vector<char>& data, Header::Opcode::Enum messageType, std::vector<char>& output)
 {
     output.clear();
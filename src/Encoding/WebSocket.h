@@ -120,7 +120,6 @@ private:
 
 	uint32_t processHeader(char** buffer, int32_t& bufferLength);
 	uint32_t processContent(char* buffer, int32_t bufferLength);
-	void applyMask();
 
 };
 }
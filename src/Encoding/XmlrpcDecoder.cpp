@@ -36,271 +36,569 @@ namespace BaseLib
 namespace Rpc
 {
 
-XmlrpcDecoder::XmlrpcDecoder(BaseLib::SharedObjects* baseLib)
+namespace
 {
-	_bl = baseLib;
-}
 
-std::shared_ptr<std::vector<std::shared_ptr<Variable>>> XmlrpcDecoder::decodeRequest(const std::vector<char>& packet, std::string& methodName)
+/**
+ * Pull parser reading XML straight from the receive buffer. It accepts exactly what rapidxml accepts with
+ * "parse_no_entity_translation" and throws the same rapidxml::parse_error messages: Entities are not translated,
+ * whitespace-only text is dropped, other text keeps its leading and trailing whitespace and closing tag names are not
+ * validated. Comments, processing instructions, declarations and DOCTYPEs are skipped. The input ends at its first null
+ * character.
+ */
+class XmlReader
 {
-	xml_document doc;
-	try
+public:
+	enum class NodeType
 	{
-        doc.parse<parse_no_entity_translation>((char*)packet.data()); //Dirty, but there is no modification of the data
-		xml_node* node = doc.first_node();
-		if(node == nullptr || std::string(doc.first_node()->name()) != "methodCall")
-		{
-			doc.clear();
-			return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. First root node has to be \"methodCall\".")});
-		}
-		xml_node* subNode = node->first_node("methodName");
-		if(subNode == nullptr || std::string(subNode->name()) != "methodName")
-		{
-			doc.clear();
-			return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. Node \"methodName\" not found.")});
-		}
-		methodName = std::string(subNode->value());
-		if(methodName.empty())
-		{
-			doc.clear();
-			return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. \"methodName\" is empty.")});
-		}
+		element,
+		data,
+		cdata
+	};
 
-		subNode = node->first_node("params");
-		if(subNode == nullptr)
-		{
-			doc.clear();
-			return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. Node \"params\" not found.")});
-		}
+	struct Node
+	{
+		NodeType type = NodeType::element;
+		const char* name = nullptr;
+		size_t nameSize = 0;
+		const char* value = nullptr;
+		size_t valueSize = 0;
+
+		/**
+		 * "true" for elements that are not self-closing. Their contents have to be read with nextChild() or skip().
+		 */
+		bool hasContents = false;
 
-		std::shared_ptr<std::vector<std::shared_ptr<Variable>>> parameters(new std::vector<std::shared_ptr<Variable>>());
-		for(xml_node* paramNode = subNode->first_node(); paramNode; paramNode = paramNode->next_sibling())
+		template<size_t size>
+		bool isElement(const char (&elementName)[size]) const
 		{
-			xml_node* valueNode = paramNode->first_node("value");
-			if(valueNode == nullptr) continue;
-			parameters->push_back(decodeParameter(valueNode));
+			return type == NodeType::element && nameSize == size - 1 && std::memcmp(name, elementName, size - 1) == 0;
 		}
+	};
 
-		doc.clear();
-		return parameters;
+	XmlReader(const char* data, size_t size) : _position(data)
+	{
+		const char* nullCharacter = (const char*)std::memchr(data, 0, size);
+		_end = nullCharacter ? nullCharacter : data + size;
+		if(at(0) == (char)0xEF && at(1) == (char)0xBB && at(2) == (char)0xBF) _position += 3;
 	}
-	catch(const std::exception& ex)
-    {
-    	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    	doc.clear();
-    	return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. Not well formed: " + std::string(ex.what()))});
-    }
-    return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. Not well formed.")});
-}
 
-std::shared_ptr<Variable> XmlrpcDecoder::decodeResponse(const std::string& packet)
-{
-	xml_document doc;
-	try
+	/**
+	 * Reads the next node on document level. Returns "false" at the end of the document.
+	 */
+	bool nextDocumentNode(Node& node)
 	{
-		doc.parse<parse_no_entity_translation>((char*)packet.data()); //Dirty, but there is no modification of the data
-		std::shared_ptr<Variable> response = decodeResponse(&doc);
-		doc.clear();
-		return response;
+		while(true)
+		{
+			skipWhitespace();
+			if(at(0) == 0) return false;
+			if(at(0) != '<') throw parse_error("expected <", (void*)_position);
+			_position++;
+			if(parseNode(node)) return true;
+		}
 	}
-	catch(const std::exception& ex)
-    {
-    	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    	doc.clear();
-    	return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. Not well formed: " + std::string(ex.what())));
-    }
-    return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. Not well formed."));
-}
 
-std::shared_ptr<Variable> XmlrpcDecoder::decodeResponse(const std::vector<char>& packet)
-{
-	xml_document doc;
-	try
+	/**
+	 * Reads the next child of the element whose contents are being read. Returns "false" after consuming the closing tag.
+	 */
+	bool nextChild(Node& node)
 	{
-		int32_t startPos = 0;
-		if(packet.front() != '<')
+		while(true)
 		{
-			for(int32_t i = 0; i < (signed)packet.size(); i++)
+			const char* contentsStart = _position;
+			skipWhitespace();
+			const char c = at(0);
+			if(c == '<')
 			{
-				if(packet[i] == '<')
+				if(at(1) == '/')
 				{
-					startPos = i;
-					break;
+					_position += 2;
+					while(isNameCharacter(at(0))) _position++;
+					skipWhitespace();
+					if(at(0) != '>') throw parse_error("expected >", (void*)_position);
+					_position++;
+					return false;
 				}
+				_position++;
+				if(parseNode(node)) return true;
+			}
+			else if(c == 0) throw parse_error("unexpected end of data", (void*)_position);
+			else
+			{
+				//Text keeps the whitespace in front of it
+				node.type = NodeType::data;
+				node.hasContents = false;
+				node.value = contentsStart;
+				const char* lessThan = (const char*)std::memchr(_position, '<', _end - _position);
+				_position = lessThan ? lessThan : _end;
+				node.valueSize = _position - contentsStart;
+				return true;
 			}
 		}
-		if(startPos >= (signed)packet.size()) return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. Not well formed: Could not find \"<\"."));
-		doc.parse<parse_no_entity_translation>((char*)packet.data() + startPos); //Dirty, but there is no modification of the data
-		std::shared_ptr<Variable> response = decodeResponse(&doc);
-		doc.clear();
-		return response;
 	}
-	catch(const std::exception& ex)
-    {
-    	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    	doc.clear();
-    	return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. Not well formed: " + std::string(ex.what())));
-    }
-    return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. Not well formed."));
-}
 
-std::shared_ptr<Variable> XmlrpcDecoder::decodeResponse(xml_document* doc)
-{
-	try
+	/**
+	 * Skips the contents of "node".
+	 */
+	void skip(const Node& node)
 	{
-		xml_node* node = doc->first_node();
-		if(node == nullptr || std::string(doc->first_node()->name()) != "methodResponse")
+		if(!node.hasContents) return;
+		size_t depth = 1;
+		Node child;
+		while(depth > 0)
 		{
-			doc->clear();
-			return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. First root node has to be \"methodResponse\"."));
+			if(!nextChild(child)) depth--;
+			else if(child.hasContents) depth++;
 		}
+	}
+
+	/**
+	 * Skips the remaining children and the closing tag of the element whose contents are being read.
+	 */
+	void skipRemainingChildren()
+	{
+		Node child;
+		while(nextChild(child)) skip(child);
+	}
 
-		bool errorStruct = false;
-		xml_node* subNode = node->first_node("params");
-		if(subNode == nullptr)
+	/**
+	 * Returns the text rapidxml assigns as value to "node" (the first text child of elements) and consumes the node.
+	 */
+	std::string readValue(const Node& node)
+	{
+		if(node.type != NodeType::element) return std::string(node.value, node.valueSize);
+		std::string value;
+		if(!node.hasContents) return value;
+		bool valueFound = false;
+		Node child;
+		while(nextChild(child))
 		{
-			subNode = node->first_node("fault");
-			if(subNode == nullptr)
+			if(!valueFound && child.type == NodeType::data)
 			{
-				doc->clear();
-				return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. Node \"fault\" and \"params\" not found."));
+				value.assign(child.value, child.valueSize);
+				valueFound = true;
 			}
-			errorStruct = true;
-		}
-		else
-		{
-			subNode = subNode->first_node("param");
-			if(subNode == nullptr) return std::shared_ptr<Variable>(new Variable(VariableType::tVoid));
+			else skip(child);
 		}
+		return value;
+	}
+private:
+	const char* _position = nullptr;
+	const char* _end = nullptr;
 
-		subNode = subNode->first_node("value");
-		if(subNode == nullptr) return std::shared_ptr<Variable>(new Variable(VariableType::tVoid));
+	char at(size_t offset) const { return _position + offset < _end ? _position[offset] : 0; }
 
-		std::shared_ptr<Variable> response = decodeParameter(subNode);
-		if(errorStruct)
+	static bool isWhitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+	static bool isNameCharacter(char c) { return c != 0 && !isWhitespace(c) && c != '/' && c != '>' && c != '?'; }
+	static bool isAttributeNameCharacter(char c) { return isNameCharacter(c) && c != '!' && c != '<' && c != '='; }
+
+	void skipWhitespace()
+	{
+		while(_position < _end && isWhitespace(*_position)) _position++;
+	}
+
+	/**
+	 * Skips to behind "terminator".
+	 */
+	template<size_t size>
+	void skipBehind(const char (&terminator)[size])
+	{
+		while(true)
 		{
-			response->errorStruct = errorStruct;
-			if(response->structValue->find("faultCode") == response->structValue->end()) response->structValue->insert(StructElement("faultCode", PVariable(new Variable(-1))));
-			if(response->structValue->find("faultString") == response->structValue->end()) response->structValue->insert(StructElement("faultString", PVariable(new Variable(std::string("undefined")))));
+			bool match = true;
+			for(size_t i = 0; i < size - 1; i++)
+			{
+				if(at(i) != terminator[i])
+				{
+					match = false;
+					break;
+				}
+			}
+			if(match) break;
+			if(at(0) == 0) throw parse_error("unexpected end of data", (void*)_position);
+			_position++;
 		}
-		return response;
+		_position += size - 1;
 	}
-	catch(const std::exception& ex)
-    {
-    	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    	return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. Not well formed: " + std::string(ex.what())));
-    }
-    return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. Not well formed."));
-}
 
-std::shared_ptr<Variable> XmlrpcDecoder::decodeParameter(xml_node* valueNode)
-{
-	try
+	/**
+	 * Parses the node behind "<". Returns "false" for nodes that are skipped.
+	 */
+	bool parseNode(Node& node)
 	{
-		if(valueNode == nullptr) return std::shared_ptr<Variable>(new Variable(VariableType::tVoid));
-		xml_node* subNode = valueNode->first_node();
-		if(subNode == nullptr) return std::shared_ptr<Variable>(new Variable(VariableType::tString));
-
-		std::string type(subNode->name());
-		HelperFunctions::toLower(type);
-		std::string value(subNode->value());
-		if(type == "string")
+		if(at(0) == '?')
 		{
-			return std::shared_ptr<Variable>(new Variable(value));
+			//XML declaration or processing instruction
+			_position++;
+			skipBehind("?>");
+			return false;
 		}
-		else if(type == "boolean")
+		else if(at(0) == '!')
 		{
-			bool boolean = false;
-			if(value == "true" || value == "1") boolean = true;
-			return std::shared_ptr<Variable>(new Variable(boolean));
+			if(at(1) == '-' && at(2) == '-')
+			{
+				_position += 3;
+				skipBehind("-->");
+				return false;
+			}
+			else if(at(1) == '[' && at(2) == 'C' && at(3) == 'D' && at(4) == 'A' && at(5) == 'T' && at(6) == 'A' && at(7) == '[')
+			{
+				_position += 8;
+				node.type = NodeType::cdata;
+				node.hasContents = false;
+				node.value = _position;
+				skipBehind("]]>");
+				node.valueSize = _position - 3 - node.value;
+				return true;
+			}
+			else if(at(1) == 'D' && at(2) == 'O' && at(3) == 'C' && at(4) == 'T' && at(5) == 'Y' && at(6) == 'P' && at(7) == 'E' && isWhitespace(at(8)))
+			{
+				_position += 9;
+				skipDoctype();
+				return false;
+			}
+
+			_position++;
+			while(at(0) != '>')
+			{
+				if(at(0) == 0) throw parse_error("unexpected end of data", (void*)_position);
+				_position++;
+			}
+			_position++;
+			return false;
 		}
-		else if(type == "i4" || type == "int")
+
+		node.type = NodeType::element;
+		node.name = _position;
+		while(isNameCharacter(at(0))) _position++;
+		node.nameSize = _position - node.name;
+		if(node.nameSize == 0) throw parse_error("expected element name", (void*)_position);
+		node.value = nullptr;
+		node.valueSize = 0;
+		skipWhitespace();
+		skipAttributes();
+		if(at(0) == '>')
 		{
-			return std::shared_ptr<Variable>(new Variable(Math::getNumber(value)));
+			_position++;
+			node.hasContents = true;
 		}
-		else if(type == "i8")
+		else if(at(0) == '/')
 		{
-			return std::shared_ptr<Variable>(new Variable(Math::getNumber64(value)));
+			_position++;
+			if(at(0) != '>') throw parse_error("expected >", (void*)_position);
+			_position++;
+			node.hasContents = false;
 		}
-		else if(type == "double")
+		else throw parse_error("expected >", (void*)_position);
+		return true;
+	}
+
+	void skipAttributes()
+	{
+		while(isAttributeNameCharacter(at(0)))
 		{
-			double number = 0;
-			try { number = std::stod(value); } catch(...) {}
-			return std::shared_ptr<Variable>(new Variable(number));
+			while(isAttributeNameCharacter(at(0))) _position++;
+			skipWhitespace();
+			if(at(0) != '=') throw parse_error("expected =", (void*)_position);
+			_position++;
+			skipWhitespace();
+			const char quote = at(0);
+			if(quote != '\'' && quote != '"') throw parse_error("expected ' or \"", (void*)_position);
+			_position++;
+			while(at(0) != 0 && at(0) != quote) _position++;
+			if(at(0) != quote) throw parse_error("expected ' or \"", (void*)_position);
+			_position++;
+			skipWhitespace();
 		}
-		else if(type == "base64")
+	}
+
+	void skipDoctype()
+	{
+		while(at(0) != '>')
 		{
-			std::shared_ptr<Variable> base64(new Variable(VariableType::tBase64));
-			base64->stringValue = value;
-			return base64;
+			if(at(0) == '[')
+			{
+				_position++;
+				int32_t depth = 1;
+				while(depth > 0)
+				{
+					if(at(0) == '[') depth++;
+					else if(at(0) == ']') depth--;
+					else if(at(0) == 0) throw parse_error("unexpected end of data", (void*)_position);
+					_position++;
+				}
+			}
+			else if(at(0) == 0) throw parse_error("unexpected end of data", (void*)_position);
+			else _position++;
 		}
-		else if(type == "array")
+		_position++;
+	}
+};
+
+PVariable decodeParameter(XmlReader& reader, const XmlReader::Node& valueNode);
+
+PVariable decodeStruct(XmlReader& reader, const XmlReader::Node& structNode)
+{
+	PVariable rpcStruct = std::make_shared<Variable>(VariableType::tStruct);
+	if(!structNode.hasContents) return rpcStruct;
+
+	XmlReader::Node memberNode;
+	while(reader.nextChild(memberNode))
+	{
+		if(!memberNode.hasContents) continue;
+
+		//The value is the first "value" element behind the first "name" element.
+		bool nameFound = false;
+		std::string name;
+		PVariable value;
+		XmlReader::Node subNode;
+		while(reader.nextChild(subNode))
 		{
-			return decodeArray(subNode);
+			if(!nameFound && subNode.isElement("name"))
+			{
+				nameFound = true;
+				name = reader.readValue(subNode);
+			}
+			else if(nameFound && !name.empty() && !value && subNode.isElement("value")) value = decodeParameter(reader, subNode);
+			else reader.skip(subNode);
 		}
-		else if(type == "struct")
+		if(!value) continue;
+		rpcStruct->structValue->emplace_hint(rpcStruct->structValue->end(), std::move(name), std::move(value));
+	}
+	return rpcStruct;
+}
+
+PVariable decodeArray(XmlReader& reader, const XmlReader::Node& arrayNode)
+{
+	PVariable rpcArray = std::make_shared<Variable>(VariableType::tArray);
+	if(!arrayNode.hasContents) return rpcArray;
+
+	bool dataFound = false;
+	XmlReader::Node subNode;
+	while(reader.nextChild(subNode))
+	{
+		if(!dataFound && subNode.isElement("data"))
 		{
-			return decodeStruct(subNode);
+			dataFound = true;
+			if(!subNode.hasContents) continue;
+			//Every child is a value, including text.
+			XmlReader::Node valueNode;
+			while(reader.nextChild(valueNode))
+			{
+				rpcArray->arrayValue->push_back(decodeParameter(reader, valueNode));
+			}
 		}
-		else if(type == "nil" || type == "ex:nil")
+		else reader.skip(subNode);
+	}
+	return rpcArray;
+}
+
+/**
+ * Decodes a "value" element and consumes it.
+ */
+PVariable decodeParameter(XmlReader& reader, const XmlReader::Node& valueNode)
+{
+	XmlReader::Node subNode;
+	if(!valueNode.hasContents || !reader.nextChild(subNode)) return std::make_shared<Variable>(VariableType::tString);
+
+	PVariable result;
+	if(subNode.type != XmlReader::NodeType::element) result = std::make_shared<Variable>(std::string(subNode.value, subNode.valueSize));
+	else
+	{
+		std::string type(subNode.name, subNode.nameSize);
+		HelperFunctions::toLower(type);
+		if(type == "array") result = decodeArray(reader, subNode);
+		else if(type == "struct") result = decodeStruct(reader, subNode);
+		else
 		{
-			return std::shared_ptr<Variable>(new Variable(VariableType::tVoid));
+			std::string value = reader.readValue(subNode);
+			if(type == "boolean") result = std::make_shared<Variable>(value == "true" || value == "1");
+			else if(type == "i4" || type == "int") result = std::make_shared<Variable>(Math::getNumber(value));
+			else if(type == "i8") result = std::make_shared<Variable>(Math::getNumber64(value));
+			else if(type == "double")
+			{
+				double number = 0;
+				try { number = std::stod(value); } catch(...) {}
+				result = std::make_shared<Variable>(number);
+			}
+			else if(type == "base64")
+			{
+				result = std::make_shared<Variable>(VariableType::tBase64);
+				result->stringValue = std::move(value);
+			}
+			else if(type == "nil" || type == "ex:nil") result = std::make_shared<Variable>(VariableType::tVoid);
+			else result = std::make_shared<Variable>(std::move(value)); //"string" or no type
 		}
-		return std::shared_ptr<Variable>(new Variable(value)); //if no type is specified return string
 	}
-	catch(const std::exception& ex)
-    {
-    	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    return std::shared_ptr<Variable>(new Variable(0));
+	reader.skipRemainingChildren();
+	return result;
 }
 
-std::shared_ptr<Variable> XmlrpcDecoder::decodeStruct(xml_node* structNode)
+/**
+ * Returns the first "value" element below "node" decoded or nullptr if there is none. Consumes "node".
+ */
+PVariable decodeFirstValue(XmlReader& reader, const XmlReader::Node& node)
 {
-	std::shared_ptr<Variable> rpcStruct(new Variable(VariableType::tStruct));
-	try
+	if(!node.hasContents) return PVariable();
+	PVariable value;
+	XmlReader::Node subNode;
+	while(reader.nextChild(subNode))
 	{
-		if(structNode == nullptr) return rpcStruct;
+		if(!value && subNode.isElement("value")) value = decodeParameter(reader, subNode);
+		else reader.skip(subNode);
+	}
+	return value;
+}
+
+/**
+ * rapidxml parses the whole document before it is evaluated, so syntax errors behind the decoded part take precedence.
+ */
+void skipRemainingDocument(XmlReader& reader)
+{
+	XmlReader::Node node;
+	while(reader.nextDocumentNode(node)) reader.skip(node);
+}
+
+}
 
-		for(xml_node* memberNode = structNode->first_node(); memberNode; memberNode = memberNode->next_sibling())
+XmlrpcDecoder::XmlrpcDecoder(BaseLib::SharedObjects* baseLib)
+{
+	_bl = baseLib;
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<Variable>>> XmlrpcDecoder::decodeRequest(const std::vector<char>& packet, std::string& methodName)
+{
+	try
+	{
+		XmlReader reader(packet.data(), packet.size());
+		XmlReader::Node node;
+		bool isMethodCall = reader.nextDocumentNode(node) && node.isElement("methodCall");
+		bool methodNameFound = false;
+		std::string name;
+		std::shared_ptr<std::vector<std::shared_ptr<Variable>>> parameters;
+		if(isMethodCall && node.hasContents)
 		{
-			xml_node* subNode = memberNode->first_node("name");
-			if(subNode == nullptr) continue;
-			std::string name(subNode->value());
-			if(name.empty()) continue;
-			subNode = subNode->next_sibling("value");
-			if(subNode == nullptr) continue;
-			std::shared_ptr<Variable> element = decodeParameter(subNode);
-			rpcStruct->structValue->insert(StructElement(name, element));
+			XmlReader::Node subNode;
+			while(reader.nextChild(subNode))
+			{
+				if(!methodNameFound && subNode.isElement("methodName"))
+				{
+					methodNameFound = true;
+					name = reader.readValue(subNode);
+				}
+				else if(!parameters && subNode.isElement("params"))
+				{
+					parameters = std::make_shared<std::vector<std::shared_ptr<Variable>>>();
+					if(!subNode.hasContents) continue;
+					XmlReader::Node paramNode;
+					while(reader.nextChild(paramNode))
+					{
+						PVariable parameter = decodeFirstValue(reader, paramNode);
+						if(parameter) parameters->push_back(std::move(parameter));
+					}
+				}
+				else reader.skip(subNode);
+			}
 		}
+		else reader.skip(node);
+		skipRemainingDocument(reader);
+
+		if(!isMethodCall) return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. First root node has to be \"methodCall\".")});
+		if(!methodNameFound) return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. Node \"methodName\" not found.")});
+		methodName = std::move(name);
+		if(methodName.empty()) return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. \"methodName\" is empty.")});
+		if(!parameters) return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. Node \"params\" not found.")});
+		return parameters;
 	}
 	catch(const std::exception& ex)
     {
     	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    	return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. Not well formed: " + std::string(ex.what()))});
     }
-	return rpcStruct;
+    return std::shared_ptr<std::vector<std::shared_ptr<Variable>>>(new std::vector<std::shared_ptr<Variable>>{Variable::createError(-32700, "Parse error. Not well formed.")});
 }
 
-std::shared_ptr<Variable> XmlrpcDecoder::decodeArray(xml_node* arrayNode)
+std::shared_ptr<Variable> XmlrpcDecoder::decodeResponse(const std::string& packet)
 {
-	std::shared_ptr<Variable> rpcArray(new Variable(VariableType::tArray));
-	try
-	{
-		if(arrayNode == nullptr) return rpcArray;
+	return decodeResponse(packet.data(), packet.size());
+}
 
-		xml_node* dataNode = arrayNode->first_node("data");
-		if(dataNode == nullptr) return rpcArray;
+std::shared_ptr<Variable> XmlrpcDecoder::decodeResponse(const std::vector<char>& packet)
+{
+	size_t startPos = 0;
+	if(!packet.empty() && packet.front() != '<')
+	{
+		for(size_t i = 0; i < packet.size(); i++)
+		{
+			if(packet[i] == '<')
+			{
+				startPos = i;
+				break;
+			}
+		}
+	}
+	return decodeResponse(packet.data() + startPos, packet.size() - startPos);
+}
 
-		for(xml_node* valueNode = dataNode->first_node(); valueNode; valueNode = valueNode->next_sibling())
+std::shared_ptr<Variable> XmlrpcDecoder::decodeResponse(const char* packet, size_t size)
+{
+	try
+	{
+		XmlReader reader(packet, size);
+		XmlReader::Node node;
+		bool isMethodResponse = reader.nextDocumentNode(node) && node.isElement("methodResponse");
+		bool paramsFound = false;
+		bool paramFound = false;
+		bool faultFound = false;
+		PVariable paramValue;
+		PVariable faultValue;
+		if(isMethodResponse && node.hasContents)
 		{
-			rpcArray->arrayValue->push_back(decodeParameter(valueNode));
+			XmlReader::Node subNode;
+			while(reader.nextChild(subNode))
+			{
+				if(!paramsFound && subNode.isElement("params"))
+				{
+					paramsFound = true;
+					if(!subNode.hasContents) continue;
+					XmlReader::Node paramNode;
+					while(reader.nextChild(paramNode))
+					{
+						if(!paramFound && paramNode.isElement("param"))
+						{
+							paramFound = true;
+							paramValue = decodeFirstValue(reader, paramNode);
+						}
+						else reader.skip(paramNode);
+					}
+				}
+				else if(!faultFound && !paramsFound && subNode.isElement("fault"))
+				{
+					faultFound = true;
+					faultValue = decodeFirstValue(reader, subNode);
+				}
+				else reader.skip(subNode);
+			}
 		}
+		else reader.skip(node);
+		skipRemainingDocument(reader);
+
+		if(!isMethodResponse) return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. First root node has to be \"methodResponse\"."));
+		if(paramsFound) return paramValue ? paramValue : std::make_shared<Variable>(VariableType::tVoid);
+		if(!faultFound) return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. Node \"fault\" and \"params\" not found."));
+		if(!faultValue) return std::make_shared<Variable>(VariableType::tVoid);
+
+		faultValue->errorStruct = true;
+		if(faultValue->structValue->find("faultCode") == faultValue->structValue->end()) faultValue->structValue->insert(StructElement("faultCode", PVariable(new Variable(-1))));
+		if(faultValue->structValue->find("faultString") == faultValue->structValue->end()) faultValue->structValue->insert(StructElement("faultString", PVariable(new Variable(std::string("undefined")))));
+		return faultValue;
 	}
 	catch(const std::exception& ex)
     {
     	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    	return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. Not well formed: " + std::string(ex.what())));
     }
-	return rpcArray;
+    return std::shared_ptr<Variable>(Variable::createError(-32700, "Parse error. Not well formed."));
 }
 
 }
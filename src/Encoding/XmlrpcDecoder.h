@@ -58,10 +58,11 @@ public:
 private:
 	BaseLib::SharedObjects* _bl = nullptr;
 
-	std::shared_ptr<Variable> decodeParameter(xml_node* valueNode);
-	std::shared_ptr<Variable> decodeArray(xml_node* dataNode);
-	std::shared_ptr<Variable> decodeStruct(xml_node* structNode);
-	std::shared_ptr<Variable> decodeResponse(xml_document* doc);
+	/**
+	 * Decodes the response directly from "packet" without building an xml_document. The result is the same as parsing
+	 * the packet with rapidxml ("parse_no_entity_translation") and walking the document.
+	 */
+	std::shared_ptr<Variable> decodeResponse(const char* packet, size_t size);
 };
 
 } /* namespace Rpc */
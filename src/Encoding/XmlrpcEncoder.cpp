@@ -31,13 +31,98 @@
 #include "XmlrpcEncoder.h"
 #include "../BaseLib.h"
 
-#include "RapidXml/rapidxml_print.hpp"
-
 namespace BaseLib
 {
 namespace Rpc
 {
 
+namespace
+{
+
+template<typename Output, size_t size>
+inline void appendLiteral(Output& output, const char (&literal)[size])
+{
+	output.insert(output.end(), literal, literal + size - 1);
+}
+
+/**
+ * Values used to be passed to rapidxml as zero terminated strings, so everything behind a null character is ignored.
+ */
+inline size_t terminatedSize(const char* data, size_t size)
+{
+	const char* nullCharacter = (const char*)std::memchr(data, 0, size);
+	return nullCharacter ? (size_t)(nullCharacter - data) : size;
+}
+
+/**
+ * Escapes the same characters as rapidxml_print. Runs of characters that don't need escaping are copied at once.
+ */
+template<typename Output>
+void appendEscaped(Output& output, const char* data, size_t size)
+{
+	const char* end = data + size;
+	const char* runStart = data;
+	for(const char* i = data; i != end; ++i)
+	{
+		switch(*i)
+		{
+			case '<':
+				output.insert(output.end(), runStart, i);
+				appendLiteral(output, "&lt;");
+				break;
+			case '>':
+				output.insert(output.end(), runStart, i);
+				appendLiteral(output, "&gt;");
+				break;
+			case '\'':
+				output.insert(output.end(), runStart, i);
+				appendLiteral(output, "&apos;");
+				break;
+			case '"':
+				output.insert(output.end(), runStart, i);
+				appendLiteral(output, "&quot;");
+				break;
+			case '&':
+				output.insert(output.end(), runStart, i);
+				appendLiteral(output, "&amp;");
+				break;
+			default:
+				continue;
+		}
+		runStart = i + 1;
+	}
+	output.insert(output.end(), runStart, end);
+}
+
+/**
+ * Appends "<name>value</name>" or "<name/>" for empty values.
+ */
+template<typename Output, size_t nameSize>
+void appendElement(Output& output, const char (&name)[nameSize], const char* value, size_t valueSize)
+{
+	valueSize = terminatedSize(value, valueSize);
+	output.push_back('<');
+	output.insert(output.end(), name, name + nameSize - 1);
+	if(valueSize == 0)
+	{
+		appendLiteral(output, "/>");
+		return;
+	}
+	output.push_back('>');
+	appendEscaped(output, value, valueSize);
+	appendLiteral(output, "</");
+	output.insert(output.end(), name, name + nameSize - 1);
+	output.push_back('>');
+}
+
+template<typename Output>
+void reserve(Output& output, size_t additionalSize)
+{
+	if(output.capacity() < output.size() + additionalSize) output.reserve(output.size() + additionalSize);
+}
+
+}
+
 XmlrpcEncoder::XmlrpcEncoder(BaseLib::SharedObjects* baseLib)
 {
 	_bl = baseLib;
@@ -45,228 +130,187 @@ XmlrpcEncoder::XmlrpcEncoder(BaseLib::SharedObjects* baseLib)
 
 void XmlrpcEncoder::encodeRequest(std::string methodName, std::shared_ptr<std::list<std::shared_ptr<Variable>>> parameters, std::vector<char>& encodedData)
 {
-	xml_document doc;
 	try
 	{
-		xml_node *node = doc.allocate_node(node_element, "methodCall");
-		doc.append_node(node);
-		xml_node *nameNode = doc.allocate_node(node_element, "methodName", methodName.c_str());
-		node->append_node(nameNode);
-		xml_node *paramsNode = doc.allocate_node(node_element, "params");
-		node->append_node(paramsNode);
-
-		for(std::list<std::shared_ptr<Variable>>::iterator i = parameters->begin(); i != parameters->end(); ++i)
-		{
-			xml_node *paramNode = doc.allocate_node(node_element, "param");
-			paramsNode->append_node(paramNode);
-			encodeVariable(&doc, paramNode, *i);
-		}
-
-		std::string temp("<?xml version=\"1.0\"?>\r\n");
-		encodedData.insert(encodedData.end(), temp.begin(), temp.end());
-		print(std::back_inserter(encodedData), doc, 1);
-		doc.clear();
+		writeRequest(methodName, parameters->begin(), parameters->end(), encodedData);
 	}
 	catch(const std::exception& ex)
     {
     	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
-    doc.clear();
 }
 
 void XmlrpcEncoder::encodeRequest(std::string methodName, std::shared_ptr<std::vector<std::shared_ptr<Variable>>> parameters, std::vector<char>& encodedData)
 {
-	xml_document doc;
 	try
 	{
-		xml_node *node = doc.allocate_node(node_element, "methodCall");
-		doc.append_node(node);
-		xml_node *nameNode = doc.allocate_node(node_element, "methodName", methodName.c_str());
-		node->append_node(nameNode);
-		xml_node *paramsNode = doc.allocate_node(node_element, "params");
-		node->append_node(paramsNode);
-
-		for(std::vector<std::shared_ptr<Variable>>::iterator i = parameters->begin(); i != parameters->end(); ++i)
-		{
-			xml_node *paramNode = doc.allocate_node(node_element, "param");
-			paramsNode->append_node(paramNode);
-			encodeVariable(&doc, paramNode, *i);
-		}
-		std::string temp("<?xml version=\"1.0\"?>\r\n");
-		encodedData.insert(encodedData.end(), temp.begin(), temp.end());
-		print(std::back_inserter(encodedData), doc, 1);
-		doc.clear();
+		writeRequest(methodName, parameters->begin(), parameters->end(), encodedData);
 	}
 	catch(const std::exception& ex)
     {
     	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
-    doc.clear();
 }
 
 void XmlrpcEncoder::encodeResponse(std::shared_ptr<Variable> variable, std::vector<char>& encodedData)
 {
-	xml_document doc;
 	try
 	{
-		xml_node *node = doc.allocate_node(node_element, "methodResponse");
-		doc.append_node(node);
-		if(variable->errorStruct)
-		{
-			xml_node *faultNode = doc.allocate_node(node_element, "fault");
-			node->append_node(faultNode);
-			encodeVariable(&doc, faultNode, variable);
-		}
-		else
-		{
-			xml_node *paramsNode = doc.allocate_node(node_element, "params");
-			node->append_node(paramsNode);
-			xml_node *paramNode = doc.allocate_node(node_element, "param");
-			paramsNode->append_node(paramNode);
-			encodeVariable(&doc, paramNode, variable);
-		}
-		print(std::back_inserter(encodedData), doc, 1);
-		doc.clear();
+		writeResponse(variable, encodedData);
 	}
 	catch(const std::exception& ex)
     {
     	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
-    doc.clear();
 }
 
 void XmlrpcEncoder::encodeResponse(std::shared_ptr<Variable> variable, std::vector<uint8_t>& encodedData)
 {
-	xml_document doc;
 	try
 	{
-		xml_node *node = doc.allocate_node(node_element, "methodResponse");
-		doc.append_node(node);
-		if(variable->errorStruct)
-		{
-			xml_node *faultNode = doc.allocate_node(node_element, "fault");
-			node->append_node(faultNode);
-			encodeVariable(&doc, faultNode, variable);
-		}
-		else
-		{
-			xml_node *paramsNode = doc.allocate_node(node_element, "params");
-			node->append_node(paramsNode);
-			xml_node *paramNode = doc.allocate_node(node_element, "param");
-			paramsNode->append_node(paramNode);
-			encodeVariable(&doc, paramNode, variable);
-		}
-		print(std::back_inserter(encodedData), doc, 1);
-		doc.clear();
+		writeResponse(variable, encodedData);
 	}
 	catch(const std::exception& ex)
 	{
 		_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
 	}
-	doc.clear();
 }
 
-void XmlrpcEncoder::encodeVariable(xml_document* doc, xml_node* node, std::shared_ptr<Variable> variable)
+template<typename Iterator>
+void XmlrpcEncoder::writeRequest(const std::string& methodName, Iterator parametersBegin, Iterator parametersEnd, std::vector<char>& encodedData)
 {
-	try
+	reserve(encodedData, 1024);
+	appendLiteral(encodedData, "<?xml version=\"1.0\"?>\r\n<methodCall>");
+	appendElement(encodedData, "methodName", methodName.c_str(), methodName.size());
+	if(parametersBegin == parametersEnd) appendLiteral(encodedData, "<params/>");
+	else
 	{
-		xml_node *valueNode = doc->allocate_node(node_element, "value");
-		node->append_node(valueNode);
-		if(!variable || variable->type == VariableType::tVoid)
-		{
-			//leave valueNode empty
-		}
-		else if(variable->type == VariableType::tInteger)
+		appendLiteral(encodedData, "<params>");
+		for(Iterator i = parametersBegin; i != parametersEnd; ++i)
 		{
-			xml_node *valueNode2 = doc->allocate_node(node_element, "i4", doc->allocate_string(std::to_string(variable->integerValue).c_str()));
-			valueNode->append_node(valueNode2);
-		}
-		else if(variable->type == VariableType::tInteger64)
-		{
-			xml_node *valueNode2 = doc->allocate_node(node_element, "i8", doc->allocate_string(std::to_string(variable->integerValue64).c_str()));
-			valueNode->append_node(valueNode2);
-		}
-		else if(variable->type == VariableType::tFloat)
-		{
-			xml_node *valueNode2 = doc->allocate_node(node_element, "double", doc->allocate_string(Math::toString(variable->floatValue).c_str()));
-			valueNode->append_node(valueNode2);
-		}
-		else if(variable->type == VariableType::tBoolean)
-		{
-			xml_node *valueNode2 = doc->allocate_node(node_element, "boolean", doc->allocate_string(std::to_string(variable->booleanValue).c_str()));
-			valueNode->append_node(valueNode2);
-		}
-		else if(variable->type == VariableType::tString)
-		{
-			//Don't allocate string. It is unnecessary, because variable->stringvalue exists until the encoding is done.
-			//xml_node *valueNode2 = doc->allocate_node(node_element, "string", variable->stringValue.c_str());
-			//valueNode->append_node(valueNode2);
-			//Some servers/clients don't understand strings in string tags - don't ask me why, so just print the value
-			valueNode->value(variable->stringValue.c_str());
-		}
-		else if(variable->type == VariableType::tBase64)
-		{
-			//Don't allocate string. It is unnecessary, because variable->stringvalue exists until the encoding is done.
-			xml_node *valueNode2 = doc->allocate_node(node_element, "base64", variable->stringValue.c_str());
-			valueNode->append_node(valueNode2);
-		}
-		else if(variable->type == VariableType::tStruct)
-		{
-			encodeStruct(doc, valueNode, variable);
-		}
-		else if(variable->type == VariableType::tArray)
-		{
-			encodeArray(doc, valueNode, variable);
+			appendLiteral(encodedData, "<param>");
+			encodeVariable(encodedData, *i);
+			appendLiteral(encodedData, "</param>");
 		}
+		appendLiteral(encodedData, "</params>");
 	}
-	catch(const std::exception& ex)
-    {
-    	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
+	appendLiteral(encodedData, "</methodCall>");
 }
 
-void XmlrpcEncoder::encodeStruct(xml_document* doc, xml_node* node, std::shared_ptr<Variable> variable)
+template<typename Output>
+void XmlrpcEncoder::writeResponse(const std::shared_ptr<Variable>& variable, Output& encodedData)
 {
-	try
+	reserve(encodedData, 1024);
+	if(variable->errorStruct)
 	{
-		xml_node *structNode = doc->allocate_node(node_element, "struct");
-		node->append_node(structNode);
-
-		for(Struct::iterator i = variable->structValue->begin(); i != variable->structValue->end(); ++i)
-		{
-			if(i->first.empty() || !i->second) continue;
-			xml_node *memberNode = doc->allocate_node(node_element, "member");
-			structNode->append_node(memberNode);
-			xml_node *nameNode = doc->allocate_node(node_element, "name", i->first.c_str());
-			memberNode->append_node(nameNode);
-			encodeVariable(doc, memberNode, i->second);
-		}
+		appendLiteral(encodedData, "<methodResponse><fault>");
+		encodeVariable(encodedData, variable);
+		appendLiteral(encodedData, "</fault></methodResponse>");
+	}
+	else
+	{
+		appendLiteral(encodedData, "<methodResponse><params><param>");
+		encodeVariable(encodedData, variable);
+		appendLiteral(encodedData, "</param></params></methodResponse>");
 	}
-	catch(const std::exception& ex)
-    {
-    	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
 }
 
-void XmlrpcEncoder::encodeArray(xml_document* doc, xml_node* node, std::shared_ptr<Variable> variable)
+template<typename Output>
+void XmlrpcEncoder::encodeVariable(Output& encodedData, const std::shared_ptr<Variable>& variable)
 {
-	try
+	if(!variable || variable->type == VariableType::tVoid)
 	{
-		xml_node *arrayNode = doc->allocate_node(node_element, "array");
-		node->append_node(arrayNode);
-
-		xml_node *dataNode = doc->allocate_node(node_element, "data");
-		arrayNode->append_node(dataNode);
+		appendLiteral(encodedData, "<value/>");
+	}
+	else if(variable->type == VariableType::tInteger)
+	{
+		appendLiteral(encodedData, "<value><i4>");
+		std::string value = std::to_string(variable->integerValue);
+		encodedData.insert(encodedData.end(), value.begin(), value.end());
+		appendLiteral(encodedData, "</i4></value>");
+	}
+	else if(variable->type == VariableType::tInteger64)
+	{
+		appendLiteral(encodedData, "<value><i8>");
+		std::string value = std::to_string(variable->integerValue64);
+		encodedData.insert(encodedData.end(), value.begin(), value.end());
+		appendLiteral(encodedData, "</i8></value>");
+	}
+	else if(variable->type == VariableType::tFloat)
+	{
+		appendLiteral(encodedData, "<value>");
+		std::string value = Math::toString(variable->floatValue);
+		appendElement(encodedData, "double", value.c_str(), value.size());
+		appendLiteral(encodedData, "</value>");
+	}
+	else if(variable->type == VariableType::tBoolean)
+	{
+		if(variable->booleanValue) appendLiteral(encodedData, "<value><boolean>1</boolean></value>");
+		else appendLiteral(encodedData, "<value><boolean>0</boolean></value>");
+	}
+	else if(variable->type == VariableType::tString)
+	{
+		//Some servers/clients don't understand strings in string tags - don't ask me why, so just print the value
+		BufferView value = variable->getDataView();
+		appendElement(encodedData, "value", (const char*)value.data(), value.size());
+	}
+	else if(variable->type == VariableType::tBase64)
+	{
+		BufferView value = variable->getDataView();
+		appendLiteral(encodedData, "<value>");
+		appendElement(encodedData, "base64", (const char*)value.data(), value.size());
+		appendLiteral(encodedData, "</value>");
+	}
+	else if(variable->type == VariableType::tStruct)
+	{
+		appendLiteral(encodedData, "<value>");
+		encodeStruct(encodedData, variable);
+		appendLiteral(encodedData, "</value>");
+	}
+	else if(variable->type == VariableType::tArray)
+	{
+		appendLiteral(encodedData, "<value>");
+		encodeArray(encodedData, variable);
+		appendLiteral(encodedData, "</value>");
+	}
+	else appendLiteral(encodedData, "<value/>");
+}
 
-		for(std::vector<std::shared_ptr<Variable>>::iterator i = variable->arrayValue->begin(); i != variable->arrayValue->end(); ++i)
+template<typename Output>
+void XmlrpcEncoder::encodeStruct(Output& encodedData, const std::shared_ptr<Variable>& variable)
+{
+	bool empty = true;
+	for(Struct::iterator i = variable->structValue->begin(); i != variable->structValue->end(); ++i)
+	{
+		if(i->first.empty() || !i->second) continue;
+		if(empty)
 		{
-			encodeVariable(doc, dataNode, *i);
+			appendLiteral(encodedData, "<struct>");
+			empty = false;
 		}
+		appendLiteral(encodedData, "<member>");
+		appendElement(encodedData, "name", i->first.c_str(), i->first.size());
+		encodeVariable(encodedData, i->second);
+		appendLiteral(encodedData, "</member>");
 	}
-	catch(const std::exception& ex)
-    {
-    	_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
+	if(empty) appendLiteral(encodedData, "<struct/>");
+	else appendLiteral(encodedData, "</struct>");
+}
+
+template<typename Output>
+void XmlrpcEncoder::encodeArray(Output& encodedData, const std::shared_ptr<Variable>& variable)
+{
+	if(variable->arrayValue->empty())
+	{
+		appendLiteral(encodedData, "<array><data/></array>");
+		return;
+	}
+	appendLiteral(encodedData, "<array><data>");
+	for(std::vector<std::shared_ptr<Variable>>::iterator i = variable->arrayValue->begin(); i != variable->arrayValue->end(); ++i)
+	{
+		encodeVariable(encodedData, *i);
+	}
+	appendLiteral(encodedData, "</data></array>");
 }
 
 }
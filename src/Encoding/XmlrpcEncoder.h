@@ -61,9 +61,13 @@ public:
 private:
 	BaseLib::SharedObjects* _bl = nullptr;
 
-	void encodeVariable(xml_document* doc, xml_node* node, std::shared_ptr<Variable> variable);
-	void encodeStruct(xml_document* doc, xml_node* node, std::shared_ptr<Variable> variable);
-	void encodeArray(xml_document* doc, xml_node* node, std::shared_ptr<Variable> variable);
+	//The XML is written directly into the output buffer without building an xml_document first. The output matches
+	//rapidxml_print with "print_no_indenting".
+	template<typename Iterator> static void writeRequest(const std::string& methodName, Iterator parametersBegin, Iterator parametersEnd, std::vector<char>& encodedData);
+	template<typename Output> static void writeResponse(const std::shared_ptr<Variable>& variable, Output& encodedData);
+	template<typename Output> static void encodeVariable(Output& encodedData, const std::shared_ptr<Variable>& variable);
+	template<typename Output> static void encodeStruct(Output& encodedData, const std::shared_ptr<Variable>& variable);
+	template<typename Output> static void encodeArray(Output& encodedData, const std::shared_ptr<Variable>& variable);
 };
 
 }
@@ -23,245 +23,477 @@
 
    René Nyffenegger rene.nyffenegger@adp-gmbh.ch
 
+   Altered for libhomegear-base: Table driven encoding and decoding with SIMD
+   acceleration and chunk by chunk encoders and decoders.
+
 */
 
 #include "Base64.h"
 
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace BaseLib
 {
-static const std::string base64_chars =
-             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-             "abcdefghijklmnopqrstuvwxyz"
-             "0123456789+/";
 
-void Base64::encode(const std::string& in, std::string& out)
+namespace
 {
-	out.clear();
-	//Formula from Wikipedia +1 for "\0"
-	out.reserve(4*((in.size() + 2)/3) + 1);
-	int in_len = in.size();
-	int pos = 0;
-	int i = 0;
-	int j = 0;
-	unsigned char char_array_3[3];
-	unsigned char char_array_4[4];
-
-	while (in_len--)
-	{
-		char_array_3[i++] = in[pos++];
-		if (i == 3)
-		{
-			char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-			char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-			char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-			char_array_4[3] = char_array_3[2] & 0x3f;
-
-			for(i = 0; (i <4) ; i++)
-				out.push_back(base64_chars[char_array_4[i]]);
-			i = 0;
-		}
-	}
-
-	if (i)
-	{
-	for(j = i; j < 3; j++)
-		char_array_3[j] = '\0';
 
-	char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-	char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-	char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-	char_array_4[3] = char_array_3[2] & 0x3f;
+const char encodingTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-	for (j = 0; (j < i + 1); j++)
-		out.push_back(base64_chars[char_array_4[j]]);
+/**
+ * Maps characters to their 6 bit value. 0xFF marks characters that are not Base64, including "=".
+ */
+const uint8_t decodingTable[256] =
+{
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,   62, 0xFF, 0xFF, 0xFF,   63,
+	  52,   53,   54,   55,   56,   57,   58,   59,   60,   61, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF,    0,    1,    2,    3,    4,    5,    6,    7,    8,    9,   10,   11,   12,   13,   14,
+	  15,   16,   17,   18,   19,   20,   21,   22,   23,   24,   25, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF,   26,   27,   28,   29,   30,   31,   32,   33,   34,   35,   36,   37,   38,   39,   40,
+	  41,   42,   43,   44,   45,   46,   47,   48,   49,   50,   51, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+inline size_t encodedSize(size_t size)
+{
+	return ((size + 2) / 3) * 4;
+}
 
-	while((i++ < 3))
-		out.push_back('=');
+#if defined(__SSSE3__)
 
+/**
+ * Encodes 12 bytes per iteration. As 16 bytes are loaded, the last four bytes of "in" are left to the caller.
+ *
+ * @return Returns the number of bytes encoded.
+ */
+size_t encodeBlocks(const uint8_t* in, size_t size, char* out)
+{
+	const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+	size_t i = 0;
+	for(; size - i >= 16; i += 12, out += 16)
+	{
+		//Split each group of three bytes into four 6 bit indices (one per byte).
+		__m128i data = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(in + i)), shuffle);
+		const __m128i high = _mm_mulhi_epu16(_mm_and_si128(data, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+		const __m128i low = _mm_mullo_epi16(_mm_and_si128(data, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+		const __m128i indices = _mm_or_si128(high, low);
+
+		//"A" for 0-25, "a" for 26-51, "0" for 52-61, "+" for 62 and "/" for 63.
+		__m128i offset = _mm_set1_epi8(65);
+		offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(indices, _mm_set1_epi8(25)), _mm_set1_epi8(6)));
+		offset = _mm_sub_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(indices, _mm_set1_epi8(51)), _mm_set1_epi8(75)));
+		offset = _mm_sub_epi8(offset, _mm_and_si128(_mm_cmpeq_epi8(indices, _mm_set1_epi8(62)), _mm_set1_epi8(15)));
+		offset = _mm_sub_epi8(offset, _mm_and_si128(_mm_cmpeq_epi8(indices, _mm_set1_epi8(63)), _mm_set1_epi8(12)));
+		_mm_storeu_si128((__m128i*)out, _mm_add_epi8(indices, offset));
 	}
+	return i;
 }
 
-void Base64::encode(const std::vector<char>& in, std::string& out)
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+
+/**
+ * Encodes 48 bytes per iteration.
+ *
+ * @return Returns the number of bytes encoded.
+ */
+size_t encodeBlocks(const uint8_t* in, size_t size, char* out)
 {
-	out.clear();
-	//Formula from Wikipedia +1 for "\0"
-	out.reserve(4*((in.size() + 2)/3) + 1);
-	int in_len = in.size();
-	int pos = 0;
-	int i = 0;
-	int j = 0;
-	unsigned char char_array_3[3];
-	unsigned char char_array_4[4];
-
-	while (in_len--)
+	uint8x16x4_t table;
+	for(int32_t i = 0; i < 4; i++)
 	{
-		char_array_3[i++] = in[pos++];
-		if (i == 3)
-		{
-			char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-			char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-			char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-			char_array_4[3] = char_array_3[2] & 0x3f;
-
-			for(i = 0; (i <4) ; i++)
-				out.push_back(base64_chars[char_array_4[i]]);
-			i = 0;
-		}
+		table.val[i] = vld1q_u8((const uint8_t*)encodingTable + (i * 16));
 	}
-
-	if (i)
+	const uint8x16_t mask = vdupq_n_u8(0x3F);
+	size_t i = 0;
+	for(; size - i >= 48; i += 48, out += 64)
 	{
-	for(j = i; j < 3; j++)
-		char_array_3[j] = '\0';
+		const uint8x16x3_t data = vld3q_u8(in + i);
+		uint8x16x4_t result;
+		result.val[0] = vqtbl4q_u8(table, vshrq_n_u8(data.val[0], 2));
+		result.val[1] = vqtbl4q_u8(table, vandq_u8(vorrq_u8(vshlq_n_u8(data.val[0], 4), vshrq_n_u8(data.val[1], 4)), mask));
+		result.val[2] = vqtbl4q_u8(table, vandq_u8(vorrq_u8(vshlq_n_u8(data.val[1], 2), vshrq_n_u8(data.val[2], 6)), mask));
+		result.val[3] = vqtbl4q_u8(table, vandq_u8(data.val[2], mask));
+		vst4q_u8((uint8_t*)out, result);
+	}
+	return i;
+}
 
-	char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-	char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-	char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-	char_array_4[3] = char_array_3[2] & 0x3f;
+#else
 
-	for (j = 0; (j < i + 1); j++)
-		out.push_back(base64_chars[char_array_4[j]]);
+size_t encodeBlocks(const uint8_t*, size_t, char*)
+{
+	return 0;
+}
 
-	while((i++ < 3))
-		out.push_back('=');
+#endif
 
+/**
+ * Encodes all complete groups of three bytes.
+ *
+ * @return Returns the number of bytes encoded.
+ */
+size_t encodeGroups(const uint8_t* in, size_t size, char* out)
+{
+	size_t i = encodeBlocks(in, size, out);
+	out += (i / 3) * 4;
+	for(; size - i >= 3; i += 3, out += 4)
+	{
+		const uint32_t group = ((uint32_t)in[i] << 16) | ((uint32_t)in[i + 1] << 8) | in[i + 2];
+		out[0] = encodingTable[group >> 18];
+		out[1] = encodingTable[(group >> 12) & 0x3F];
+		out[2] = encodingTable[(group >> 6) & 0x3F];
+		out[3] = encodingTable[group & 0x3F];
 	}
+	return i;
 }
 
-void Base64::encode(const std::vector<uint8_t>& in, std::string& out)
+/**
+ * Encodes the last one or two bytes including padding.
+ */
+void encodeRemainder(const uint8_t* in, size_t size, char* out)
 {
-	out.clear();
-	//Formula from Wikipedia +1 for "\0"
-	out.reserve(4*((in.size() + 2)/3) + 1);
-	int in_len = in.size();
-	int pos = 0;
-	int i = 0;
-	int j = 0;
-	unsigned char char_array_3[3];
-	unsigned char char_array_4[4];
-
-	while (in_len--)
+	const uint32_t group = ((uint32_t)in[0] << 16) | (size == 2 ? (uint32_t)in[1] << 8 : 0);
+	out[0] = encodingTable[group >> 18];
+	out[1] = encodingTable[(group >> 12) & 0x3F];
+	out[2] = size == 2 ? encodingTable[(group >> 6) & 0x3F] : '=';
+	out[3] = '=';
+}
+
+void encode(const uint8_t* in, size_t size, std::string& out)
+{
+	out.resize(encodedSize(size));
+	if(size == 0) return;
+	const size_t encoded = encodeGroups(in, size, &out[0]);
+	if(encoded < size) encodeRemainder(in + encoded, size - encoded, &out[(encoded / 3) * 4]);
+}
+
+#if defined(__SSE2__)
+
+/**
+ * Decodes 16 characters per iteration and stops in front of the first block containing a character that is not Base64.
+ *
+ * @return Returns the number of characters decoded.
+ */
+size_t decodeBlocks(const char* in, size_t size, uint8_t* out)
+{
+	size_t i = 0;
+	for(; size - i >= 16; i += 16, out += 12)
 	{
-		char_array_3[i++] = in[pos++];
-		if (i == 3)
+		//Signed comparisons, so characters above 127 are in none of the ranges.
+		const __m128i data = _mm_loadu_si128((const __m128i*)(in + i));
+		const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(data, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(data, _mm_set1_epi8('Z' + 1)));
+		const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(data, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(data, _mm_set1_epi8('z' + 1)));
+		const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(data, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(data, _mm_set1_epi8('9' + 1)));
+		const __m128i plus = _mm_cmpeq_epi8(data, _mm_set1_epi8('+'));
+		const __m128i slash = _mm_cmpeq_epi8(data, _mm_set1_epi8('/'));
+		if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)), slash)) != 0xFFFF) break;
+
+		__m128i offset = _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-65)), _mm_and_si128(lower, _mm_set1_epi8(-71)));
+		offset = _mm_or_si128(offset, _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(4)), _mm_and_si128(plus, _mm_set1_epi8(19))));
+		offset = _mm_or_si128(offset, _mm_and_si128(slash, _mm_set1_epi8(16)));
+		const __m128i values = _mm_add_epi8(data, offset);
+
+		//Merge the four 6 bit values of each 32 bit lane into 24 bits.
+		__m128i merged = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0x00FF)), 6), _mm_srli_epi16(values, 8));
+		merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+
+#if defined(__SSSE3__)
+		merged = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		_mm_storel_epi64((__m128i*)out, merged);
+		const uint32_t last = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(merged, 8));
+		std::memcpy(out + 8, &last, 4);
+#else
+		uint32_t groups[4];
+		_mm_storeu_si128((__m128i*)groups, merged);
+		for(int32_t j = 0; j < 4; j++)
 		{
-			char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-			char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-			char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-			char_array_4[3] = char_array_3[2] & 0x3f;
-
-			for(i = 0; (i <4) ; i++)
-				out.push_back(base64_chars[char_array_4[i]]);
-			i = 0;
+			out[j * 3] = (uint8_t)(groups[j] >> 16);
+			out[j * 3 + 1] = (uint8_t)(groups[j] >> 8);
+			out[j * 3 + 2] = (uint8_t)groups[j];
 		}
+#endif
 	}
+	return i;
+}
+
+#elif defined(__aarch64__) && defined(__ARM_NEON)
 
-	if (i)
+inline uint8x16_t inRange(uint8x16_t data, uint8_t first, uint8_t last)
+{
+	return vandq_u8(vcgeq_u8(data, vdupq_n_u8(first)), vcleq_u8(data, vdupq_n_u8(last)));
+}
+
+/**
+ * Translates 16 characters to their 6 bit values. Returns "false" when one of the characters is not Base64.
+ */
+inline bool translate(uint8x16_t& data)
+{
+	const uint8x16_t upper = inRange(data, 'A', 'Z');
+	const uint8x16_t lower = inRange(data, 'a', 'z');
+	const uint8x16_t digit = inRange(data, '0', '9');
+	const uint8x16_t plus = vceqq_u8(data, vdupq_n_u8('+'));
+	const uint8x16_t slash = vceqq_u8(data, vdupq_n_u8('/'));
+	if(vminvq_u8(vorrq_u8(vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, plus)), slash)) != 0xFF) return false;
+
+	uint8x16_t offset = vorrq_u8(vandq_u8(upper, vdupq_n_u8((uint8_t)-65)), vandq_u8(lower, vdupq_n_u8((uint8_t)-71)));
+	offset = vorrq_u8(offset, vorrq_u8(vandq_u8(digit, vdupq_n_u8(4)), vandq_u8(plus, vdupq_n_u8(19))));
+	offset = vorrq_u8(offset, vandq_u8(slash, vdupq_n_u8(16)));
+	data = vaddq_u8(data, offset);
+	return true;
+}
+
+/**
+ * Decodes 64 characters per iteration and stops in front of the first block containing a character that is not Base64.
+ *
+ * @return Returns the number of characters decoded.
+ */
+size_t decodeBlocks(const char* in, size_t size, uint8_t* out)
+{
+	size_t i = 0;
+	for(; size - i >= 64; i += 64, out += 48)
 	{
-	for(j = i; j < 3; j++)
-		char_array_3[j] = '\0';
+		uint8x16x4_t data = vld4q_u8((const uint8_t*)in + i);
+		if(!translate(data.val[0]) || !translate(data.val[1]) || !translate(data.val[2]) || !translate(data.val[3])) break;
+		uint8x16x3_t result;
+		result.val[0] = vorrq_u8(vshlq_n_u8(data.val[0], 2), vshrq_n_u8(data.val[1], 4));
+		result.val[1] = vorrq_u8(vshlq_n_u8(data.val[1], 4), vshrq_n_u8(data.val[2], 2));
+		result.val[2] = vorrq_u8(vshlq_n_u8(data.val[2], 6), data.val[3]);
+		vst3q_u8(out, result);
+	}
+	return i;
+}
 
-	char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-	char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-	char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-	char_array_4[3] = char_array_3[2] & 0x3f;
+#else
 
-	for (j = 0; (j < i + 1); j++)
-		out.push_back(base64_chars[char_array_4[j]]);
+size_t decodeBlocks(const char*, size_t, uint8_t*)
+{
+	return 0;
+}
 
-	while((i++ < 3))
-		out.push_back('=');
+#endif
 
+/**
+ * Decodes complete groups of four characters and stops in front of the first group containing a character that is not Base64.
+ *
+ * @return Returns the number of characters decoded.
+ */
+size_t decodeGroups(const char* in, size_t size, uint8_t* out)
+{
+	size_t i = decodeBlocks(in, size, out);
+	out += (i / 4) * 3;
+	for(; size - i >= 4; i += 4, out += 3)
+	{
+		const uint32_t a = decodingTable[(uint8_t)in[i]];
+		const uint32_t b = decodingTable[(uint8_t)in[i + 1]];
+		const uint32_t c = decodingTable[(uint8_t)in[i + 2]];
+		const uint32_t d = decodingTable[(uint8_t)in[i + 3]];
+		if((a | b | c | d) & 0x80) break;
+		const uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+		out[0] = (uint8_t)(group >> 16);
+		out[1] = (uint8_t)(group >> 8);
+		out[2] = (uint8_t)group;
 	}
+	return i;
 }
 
-void Base64::decode(const std::string& in, std::string& out)
+/**
+ * Returns the number of Base64 characters at the beginning of "in", but at most "maxSize".
+ */
+size_t validSize(const char* in, size_t size, size_t maxSize)
 {
-	int in_len = in.size();
-	int i = 0;
-	int j = 0;
-	int in_ = 0;
-	unsigned char char_array_4[4], char_array_3[3];
-	out.clear();
-	//Formula from encode reversed, +1 for "\0"
-	out.reserve(((in.size() * 3) / 4) - 2 + 1);
+	size_t i = 0;
+	while(i < size && i < maxSize && decodingTable[(uint8_t)in[i]] != 0xFF) i++;
+	return i;
+}
 
-	while (in_len-- && ( in[in_] != '=') && isBase64(in[in_]))
-	{
-		char_array_4[i++] = in[in_]; in_++;
-		if (i ==4)
-		{
-			for (i = 0; i <4; i++)
-				char_array_4[i] = base64_chars.find(char_array_4[i]);
+/**
+ * Decodes an incomplete group of up to three characters. A single character doesn't contain a complete byte.
+ *
+ * @return Returns the number of bytes written.
+ */
+size_t decodeRemainder(const char* in, size_t size, uint8_t* out)
+{
+	if(size < 2) return 0;
+	const uint32_t group = ((uint32_t)decodingTable[(uint8_t)in[0]] << 18) | ((uint32_t)decodingTable[(uint8_t)in[1]] << 12) | (size == 3 ? (uint32_t)decodingTable[(uint8_t)in[2]] << 6 : 0);
+	out[0] = (uint8_t)(group >> 16);
+	if(size == 3) out[1] = (uint8_t)(group >> 8);
+	return size - 1;
+}
 
-			char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-			char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-			char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+template<typename Output>
+void decode(const std::string& in, Output& out)
+{
+	out.clear();
+	if(in.empty()) return;
+	out.resize((in.size() / 4) * 3 + 2);
+	uint8_t* data = (uint8_t*)&out[0];
+	const size_t decoded = decodeGroups(in.data(), in.size(), data);
+	size_t outputSize = (decoded / 4) * 3;
+	outputSize += decodeRemainder(in.data() + decoded, validSize(in.data() + decoded, in.size() - decoded, 3), data + outputSize);
+	out.resize(outputSize);
+}
 
-			for (i = 0; (i < 3); i++)
-				out.push_back(char_array_3[i]);
-			i = 0;
-		}
-	}
+}
 
-	if (i)
-	{
-		for (j = i; j <4; j++)
-			char_array_4[j] = 0;
+void Base64::encode(const std::string& in, std::string& out)
+{
+	BaseLib::encode((const uint8_t*)in.data(), in.size(), out);
+}
 
-		for (j = 0; j <4; j++)
-			char_array_4[j] = base64_chars.find(char_array_4[j]);
+void Base64::encode(const std::vector<char>& in, std::string& out)
+{
+	BaseLib::encode((const uint8_t*)in.data(), in.size(), out);
+}
 
-		char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-		char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-		char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+void Base64::encode(const std::vector<uint8_t>& in, std::string& out)
+{
+	BaseLib::encode(in.data(), in.size(), out);
+}
 
-		for (j = 0; (j < i - 1); j++) out.push_back(char_array_3[j]);
-	}
+void Base64::decode(const std::string& in, std::string& out)
+{
+	BaseLib::decode(in, out);
 }
 
 void Base64::decode(const std::string& in, std::vector<char>& out)
 {
-	int in_len = in.size();
-	int i = 0;
-	int j = 0;
-	int in_ = 0;
-	unsigned char char_array_4[4], char_array_3[3];
-	out.clear();
-	//Formula from encode reversed, +1 for "\0"
-	out.reserve(((in.size() * 3) / 4) - 2 + 1);
+	BaseLib::decode(in, out);
+}
 
-	while (in_len-- && ( in[in_] != '=') && isBase64(in[in_]))
+void Base64::Encoder::encode(const char* data, size_t size, std::string& out)
+{
+	const uint8_t* in = (const uint8_t*)data;
+	const size_t outputStart = out.size();
+	out.resize(outputStart + ((_remainderSize + size) / 3) * 4);
+	char* output = &out[0] + outputStart;
+
+	if(_remainderSize > 0)
 	{
-		char_array_4[i++] = in[in_]; in_++;
-		if (i ==4)
+		if(_remainderSize + size < 3)
 		{
-			for (i = 0; i <4; i++)
-				char_array_4[i] = base64_chars.find(char_array_4[i]);
+			std::memcpy(_remainder + _remainderSize, in, size);
+			_remainderSize += size;
+			return;
+		}
+		uint8_t group[3];
+		std::memcpy(group, _remainder, _remainderSize);
+		std::memcpy(group + _remainderSize, in, 3 - _remainderSize);
+		encodeGroups(group, 3, output);
+		output += 4;
+		in += 3 - _remainderSize;
+		size -= 3 - _remainderSize;
+		_remainderSize = 0;
+	}
+
+	const size_t encoded = encodeGroups(in, size, output);
+	_remainderSize = size - encoded;
+	if(_remainderSize > 0) std::memcpy(_remainder, in + encoded, _remainderSize);
+}
+
+void Base64::Encoder::finish(std::string& out)
+{
+	if(_remainderSize > 0)
+	{
+		out.resize(out.size() + 4);
+		encodeRemainder(_remainder, _remainderSize, &out[out.size() - 4]);
+	}
+	_remainderSize = 0;
+}
 
-			char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-			char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-			char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+template<typename Output>
+void Base64::Decoder::append(const char* data, size_t size, Output& out)
+{
+	if(_finished || size == 0) return;
+	const size_t outputStart = out.size();
+	out.resize(outputStart + ((_bufferSize + size) / 4) * 3 + 2);
+	uint8_t* output = (uint8_t*)&out[0] + outputStart;
 
-			for (i = 0; (i < 3); i++)
-				out.push_back(char_array_3[i]);
-			i = 0;
+	if(_bufferSize > 0)
+	{
+		const size_t required = 4 - _bufferSize;
+		const size_t valid = validSize(data, size, required);
+		std::memcpy(_buffer + _bufferSize, data, valid);
+		_bufferSize += valid;
+		if(valid < required && valid < size)
+		{
+			output += decodeRemainder(_buffer, _bufferSize, output);
+			_bufferSize = 0;
+			_finished = true;
 		}
+		else if(_bufferSize == 4)
+		{
+			output += (decodeGroups(_buffer, 4, output) / 4) * 3;
+			_bufferSize = 0;
+		}
+		data += valid;
+		size -= valid;
 	}
 
-	if (i)
+	if(!_finished && size > 0)
 	{
-		for (j = i; j <4; j++)
-			char_array_4[j] = 0;
+		const size_t decoded = decodeGroups(data, size, output);
+		output += (decoded / 4) * 3;
+		data += decoded;
+		size -= decoded;
+		const size_t valid = validSize(data, size, 3);
+		if(valid < size)
+		{
+			output += decodeRemainder(data, valid, output);
+			_finished = true;
+		}
+		else
+		{
+			std::memcpy(_buffer, data, valid);
+			_bufferSize = valid;
+		}
+	}
 
-		for (j = 0; j <4; j++)
-			char_array_4[j] = base64_chars.find(char_array_4[j]);
+	out.resize(output - (uint8_t*)&out[0]);
+}
 
-		char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-		char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-		char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+template<typename Output>
+void Base64::Decoder::flush(Output& out)
+{
+	const size_t outputStart = out.size();
+	out.resize(outputStart + 2);
+	out.resize(outputStart + decodeRemainder(_buffer, _bufferSize, (uint8_t*)&out[0] + outputStart));
+	_bufferSize = 0;
+	_finished = false;
+}
 
-		for (j = 0; (j < i - 1); j++) out.push_back(char_array_3[j]);
-	}
+void Base64::Decoder::decode(const char* data, size_t size, std::string& out)
+{
+	append(data, size, out);
+}
+
+void Base64::Decoder::decode(const char* data, size_t size, std::vector<char>& out)
+{
+	append(data, size, out);
 }
+
+void Base64::Decoder::finish(std::string& out)
+{
+	flush(out);
+}
+
+void Base64::Decoder::finish(std::vector<char>& out)
+{
+	flush(out);
+}
+
 }
@@ -23,6 +23,9 @@
 
    René Nyffenegger rene.nyffenegger@adp-gmbh.ch
 
+   Altered for libhomegear-base: Table driven encoding and decoding with SIMD
+   acceleration and chunk by chunk encoders and decoders.
+
 */
 
 #ifndef BASE64_H_
@@ -77,18 +80,80 @@ public:
 	 * @param[out] out The char vector the result is stored in.
 	 */
 	static void decode(const std::string& in, std::vector<char>& out);
-private:
-	Base64() {}
 
 	/**
-	 * Checks whether a character is Base64 decodeable.
-	 *
-	 * @param c The character to check.
-	 * @return Returns "true" when the character is decodeable, otherwise "false".
+	 * Encodes data chunk by chunk, so large inputs don't need to be held in memory at once. The concatenated output
+	 * of all calls equals the output of Base64::encode() for the concatenated input.
 	 */
-	static inline bool isBase64(unsigned char c) {
-		return (isalnum(c) || (c == '+') || (c == '/'));
-	}
+	class Encoder
+	{
+	public:
+		Encoder() = default;
+		virtual ~Encoder() = default;
+
+		/**
+		 * Encodes the next chunk and appends the result to "out". Up to two bytes are kept until the next call or finish().
+		 *
+		 * @param[in] data The binary data to encode.
+		 * @param[in] size The size of "data".
+		 * @param[out] out The string the result is appended to.
+		 */
+		void encode(const char* data, size_t size, std::string& out);
+
+		/**
+		 * Appends the kept bytes including padding to "out" and resets the encoder.
+		 *
+		 * @param[out] out The string the result is appended to.
+		 */
+		void finish(std::string& out);
+	private:
+		uint8_t _remainder[2];
+		size_t _remainderSize = 0;
+	};
+
+	/**
+	 * Decodes data chunk by chunk, so large inputs don't need to be held in memory at once. The concatenated output
+	 * of all calls equals the output of Base64::decode() for the concatenated input. Like Base64::decode() the decoder
+	 * stops at "=" or the first character that is not Base64.
+	 */
+	class Decoder
+	{
+	public:
+		Decoder() = default;
+		virtual ~Decoder() = default;
+
+		/**
+		 * Returns "true" when "=" or a character that is not Base64 was found. All further input is ignored until finish() is called.
+		 */
+		bool isFinished() { return _finished; }
+
+		/**
+		 * Decodes the next chunk and appends the result to "out". Up to three characters are kept until the next call or finish().
+		 *
+		 * @param[in] data The data to decode.
+		 * @param[in] size The size of "data".
+		 * @param[out] out The string or char vector the result is appended to.
+		 */
+		void decode(const char* data, size_t size, std::string& out);
+		void decode(const char* data, size_t size, std::vector<char>& out);
+
+		/**
+		 * Appends the bytes of the kept characters to "out" and resets the decoder.
+		 *
+		 * @param[out] out The string or char vector the result is appended to.
+		 */
+		void finish(std::string& out);
+		void finish(std::vector<char>& out);
+	private:
+		char _buffer[4];
+		size_t _bufferSize = 0;
+		bool _finished = false;
+
+		template<typename Output> void append(const char* data, size_t size, Output& out);
+		template<typename Output> void flush(Output& out);
+	};
+private:
+	Base64() {}
 };
 
 }
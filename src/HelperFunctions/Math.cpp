@@ -31,11 +31,30 @@
 #include "Math.h"
 #include "HelperFunctions.h"
 
+#include <cctype>
 #include <iomanip>
 
 namespace BaseLib
 {
 
+namespace
+{
+
+/**
+ * Returns "false" when std::stoll() would throw std::invalid_argument, i. e. when there is no digit after leading
+ * whitespace and the sign. Most strings passed to getNumber64() are no numbers and exceptions are expensive.
+ */
+bool hasDigit(const std::string& s, bool isHex)
+{
+	auto i = s.begin();
+	while(i != s.end() && std::isspace((unsigned char)*i)) ++i;
+	if(i != s.end() && (*i == '-' || *i == '+')) ++i;
+	if(i == s.end()) return false;
+	return isHex ? std::isxdigit((unsigned char)*i) : std::isdigit((unsigned char)*i);
+}
+
+}
+
 Math::Point2D::Point2D(const std::string& s)
 {
 	std::vector<std::string> elements = HelperFunctions::splitAll(s, ';');
@@ -223,6 +242,7 @@ int64_t Math::getNumber64(const std::string& s, bool isHex)
 {
 	auto xpos = s.find('x');
 	int64_t number = 0;
+	if(!hasDigit(s, xpos != std::string::npos || isHex)) return number;
 	if(xpos == std::string::npos && !isHex) try { number = std::stoll(s, 0, 10); } catch(...) {}
 	else try { number = std::stoll(s, 0, 16); } catch(...) {}
 	return number;
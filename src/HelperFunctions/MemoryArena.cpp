@@ -0,0 +1,114 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "MemoryArena.h"
+
+namespace BaseLib
+{
+
+namespace
+{
+	thread_local MemoryArena::Scope* currentScope = nullptr;
+}
+
+constexpr size_t MemoryArena::_scopeReferences;
+
+MemoryArena::Scope::Scope(size_t maxBlockSize) : _outerScope(currentScope), _maxBlockSize(maxBlockSize)
+{
+	if(!_outerScope) currentScope = this;
+}
+
+MemoryArena::Scope::~Scope()
+{
+	if(_outerScope) return;
+	currentScope = nullptr;
+	if(_arena) _arena->close();
+}
+
+MemoryArena* MemoryArena::Scope::arena()
+{
+	if(_outerScope) return _outerScope->arena();
+	if(!_arena) _arena = new MemoryArena(_maxBlockSize);
+	return _arena;
+}
+
+MemoryArena::MemoryArena(size_t maxBlockSize) : _maxBlockSize(maxBlockSize < 1024 ? 1024 : maxBlockSize)
+{
+}
+
+MemoryArena* MemoryArena::current()
+{
+	return currentScope ? currentScope->arena() : nullptr;
+}
+
+char* MemoryArena::align(char* pointer, size_t alignment)
+{
+	uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+	return pointer + ((alignment - (address % alignment)) % alignment);
+}
+
+void* MemoryArena::allocate(size_t size, size_t alignment)
+{
+	char* pointer = _position ? align(_position, alignment) : nullptr;
+	if(!pointer || pointer + size > _end)
+	{
+		if(size + alignment > _nextBlockSize / 4)
+		{
+			//Large allocations get their own block, so the current block is not abandoned
+			_blocks.emplace_back(new char[size + alignment]);
+			_reservedBytes += size + alignment;
+			_allocations++;
+			return align(_blocks.back().get(), alignment);
+		}
+
+		_blocks.emplace_back(new char[_nextBlockSize]);
+		_reservedBytes += _nextBlockSize;
+		_end = _blocks.back().get() + _nextBlockSize;
+		pointer = align(_blocks.back().get(), alignment);
+		if(_nextBlockSize < _maxBlockSize) _nextBlockSize = _nextBlockSize * 2 < _maxBlockSize ? _nextBlockSize * 2 : _maxBlockSize;
+	}
+	_position = pointer + size;
+	_allocations++;
+	return pointer;
+}
+
+void MemoryArena::release() noexcept
+{
+	if(_references.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+}
+
+void MemoryArena::close() noexcept
+{
+	//Replace the placeholder by the number of objects allocated. Objects already released have been subtracted before.
+	size_t placeholderExcess = _scopeReferences - _allocations;
+	if(_references.fetch_sub(placeholderExcess, std::memory_order_acq_rel) == placeholderExcess) delete this;
+}
+
+}
@@ -0,0 +1,187 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LIBHOMEGEAR_BASE_MEMORYARENA_H_
+#define LIBHOMEGEAR_BASE_MEMORYARENA_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace BaseLib
+{
+
+/**
+ * Bump allocator for objects that die together, e. g. the Variable tree of an RPC request. Memory is only returned
+ * when the last object allocated from the arena is destroyed. Then all blocks are freed in one step.
+ *
+ * An arena belongs to the MemoryArena::Scope that created it and is only allocated from on the scope's thread, so
+ * allocation needs no locking. Objects may be released on any thread. Each of them holds a plain pointer to the arena
+ * and decrements its atomic object count once when it is released. There is no reference counting per copy of the
+ * allocator.
+ *
+ * Limitations:
+ * - Memory of destroyed objects is not reused. An arena is only suitable for short lived trees.
+ * - A single object kept beyond the request (e. g. a value stored in a peer) keeps the whole arena alive. Copy such
+ *   values instead of storing them. To keep this cheap for small requests, the first block is only 1 KiB and the block
+ *   size doubles up to the maximum block size.
+ * - Only the objects created by makeShared() and their reference count come from the arena. Memory allocated by the
+ *   objects themselves, like the storage of arrayValue, structValue, stringValue and binaryValue, still comes from
+ *   std::allocator.
+ *
+ * The arena is opt-in. The decoders and Peer::getDeviceDescription() allocate with makeShared(), but don't open a
+ * Scope themselves, as many of their results are kept for a long time (device descriptions, settings, service
+ * messages) and each would keep an arena block of at least 1 KiB alive. Code handling a request whose Variables all
+ * die with the response opens a Scope around it. Nested scopes use the arena of the outermost scope:
+ *
+ *     MemoryArena::Scope arenaScope;
+ *     auto parameters = rpcDecoder.decodeRequest(packet, methodName);
+ */
+class MemoryArena
+{
+public:
+	/**
+	 * Makes makeShared() allocate from an arena on the current thread until the scope is left. The arena is created on
+	 * the first allocation, so a scope nothing is allocated in costs nothing.
+	 */
+	class Scope
+	{
+	public:
+		explicit Scope(size_t maxBlockSize = 65536);
+		~Scope();
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		/**
+		 * Returns the arena of the outermost scope of the current thread and creates it if necessary.
+		 */
+		MemoryArena* arena();
+	private:
+		Scope* _outerScope = nullptr;
+		size_t _maxBlockSize = 65536;
+		MemoryArena* _arena = nullptr;
+	};
+
+	MemoryArena(const MemoryArena&) = delete;
+	MemoryArena& operator=(const MemoryArena&) = delete;
+
+	/**
+	 * Returns the arena of the current thread's outermost Scope or nullptr when there is no scope.
+	 */
+	static MemoryArena* current();
+
+	/**
+	 * Creates an object in the current thread's arena. Falls back to std::make_shared when no scope is active.
+	 */
+	template<typename T, typename... Args>
+	static std::shared_ptr<T> makeShared(Args&&... args);
+
+	/**
+	 * Allocates memory for one object. Must only be called on the thread of the scope owning the arena while the scope
+	 * is active. Every allocation must be paired with a call to release().
+	 */
+	void* allocate(size_t size, size_t alignment);
+
+	/**
+	 * Called when an object allocated from the arena is destroyed. Can be called on any thread. The arena is deleted
+	 * when its scope has been left and all objects have been released.
+	 */
+	void release() noexcept;
+
+	/**
+	 * Returns the number of bytes reserved from the system.
+	 */
+	size_t reservedBytes() const { return _reservedBytes; }
+private:
+	/**
+	 * Stands in for the objects that will be allocated while the scope is active. It is replaced by the actual number of
+	 * objects in close(), so releases during the scope never bring _references to 0.
+	 */
+	static constexpr size_t _scopeReferences = SIZE_MAX / 2;
+
+	std::atomic<size_t> _references{_scopeReferences};
+	size_t _allocations = 0;
+	size_t _maxBlockSize = 65536;
+	size_t _nextBlockSize = 1024;
+	size_t _reservedBytes = 0;
+	std::vector<std::unique_ptr<char[]>> _blocks;
+	char* _position = nullptr;
+	char* _end = nullptr;
+
+	explicit MemoryArena(size_t maxBlockSize);
+	~MemoryArena() = default;
+
+	/**
+	 * Called by the owning scope when it is left.
+	 */
+	void close() noexcept;
+
+	static char* align(char* pointer, size_t alignment);
+};
+
+/**
+ * Standard allocator allocating from a MemoryArena. Every deallocation releases one object of the arena.
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	explicit ArenaAllocator(MemoryArena* arena) noexcept : _arena(arena) {}
+	template<typename U> ArenaAllocator(const ArenaAllocator<U>& rhs) noexcept : _arena(rhs.arena()) {}
+
+	T* allocate(size_t count) { return static_cast<T*>(_arena->allocate(count * sizeof(T), alignof(T))); }
+	void deallocate(T* /* pointer */, size_t /* count */) noexcept { _arena->release(); }
+
+	MemoryArena* arena() const noexcept { return _arena; }
+private:
+	MemoryArena* _arena = nullptr;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) { return lhs.arena() == rhs.arena(); }
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) { return lhs.arena() != rhs.arena(); }
+
+template<typename T, typename... Args>
+std::shared_ptr<T> MemoryArena::makeShared(Args&&... args)
+{
+	MemoryArena* arena = current();
+	if(!arena) return std::make_shared<T>(std::forward<Args>(args)...);
+	return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+}
+
+}
+
+#endif
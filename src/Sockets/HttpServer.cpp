@@ -123,14 +123,10 @@ void HttpServer::packetReceived(int32_t clientId, TcpSocket::TcpPacket &packet)
       http = clientIterator->second.http;
     }
 
-    uint32_t processedBytes = 0;
-    while (processedBytes < packet.size()) {
-      processedBytes = http->process((char *)(packet.data() + processedBytes), packet.size() - processedBytes);
-      if (http->isFinished()) {
-        if (_packetReceivedCallback) _packetReceivedCallback(clientId, *http);
-        http->reset();
-      }
-    }
+    //Handles pipelined requests, i. e. several requests in one packet.
+    http->processAll((char *)packet.data(), packet.size(), [&](Http &message) {
+      if (_packetReceivedCallback) _packetReceivedCallback(clientId, message);
+    });
     return;
   }
   catch (const std::exception &ex) {
@@ -147,6 +143,13 @@ void HttpServer::send(int32_t clientId, const std::vector<char> &packet, bool cl
   _socket->sendToClient(clientId, packet, closeConnection);
 }
 
+Http::ChunkedWriter HttpServer::createChunkedWriter(int32_t clientId, size_t chunkSize) {
+  std::shared_ptr<TcpSocket> socket = _socket;
+  return Http::ChunkedWriter([socket, clientId](const char *data, size_t size) {
+    if (!socket || !socket->sendToClient(clientId, data, size, false)) throw HttpServerException("Could not send data to client " + std::to_string(clientId) + ".");
+  }, chunkSize);
+}
+
 std::string HttpServer::getClientCertDn(int32_t clientId) {
   return _socket ? _socket->getClientCertDn(clientId) : "";
 }
@@ -170,6 +170,23 @@ class HttpServer {
   void send(int32_t clientId, const TcpSocket::TcpPacket &packet, bool closeConnection = true);
   void send(int32_t clientId, const std::vector<char> &packet, bool closeConnection = true);
 
+  /**
+   * Returns a writer that sends a chunked response straight to the client as it is generated, e. g. for backups or
+   * logs that shouldn't be held in memory. The connection stays open.
+   *
+   * Example:
+   *
+   *     auto writer = _httpServer->createChunkedWriter(clientId);
+   *     writer.writeHeader(200, "text/plain", {});
+   *     std::ifstream file("/var/log/homegear/homegear.log", std::ios::binary);
+   *     std::array<char, 16384> buffer;
+   *     while(file.read(buffer.data(), buffer.size()) || file.gcount() > 0) writer.write(buffer.data(), file.gcount());
+   *     writer.finish();
+   *
+   * @throws HttpServerException when the data can't be sent, so generating the response stops.
+   */
+  Http::ChunkedWriter createChunkedWriter(int32_t clientId, size_t chunkSize = 16384);
+
   std::string getClientCertDn(int32_t clientId);
   std::string getClientCertSerial(int32_t clientId);
   int64_t getClientCertExpiration(int32_t clientId);
@@ -480,32 +480,14 @@ void TcpSocket::readClient(const PTcpClientData &clientData) {
 }
 
 bool TcpSocket::sendToClient(int32_t clientId, const TcpPacket &packet, bool closeConnection) {
-  PTcpClientData clientData;
-  try {
-    {
-      std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
-      auto clientIterator = _clients.find(clientId);
-      if (clientIterator == _clients.end()) return false;
-      clientData = clientIterator->second;
-    }
-
-    clientData->socket->proofwrite((char *)packet.data(), packet.size());
-    if (closeConnection) {
-      _bl->fileDescriptorManager.close(clientData->fileDescriptor);
-      if (_connectionClosedCallbackEx) _connectionClosedCallbackEx(clientData->id, 0, "");
-      else if (_connectionClosedCallback) _connectionClosedCallback(clientData->id);
-    }
-    return true;
-  }
-  catch (const std::exception &ex) {
-    _bl->fileDescriptorManager.close(clientData->fileDescriptor);
-    if (_connectionClosedCallbackEx) _connectionClosedCallbackEx(clientData->id, -300, std::string("Error sending data to client: ") + ex.what());
-    else if (_connectionClosedCallback) _connectionClosedCallback(clientData->id);
-  }
-  return false;
+  return sendToClient(clientId, (const char *)packet.data(), packet.size(), closeConnection);
 }
 
 bool TcpSocket::sendToClient(int32_t clientId, const std::vector<char> &packet, bool closeConnection) {
+  return sendToClient(clientId, packet.data(), packet.size(), closeConnection);
+}
+
+bool TcpSocket::sendToClient(int32_t clientId, const char *data, size_t size, bool closeConnection) {
   PTcpClientData clientData;
   try {
     {
@@ -515,7 +497,7 @@ bool TcpSocket::sendToClient(int32_t clientId, const std::vector<char> &packet,
       clientData = clientIterator->second;
     }
 
-    clientData->socket->proofwrite((char *)packet.data(), packet.size());
+    clientData->socket->proofwrite(data, size);
     if (closeConnection) {
       _bl->fileDescriptorManager.close(clientData->fileDescriptor);
       if (_connectionClosedCallbackEx) _connectionClosedCallbackEx(clientData->id, 0, "");
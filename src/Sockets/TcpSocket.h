@@ -548,6 +548,16 @@ class TcpSocket : public IQueue {
    */
   bool sendToClient(int32_t clientId, const std::vector<char> &packet, bool closeConnection = false);
 
+  /**
+   * Sends a response to a TCP client connected to the server.
+   *
+   * @param clientId The ID of the client as passed to TcpSocket::TcpServerServer::packetReceivedCallback.
+   * @param data The data to send.
+   * @param size The size of "data".
+   * @param closeConnection Close the connection after sending the data.
+   */
+  bool sendToClient(int32_t clientId, const char *data, size_t size, bool closeConnection = false);
+
   /**
    * Closes the connection to a connected client.
    *
@@ -309,9 +309,65 @@ void Peer::raiseRemoveWebserverEventHandler() {
 
 void Peer::raiseRPCEvent(std::string &source, uint64_t peerId, int32_t channel, std::string &deviceAddress, std::shared_ptr<std::vector<std::string>> &valueKeys, std::shared_ptr<std::vector<PVariable>> &values) {
   if (_peerID == 0) return;
+  if (peerId == _peerID) {
+    //Filter copies of the pointers, as callers often pass the same vectors to raiseEvent().
+    auto filteredValueKeys = valueKeys;
+    auto filteredValues = values;
+    if (!filterUnchangedRpcEventValues(channel, filteredValueKeys, filteredValues)) return;
+    if (_eventHandler) ((IPeerEventSink *)_eventHandler)->onRPCEvent(source, peerId, channel, deviceAddress, filteredValueKeys, filteredValues);
+    return;
+  }
   if (_eventHandler) ((IPeerEventSink *)_eventHandler)->onRPCEvent(source, peerId, channel, deviceAddress, valueKeys, values);
 }
 
+bool Peer::filterUnchangedRpcEventValues(int32_t channel, std::shared_ptr<std::vector<std::string>> &valueKeys, std::shared_ptr<std::vector<PVariable>> &values) {
+  if (!valueKeys || !values || valueKeys->size() != values->size()) return true;
+  auto channelIterator = valuesCentral.find(channel);
+  if (channelIterator == valuesCentral.end()) return true;
+  std::vector<bool> changed(values->size(), true);
+  size_t changedCount = values->size();
+
+  std::unique_lock<std::mutex> lastRpcEventValuesGuard(_lastRpcEventValuesMutex, std::defer_lock);
+  for (size_t i = 0; i < values->size(); i++) {
+    auto &value = values->at(i);
+    if (!value) continue;
+    auto parameterIterator = channelIterator->second.find(valueKeys->at(i));
+    if (parameterIterator == channelIterator->second.end()) continue;
+    auto &rpcParameter = parameterIterator->second.rpcParameter;
+    if (!rpcParameter || !rpcParameter->suppressUnchangedEvents) continue;
+    //Actions like PRESS_SHORT carry no state, so every event has to be delivered.
+    if (!rpcParameter->logical || rpcParameter->logical->type == ILogical::Type::Enum::tAction) continue;
+
+    auto hash = value->hash();
+    if (!lastRpcEventValuesGuard.owns_lock()) lastRpcEventValuesGuard.lock();
+    auto &lastValue = _lastRpcEventValues[channel][valueKeys->at(i)];
+    if (lastValue.value && lastValue.hash == hash && *lastValue.value == *value) {
+      changed[i] = false;
+      changedCount--;
+      continue;
+    }
+    lastValue.hash = hash;
+    lastValue.value = std::make_shared<Variable>(*value);
+  }
+  if (lastRpcEventValuesGuard.owns_lock()) lastRpcEventValuesGuard.unlock();
+
+  if (changedCount == values->size()) return true;
+  if (changedCount == 0) return false;
+
+  auto filteredKeys = std::make_shared<std::vector<std::string>>();
+  auto filteredValues = std::make_shared<std::vector<PVariable>>();
+  filteredKeys->reserve(changedCount);
+  filteredValues->reserve(changedCount);
+  for (size_t i = 0; i < values->size(); i++) {
+    if (!changed[i]) continue;
+    filteredKeys->push_back(valueKeys->at(i));
+    filteredValues->push_back(values->at(i));
+  }
+  valueKeys = filteredKeys;
+  values = filteredValues;
+  return true;
+}
+
 void Peer::raiseRPCUpdateDevice(uint64_t id, int32_t channel, std::string address, int32_t hint) {
   if (_eventHandler) ((IPeerEventSink *)_eventHandler)->onRPCUpdateDevice(id, channel, address, hint);
 }
@@ -2163,23 +2219,23 @@ PVariable Peer::getAllValues(PRpcClientInfo clientInfo, bool returnWriteOnly, bo
     auto central = getCentral();
     if (!central) return Variable::createError(-32500, "Could not get central.");
 
-    values->structValue->insert(StructElement("FAMILY", std::make_shared<Variable>((uint32_t)getCentral()->deviceFamily())));
-    values->structValue->insert(StructElement("ID", std::make_shared<Variable>((uint32_t)_peerID)));
-    values->structValue->insert(StructElement("ADDRESS", std::make_shared<Variable>(_serialNumber)));
-    values->structValue->insert(StructElement("TYPE", std::make_shared<Variable>(_rpcTypeString)));
-    if (_deviceType <= 0xFFFFFFFF) values->structValue->emplace("TYPE_ID", std::make_shared<BaseLib::Variable>((int32_t)_deviceType));
-    else values->structValue->emplace("TYPE_ID", std::make_shared<BaseLib::Variable>(_deviceType));
-    values->structValue->insert(StructElement("NAME", std::make_shared<Variable>(getName(-1))));
+    values->emplaceStructElement("FAMILY", (uint32_t)getCentral()->deviceFamily());
+    values->emplaceStructElement("ID", (uint32_t)_peerID);
+    values->emplaceStructElement("ADDRESS", _serialNumber);
+    values->emplaceStructElement("TYPE", _rpcTypeString);
+    if (_deviceType <= 0xFFFFFFFF) values->emplaceStructElement("TYPE_ID", (int32_t)_deviceType);
+    else values->emplaceStructElement("TYPE_ID", _deviceType);
+    values->emplaceStructElement("NAME", getName(-1));
     auto room = getRoom(-1);
-    if (room != 0) values->structValue->insert(StructElement("ROOM", std::make_shared<Variable>(room)));
+    if (room != 0) values->emplaceStructElement("ROOM", room);
     auto categoryIds = getCategories(-1);
     if (!categoryIds.empty()) {
       auto categories = std::make_shared<Variable>(VariableType::tArray);
       categories->arrayValue->reserve(categoryIds.size());
       for (auto categoryId : categoryIds) {
-        categories->arrayValue->push_back(std::make_shared<Variable>(categoryId));
+        categories->emplaceArrayElement(categoryId);
       }
-      values->structValue->insert(StructElement("CATEGORIES", categories));
+      values->structValue->emplace("CATEGORIES", std::move(categories));
     }
     PVariable channels(new Variable(VariableType::tArray));
     for (auto i = _rpcDevice->functions.begin(); i != _rpcDevice->functions.end(); ++i) {
@@ -2189,23 +2245,23 @@ PVariable Peer::getAllValues(PRpcClientInfo clientInfo, bool returnWriteOnly, bo
         if (!parameterData.empty() && i->first >= i->second->channel + parameterData.at(parameterData.size() - 1)) continue;
       }
       PVariable channel(new Variable(VariableType::tStruct));
-      channel->structValue->insert(StructElement("INDEX", std::make_shared<Variable>(i->first)));
-      channel->structValue->insert(StructElement("NAME", std::make_shared<Variable>(getName(i->first))));
-      channel->structValue->insert(StructElement("TYPE", std::make_shared<Variable>(i->second->type)));
+      channel->emplaceStructElement("INDEX", i->first);
+      channel->emplaceStructElement("NAME", getName(i->first));
+      channel->emplaceStructElement("TYPE", i->second->type);
       auto room = getRoom(i->first);
-      if (room != 0) channel->structValue->insert(StructElement("ROOM", std::make_shared<Variable>(room)));
+      if (room != 0) channel->emplaceStructElement("ROOM", room);
       auto categoryIds = getCategories(i->first);
       if (!categoryIds.empty()) {
         auto categories = std::make_shared<Variable>(VariableType::tArray);
         categories->arrayValue->reserve(categoryIds.size());
         for (auto categoryId : categoryIds) {
-          categories->arrayValue->push_back(std::make_shared<Variable>(categoryId));
+          categories->emplaceArrayElement(categoryId);
         }
-        channel->structValue->insert(StructElement("CATEGORIES", categories));
+        channel->structValue->emplace("CATEGORIES", std::move(categories));
       }
 
       PVariable parameters(new Variable(VariableType::tStruct));
-      channel->structValue->insert(StructElement("PARAMSET", parameters));
+      channel->structValue->emplace("PARAMSET", parameters);
       channels->arrayValue->push_back(channel);
 
       PParameterGroup parameterGroup = getParameterSet(i->first, ParameterGroup::Type::variables);
@@ -2245,23 +2301,23 @@ PVariable Peer::getAllValues(PRpcClientInfo clientInfo, bool returnWriteOnly, bo
             if (!convertFromPacketHook(parameter, parameterData, value)) value = parameter.rpcParameter->convertFromPacket(parameterData, clientInfo->addon && clientInfo->peerId == _peerID ? Role() : parameter.mainRole(), false);
           }
           if (!value) continue;
-          element->structValue->insert(StructElement("VALUE", value));
+          element->structValue->emplace("VALUE", value);
         }
 
-        element->structValue->insert(StructElement("READABLE", PVariable(new Variable(parameter.rpcParameter->readable))));
-        element->structValue->insert(StructElement("WRITEABLE", PVariable(new Variable(parameter.rpcParameter->writeable))));
-        element->structValue->insert(StructElement("TRANSMITTED", PVariable(new Variable(parameter.rpcParameter->transmitted))));
-        element->structValue->insert(StructElement("UNIT", PVariable(new Variable(parameter.rpcParameter->unit))));
+        element->emplaceStructElement("READABLE", parameter.rpcParameter->readable);
+        element->emplaceStructElement("WRITEABLE", parameter.rpcParameter->writeable);
+        element->emplaceStructElement("TRANSMITTED", parameter.rpcParameter->transmitted);
+        element->emplaceStructElement("UNIT", parameter.rpcParameter->unit);
         auto room = parameter.getRoom();
-        if (room != 0) element->structValue->insert(StructElement("ROOM", std::make_shared<Variable>(room)));
+        if (room != 0) element->emplaceStructElement("ROOM", room);
         auto categoryIds = parameter.getCategories();
         if (!categoryIds.empty()) {
           auto categories = std::make_shared<Variable>(VariableType::tArray);
           categories->arrayValue->reserve(categoryIds.size());
           for (auto categoryId : categoryIds) {
-            categories->arrayValue->push_back(std::make_shared<Variable>(categoryId));
+            categories->emplaceArrayElement(categoryId);
           }
-          element->structValue->insert(StructElement("CATEGORIES", categories));
+          element->structValue->emplace("CATEGORIES", std::move(categories));
         }
         auto roles = parameter.getRoles();
         if (!roles.empty()) {
@@ -2269,99 +2325,99 @@ PVariable Peer::getAllValues(PRpcClientInfo clientInfo, bool returnWriteOnly, bo
           rolesArray->arrayValue->reserve(roles.size());
           for (auto role : roles) {
             auto roleStruct = std::make_shared<Variable>(VariableType::tStruct);
-            roleStruct->structValue->emplace("id", std::make_shared<BaseLib::Variable>(role.second.id));
-            roleStruct->structValue->emplace("direction", std::make_shared<BaseLib::Variable>((int32_t)role.second.direction));
-            if (role.second.invert) roleStruct->structValue->emplace("invert", std::make_shared<BaseLib::Variable>(role.second.invert));
-            roleStruct->structValue->emplace("level", std::make_shared<BaseLib::Variable>((role.second.id / 10000) * 10000 == role.second.id ? 0 : ((role.second.id / 100) * 100 == role.second.id ? 1 : 2)));
+            roleStruct->emplaceStructElement("id", role.second.id);
+            roleStruct->emplaceStructElement("direction", (int32_t)role.second.direction);
+            if (role.second.invert) roleStruct->emplaceStructElement("invert", role.second.invert);
+            roleStruct->emplaceStructElement("level", (role.second.id / 10000) * 10000 == role.second.id ? 0 : ((role.second.id / 100) * 100 == role.second.id ? 1 : 2));
             rolesArray->arrayValue->emplace_back(std::move(roleStruct));
           }
-          element->structValue->insert(StructElement("ROLES", rolesArray));
+          element->structValue->emplace("ROLES", std::move(rolesArray));
         }
         if (parameter.rpcParameter->logical->type == ILogical::Type::tBoolean) {
           if (value) value->type = VariableType::tBoolean; //For some families/variables "convertFromPacket" returns wrong type
-          element->structValue->insert(StructElement("TYPE", std::make_shared<Variable>(std::string("BOOL"))));
+          element->emplaceStructElement("TYPE", std::string("BOOL"));
         } else if (parameter.rpcParameter->logical->type == ILogical::Type::tString) {
           if (value) value->type = VariableType::tString; //For some families/variables "convertFromPacket" returns wrong type
-          element->structValue->insert(StructElement("TYPE", std::make_shared<Variable>(std::string("STRING"))));
+          element->emplaceStructElement("TYPE", std::string("STRING"));
         } else if (parameter.rpcParameter->logical->type == ILogical::Type::tAction) {
           if (value) value->type = VariableType::tBoolean; //For some families/variables "convertFromPacket" returns wrong type
-          element->structValue->insert(StructElement("TYPE", std::make_shared<Variable>(std::string("ACTION"))));
+          element->emplaceStructElement("TYPE", std::string("ACTION"));
         } else if (parameter.rpcParameter->logical->type == ILogical::Type::tInteger) {
           if (value) value->type = VariableType::tInteger; //For some families/variables "convertFromPacket" returns wrong type
           LogicalInteger *logicalInteger = (LogicalInteger *)parameter.rpcParameter->logical.get();
-          element->structValue->insert(StructElement("TYPE", std::make_shared<Variable>(std::string("INTEGER"))));
-          element->structValue->insert(StructElement("MIN", PVariable(new Variable(logicalInteger->minimumValue))));
-          element->structValue->insert(StructElement("MAX", PVariable(new Variable(logicalInteger->maximumValue))));
+          element->emplaceStructElement("TYPE", std::string("INTEGER"));
+          element->emplaceStructElement("MIN", logicalInteger->minimumValue);
+          element->emplaceStructElement("MAX", logicalInteger->maximumValue);
 
           if (!logicalInteger->specialValuesStringMap.empty()) {
             PVariable specialValues(new Variable(VariableType::tArray));
             for (std::unordered_map<std::string, int32_t>::iterator j = logicalInteger->specialValuesStringMap.begin(); j != logicalInteger->specialValuesStringMap.end(); ++j) {
               PVariable specialElement(new Variable(VariableType::tStruct));
-              specialElement->structValue->insert(StructElement("ID", std::make_shared<Variable>(j->first)));
-              specialElement->structValue->insert(StructElement("VALUE", std::make_shared<Variable>(j->second)));
-              specialValues->arrayValue->push_back(specialElement);
+              specialElement->emplaceStructElement("ID", j->first);
+              specialElement->emplaceStructElement("VALUE", j->second);
+              specialValues->arrayValue->push_back(std::move(specialElement));
             }
-            element->structValue->insert(StructElement("SPECIAL", specialValues));
+            element->structValue->emplace("SPECIAL", std::move(specialValues));
           }
         } else if (parameter.rpcParameter->logical->type == ILogical::Type::tInteger64) {
           if (value) value->type = VariableType::tInteger64; //For some families/variables "convertFromPacket" returns wrong type
           LogicalInteger64 *logicalInteger64 = (LogicalInteger64 *)parameter.rpcParameter->logical.get();
-          element->structValue->insert(StructElement("TYPE", PVariable(new Variable(std::string("INTEGER64")))));
-          element->structValue->insert(StructElement("MIN", PVariable(new Variable(logicalInteger64->minimumValue))));
-          element->structValue->insert(StructElement("MAX", PVariable(new Variable(logicalInteger64->maximumValue))));
+          element->emplaceStructElement("TYPE", std::string("INTEGER64"));
+          element->emplaceStructElement("MIN", logicalInteger64->minimumValue);
+          element->emplaceStructElement("MAX", logicalInteger64->maximumValue);
 
           if (!logicalInteger64->specialValuesStringMap.empty()) {
             PVariable specialValues(new Variable(VariableType::tArray));
             for (std::unordered_map<std::string, int64_t>::iterator j = logicalInteger64->specialValuesStringMap.begin(); j != logicalInteger64->specialValuesStringMap.end(); ++j) {
               PVariable specialElement(new Variable(VariableType::tStruct));
-              specialElement->structValue->insert(StructElement("ID", PVariable(new Variable(j->first))));
-              specialElement->structValue->insert(StructElement("VALUE", PVariable(new Variable(j->second))));
-              specialValues->arrayValue->push_back(specialElement);
+              specialElement->emplaceStructElement("ID", j->first);
+              specialElement->emplaceStructElement("VALUE", j->second);
+              specialValues->arrayValue->push_back(std::move(specialElement));
             }
-            element->structValue->insert(StructElement("SPECIAL", specialValues));
+            element->structValue->emplace("SPECIAL", std::move(specialValues));
           }
         } else if (parameter.rpcParameter->logical->type == ILogical::Type::tEnum) {
           if (value) value->type = VariableType::tInteger; //For some families/variables "convertFromPacket" returns wrong type
           LogicalEnumeration *logicalEnumeration = (LogicalEnumeration *)parameter.rpcParameter->logical.get();
-          element->structValue->insert(StructElement("TYPE", std::make_shared<Variable>(std::string("ENUM"))));
-          element->structValue->insert(StructElement("MIN", PVariable(new Variable(logicalEnumeration->minimumValue))));
-          element->structValue->insert(StructElement("MAX", PVariable(new Variable(logicalEnumeration->maximumValue))));
+          element->emplaceStructElement("TYPE", std::string("ENUM"));
+          element->emplaceStructElement("MIN", logicalEnumeration->minimumValue);
+          element->emplaceStructElement("MAX", logicalEnumeration->maximumValue);
 
           PVariable valueList(new Variable(VariableType::tArray));
           for (std::vector<EnumerationValue>::iterator j = logicalEnumeration->values.begin(); j != logicalEnumeration->values.end(); ++j) {
-            valueList->arrayValue->push_back(std::make_shared<Variable>(j->id));
+            valueList->emplaceArrayElement(j->id);
           }
-          element->structValue->insert(StructElement("VALUE_LIST", valueList));
+          element->structValue->emplace("VALUE_LIST", std::move(valueList));
         } else if (parameter.rpcParameter->logical->type == ILogical::Type::tFloat) {
           if (value) value->type = VariableType::tFloat; //For some families/variables "convertFromPacket" returns wrong type
           LogicalDecimal *logicalDecimal = (LogicalDecimal *)parameter.rpcParameter->logical.get();
-          element->structValue->insert(StructElement("TYPE", std::make_shared<Variable>(std::string("FLOAT"))));
-          element->structValue->insert(StructElement("MIN", PVariable(new Variable(logicalDecimal->minimumValue))));
-          element->structValue->insert(StructElement("MAX", PVariable(new Variable(logicalDecimal->maximumValue))));
+          element->emplaceStructElement("TYPE", std::string("FLOAT"));
+          element->emplaceStructElement("MIN", logicalDecimal->minimumValue);
+          element->emplaceStructElement("MAX", logicalDecimal->maximumValue);
 
           if (!logicalDecimal->specialValuesStringMap.empty()) {
             PVariable specialValues(new Variable(VariableType::tArray));
             for (std::unordered_map<std::string, double>::iterator j = logicalDecimal->specialValuesStringMap.begin(); j != logicalDecimal->specialValuesStringMap.end(); ++j) {
               PVariable specialElement(new Variable(VariableType::tStruct));
-              specialElement->structValue->insert(StructElement("ID", std::make_shared<Variable>(j->first)));
-              specialElement->structValue->insert(StructElement("VALUE", std::make_shared<Variable>(j->second)));
-              specialValues->arrayValue->push_back(specialElement);
+              specialElement->emplaceStructElement("ID", j->first);
+              specialElement->emplaceStructElement("VALUE", j->second);
+              specialValues->arrayValue->push_back(std::move(specialElement));
             }
-            element->structValue->insert(StructElement("SPECIAL", specialValues));
+            element->structValue->emplace("SPECIAL", std::move(specialValues));
           }
         } else if (parameter.rpcParameter->logical->type == ILogical::Type::tArray) {
           if (!clientInfo->initNewFormat) continue;
           if (value) value->type = VariableType::tArray; //For some families/variables "convertFromPacket" returns wrong type
-          element->structValue->insert(StructElement("TYPE", PVariable(new Variable(std::string("ARRAY")))));
+          element->emplaceStructElement("TYPE", std::string("ARRAY"));
         } else if (parameter.rpcParameter->logical->type == ILogical::Type::tStruct) {
           if (!clientInfo->initNewFormat) continue;
           if (value) value->type = VariableType::tStruct; //For some families/variables "convertFromPacket" returns wrong type
-          element->structValue->insert(StructElement("TYPE", std::make_shared<Variable>(std::string("STRUCT"))));
+          element->emplaceStructElement("TYPE", std::string("STRUCT"));
         }
-        parameters->structValue->insert(StructElement(parameter.rpcParameter->id, element));
+        parameters->structValue->emplace(parameter.rpcParameter->id, std::move(element));
       }
     }
-    values->structValue->insert(StructElement("CHANNELS", channels));
+    values->structValue->emplace("CHANNELS", std::move(channels));
 
     return values;
   }
@@ -2404,7 +2460,7 @@ PVariable Peer::getConfigParameter(PRpcClientInfo clientInfo, uint32_t channel,
 PVariable Peer::getDeviceDescription(PRpcClientInfo clientInfo, int32_t channel, std::map<std::string, bool> fields) {
   try {
     if (_disposing) return Variable::createError(-32500, "Peer is disposing.");
-    PVariable description(new Variable(VariableType::tStruct));
+    PVariable description = MemoryArena::makeShared<Variable>(VariableType::tStruct);
 
     if (channel == -1) //Base device
     {
@@ -2415,27 +2471,27 @@ PVariable Peer::getDeviceDescription(PRpcClientInfo clientInfo, int32_t channel,
       std::string language = clientInfo ? clientInfo->language : "en-US";
       std::string filename = _rpcDevice->getFilename();
 
-      if (fields.empty() || fields.find("FAMILY") != fields.end()) description->structValue->insert(StructElement("FAMILY", PVariable(new Variable((uint32_t)getCentral()->deviceFamily()))));
-      if (fields.empty() || fields.find("ID") != fields.end()) description->structValue->insert(StructElement("ID", PVariable(new Variable((uint32_t)_peerID))));
-      if (fields.empty() || fields.find("ADDRESS") != fields.end()) description->structValue->insert(StructElement("ADDRESS", PVariable(new Variable(_serialNumber))));
-      if (fields.empty() || fields.find("NAME") != fields.end()) description->structValue->insert(StructElement("NAME", PVariable(new Variable(getName(-1)))));
+      if (fields.empty() || fields.find("FAMILY") != fields.end()) description->emplaceStructElement("FAMILY", (uint32_t)getCentral()->deviceFamily());
+      if (fields.empty() || fields.find("ID") != fields.end()) description->emplaceStructElement("ID", (uint32_t)_peerID);
+      if (fields.empty() || fields.find("ADDRESS") != fields.end()) description->emplaceStructElement("ADDRESS", _serialNumber);
+      if (fields.empty() || fields.find("NAME") != fields.end()) description->emplaceStructElement("NAME", getName(-1));
       if (supportedDevice && !supportedDevice->serialPrefix.empty() && (fields.empty() || fields.find("SERIAL_PREFIX") != fields.end()))
         description->structValue->insert(StructElement("SERIAL_PREFIX",
-                                                       PVariable(new Variable(supportedDevice->serialPrefix))));
+                                                       MemoryArena::makeShared<Variable>(supportedDevice->serialPrefix)));
 
       if (supportedDevice) {
         std::string descriptionText = central->getTranslations()->getTypeDescription(filename, language, supportedDevice->id);
-        if (!descriptionText.empty() && fields.find("DESCRIPTION") != fields.end()) description->structValue->insert(StructElement("DESCRIPTION", PVariable(new Variable(descriptionText))));
+        if (!descriptionText.empty() && fields.find("DESCRIPTION") != fields.end()) description->emplaceStructElement("DESCRIPTION", std::move(descriptionText));
         std::string longDescriptionText = central->getTranslations()->getTypeLongDescription(filename, language, supportedDevice->id);
-        if (!longDescriptionText.empty() && fields.find("LONG_DESCRIPTION") != fields.end()) description->structValue->insert(StructElement("LONG_DESCRIPTION", PVariable(new Variable(longDescriptionText))));
+        if (!longDescriptionText.empty() && fields.find("LONG_DESCRIPTION") != fields.end()) description->emplaceStructElement("LONG_DESCRIPTION", std::move(longDescriptionText));
       }
 
-      if (fields.empty() || fields.find("PAIRING_METHOD") != fields.end()) description->structValue->insert(StructElement("PAIRING_METHOD", std::make_shared<Variable>(_rpcDevice->pairingMethod)));
+      if (fields.empty() || fields.find("PAIRING_METHOD") != fields.end()) description->emplaceStructElement("PAIRING_METHOD", _rpcDevice->pairingMethod);
 
-      PVariable variable = PVariable(new Variable(VariableType::tArray));
-      PVariable variable2 = PVariable(new Variable(VariableType::tArray));
-      if (fields.empty() || fields.find("CHILDREN") != fields.end()) description->structValue->insert(StructElement("CHILDREN", variable));
-      if (fields.empty() || fields.find("CHANNELS") != fields.end()) description->structValue->insert(StructElement("CHANNELS", variable2));
+      PVariable variable = MemoryArena::makeShared<Variable>(VariableType::tArray);
+      PVariable variable2 = MemoryArena::makeShared<Variable>(VariableType::tArray);
+      if (fields.empty() || fields.find("CHILDREN") != fields.end()) description->structValue->emplace("CHILDREN", variable);
+      if (fields.empty() || fields.find("CHANNELS") != fields.end()) description->structValue->emplace("CHANNELS", variable2);
 
       if (fields.empty() || fields.find("CHILDREN") != fields.end() || fields.find("CHANNELS") != fields.end()) {
         for (Functions::iterator i = _rpcDevice->functions.begin(); i != _rpcDevice->functions.end(); ++i) {
@@ -2444,20 +2500,20 @@ PVariable Peer::getDeviceDescription(PRpcClientInfo clientInfo, int32_t channel,
             std::vector<uint8_t> parameterData = configCentral[0][i->second->countFromVariable].getBinaryData();
             if (parameterData.size() > 0 && i->first >= i->second->channel + parameterData.at(parameterData.size() - 1)) continue;
           }
-          if (fields.empty() || fields.find("CHILDREN") != fields.end()) variable->arrayValue->push_back(PVariable(new Variable(_serialNumber + ":" + std::to_string(i->first))));
-          if (fields.empty() || fields.find("CHANNELS") != fields.end()) variable2->arrayValue->push_back(PVariable(new Variable(i->first)));
+          if (fields.empty() || fields.find("CHILDREN") != fields.end()) variable->emplaceArrayElement(_serialNumber + ":" + std::to_string(i->first));
+          if (fields.empty() || fields.find("CHANNELS") != fields.end()) variable2->emplaceArrayElement(i->first);
         }
       }
 
       if (fields.empty() || fields.find("FIRMWARE") != fields.end()) {
-        if (_firmwareVersion != -1) description->structValue->insert(StructElement("FIRMWARE", PVariable(new Variable(getFirmwareVersionString(_firmwareVersion)))));
-        else if (!_firmwareVersionString.empty()) description->structValue->insert(StructElement("FIRMWARE", PVariable(new Variable(_firmwareVersionString))));
-        else description->structValue->insert(StructElement("FIRMWARE", PVariable(new Variable(std::string("?")))));
+        if (_firmwareVersion != -1) description->emplaceStructElement("FIRMWARE", getFirmwareVersionString(_firmwareVersion));
+        else if (!_firmwareVersionString.empty()) description->emplaceStructElement("FIRMWARE", _firmwareVersionString);
+        else description->emplaceStructElement("FIRMWARE", std::string("?"));
       }
 
       if ((fields.empty() || fields.find("AVAILABLE_FIRMWARE") != fields.end()) && (_firmwareVersion != -1 || !_firmwareVersionString.empty())) {
         int32_t newFirmwareVersion = getNewFirmwareVersion();
-        if (newFirmwareVersion > _firmwareVersion) description->structValue->insert(StructElement("AVAILABLE_FIRMWARE", PVariable(new Variable(getFirmwareVersionString(newFirmwareVersion)))));
+        if (newFirmwareVersion > _firmwareVersion) description->emplaceStructElement("AVAILABLE_FIRMWARE", getFirmwareVersionString(newFirmwareVersion));
       }
 
       if (fields.empty() || fields.find("FLAGS") != fields.end()) {
@@ -2465,57 +2521,57 @@ PVariable Peer::getDeviceDescription(PRpcClientInfo clientInfo, int32_t channel,
         if (_rpcDevice->visible) uiFlags += 1;
         if (_rpcDevice->internal) uiFlags += 2;
         if (!_rpcDevice->deletable || isTeam()) uiFlags += 8;
-        description->structValue->insert(StructElement("FLAGS", PVariable(new Variable(uiFlags))));
+        description->emplaceStructElement("FLAGS", uiFlags);
       }
 
-      if (fields.empty() || fields.find("INTERFACE") != fields.end()) description->structValue->insert(StructElement("INTERFACE", PVariable(new Variable(getCentral()->getSerialNumber()))));
+      if (fields.empty() || fields.find("INTERFACE") != fields.end()) description->emplaceStructElement("INTERFACE", getCentral()->getSerialNumber());
 
       if (fields.empty() || fields.find("PARAMSETS") != fields.end()) {
-        variable = PVariable(new Variable(VariableType::tArray));
-        description->structValue->insert(StructElement("PARAMSETS", variable));
-        variable->arrayValue->push_back(PVariable(new Variable(std::string("MASTER")))); //Always MASTER
+        variable = MemoryArena::makeShared<Variable>(VariableType::tArray);
+        description->structValue->emplace("PARAMSETS", variable);
+        variable->emplaceArrayElement(std::string("MASTER")); //Always MASTER
       }
 
-      if (fields.empty() || fields.find("PARENT") != fields.end()) description->structValue->insert(StructElement("PARENT", PVariable(new Variable(std::string("")))));
+      if (fields.empty() || fields.find("PARENT") != fields.end()) description->emplaceStructElement("PARENT", std::string(""));
 
-      if (!_ip.empty() && (fields.empty() || fields.find("IP_ADDRESS") != fields.end())) description->structValue->insert(StructElement("IP_ADDRESS", PVariable(new Variable(_ip))));
+      if (!_ip.empty() && (fields.empty() || fields.find("IP_ADDRESS") != fields.end())) description->emplaceStructElement("IP_ADDRESS", _ip);
 
-      if (fields.empty() || fields.find("PHYSICAL_ADDRESS") != fields.end()) description->structValue->insert(StructElement("PHYSICAL_ADDRESS", PVariable(new Variable(_address))));
+      if (fields.empty() || fields.find("PHYSICAL_ADDRESS") != fields.end()) description->emplaceStructElement("PHYSICAL_ADDRESS", _address);
 
       //Compatibility
-      if (fields.empty() || fields.find("RF_ADDRESS") != fields.end()) description->structValue->insert(StructElement("RF_ADDRESS", PVariable(new Variable(_address))));
+      if (fields.empty() || fields.find("RF_ADDRESS") != fields.end()) description->emplaceStructElement("RF_ADDRESS", _address);
       //Compatibility
-      if (fields.empty() || fields.find("ROAMING") != fields.end()) description->structValue->insert(StructElement("ROAMING", PVariable(new Variable((int32_t)0))));
+      if (fields.empty() || fields.find("ROAMING") != fields.end()) description->emplaceStructElement("ROAMING", (int32_t)0);
 
-      if (fields.empty() || fields.find("RX_MODE") != fields.end()) description->structValue->insert(StructElement("RX_MODE", PVariable(new Variable((int32_t)_rpcDevice->receiveModes))));
+      if (fields.empty() || fields.find("RX_MODE") != fields.end()) description->emplaceStructElement("RX_MODE", (int32_t)_rpcDevice->receiveModes);
 
-      if (!_rpcTypeString.empty() && (fields.empty() || fields.find("TYPE") != fields.end())) description->structValue->insert(StructElement("TYPE", PVariable(new Variable(_rpcTypeString))));
+      if (!_rpcTypeString.empty() && (fields.empty() || fields.find("TYPE") != fields.end())) description->emplaceStructElement("TYPE", _rpcTypeString);
 
       if (fields.empty() || fields.find("TYPE_ID") != fields.end()) {
-        if (_deviceType <= 0xFFFFFFFF) description->structValue->emplace("TYPE_ID", std::make_shared<Variable>((int32_t)_deviceType));
-        else description->structValue->emplace("TYPE_ID", std::make_shared<Variable>(_deviceType));
+        if (_deviceType <= 0xFFFFFFFF) description->emplaceStructElement("TYPE_ID", (int32_t)_deviceType);
+        else description->emplaceStructElement("TYPE_ID", _deviceType);
       }
 
-      if (fields.empty() || fields.find("VERSION") != fields.end()) description->structValue->insert(StructElement("VERSION", PVariable(new Variable(_rpcDevice->version))));
+      if (fields.empty() || fields.find("VERSION") != fields.end()) description->emplaceStructElement("VERSION", _rpcDevice->version);
 
-      if (fields.find("WIRELESS") != fields.end()) description->structValue->insert(StructElement("WIRELESS", PVariable(new Variable(wireless()))));
+      if (fields.find("WIRELESS") != fields.end()) description->emplaceStructElement("WIRELESS", wireless());
 
       auto room = getRoom(-1);
-      if ((fields.empty() || fields.find("ROOM") != fields.end()) && room != 0) description->structValue->emplace("ROOM", std::make_shared<Variable>(room));
+      if ((fields.empty() || fields.find("ROOM") != fields.end()) && room != 0) description->emplaceStructElement("ROOM", room);
 
       if (fields.find("ROOMNAME") != fields.end() && room != 0) {
         auto name = _bl->db->getRoomName(clientInfo, room);
-        if (!name.empty()) description->structValue->emplace("ROOMNAME", std::make_shared<Variable>(name));
+        if (!name.empty()) description->emplaceStructElement("ROOMNAME", std::move(name));
       }
 
       auto categories = getCategories(-1);
       if (fields.find("CATEGORIES") != fields.end() && !categories.empty()) {
-        PVariable categoriesResult = std::make_shared<Variable>(VariableType::tArray);
+        PVariable categoriesResult = MemoryArena::makeShared<Variable>(VariableType::tArray);
         categoriesResult->arrayValue->reserve(categories.size());
         for (auto category : categories) {
-          categoriesResult->arrayValue->push_back(std::make_shared<Variable>(category));
+          categoriesResult->emplaceArrayElement(category);
         }
-        description->structValue->emplace("CATEGORIES", categoriesResult);
+        description->structValue->emplace("CATEGORIES", std::move(categoriesResult));
       }
     } else {
       if (_rpcDevice->functions.find(channel) == _rpcDevice->functions.end()) return Variable::createError(-2, "Unknown channel.");
@@ -2526,11 +2582,11 @@ PVariable Peer::getDeviceDescription(PRpcClientInfo clientInfo, int32_t channel,
       }
       if (!rpcFunction->visible) return description;
 
-      if (fields.empty() || fields.find("FAMILYID") != fields.end()) description->structValue->insert(StructElement("FAMILY", PVariable(new Variable((uint32_t)getCentral()->deviceFamily()))));
-      if (fields.empty() || fields.find("ID") != fields.end()) description->structValue->insert(StructElement("ID", PVariable(new Variable((uint32_t)_peerID))));
-      if (fields.empty() || fields.find("CHANNEL") != fields.end()) description->structValue->insert(StructElement("CHANNEL", PVariable(new Variable(channel))));
-      if (fields.empty() || fields.find("NAME") != fields.end()) description->structValue->insert(StructElement("NAME", PVariable(new Variable(getName(channel)))));
-      if (fields.empty() || fields.find("ADDRESS") != fields.end()) description->structValue->insert(StructElement("ADDRESS", PVariable(new Variable(_serialNumber + ":" + std::to_string(channel)))));
+      if (fields.empty() || fields.find("FAMILYID") != fields.end()) description->emplaceStructElement("FAMILY", (uint32_t)getCentral()->deviceFamily());
+      if (fields.empty() || fields.find("ID") != fields.end()) description->emplaceStructElement("ID", (uint32_t)_peerID);
+      if (fields.empty() || fields.find("CHANNEL") != fields.end()) description->emplaceStructElement("CHANNEL", channel);
+      if (fields.empty() || fields.find("NAME") != fields.end()) description->emplaceStructElement("NAME", getName(channel));
+      if (fields.empty() || fields.find("ADDRESS") != fields.end()) description->emplaceStructElement("ADDRESS", _serialNumber + ":" + std::to_string(channel));
 
       if (fields.empty() || fields.find("AES_ACTIVE") != fields.end()) {
         int32_t aesActive = 0;
@@ -2541,7 +2597,7 @@ PVariable Peer::getDeviceDescription(PRpcClientInfo clientInfo, int32_t channel,
           }
         }
         //Integer for compatability
-        description->structValue->insert(StructElement("AES_ACTIVE", PVariable(new Variable(aesActive))));
+        description->emplaceStructElement("AES_ACTIVE", aesActive);
       }
 
       if (fields.empty() || fields.find("DIRECTION") != fields.end() || fields.find("LINK_SOURCE_ROLES") != fields.end() || fields.find("LINK_TARGET_ROLES") != fields.end()) {
@@ -2567,9 +2623,9 @@ PVariable Peer::getDeviceDescription(PRpcClientInfo clientInfo, int32_t channel,
 
         //Overwrite direction when manually set
         if (rpcFunction->direction != Function::Direction::Enum::none) direction = (int32_t)rpcFunction->direction;
-        if (fields.empty() || fields.find("DIRECTION") != fields.end()) description->structValue->insert(StructElement("DIRECTION", PVariable(new Variable(direction))));
-        if (fields.empty() || fields.find("LINK_SOURCE_ROLES") != fields.end()) description->structValue->insert(StructElement("LINK_SOURCE_ROLES", PVariable(new Variable(linkSourceRoles.str()))));
-        if (fields.empty() || fields.find("LINK_TARGET_ROLES") != fields.end()) description->structValue->insert(StructElement("LINK_TARGET_ROLES", PVariable(new Variable(linkTargetRoles.str()))));
+        if (fields.empty() || fields.find("DIRECTION") != fields.end()) description->emplaceStructElement("DIRECTION", direction);
+        if (fields.empty() || fields.find("LINK_SOURCE_ROLES") != fields.end()) description->emplaceStructElement("LINK_SOURCE_ROLES", linkSourceRoles.str());
+        if (fields.empty() || fields.find("LINK_TARGET_ROLES") != fields.end()) description->emplaceStructElement("LINK_TARGET_ROLES", linkTargetRoles.str());
       }
 
       if (fields.empty() || fields.find("FLAGS") != fields.end()) {
@@ -2577,53 +2633,53 @@ PVariable Peer::getDeviceDescription(PRpcClientInfo clientInfo, int32_t channel,
         if (rpcFunction->visible) uiFlags += 1;
         if (rpcFunction->internal) uiFlags += 2;
         if (rpcFunction->deletable || isTeam()) uiFlags += 8;
-        description->structValue->insert(StructElement("FLAGS", PVariable(new Variable(uiFlags))));
+        description->emplaceStructElement("FLAGS", uiFlags);
       }
 
       if (fields.empty() || fields.find("GROUP") != fields.end()) {
         int32_t groupedWith = getChannelGroupedWith(channel);
         if (groupedWith > -1) {
-          description->structValue->insert(StructElement("GROUP", PVariable(new Variable(_serialNumber + ":" + std::to_string(groupedWith)))));
+          description->emplaceStructElement("GROUP", _serialNumber + ":" + std::to_string(groupedWith));
         }
       }
 
-      if (fields.empty() || fields.find("INDEX") != fields.end()) description->structValue->insert(StructElement("INDEX", PVariable(new Variable(channel))));
+      if (fields.empty() || fields.find("INDEX") != fields.end()) description->emplaceStructElement("INDEX", channel);
 
       if (fields.empty() || fields.find("PARAMSETS") != fields.end()) {
-        PVariable variable = PVariable(new Variable(VariableType::tArray));
-        description->structValue->insert(StructElement("PARAMSETS", variable));
-        if (!rpcFunction->configParameters->parameters.empty() || !rpcFunction->configParameters->id.empty()) variable->arrayValue->push_back(PVariable(new Variable(std::string("MASTER"))));
-        if (!rpcFunction->variables->parameters.empty() || !rpcFunction->variables->id.empty()) variable->arrayValue->push_back(PVariable(new Variable(std::string("VALUES"))));
-        if (!rpcFunction->linkParameters->parameters.empty() || !rpcFunction->linkParameters->id.empty()) variable->arrayValue->push_back(PVariable(new Variable(std::string("LINK"))));
+        PVariable variable = MemoryArena::makeShared<Variable>(VariableType::tArray);
+        description->structValue->emplace("PARAMSETS", variable);
+        if (!rpcFunction->configParameters->parameters.empty() || !rpcFunction->configParameters->id.empty()) variable->emplaceArrayElement(std::string("MASTER"));
+        if (!rpcFunction->variables->parameters.empty() || !rpcFunction->variables->id.empty()) variable->emplaceArrayElement(std::string("VALUES"));
+        if (!rpcFunction->linkParameters->parameters.empty() || !rpcFunction->linkParameters->id.empty()) variable->emplaceArrayElement(std::string("LINK"));
       }
-      //if(rpcChannel->parameterSets.find(Rpc::ParameterSet::Type::Enum::link) != rpcChannel->parameterSets.end()) variable->arrayValue->push_back(PVariable(new Variable(rpcChannel->parameterSets.at(Rpc::ParameterSet::Type::Enum::link)->typeString())));
-      //if(rpcChannel->parameterSets.find(Rpc::ParameterSet::Type::Enum::master) != rpcChannel->parameterSets.end()) variable->arrayValue->push_back(PVariable(new Variable(rpcChannel->parameterSets.at(Rpc::ParameterSet::Type::Enum::master)->typeString())));
-      //if(rpcChannel->parameterSets.find(Rpc::ParameterSet::Type::Enum::values) != rpcChannel->parameterSets.end()) variable->arrayValue->push_back(PVariable(new Variable(rpcChannel->parameterSets.at(Rpc::ParameterSet::Type::Enum::values)->typeString())));
+      //if(rpcChannel->parameterSets.find(Rpc::ParameterSet::Type::Enum::link) != rpcChannel->parameterSets.end()) variable->arrayValue->push_back(MemoryArena::makeShared<Variable>(rpcChannel->parameterSets.at(Rpc::ParameterSet::Type::Enum::link)->typeString()));
+      //if(rpcChannel->parameterSets.find(Rpc::ParameterSet::Type::Enum::master) != rpcChannel->parameterSets.end()) variable->arrayValue->push_back(MemoryArena::makeShared<Variable>(rpcChannel->parameterSets.at(Rpc::ParameterSet::Type::Enum::master)->typeString()));
+      //if(rpcChannel->parameterSets.find(Rpc::ParameterSet::Type::Enum::values) != rpcChannel->parameterSets.end()) variable->arrayValue->push_back(MemoryArena::makeShared<Variable>(rpcChannel->parameterSets.at(Rpc::ParameterSet::Type::Enum::values)->typeString()));
 
-      if (fields.empty() || fields.find("PARENT") != fields.end()) description->structValue->insert(StructElement("PARENT", PVariable(new Variable(_serialNumber))));
+      if (fields.empty() || fields.find("PARENT") != fields.end()) description->emplaceStructElement("PARENT", _serialNumber);
 
-      if (!_rpcTypeString.empty() && (fields.empty() || fields.find("PARENT_TYPE") != fields.end())) description->structValue->insert(StructElement("PARENT_TYPE", PVariable(new Variable(_rpcTypeString))));
+      if (!_rpcTypeString.empty() && (fields.empty() || fields.find("PARENT_TYPE") != fields.end())) description->emplaceStructElement("PARENT_TYPE", _rpcTypeString);
 
-      if (fields.empty() || fields.find("TYPE") != fields.end()) description->structValue->insert(StructElement("TYPE", PVariable(new Variable(rpcFunction->type))));
+      if (fields.empty() || fields.find("TYPE") != fields.end()) description->emplaceStructElement("TYPE", rpcFunction->type);
 
-      if (fields.empty() || fields.find("VERSION") != fields.end()) description->structValue->insert(StructElement("VERSION", PVariable(new Variable(_rpcDevice->version))));
+      if (fields.empty() || fields.find("VERSION") != fields.end()) description->emplaceStructElement("VERSION", _rpcDevice->version);
 
       auto room = getRoom(channel);
-      if ((fields.empty() || fields.find("ROOM") != fields.end()) && room != 0) description->structValue->emplace("ROOM", std::make_shared<Variable>(room));
+      if ((fields.empty() || fields.find("ROOM") != fields.end()) && room != 0) description->emplaceStructElement("ROOM", room);
 
       if (fields.find("ROOMNAME") != fields.end() && room != 0) {
         auto name = _bl->db->getRoomName(clientInfo, room);
-        if (!name.empty()) description->structValue->emplace("ROOMNAME", std::make_shared<Variable>(name));
+        if (!name.empty()) description->emplaceStructElement("ROOMNAME", std::move(name));
       }
 
       auto categories = getCategories(channel);
       if (fields.find("CATEGORIES") != fields.end() && !categories.empty()) {
-        PVariable categoriesResult = std::make_shared<Variable>(VariableType::tArray);
+        PVariable categoriesResult = MemoryArena::makeShared<Variable>(VariableType::tArray);
         categoriesResult->arrayValue->reserve(categories.size());
         for (auto category : categories) {
-          categoriesResult->arrayValue->push_back(std::make_shared<Variable>(category));
+          categoriesResult->emplaceArrayElement(category);
         }
-        description->structValue->emplace("CATEGORIES", categoriesResult);
+        description->structValue->emplace("CATEGORIES", std::move(categoriesResult));
       }
     }
     return description;
@@ -3084,7 +3140,7 @@ PVariable Peer::getParamset(PRpcClientInfo clientInfo, int32_t channel, Paramete
         if (!element) continue;
         if (element->type == VariableType::tVoid) continue;
         if (parameter.rpcParameter->password && (!clientInfo || !clientInfo->scriptEngineServer)) element.reset(new Variable(element->type));
-        variables->structValue->insert(StructElement(parameter.rpcParameter->id, element));
+        variables->structValue->emplace(parameter.rpcParameter->id, std::move(element));
       }
     } else if (type == ParameterGroup::Type::Enum::config) {
       auto configIterator = configCentral.find(channel);
@@ -3111,7 +3167,7 @@ PVariable Peer::getParamset(PRpcClientInfo clientInfo, int32_t channel, Paramete
         if (!element) continue;
         if (element->type == VariableType::tVoid) continue;
         if (parameter.rpcParameter->password && (!clientInfo || !clientInfo->scriptEngineServer)) element.reset(new Variable(element->type));
-        variables->structValue->insert(StructElement(parameter.rpcParameter->id, element));
+        variables->structValue->emplace(parameter.rpcParameter->id, std::move(element));
       }
     } else if (type == ParameterGroup::Type::Enum::link) {
       std::shared_ptr<BasicPeer> remotePeer;
@@ -3147,7 +3203,7 @@ PVariable Peer::getParamset(PRpcClientInfo clientInfo, int32_t channel, Paramete
         if (!element) continue;
         if (element->type == VariableType::tVoid) continue;
         if (parameter.rpcParameter->password && (!clientInfo || !clientInfo->scriptEngineServer)) element.reset(new Variable(element->type));
-        variables->structValue->insert(StructElement(parameter.rpcParameter->id, element));
+        variables->structValue->emplace(parameter.rpcParameter->id, std::move(element));
       }
     }
 
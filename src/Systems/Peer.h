@@ -591,6 +591,36 @@ class Peer : public ServiceMessages::IServiceEventSink, public IEvents {
   bool _saveTeam = false;
   uint32_t _lastPacketReceived = 0;
 
+  // {{{ Suppression of unchanged RPC events
+  struct LastRpcEventValue {
+    /**
+     * Variable::hash() of value, so only the new value needs to be hashed.
+     */
+    uint64_t hash = 0;
+
+    /**
+     * Copy of the last delivered value. It owns its data, so no receive buffers are kept alive.
+     */
+    PVariable value;
+  };
+
+  std::mutex _lastRpcEventValuesMutex;
+
+  /**
+   * The last delivered values of variables with suppressUnchangedEvents set by channel and variable name.
+   */
+  std::unordered_map<int32_t, std::unordered_map<std::string, LastRpcEventValue>> _lastRpcEventValues;
+
+  /**
+   * Removes all values of variables with suppressUnchangedEvents set from valueKeys and values, when they are equal to
+   * the last delivered value. Values are compared by hash first and then confirmed with Variable::operator==, so a hash
+   * collision never drops a changed value. Action variables (e. g. PRESS_SHORT) are never removed.
+   *
+   * @return Returns false when no value is left.
+   */
+  bool filterUnchangedRpcEventValues(int32_t channel, std::shared_ptr<std::vector<std::string>> &valueKeys, std::shared_ptr<std::vector<PVariable>> &values);
+  // }}}
+
   // {{{ Event handling
   //Hooks
   std::map<int32_t, PEventHandler> _webserverEventHandlers;
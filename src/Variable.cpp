@@ -32,6 +32,7 @@
 #include "BaseLib.h"
 
 #include <iostream>
+#include <cstring>
 
 namespace BaseLib
 {
@@ -39,32 +40,33 @@ namespace BaseLib
 Variable::Variable()
 {
 	type = VariableType::tVoid;
-	arrayValue = std::make_shared<Array>();
-	structValue = std::make_shared<Struct>();
 }
 
 Variable::Variable(Variable const& rhs)
 {
 	errorStruct = rhs.errorStruct;
 	type = rhs.type;
-	stringValue = rhs.stringValue;
 	integerValue = rhs.integerValue;
 	integerValue64 = rhs.integerValue64;
 	floatValue = rhs.floatValue;
 	booleanValue = rhs.booleanValue;
-	binaryValue = rhs.binaryValue;
-	for(Array::const_iterator i = rhs.arrayValue->begin(); i != rhs.arrayValue->end(); ++i)
-	{
-		PVariable lhs = std::make_shared<Variable>();
-		*lhs = *(*i);
-		arrayValue->push_back(lhs);
-	}
-	for(Struct::const_iterator i = rhs.structValue->begin(); i != rhs.structValue->end(); ++i)
-	{
-		PVariable lhs = std::make_shared<Variable>();
-		*lhs = *(i->second);
-		structValue->insert(std::pair<std::string, PVariable>(i->first, lhs));
-	}
+	copyData(rhs);
+	copyContainers(rhs);
+}
+
+Variable::Variable(Variable&& rhs) noexcept
+{
+	errorStruct = rhs.errorStruct;
+	type = rhs.type;
+	stringValue = std::move(rhs.stringValue);
+	integerValue = rhs.integerValue;
+	integerValue64 = rhs.integerValue64;
+	floatValue = rhs.floatValue;
+	booleanValue = rhs.booleanValue;
+	arrayValue = std::move(rhs.arrayValue);
+	structValue = std::move(rhs.structValue);
+	binaryValue = std::move(rhs.binaryValue);
+	dataView = std::move(rhs.dataView);
 }
 
 Variable::Variable(VariableType variableType) : Variable()
@@ -127,6 +129,15 @@ Variable::Variable(const std::string& string) : Variable()
 	booleanValue = !stringValue.empty() && stringValue != "0" && stringValue != "false" && stringValue != "f";
 }
 
+Variable::Variable(std::string&& string) : Variable()
+{
+	type = VariableType::tString;
+	stringValue = std::move(string);
+	integerValue64 = Math::getNumber64(stringValue);
+	integerValue = (int32_t)integerValue64;
+	booleanValue = !stringValue.empty() && stringValue != "0" && stringValue != "false" && stringValue != "f";
+}
+
 Variable::Variable(const char* string) : Variable(std::string(string))
 {
 }
@@ -154,6 +165,12 @@ Variable::Variable(const PArray& arrayVal) : Variable()
 	arrayValue = arrayVal;
 }
 
+Variable::Variable(PArray&& arrayVal) : Variable()
+{
+	type = VariableType::tArray;
+	arrayValue = std::move(arrayVal);
+}
+
 Variable::Variable(const std::vector<std::string>& arrayVal) : Variable()
 {
 	type = VariableType::tArray;
@@ -170,12 +187,24 @@ Variable::Variable(const PStruct& structVal) : Variable()
 	structValue = structVal;
 }
 
+Variable::Variable(PStruct&& structVal) : Variable()
+{
+	type = VariableType::tStruct;
+	structValue = std::move(structVal);
+}
+
 Variable::Variable(const std::vector<uint8_t>& binaryVal) : Variable()
 {
 	type = VariableType::tBinary;
 	binaryValue = binaryVal;
 }
 
+Variable::Variable(std::vector<uint8_t>&& binaryVal) : Variable()
+{
+	type = VariableType::tBinary;
+	binaryValue = std::move(binaryVal);
+}
+
 Variable::Variable(const uint8_t* binaryVal, size_t binaryValSize) : Variable()
 {
 	type = VariableType::tBinary;
@@ -241,6 +270,183 @@ Variable::~Variable()
 {
 }
 
+void Variable::copyContainers(const Variable& rhs)
+{
+	arrayValue.resetToEmpty();
+	structValue.resetToEmpty();
+	if(!rhs.arrayValue.isEmpty())
+	{
+		arrayValue->reserve(rhs.arrayValue->size());
+		for(auto& element : *rhs.arrayValue)
+		{
+			arrayValue->push_back(std::make_shared<Variable>(*element));
+		}
+	}
+	if(!rhs.structValue.isEmpty())
+	{
+		for(auto& element : *rhs.structValue)
+		{
+			structValue->emplace_hint(structValue->end(), element.first, std::make_shared<Variable>(*element.second));
+		}
+	}
+}
+
+PVariable Variable::copyOnWrite() const
+{
+	auto copy = std::make_shared<Variable>();
+	copy->errorStruct = errorStruct;
+	copy->type = type;
+	copy->integerValue = integerValue;
+	copy->integerValue64 = integerValue64;
+	copy->floatValue = floatValue;
+	copy->booleanValue = booleanValue;
+	copy->copyData(*this);
+	copy->arrayValue = arrayValue;
+	copy->structValue = structValue;
+	return copy;
+}
+
+namespace
+{
+
+/**
+ * Replaces element by a copy on write copy when it is referenced elsewhere.
+ */
+void detachElement(PVariable& element)
+{
+	if(element && element.use_count() > 1) element = element->copyOnWrite();
+	//use_count() is a relaxed load. Synchronize with the release of the former co-owner before modifying.
+	else std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+}
+
+PVariable& Variable::mutableArrayElement(size_t index)
+{
+	PVariable& element = mutableArray().at(index);
+	detachElement(element);
+	return element;
+}
+
+PVariable& Variable::mutableStructElement(const std::string& name)
+{
+	PVariable& element = mutableStruct().at(name);
+	detachElement(element);
+	return element;
+}
+
+uint64_t Variable::hash() const
+{
+	//FNV-1a, so the result doesn't depend on the standard library implementation.
+	const uint64_t prime = 1099511628211ull;
+	auto hashBytes = [prime](uint64_t hash, const uint8_t* data, size_t size)
+	{
+		for(size_t i = 0; i < size; i++)
+		{
+			hash ^= data[i];
+			hash *= prime;
+		}
+		return hash;
+	};
+	auto hashInteger = [&hashBytes](uint64_t hash, uint64_t value)
+	{
+		uint8_t bytes[8];
+		for(int32_t i = 0; i < 8; i++) bytes[i] = (uint8_t)(value >> (i * 8));
+		return hashBytes(hash, bytes, sizeof(bytes));
+	};
+
+	uint64_t hash = hashInteger(14695981039346656037ull, (uint64_t)type);
+	switch(type)
+	{
+	case VariableType::tBoolean:
+		return hashInteger(hash, (uint64_t)booleanValue);
+	case VariableType::tInteger:
+		return hashInteger(hash, (uint64_t)(int64_t)integerValue);
+	case VariableType::tInteger64:
+		return hashInteger(hash, (uint64_t)integerValue64);
+	case VariableType::tFloat:
+	{
+		double value = floatValue == 0 ? 0 : floatValue; //0.0 and -0.0 are equal
+		uint64_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return hashInteger(hash, bits);
+	}
+	case VariableType::tString:
+	case VariableType::tBase64:
+	case VariableType::tBinary:
+	{
+		BufferView data = getDataView();
+		return hashBytes(hash, data.data(), data.size());
+	}
+	case VariableType::tArray:
+		if(arrayValue.isEmpty()) return hash;
+		for(auto& element : *arrayValue)
+		{
+			hash = hashInteger(hash, element->hash());
+		}
+		return hash;
+	case VariableType::tStruct:
+		if(structValue.isEmpty()) return hash;
+		for(auto& element : *structValue)
+		{
+			hash = hashBytes(hash, (const uint8_t*)element.first.data(), element.first.size() + 1);
+			hash = hashInteger(hash, element.second->hash());
+		}
+		return hash;
+	case VariableType::tVoid:
+	case VariableType::tVariant:
+		break;
+	}
+	return hash;
+}
+
+bool Variable::usesDataView() const
+{
+	if(!dataView.isSet()) return false;
+	if(type == VariableType::tString || type == VariableType::tBase64) return stringValue.empty();
+	return binaryValue.empty();
+}
+
+void Variable::copyData(const Variable& rhs)
+{
+	if(rhs.usesDataView())
+	{
+		if(rhs.type == VariableType::tString || rhs.type == VariableType::tBase64)
+		{
+			stringValue = rhs.dataView.toString();
+			binaryValue = rhs.binaryValue;
+		}
+		else
+		{
+			stringValue = rhs.stringValue;
+			binaryValue = rhs.dataView.toVector();
+		}
+	}
+	else
+	{
+		stringValue = rhs.stringValue;
+		binaryValue = rhs.binaryValue;
+	}
+	dataView.reset();
+}
+
+BufferView Variable::getDataView() const
+{
+	if(usesDataView()) return dataView;
+	if(type == VariableType::tString || type == VariableType::tBase64) return BufferView(std::shared_ptr<const void>(), (const uint8_t*)stringValue.data(), stringValue.size());
+	return BufferView(std::shared_ptr<const void>(), binaryValue.data(), binaryValue.size());
+}
+
+void Variable::resolveDataView()
+{
+	if(usesDataView())
+	{
+		if(type == VariableType::tString || type == VariableType::tBase64) stringValue = dataView.toString();
+		else binaryValue = dataView.toVector();
+	}
+	dataView.reset();
+}
+
 void Variable::parseXmlNode(const xml_node* node, PStruct& xmlStruct)
 {
 	for(const xml_attribute* attr = node->first_attribute(); attr; attr = attr->next_attribute())
@@ -274,64 +480,72 @@ Variable& Variable::operator=(const Variable& rhs)
 	if(&rhs == this) return *this;
 	errorStruct = rhs.errorStruct;
 	type = rhs.type;
-	stringValue = rhs.stringValue;
 	integerValue = rhs.integerValue;
 	integerValue64 = rhs.integerValue64;
 	floatValue = rhs.floatValue;
 	booleanValue = rhs.booleanValue;
-	binaryValue = rhs.binaryValue;
-	for(Array::const_iterator i = rhs.arrayValue->begin(); i != rhs.arrayValue->end(); ++i)
-	{
-		PVariable lhs = std::make_shared<Variable>();
-		*lhs = *(*i);
-		arrayValue->push_back(lhs);
-	}
-	for(Struct::const_iterator i = rhs.structValue->begin(); i != rhs.structValue->end(); ++i)
-	{
-		PVariable lhs = std::make_shared<Variable>();
-		*lhs = *(i->second);
-		structValue->insert(std::pair<std::string, PVariable>(i->first, lhs));
-	}
+	copyData(rhs);
+	copyContainers(rhs);
+	return *this;
+}
+
+Variable& Variable::operator=(Variable&& rhs) noexcept
+{
+	if(&rhs == this) return *this;
+	errorStruct = rhs.errorStruct;
+	type = rhs.type;
+	stringValue = std::move(rhs.stringValue);
+	integerValue = rhs.integerValue;
+	integerValue64 = rhs.integerValue64;
+	floatValue = rhs.floatValue;
+	booleanValue = rhs.booleanValue;
+	arrayValue = std::move(rhs.arrayValue);
+	structValue = std::move(rhs.structValue);
+	binaryValue = std::move(rhs.binaryValue);
+	dataView = std::move(rhs.dataView);
 	return *this;
 }
 
-bool Variable::operator==(const Variable& rhs)
+bool Variable::operator==(const Variable& rhs) const
 {
+	if(&rhs == this) return true;
 	if(type != rhs.type) return false;
 	if(type == VariableType::tBoolean) return booleanValue == rhs.booleanValue;
 	if(type == VariableType::tInteger) return integerValue == rhs.integerValue;
 	if(type == VariableType::tInteger64) return integerValue64 == rhs.integerValue64;
-	if(type == VariableType::tString) return stringValue == rhs.stringValue;
+	if(type == VariableType::tString || type == VariableType::tBase64 || type == VariableType::tBinary)
+	{
+		if(usesDataView() || rhs.usesDataView())
+		{
+			BufferView data = getDataView();
+			BufferView rhsData = rhs.getDataView();
+			return data.size() == rhsData.size() && (data.empty() || std::memcmp(data.data(), rhsData.data(), data.size()) == 0);
+		}
+		if(type == VariableType::tBinary) return binaryValue == rhs.binaryValue;
+		return stringValue == rhs.stringValue;
+	}
 	if(type == VariableType::tFloat) return floatValue == rhs.floatValue;
 	if(type == VariableType::tArray)
 	{
+		if(arrayValue.isEmpty() || rhs.arrayValue.isEmpty()) return arrayValue.isEmpty() == rhs.arrayValue.isEmpty();
+		if(arrayValue.sharesContainerWith(rhs.arrayValue)) return true;
 		if(arrayValue->size() != rhs.arrayValue->size()) return false;
-		for(std::pair<Array::iterator, Array::iterator> i(arrayValue->begin(), rhs.arrayValue->begin()); i.first != arrayValue->end(); ++i.first, ++i.second)
+		for(Array::const_iterator i = arrayValue->begin(), j = rhs.arrayValue->begin(); i != arrayValue->end(); ++i, ++j)
 		{
-			if(**(i.first) != **(i.second)) return false;
+			if(*i != *j && **i != **j) return false;
 		}
 		return true;
 	}
 	if(type == VariableType::tStruct)
 	{
+		if(structValue.isEmpty() || rhs.structValue.isEmpty()) return structValue.isEmpty() == rhs.structValue.isEmpty();
+		if(structValue.sharesContainerWith(rhs.structValue)) return true;
 		if(structValue->size() != rhs.structValue->size()) return false;
-		for(auto& element : *structValue)
-        {
-		    auto rhsIterator = rhs.structValue->find(element.first);
-		    if(rhsIterator == rhs.structValue->end() || *element.second != *rhsIterator->second) return false;
-        }
-		return true;
-	}
-	if(type == VariableType::tBase64) return stringValue == rhs.stringValue;
-	if(type == VariableType::tBinary)
-	{
-		if(binaryValue.size() != rhs.binaryValue.size()) return false;
-		if(binaryValue.empty()) return true;
-		uint8_t* i = &binaryValue[0];
-		uint8_t* j = (uint8_t*)&rhs.binaryValue[0];
-		for(; i < &binaryValue[0] + binaryValue.size(); i++, j++)
+		//Both maps are sorted by key, so they can be compared element by element.
+		for(Struct::const_iterator i = structValue->begin(), j = rhs.structValue->begin(); i != structValue->end(); ++i, ++j)
 		{
-			if(*i != *j) return false;
+			if(i->first != j->first) return false;
+			if(i->second != j->second && *i->second != *j->second) return false;
 		}
 		return true;
 	}
@@ -414,7 +628,7 @@ bool Variable::operator>=(const Variable& rhs)
 	return false;
 }
 
-bool Variable::operator!=(const Variable& rhs)
+bool Variable::operator!=(const Variable& rhs) const
 {
 	return !(operator==(rhs));
 }
@@ -427,13 +641,13 @@ Variable::operator bool_type() const
 		switch(type)
 		{
 		case VariableType::tArray:
-			result = !arrayValue->empty();
+			result = !arrayValue.isEmpty();
 			break;
 		case VariableType::tBase64:
-			result = !stringValue.empty();
+			result = !getDataView().empty();
 			break;
 		case VariableType::tBinary:
-			result = !binaryValue.empty();
+			result = !getDataView().empty();
 			break;
 		case VariableType::tBoolean:
 			break;
@@ -447,10 +661,11 @@ Variable::operator bool_type() const
 			result = (bool)integerValue64;
 			break;
 		case VariableType::tString:
-			result = !stringValue.empty() && stringValue != "0" && stringValue != "false" && stringValue != "f";
+			if(usesDataView()) result = booleanValue;
+			else result = !stringValue.empty() && stringValue != "0" && stringValue != "false" && stringValue != "f";
 			break;
 		case VariableType::tStruct:
-			result = !structValue->empty();
+			result = !structValue.isEmpty();
 			break;
 		case VariableType::tVariant:
 			break;
@@ -488,11 +703,11 @@ std::string Variable::print(bool stdout, bool stderr, bool oneLine)
 	}
 	else if(type == VariableType::tString)
 	{
-		result << "(String) " << stringValue << (oneLine ? " " : "\n");
+		result << "(String) " << (usesDataView() ? dataView.toString() : stringValue) << (oneLine ? " " : "\n");
 	}
 	else if(type == VariableType::tBase64)
 	{
-		result << "(Base64) " << stringValue << (oneLine ? " " : "\n");
+		result << "(Base64) " << (usesDataView() ? dataView.toString() : stringValue) << (oneLine ? " " : "\n");
 	}
 	else if(type == VariableType::tArray)
 	{
@@ -506,7 +721,7 @@ std::string Variable::print(bool stdout, bool stderr, bool oneLine)
 	}
 	else if(type == VariableType::tBinary)
 	{
-		result << "(Binary) " << HelperFunctions::getHexString(binaryValue) << (oneLine ? " " : "\n");
+		result << "(Binary) " << HelperFunctions::getHexString(usesDataView() ? dataView.toVector() : binaryValue) << (oneLine ? " " : "\n");
 	}
 	else
 	{
@@ -544,11 +759,11 @@ std::string Variable::print(PVariable variable, std::string indent, bool ignoreI
 	}
 	else if(variable->type == VariableType::tString)
 	{
-		result << (ignoreIndentOnFirstLine ? "" : indent) << "(String) " << variable->stringValue << (oneLine ? " " : "\n");
+		result << (ignoreIndentOnFirstLine ? "" : indent) << "(String) " << (variable->usesDataView() ? variable->dataView.toString() : variable->stringValue) << (oneLine ? " " : "\n");
 	}
 	else if(type == VariableType::tBase64)
 	{
-		result << (ignoreIndentOnFirstLine ? "" : indent) << "(Base64) " << variable->stringValue << (oneLine ? " " : "\n");
+		result << (ignoreIndentOnFirstLine ? "" : indent) << "(Base64) " << (variable->usesDataView() ? variable->dataView.toString() : variable->stringValue) << (oneLine ? " " : "\n");
 	}
 	else if(variable->type == VariableType::tArray)
 	{
@@ -560,7 +775,7 @@ std::string Variable::print(PVariable variable, std::string indent, bool ignoreI
 	}
 	else if(variable->type == VariableType::tBinary)
 	{
-		result << (ignoreIndentOnFirstLine ? "" : indent) << "(Binary) " << HelperFunctions::getHexString(variable->binaryValue) << (oneLine ? " " : "\n");
+		result << (ignoreIndentOnFirstLine ? "" : indent) << "(Binary) " << HelperFunctions::getHexString(variable->usesDataView() ? variable->dataView.toVector() : variable->binaryValue) << (oneLine ? " " : "\n");
 	}
 	else
 	{
@@ -692,6 +907,7 @@ std::string Variable::toString()
 	case VariableType::tArray:
 		return "array";
 	case VariableType::tBase64:
+		if(usesDataView()) return dataView.toString();
 		return stringValue;
 	case VariableType::tBoolean:
 		if(booleanValue) return "true"; else return "false";
@@ -702,10 +918,12 @@ std::string Variable::toString()
 	case VariableType::tInteger64:
 		return std::to_string(integerValue64);
 	case VariableType::tString:
+		if(usesDataView()) return dataView.toString();
 		return stringValue;
 	case VariableType::tStruct:
 		return "struct";
 	case VariableType::tBinary:
+		if(usesDataView()) return HelperFunctions::getHexString(dataView.toVector());
 		return HelperFunctions::getHexString(binaryValue);
 	case VariableType::tVoid:
 		return "";
@@ -34,6 +34,8 @@
 #include "Encoding/RapidXml/rapidxml.h"
 #include "DeviceDescription/Logical.h"
 #include "DeviceDescription/Physical.h"
+#include "BufferView.h"
+#include "HelperFunctions/MemoryArena.h"
 
 #include <vector>
 #include <string>
@@ -41,6 +43,8 @@
 #include <map>
 #include <list>
 #include <cmath>
+#include <atomic>
+#include <thread>
 
 using namespace rapidxml;
 
@@ -75,6 +79,172 @@ typedef std::shared_ptr<Array> PArray;
 typedef std::list<PVariable> List;
 typedef std::shared_ptr<List> PList;
 
+/**
+ * Holder for the array and struct containers of Variable. The container is only allocated on first access, so scalar
+ * variables don't pay for two additional heap allocations. Logically an unallocated holder contains an empty container,
+ * so it can be used like the std::shared_ptr it replaces (i. e. "variable->arrayValue->push_back(...)" or
+ * "PArray array = variable->arrayValue;"). Use isAllocated() to check for content without allocating.
+ *
+ * Concurrent reads are safe like with the eagerly allocated std::shared_ptr before: The thread allocating first claims the
+ * holder with a compare and swap on its state and publishes the container by setting the state to allocated. Threads
+ * losing that race wait for the publication, which only happens when two threads access a new holder at the same time.
+ * There is no lock shared between holders. Like with std::shared_ptr concurrent modifications of the holder itself
+ * (assignment, reset(), ...) are not safe.
+ *
+ * Assigning nullptr or an empty std::shared_ptr or calling reset() leaves the holder empty. As with std::shared_ptr it
+ * then evaluates to false and must not be dereferenced. resetToEmpty() drops the container and makes the holder behave
+ * like a new one instead.
+ *
+ * Const access only hands out const containers. Containers shared between variables (see Variable::copyOnWrite()) must
+ * only be modified through detach().
+ */
+template<typename T>
+class LazySharedPointer
+{
+public:
+	LazySharedPointer() = default;
+	explicit LazySharedPointer(const std::shared_ptr<T>& pointer) : _pointer(pointer), _state(State::allocated) {}
+	explicit LazySharedPointer(std::shared_ptr<T>&& pointer) : _pointer(std::move(pointer)), _state(State::allocated) {}
+
+	/**
+	 * Shares the container of rhs. Doesn't allocate: When rhs is not allocated yet, the new holder isn't either and gets
+	 * its own container on first access.
+	 */
+	LazySharedPointer(const LazySharedPointer& rhs) { assign(rhs); }
+	LazySharedPointer(LazySharedPointer&& rhs) noexcept { take(rhs); }
+
+	LazySharedPointer& operator=(const LazySharedPointer& rhs) { if(&rhs != this) assign(rhs); return *this; }
+	LazySharedPointer& operator=(LazySharedPointer&& rhs) noexcept { if(&rhs != this) take(rhs); return *this; }
+	LazySharedPointer& operator=(const std::shared_ptr<T>& rhs) { _pointer = rhs; _state.store(State::allocated, std::memory_order_release); return *this; }
+	LazySharedPointer& operator=(std::shared_ptr<T>&& rhs) { _pointer = std::move(rhs); _state.store(State::allocated, std::memory_order_release); return *this; }
+	LazySharedPointer& operator=(std::nullptr_t) { reset(); return *this; }
+
+	T* operator->() { return get(); }
+	const T* operator->() const { return get(); }
+	T& operator*() { return *get(); }
+	const T& operator*() const { return *get(); }
+	T* get() { return isPublished() ? _pointer.get() : allocate(); }
+	const T* get() const { return isPublished() ? _pointer.get() : allocate(); }
+	std::shared_ptr<T>& getShared()
+	{
+		if(!isPublished()) allocate();
+		return _pointer;
+	}
+	std::shared_ptr<const T> getShared() const
+	{
+		if(!isPublished()) allocate();
+		return _pointer;
+	}
+	operator std::shared_ptr<T>&() { return getShared(); }
+	operator std::shared_ptr<const T>() const { return getShared(); }
+
+	/**
+	 * Returns the container for modification. When the container is also referenced elsewhere, e. g. by a copy created
+	 * with Variable::copyOnWrite(), the holder gets its own copy of the container first. Only the container is copied,
+	 * not the elements.
+	 */
+	T& detach()
+	{
+		std::shared_ptr<T>& pointer = getShared();
+		if(pointer.use_count() > 1) pointer = std::make_shared<T>(*pointer);
+		//use_count() is a relaxed load. Synchronize with the release of the former co-owner before modifying.
+		else std::atomic_thread_fence(std::memory_order_acquire);
+		return *pointer;
+	}
+
+	/**
+	 * False only after the holder has been emptied explicitly (see reset()), just like the std::shared_ptr it replaces.
+	 * An unallocated holder is true, because it behaves like an empty container. Does not allocate.
+	 */
+	explicit operator bool() const noexcept { return !isPublished() || _pointer; }
+	bool operator==(std::nullptr_t) const noexcept { return !(bool)*this; }
+	bool operator!=(std::nullptr_t) const noexcept { return (bool)*this; }
+	bool operator==(const std::shared_ptr<T>& rhs) const { return isPublished() && _pointer == rhs; }
+	bool operator!=(const std::shared_ptr<T>& rhs) const { return !(*this == rhs); }
+
+	/**
+	 * Returns true when the container has been allocated. Does not allocate it.
+	 */
+	bool isAllocated() const noexcept { return isPublished() && _pointer; }
+
+	/**
+	 * Returns true when there is no container or the container is empty. Does not allocate it.
+	 */
+	bool isEmpty() const { return !isAllocated() || _pointer->empty(); }
+
+	/**
+	 * Returns true when both holders point to the same allocated container. Does not allocate it.
+	 */
+	bool sharesContainerWith(const LazySharedPointer& rhs) const noexcept { return isAllocated() && rhs.isAllocated() && _pointer == rhs._pointer; }
+
+	long use_count() const noexcept { return isAllocated() ? _pointer.use_count() : 0; }
+
+	/**
+	 * Empties the holder like std::shared_ptr::reset(). It must be assigned a container before it is accessed again.
+	 */
+	void reset() noexcept { _pointer.reset(); _state.store(State::allocated, std::memory_order_release); }
+
+	/**
+	 * Drops the container. Afterwards the holder behaves like a new one: It is empty and allocates on next access.
+	 */
+	void resetToEmpty() noexcept { _pointer.reset(); _state.store(State::unallocated, std::memory_order_release); }
+	void swap(std::shared_ptr<T>& rhs) { getShared().swap(rhs); }
+private:
+	mutable std::shared_ptr<T> _pointer;
+
+	enum class State : uint8_t
+	{
+		unallocated,
+		allocating,
+		allocated
+	};
+
+	/**
+	 * State::allocated once _pointer is valid, either by allocate() or by assignment. Until then _pointer is only accessed by
+	 * the thread that changed the state from unallocated to allocating.
+	 */
+	mutable std::atomic<State> _state{State::unallocated};
+
+	bool isPublished() const noexcept { return _state.load(std::memory_order_acquire) == State::allocated; }
+
+	T* allocate() const
+	{
+		State expected = State::unallocated;
+		if(_state.compare_exchange_strong(expected, State::allocating, std::memory_order_acquire))
+		{
+			try
+			{
+				_pointer = std::make_shared<T>();
+			}
+			catch(...)
+			{
+				_state.store(State::unallocated, std::memory_order_release);
+				throw;
+			}
+			_state.store(State::allocated, std::memory_order_release);
+		}
+		else while(!isPublished()) std::this_thread::yield();
+		return _pointer.get();
+	}
+
+	void assign(const LazySharedPointer& rhs)
+	{
+		if(rhs.isPublished())
+		{
+			_pointer = rhs._pointer;
+			_state.store(State::allocated, std::memory_order_release);
+		}
+		else resetToEmpty();
+	}
+
+	void take(LazySharedPointer& rhs) noexcept
+	{
+		_pointer = std::move(rhs._pointer);
+		_state.store(rhs._state.load(std::memory_order_acquire), std::memory_order_release);
+		rhs._state.store(State::unallocated, std::memory_order_release);
+	}
+};
+
 class Variable
 {
 private:
@@ -85,6 +255,21 @@ private:
 	std::string printStruct(PStruct rpcStruct, std::string indent, bool ignoreIndentOnFirstLine, bool oneLine);
 	std::string printArray(PArray rpcArray, std::string indent, bool ignoreIndentOnFirstLine, bool oneLine);
 
+	/**
+	 * Replaces arrayValue and structValue with deep copies of the containers of rhs.
+	 */
+	void copyContainers(const Variable& rhs);
+
+	/**
+	 * Returns true when dataView is set and stringValue or binaryValue (depending on the type) is empty.
+	 */
+	bool usesDataView() const;
+
+	/**
+	 * Copies stringValue and binaryValue of rhs. When rhs uses a view, its content is copied instead of the view.
+	 */
+	void copyData(const Variable& rhs);
+
 	/**
 	 * Converts a XML node to a struct. Important: Multiple usage of the same name on the same level is not possible.
 	 */
@@ -97,12 +282,22 @@ public:
 	int64_t integerValue64 = 0;
 	double floatValue = 0;
 	bool booleanValue = false;
-	PArray arrayValue;
-	PStruct structValue;
+	LazySharedPointer<Array> arrayValue;
+	LazySharedPointer<Struct> structValue;
 	std::vector<uint8_t> binaryValue;
 
+	/**
+	 * Zero-copy alternative to stringValue (tString and tBase64) and binaryValue (tBinary) pointing into a receive
+	 * buffer. Only set by decoders when explicitly requested (see RpcDecoder::setMinimumViewSize()), which also fill the
+	 * numeric fields. The view is only used while stringValue or binaryValue is empty, so assigning a value replaces it.
+	 * Copies of the variable own their data and don't reference the buffer. Code reading stringValue or binaryValue
+	 * directly needs to call resolveDataView() first or use getDataView().
+	 */
+	BufferView dataView;
+
     Variable();
     Variable(Variable const& rhs);
+    Variable(Variable&& rhs) noexcept;
     explicit Variable(VariableType variableType);
     explicit Variable(uint8_t integer);
     explicit Variable(int32_t integer);
@@ -110,13 +305,17 @@ public:
     explicit Variable(int64_t integer);
     explicit Variable(uint64_t integer);
     explicit Variable(const std::string& string);
+    explicit Variable(std::string&& string);
     explicit Variable(const char* string);
     explicit Variable(bool boolean);
     explicit Variable(double floatVal);
     explicit Variable(const PArray& arrayVal);
+    explicit Variable(PArray&& arrayVal);
     explicit Variable(const std::vector<std::string>& arrayVal);
     explicit Variable(const PStruct& structVal);
+    explicit Variable(PStruct&& structVal);
     explicit Variable(const std::vector<uint8_t>& binaryVal);
+    explicit Variable(std::vector<uint8_t>&& binaryVal);
     explicit Variable(const uint8_t* binaryVal, size_t binaryValSize);
     explicit Variable(const std::vector<char>& binaryVal);
     explicit Variable(const char* binaryVal, size_t binaryValSize);
@@ -134,12 +333,93 @@ public:
 	static PVariable fromString(std::string& value, VariableType type);
 	std::string toString();
 	Variable& operator=(const Variable& rhs);
-	bool operator==(const Variable& rhs);
+	Variable& operator=(Variable&& rhs) noexcept;
+
+	/**
+	 * Constructs a variable from args in place and appends it to arrayValue. Pass strings, binaries and containers as
+	 * rvalues to move them into the new variable.
+	 *
+	 * @return Returns the new element.
+	 */
+	template<typename... Args>
+	PVariable& emplaceArrayElement(Args&&... args)
+	{
+		arrayValue->emplace_back(MemoryArena::makeShared<Variable>(std::forward<Args>(args)...));
+		return arrayValue->back();
+	}
+
+	/**
+	 * Constructs a variable from args in place and inserts it into structValue. Like insert(), an existing member with
+	 * the same name is not replaced.
+	 *
+	 * @return Returns the member with the given name.
+	 */
+	template<typename... Args>
+	PVariable& emplaceStructElement(std::string name, Args&&... args)
+	{
+		return structValue->emplace(std::move(name), MemoryArena::makeShared<Variable>(std::forward<Args>(args)...)).first->second;
+	}
+
+	/**
+	 * Returns a copy of the variable in constant time. The array and struct containers and their elements are shared
+	 * with this variable. This variable is not modified, so it can be copied while other threads read it.
+	 *
+	 * Shared containers and elements must not be modified directly through arrayValue or structValue, as that would
+	 * change both variables. Use mutableArray(), mutableStruct(), mutableArrayElement() and mutableStructElement()
+	 * instead. They copy a container or element first when it is still referenced elsewhere. PVariables to elements
+	 * obtained before keep pointing to the shared, unmodified element.
+	 */
+	PVariable copyOnWrite() const;
+
+	/**
+	 * Returns arrayValue for modification. See copyOnWrite().
+	 */
+	Array& mutableArray() { return arrayValue.detach(); }
+
+	/**
+	 * Returns structValue for modification. See copyOnWrite().
+	 */
+	Struct& mutableStruct() { return structValue.detach(); }
+
+	/**
+	 * Returns the array element at index for modification. The element is copied with copyOnWrite() first when it is
+	 * still referenced elsewhere. See copyOnWrite().
+	 *
+	 * @throws std::out_of_range when index is invalid.
+	 */
+	PVariable& mutableArrayElement(size_t index);
+
+	/**
+	 * Returns the struct member with the given name for modification. The member is copied with copyOnWrite() first when
+	 * it is still referenced elsewhere. See copyOnWrite().
+	 *
+	 * @throws std::out_of_range when there is no member with this name.
+	 */
+	PVariable& mutableStructElement(const std::string& name);
+
+	/**
+	 * Returns a structural hash over type and value, including all array elements and struct members. Equal variables
+	 * have equal hashes. The hash is computed on each call and is the same on all platforms and across restarts.
+	 */
+	uint64_t hash() const;
+
+	/**
+	 * Returns dataView when it is in use (see dataView), otherwise a view of stringValue (tString and tBase64) or
+	 * binaryValue (all other types). In the latter case the view doesn't own the data, so it is only valid as long as the
+	 * variable is unchanged.
+	 */
+	BufferView getDataView() const;
+
+	/**
+	 * Copies the content of dataView to stringValue or binaryValue when it is in use and resets dataView.
+	 */
+	void resolveDataView();
+	bool operator==(const Variable& rhs) const;
 	bool operator<(const Variable& rhs);
 	bool operator<=(const Variable& rhs);
 	bool operator>(const Variable& rhs);
 	bool operator>=(const Variable& rhs);
-	bool operator!=(const Variable& rhs);
+	bool operator!=(const Variable& rhs) const;
 	operator bool_type() const;
 };
 
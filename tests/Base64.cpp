@@ -0,0 +1,196 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+#include "Test.h"
+
+#include "BaseLib.h"
+
+#include <random>
+
+using namespace BaseLib;
+
+namespace
+{
+
+const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/**
+ * Byte by byte reference the vectorized code is compared with.
+ */
+std::string referenceEncode(const uint8_t* in, size_t size)
+{
+	std::string out;
+	for(size_t i = 0; i < size; i += 3)
+	{
+		const size_t groupSize = std::min((size_t)3, size - i);
+		uint32_t group = (uint32_t)in[i] << 16;
+		if(groupSize > 1) group |= (uint32_t)in[i + 1] << 8;
+		if(groupSize > 2) group |= in[i + 2];
+		out.push_back(alphabet[(group >> 18) & 0x3F]);
+		out.push_back(alphabet[(group >> 12) & 0x3F]);
+		out.push_back(groupSize > 1 ? alphabet[(group >> 6) & 0x3F] : '=');
+		out.push_back(groupSize > 2 ? alphabet[group & 0x3F] : '=');
+	}
+	return out;
+}
+
+/**
+ * Decodes up to the first character that is not Base64. A trailing single character contains no complete byte.
+ */
+std::string referenceDecode(const char* in, size_t size)
+{
+	std::string out;
+	uint32_t bits = 0;
+	int32_t bitCount = 0;
+	for(size_t i = 0; i < size; i++)
+	{
+		const size_t value = alphabet.find(in[i]);
+		if(value == std::string::npos) break;
+		bits = (bits << 6) | (uint32_t)value;
+		bitCount += 6;
+		if(bitCount >= 8)
+		{
+			bitCount -= 8;
+			out.push_back((char)(uint8_t)(bits >> bitCount));
+		}
+	}
+	return out;
+}
+
+std::vector<uint8_t> randomBytes(size_t size, uint32_t seed)
+{
+	std::mt19937 random(seed);
+	std::vector<uint8_t> bytes(size);
+	for(auto& byte : bytes) byte = (uint8_t)random();
+	return bytes;
+}
+
+std::string encodeAt(const uint8_t* data, size_t size)
+{
+	std::string out;
+	Base64::Encoder encoder;
+	encoder.encode((const char*)data, size, out);
+	encoder.finish(out);
+	return out;
+}
+
+std::string decodeAt(const char* data, size_t size)
+{
+	std::string out;
+	Base64::Decoder decoder;
+	decoder.decode(data, size, out);
+	decoder.finish(out);
+	return out;
+}
+
+}
+
+TEST(encodeEveryLengthAndAlignment)
+{
+	//The vectorized loops process 12 to 48 bytes per iteration, so lengths up to 200 cover all tails.
+	const std::vector<uint8_t> buffer = randomBytes(256, 1);
+	for(size_t size = 0; size <= 200; size++)
+	{
+		for(size_t offset = 0; offset < 32; offset++)
+		{
+			const uint8_t* data = buffer.data() + offset;
+			const std::string expected = referenceEncode(data, size);
+			EXPECT_MESSAGE(encodeAt(data, size) == expected, "Size " + std::to_string(size) + ", offset " + std::to_string(offset));
+
+			std::string out;
+			Base64::encode(std::vector<uint8_t>(data, data + size), out);
+			EXPECT_MESSAGE(out == expected, "Size " + std::to_string(size) + ", offset " + std::to_string(offset));
+		}
+	}
+}
+
+TEST(decodeEveryLengthAndAlignment)
+{
+	const std::vector<uint8_t> bytes = randomBytes(200, 2);
+	const std::string encoded = referenceEncode(bytes.data(), bytes.size());
+	std::string buffer(32, 'A');
+	buffer.append(encoded);
+	for(size_t size = 0; size <= encoded.size(); size++)
+	{
+		for(size_t offset = 0; offset < 32; offset++)
+		{
+			//Copy the input to the given offset, so its alignment differs from the start of the buffer.
+			std::copy(encoded.begin(), encoded.begin() + size, buffer.begin() + offset);
+			const char* data = buffer.data() + offset;
+			const std::string expected = referenceDecode(data, size);
+			EXPECT_MESSAGE(decodeAt(data, size) == expected, "Size " + std::to_string(size) + ", offset " + std::to_string(offset));
+
+			std::string out;
+			Base64::decode(std::string(data, size), out);
+			EXPECT_MESSAGE(out == expected, "Size " + std::to_string(size) + ", offset " + std::to_string(offset));
+		}
+	}
+}
+
+TEST(decodeStopsAtEveryPosition)
+{
+	//Each vector lane has to detect characters that are not Base64.
+	const std::vector<uint8_t> bytes = randomBytes(96, 3);
+	const std::string encoded = referenceEncode(bytes.data(), bytes.size());
+	for(char invalid : std::string("=*-_ \n\x80\xFF", 8))
+	{
+		for(size_t position = 0; position < encoded.size(); position++)
+		{
+			std::string input = encoded;
+			input[position] = invalid;
+			const std::string expected = referenceDecode(input.data(), input.size());
+
+			std::string out;
+			Base64::decode(input, out);
+			EXPECT_MESSAGE(out == expected, "Position " + std::to_string(position) + ", character " + std::to_string((uint8_t)invalid));
+			EXPECT_MESSAGE(decodeAt(input.data(), input.size()) == expected, "Position " + std::to_string(position) + ", character " + std::to_string((uint8_t)invalid));
+		}
+	}
+}
+
+TEST(allCharacters)
+{
+	std::vector<uint8_t> bytes(256 * 3);
+	for(size_t i = 0; i < bytes.size(); i++) bytes[i] = (uint8_t)(i / 3);
+	const std::string expected = referenceEncode(bytes.data(), bytes.size());
+	std::string encoded;
+	Base64::encode(bytes, encoded);
+	EXPECT(encoded == expected);
+
+	std::vector<char> decoded;
+	Base64::decode(encoded, decoded);
+	EXPECT(decoded.size() == bytes.size() && std::equal(decoded.begin(), decoded.end(), (const char*)bytes.data()));
+}
+
+int main()
+{
+	return Test::run();
+}
@@ -0,0 +1,132 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+#include "Test.h"
+
+#include "BaseLib.h"
+#include "Encoding/GZip.h"
+
+#include <random>
+
+using namespace BaseLib;
+
+namespace
+{
+
+/**
+ * Compressible text with some random parts, larger than zlib's output chunks.
+ */
+std::string testData(size_t size, uint32_t seed)
+{
+	std::mt19937 random(seed);
+	std::string data;
+	data.reserve(size);
+	while(data.size() < size)
+	{
+		data.append("Line " + std::to_string(random() % 1000) + ": ");
+		data.push_back((char)random());
+		data.push_back('\n');
+	}
+	data.resize(size);
+	return data;
+}
+
+/**
+ * Passes "compressed" in pieces of the given sizes. The last piece gets the rest.
+ */
+std::string decompressInPieces(const std::string& compressed, const std::vector<size_t>& pieceSizes)
+{
+	GZip::Decompressor decompressor;
+	std::string out;
+	Test::feedPieces(compressed, pieceSizes, [&](char* piece, size_t size) { decompressor.decompress(piece, size, out); });
+	EXPECT(decompressor.isFinished());
+	return out;
+}
+
+void compareSplits(const std::string& compressed, const std::string& expected)
+{
+	EXPECT(GZip::uncompress<std::string>(compressed) == expected);
+	Test::forEachSplit(compressed.size(), [&](const std::vector<size_t>& pieceSizes, const std::string& description)
+	{
+		EXPECT_MESSAGE(decompressInPieces(compressed, pieceSizes) == expected, description);
+	}, 50, 100);
+}
+
+}
+
+TEST(splitFeeding)
+{
+	for(size_t size : {0, 1, 100, 20000})
+	{
+		const std::string data = testData(size, (uint32_t)size);
+		compareSplits(GZip::compress<std::string>(data, 6), data);
+	}
+}
+
+TEST(concatenatedMembers)
+{
+	//"cat a.gz b.gz > c.gz" is a valid GZip file containing both files.
+	const std::string a = testData(20000, 1);
+	const std::string b = testData(100, 2);
+	const std::string c = testData(5000, 3);
+	const std::string compressed = GZip::compress<std::string>(a, 6) + GZip::compress<std::string>(b, 1) + GZip::compress<std::string>(c, 9);
+	compareSplits(compressed, a + b + c);
+}
+
+TEST(compressorOutput)
+{
+	//Flushes and a reused compressor produce streams the decompressor handles in any split.
+	GZip::Compressor compressor;
+	const std::string data = testData(20000, 4);
+	std::string compressed;
+	compressor.compress(data.data(), 10000, compressed);
+	compressor.flush(compressed);
+	compressor.compress(data.data() + 10000, data.size() - 10000, compressed);
+	compressor.finish(compressed);
+	compressor.compress(data.data(), 500, compressed);
+	compressor.finish(compressed);
+	compareSplits(compressed, data + data.substr(0, 500));
+}
+
+TEST(trailingGarbage)
+{
+	const std::string compressed = GZip::compress<std::string>(testData(1000, 5), 6) + "garbage";
+	EXPECT_THROW(GZip::uncompress<std::string>(compressed));
+
+	GZip::Decompressor decompressor;
+	std::string out;
+	EXPECT_THROW(decompressor.decompress(compressed.data(), compressed.size(), out));
+}
+
+int main()
+{
+	return Test::run();
+}
@@ -0,0 +1,289 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+#include "Test.h"
+
+#include "BaseLib.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+struct Message
+{
+	std::string startLine;
+	int32_t responseCode = 0;
+	std::string content;
+};
+
+std::string startLine(Http& http)
+{
+	auto& header = http.getHeader();
+	return http.getType() == Http::Type::Enum::request ? header.method + " " + header.path : std::to_string(header.responseCode);
+}
+
+/**
+ * Passes "stream" in pieces of the given sizes and returns all complete messages. The last piece gets the rest.
+ */
+std::vector<Message> process(const std::string& stream, const std::vector<size_t>& pieceSizes)
+{
+	std::vector<Message> messages;
+	Http http;
+	auto callback = [&messages](Http& message)
+	{
+		messages.emplace_back();
+		messages.back().startLine = startLine(message);
+		messages.back().content = std::string(message.getContent().data(), message.getContentSize());
+	};
+
+	Test::feedPieces(stream, pieceSizes, [&](char* piece, size_t size) { http.processAll(piece, (int32_t)size, callback); });
+	return messages;
+}
+
+std::string describe(const std::vector<Message>& messages)
+{
+	std::string description;
+	for(auto& message : messages) description += "[" + message.startLine + ": " + message.content + "] ";
+	return description;
+}
+
+/**
+ * Processes the stream in all splits of Test::forEachSplit().
+ */
+void compareSplits(const std::string& stream, const std::vector<Message>& expected)
+{
+	auto same = [&expected](const std::vector<Message>& messages)
+	{
+		if(messages.size() != expected.size()) return false;
+		for(size_t i = 0; i < messages.size(); i++)
+		{
+			if(messages[i].startLine != expected[i].startLine || messages[i].content != expected[i].content) return false;
+		}
+		return true;
+	};
+
+	Test::forEachSplit(stream.size(), [&](const std::vector<size_t>& pieceSizes, const std::string& description)
+	{
+		std::vector<Message> messages = process(stream, pieceSizes);
+		EXPECT_MESSAGE(same(messages), description + ": " + describe(messages));
+	});
+}
+
+Message message(const std::string& startLine, const std::string& content)
+{
+	Message message;
+	message.startLine = startLine;
+	message.content = content;
+	return message;
+}
+
+/**
+ * Checks getHeaderField() for the expected fields and that all values point into the raw header. Header::fields has to
+ * contain the same values.
+ */
+void checkHeaderFields(Http& http, const std::vector<std::pair<std::string, std::string>>& expected, const std::string& name)
+{
+	const std::vector<char>& rawHeader = http.getRawHeader();
+	for(auto& field : expected)
+	{
+		Http::HeaderFieldValue value = http.getHeaderField(field.first);
+		EXPECT_MESSAGE(value.toString() == field.second, name + ", " + field.first + ": " + value.toString());
+	}
+	for(auto& field : http.getHeaderFields())
+	{
+		EXPECT_MESSAGE(field.nameOffset + field.nameSize <= rawHeader.size() && field.valueOffset + field.valueSize <= rawHeader.size(), name);
+		std::string fieldName(rawHeader.data() + field.nameOffset, field.nameSize);
+		Http::HeaderFieldValue value = http.getHeaderField(fieldName);
+		EXPECT_MESSAGE(value.data >= rawHeader.data() && value.data + value.size <= rawHeader.data() + rawHeader.size(), name + ", " + fieldName);
+		HelperFunctions::toLower(fieldName);
+		EXPECT_MESSAGE(http.getHeader().fields.at(fieldName) == value.toString(), name + ", " + fieldName);
+	}
+}
+
+}
+
+TEST(pipelinedRequests)
+{
+	compareSplits("POST /a HTTP/1.1\r\nHost: x\r\nContent-Length: 5\r\n\r\nhello"
+		"POST /b HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nworld\r\n0\r\n\r\n"
+		"GET /c HTTP/1.1\r\nHost: x\r\n\r\n",
+		{message("POST /a", "hello"), message("POST /b", "world"), message("GET /c", "")});
+}
+
+TEST(chunkExtensions)
+{
+	compareSplits("POST /a HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n"
+		"5;name=value\r\nhello\r\n6 ; other=\"a;b\"\r\n world\r\n0;last\r\n\r\n"
+		"GET /b HTTP/1.1\r\nHost: x\r\n\r\n",
+		{message("POST /a", "hello world"), message("GET /b", "")});
+}
+
+TEST(trailers)
+{
+	compareSplits("POST /a HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\nTrailer: X-Checksum, X-Other\r\n\r\n"
+		"3\r\nabc\r\n0\r\nX-Checksum: 900150983cd24fb0\r\nX-Other: with spaces: and colons\r\n\r\n"
+		"POST /b HTTP/1.1\r\nHost: x\r\nContent-Length: 3\r\n\r\ndef",
+		{message("POST /a", "abc"), message("POST /b", "def")});
+}
+
+TEST(finishedWithoutTrailer)
+{
+	//A client may wait for the response before sending the empty line behind the last chunk.
+	std::string stream = "POST /a HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n0\r\n";
+	std::vector<Message> messages = process(stream, {});
+	EXPECT_MESSAGE(messages.size() == 1 && messages.at(0).content == "abc", describe(messages));
+
+	//When it is missing entirely, the next message still is read.
+	compareSplits(stream + "GET /b HTTP/1.1\r\nHost: x\r\n\r\n", {message("POST /a", "abc"), message("GET /b", "")});
+}
+
+TEST(resetDiscardsTrailer)
+{
+	//reset() is used to resynchronize after an error, so a partially received trailer must not affect the next message.
+	const std::vector<std::string> trailerStarts{"0\r\n", "0\r\nX-Tra", "0\r\nX-Trailer: abc", "0\r\nX-Trailer: abc\r"};
+	for(auto& trailerStart : trailerStarts)
+	{
+		Http http;
+		std::string stream = "POST /a HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n" + trailerStart;
+		http.process(&stream[0], (int32_t)stream.size());
+		EXPECT(http.isFinished());
+		http.reset();
+
+		std::string request = "GET /b HTTP/1.1\r\nHost: x\r\n\r\n";
+		http.process(&request[0], (int32_t)request.size());
+		EXPECT_MESSAGE(http.isFinished(), trailerStart);
+		EXPECT_MESSAGE(http.isFinished() && startLine(http) == "GET /b", trailerStart);
+	}
+}
+
+TEST(responsesWithoutBody)
+{
+	compareSplits("HTTP/1.1 204 No Content\r\nServer: x\r\n\r\n"
+		"HTTP/1.1 304 Not Modified\r\nETag: \"1\"\r\n\r\n"
+		"HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok"
+		"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nhi\r\n0\r\n\r\n",
+		{message("204", ""), message("304", ""), message("200", "ok"), message("200", "hi")});
+}
+
+TEST(chunkedWriter)
+{
+	//Small writes are combined, large ones are passed on without copying. Both read back to the same content.
+	std::string content;
+	for(int32_t i = 0; i < 5000; i++) content.append(std::to_string(i)).push_back(',');
+	for(size_t chunkSize : std::vector<size_t>{1, 7, 100, 4096})
+	{
+		for(size_t writeSize : std::vector<size_t>{1, 13, 100, 5000, content.size()})
+		{
+			std::string stream;
+			size_t uncopied = 0;
+			Http::ChunkedWriter writer([&](const char* data, size_t size)
+			{
+				if(data >= content.data() && data < content.data() + content.size()) uncopied += size;
+				stream.append(data, size);
+			}, chunkSize);
+			writer.writeHeader(200, "text/plain", {});
+			for(size_t position = 0; position < content.size(); position += writeSize) writer.write(content.data() + position, std::min(writeSize, content.size() - position));
+			writer.finish({"X-Count: 5000"});
+			EXPECT(writer.isFinished());
+			if(writeSize % chunkSize == 0) EXPECT(uncopied == content.size() - content.size() % chunkSize);
+			else if(writeSize < chunkSize) EXPECT(uncopied == 0);
+
+			std::vector<Message> messages = process(stream, {});
+			EXPECT_MESSAGE(messages.size() == 1 && messages.at(0).startLine == "200" && messages.at(0).content == content, "Chunk size " + std::to_string(chunkSize) + ", write size " + std::to_string(writeSize));
+		}
+	}
+}
+
+TEST(chunkedWriterEmptyContent)
+{
+	std::string stream;
+	Http::ChunkedWriter writer([&](const char* data, size_t size) { stream.append(data, size); });
+	writer.writeHeader(200, "text/plain", {});
+	writer.flush();
+	writer.finish();
+	EXPECT(stream.size() > 5 && stream.compare(stream.size() - 5, 5, "0\r\n\r\n") == 0);
+	compareSplits(stream, {message("200", "")});
+}
+
+TEST(headerFieldsIgnoreCase)
+{
+	std::string request = "GET / HTTP/1.1\r\nhOsT: example\r\nX-Custom-Field: a b\r\nContent-Type:  text/plain\r\nUser-Agent:\r\n\r\n";
+	Http http;
+	http.process(&request[0], (int32_t)request.size());
+	EXPECT(http.isFinished());
+
+	EXPECT(http.getHeaderField(Http::KnownHeaderField::host).toString() == "example");
+	EXPECT(http.getHeaderField(Http::KnownHeaderField::contentType).toString() == "text/plain");
+	EXPECT(http.getHeaderField(Http::KnownHeaderField::userAgent).empty());
+	EXPECT(http.getHeaderField(Http::KnownHeaderField::authorization).empty());
+	EXPECT(http.getHeaderField(Http::KnownHeaderField::count).empty());
+	EXPECT(http.getHeaderField("x-custom").empty());
+	EXPECT(http.getHeaderField("").empty());
+	checkHeaderFields(http, {{"HOST", "example"}, {"host", "example"}, {"x-custom-field", "a b"}, {"X-CUSTOM-FIELD", "a b"}, {"content-TYPE", "text/plain"}, {"user-agent", ""}}, "one piece");
+	EXPECT(http.getHeader().contentType == "text/plain");
+	EXPECT(http.getHeader().host == "example");
+}
+
+TEST(duplicateHeaderFields)
+{
+	std::string request = "GET / HTTP/1.1\r\nX-A: 1\r\nHost: a\r\nx-a: 2\r\nHOST: b\r\nX-B: 3\r\n\r\n";
+	Http http;
+	http.process(&request[0], (int32_t)request.size());
+	EXPECT(http.isFinished());
+	EXPECT(http.getHeaderFields().size() == 5);
+	//The last occurrence wins like in Header::fields.
+	EXPECT(http.getHeaderField(Http::KnownHeaderField::host).toString() == "b");
+	checkHeaderFields(http, {{"x-a", "2"}, {"X-A", "2"}, {"host", "b"}, {"x-b", "3"}}, "duplicates");
+	EXPECT(http.getHeader().fields.size() == 3);
+}
+
+TEST(headerFieldsSplitAcrossBuffers)
+{
+	const std::string request = "POST /path HTTP/1.1\r\nHost: example\r\nX-Long-Field: " + std::string(300, 'v') + "\r\n"
+		"Content-Type: application/json\r\nx-long-field: last\r\nContent-Length: 2\r\n\r\n{}";
+	const std::vector<std::pair<std::string, std::string>> expected{{"host", "example"}, {"X-Long-Field", "last"}, {"content-type", "application/json"}, {"content-length", "2"}};
+	Test::forEachSplit(request.size(), [&](const std::vector<size_t>& pieceSizes, const std::string& description)
+	{
+		//Every piece has a buffer of its own, so offsets into previous pieces would point to freed memory.
+		Http http;
+		Test::feedPieces(request, pieceSizes, [&http](char* piece, size_t size) { http.process(piece, (int32_t)size); });
+		EXPECT_MESSAGE(http.isFinished(), description);
+		if(!http.isFinished()) return;
+		checkHeaderFields(http, expected, description);
+		EXPECT_MESSAGE(http.getHeaderField(Http::KnownHeaderField::contentType).toString() == "application/json", description);
+	});
+}
+
+int main()
+{
+	return Test::run();
+}
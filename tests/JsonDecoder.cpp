@@ -0,0 +1,130 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "Test.h"
+#include "Variables.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+struct Result
+{
+	bool failed = false;
+	PVariable value;
+	uint64_t bytesRead = 0;
+};
+
+template<typename Container>
+Result decode(const Container& json)
+{
+	Result result;
+	try
+	{
+		result.value = Rpc::JsonDecoder::decode(json, result.bytesRead);
+	}
+	catch(const std::exception&)
+	{
+		result.failed = true;
+	}
+	return result;
+}
+
+/**
+ * Input of 256 bytes and more is decoded with the positions found by JsonScanner, shorter input byte by byte. Trailing
+ * whitespace doesn't change the result, so padding short input compares both.
+ */
+void compare(const std::string& json)
+{
+	const std::string padding(300, ' ');
+	const bool onlyWhitespace = json.find_first_not_of(" \n\r\t") == std::string::npos;
+
+	Result expected = decode(json);
+	Result padded = decode(json + padding);
+	bool same = expected.failed == padded.failed && (expected.failed || (Test::equal(expected.value, padded.value) && (onlyWhitespace || expected.bytesRead == padded.bytesRead)));
+	EXPECT_MESSAGE(same, json);
+
+	std::vector<char> vector(json.begin(), json.end());
+	expected = decode(vector);
+	vector.insert(vector.end(), padding.begin(), padding.end());
+	padded = decode(vector);
+	same = expected.failed == padded.failed && (expected.failed || (Test::equal(expected.value, padded.value) && (onlyWhitespace || expected.bytesRead == padded.bytesRead)));
+	EXPECT_MESSAGE(same, json);
+}
+
+}
+
+TEST(structuralDecoding)
+{
+	Test::RandomJson random(12);
+	size_t count = 0;
+	while(count < 3000)
+	{
+		std::string json = random.document(3);
+		if(json.size() + 300 > 0xFFFF || json.size() >= 256) continue;
+		compare(json);
+		compare(random.mutate(json));
+		count++;
+	}
+}
+
+TEST(structuralDecodingEdgeCases)
+{
+	compare("[nul\"  ,1]");
+	compare("[nu\\\"  ,1]");
+	compare("[\"\\u12\", \"a\"]");
+	compare("{\"a\" , \"b\":1}");
+	compare("[12abc, 1]");
+	compare("[1 2]");
+	compare("{\"a\":1,}");
+	compare("\"unterminated");
+}
+
+TEST(largeDocument)
+{
+	//Documents above 256 bytes use the scanner, so compare with a value built the same way.
+	Test::RandomJson random(7);
+	std::string json = "[";
+	for(int32_t i = 0; i < 1000; i++)
+	{
+		if(i > 0) json.push_back(',');
+		json.append(random.document(2));
+	}
+	json.push_back(']');
+	Result result = decode(json);
+	EXPECT(!result.failed && result.value->type == VariableType::tArray && result.value->arrayValue->size() == 1000);
+	EXPECT(result.bytesRead == json.size());
+}
+
+int main()
+{
+	return Test::run();
+}
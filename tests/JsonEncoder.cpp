@@ -0,0 +1,93 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "Test.h"
+#include "BaseLib.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace BaseLib;
+
+namespace
+{
+
+std::string encode(const PVariable& variable)
+{
+	std::string json;
+	Rpc::JsonEncoder::encode(variable, json);
+	std::vector<char> buffer;
+	Rpc::JsonEncoder::encode(variable, buffer);
+	EXPECT_MESSAGE(json == std::string(buffer.begin(), buffer.end()), json);
+	return json;
+}
+
+}
+
+TEST(floats)
+{
+	EXPECT(encode(std::make_shared<Variable>(1.0)) == "[1.0]");
+	EXPECT(encode(std::make_shared<Variable>(-0.5)) == "[-0.5]");
+	EXPECT(encode(std::make_shared<Variable>(0.1)) == "[0.1]");
+	EXPECT(encode(std::make_shared<Variable>(1e30)) == "[1.0e30]");
+	EXPECT(encode(std::make_shared<Variable>(std::numeric_limits<double>::quiet_NaN())) == "[null]");
+	EXPECT(encode(std::make_shared<Variable>(std::numeric_limits<double>::infinity())) == "[null]");
+}
+
+TEST(largeDocument)
+{
+	//Several MiB, so the output buffer grows many times.
+	PVariable array = std::make_shared<Variable>(VariableType::tArray);
+	std::string expected = "[";
+	for(int32_t i = 0; i < 100000; i++)
+	{
+		array->arrayValue->push_back(std::make_shared<Variable>(std::string(32, 'a' + (i % 26))));
+		if(i > 0) expected.push_back(',');
+		expected.append("\"" + std::string(32, 'a' + (i % 26)) + "\"");
+	}
+	expected.push_back(']');
+	EXPECT(encode(array) == expected);
+}
+
+TEST(stringViews)
+{
+	//Strings decoded from binary RPC packets might only reference the packet.
+	auto buffer = std::make_shared<std::string>("Line 1\nLine \"2\"");
+	PVariable variable = std::make_shared<Variable>(VariableType::tString);
+	variable->dataView = BufferView(buffer, (const uint8_t*)buffer->data(), buffer->size());
+	PVariable structVariable = std::make_shared<Variable>(VariableType::tStruct);
+	structVariable->structValue->emplace("KEY", variable);
+	EXPECT(encode(structVariable) == "{\"KEY\":\"Line 1\\nLine \\\"2\\\"\"}");
+}
+
+int main()
+{
+	return Test::run();
+}
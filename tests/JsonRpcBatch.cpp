@@ -0,0 +1,114 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+#include "Test.h"
+#include "Variables.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+std::string toString(const std::vector<char>& json)
+{
+	return std::string(json.begin(), json.end());
+}
+
+}
+
+TEST(responsesOutOfOrder)
+{
+	Rpc::JsonEncoder encoder;
+	std::vector<char> request;
+	std::vector<int32_t> ids;
+	std::vector<std::pair<std::string, PArray>> calls{{"a", PArray()}, {"b", PArray()}, {"c", PArray()}};
+	encoder.encodeBatchRequest(calls, request, ids);
+	EXPECT(ids.size() == 3);
+
+	std::string response = "[{\"jsonrpc\":\"2.0\",\"result\":\"c\",\"id\":" + std::to_string(ids[2]) + "},"
+		"{\"jsonrpc\":\"2.0\",\"error\":{\"code\":-32601,\"message\":\"Method not found\"},\"id\":" + std::to_string(ids[0]) + "},"
+		"{\"jsonrpc\":\"2.0\",\"result\":\"b\",\"id\":" + std::to_string(ids[1]) + "}]";
+	PArray results = Rpc::JsonDecoder::decodeBatchResponse(response, ids);
+	EXPECT(results->size() == 3);
+	EXPECT(results->at(0)->errorStruct && results->at(0)->structValue->at("faultCode")->integerValue == -32601);
+	EXPECT(results->at(1)->stringValue == "b");
+	EXPECT(results->at(2)->stringValue == "c");
+}
+
+TEST(stringIdsDontMatchIntegerIds)
+{
+	//Before, "abc" was read as integer 0 and answered call 0.
+	std::vector<int32_t> ids{0, 1};
+	std::string response = "[{\"jsonrpc\":\"2.0\",\"result\":\"wrong\",\"id\":\"abc\"},{\"jsonrpc\":\"2.0\",\"result\":\"wrong\",\"id\":\"1\"},"
+		"{\"jsonrpc\":\"2.0\",\"result\":\"right\",\"id\":1}]";
+	PArray results = Rpc::JsonDecoder::decodeBatchResponse(response, ids);
+	EXPECT(results->size() == 2);
+	EXPECT(results->at(0)->errorStruct);
+	EXPECT(results->at(1)->stringValue == "right");
+}
+
+TEST(requestIdsAreReturnedAsReceived)
+{
+	std::string json = "[{\"jsonrpc\":\"2.0\",\"method\":\"a\",\"params\":[1],\"id\":\"x1\"},"
+		"{\"jsonrpc\":\"2.0\",\"method\":\"b\",\"params\":[],\"id\":\"x2\"},"
+		"{\"jsonrpc\":\"2.0\",\"method\":\"c\",\"id\":7},"
+		"{\"jsonrpc\":\"2.0\",\"method\":\"d\"}]";
+	std::vector<Rpc::JsonRpcRequest> requests = Rpc::JsonDecoder::decodeBatchRequest(json);
+	EXPECT(requests.size() == 4);
+	EXPECT(requests.at(0).id->type == VariableType::tString && requests.at(0).id->stringValue == "x1");
+	EXPECT(requests.at(1).id->type == VariableType::tString && requests.at(1).id->stringValue == "x2");
+	EXPECT(requests.at(2).id->type == VariableType::tInteger && requests.at(2).id->integerValue == 7);
+	EXPECT(requests.at(3).isNotification && !requests.at(3).id);
+
+	//Answer in reverse order, each response carries its request's id.
+	std::vector<std::pair<PVariable, PVariable>> responses;
+	for(int32_t i = 2; i >= 0; i--)
+	{
+		responses.emplace_back(requests.at(i).id, std::make_shared<Variable>(requests.at(i).methodName));
+	}
+	std::vector<char> encoded;
+	Rpc::JsonEncoder::encodeBatchResponse(responses, encoded);
+	PVariable decoded = Rpc::JsonDecoder::decode(encoded);
+	EXPECT_MESSAGE(decoded->type == VariableType::tArray && decoded->arrayValue->size() == 3, toString(encoded));
+	for(auto& response : *decoded->arrayValue)
+	{
+		auto& id = response->structValue->at("id");
+		auto& result = response->structValue->at("result");
+		if(result->stringValue == "a") EXPECT(id->stringValue == "x1");
+		else if(result->stringValue == "b") EXPECT(id->stringValue == "x2");
+		else EXPECT(id->type == VariableType::tInteger && id->integerValue == 7);
+	}
+}
+
+int main()
+{
+	return Test::run();
+}
@@ -0,0 +1,121 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "Test.h"
+#include "Variables.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+struct Result
+{
+	bool failed = false;
+	std::vector<PVariable> values;
+};
+
+/**
+ * Feeds "json" in pieces of the given sizes, the rest in one piece, then calls finish().
+ */
+Result decode(const std::string& json, const std::vector<size_t>& pieces)
+{
+	Result result;
+	Rpc::JsonStreamDecoder decoder;
+	try
+	{
+		Test::feedPieces(json, pieces, [&decoder](char* piece, size_t size) { decoder.process(piece, size); });
+		decoder.finish();
+	}
+	catch(const Rpc::JsonDecoderException&)
+	{
+		result.failed = true;
+	}
+	while(decoder.valueAvailable()) result.values.push_back(decoder.getValue());
+	return result;
+}
+
+bool equal(const Result& a, const Result& b)
+{
+	if(a.failed != b.failed || a.values.size() != b.values.size()) return false;
+	for(size_t i = 0; i < a.values.size(); i++)
+	{
+		if(!Test::equal(a.values[i], b.values[i])) return false;
+	}
+	return true;
+}
+
+}
+
+TEST(splitFeeding)
+{
+	Test::RandomJson random(13);
+	for(int32_t i = 0; i < 40; i++)
+	{
+		//Newline-delimited stream of several documents
+		std::string json;
+		const size_t count = random.number(4) + 1;
+		for(size_t j = 0; j < count; j++) json.append(random.document(3) + "\n");
+		if(i % 2 == 1) json = random.mutate(json);
+
+		Result expected = decode(json, {});
+		Test::forEachSplit(json.size(), [&](const std::vector<size_t>& pieceSizes, const std::string& description)
+		{
+			EXPECT_MESSAGE(equal(expected, decode(json, pieceSizes)), description + ": " + json);
+		}, 10, 16);
+		if(i % 2 == 0) EXPECT_MESSAGE(!expected.failed && expected.values.size() == count, json);
+	}
+}
+
+TEST(sameAsJsonDecoder)
+{
+	Test::RandomJson random(14);
+	for(int32_t i = 0; i < 40; i++)
+	{
+		std::string json = random.document(3);
+		PVariable expected = Rpc::JsonDecoder::decode(json);
+		Test::forEachSplit(json.size(), [&](const std::vector<size_t>& pieceSizes, const std::string& description)
+		{
+			Result result = decode(json, pieceSizes);
+			EXPECT_MESSAGE(!result.failed && result.values.size() == 1 && Test::equal(result.values.front(), expected), description + ": " + json);
+		}, 10, 16);
+	}
+}
+
+TEST(numbersAtEndOfStream)
+{
+	Result result = decode("1 22 333", {1, 1, 1, 1, 1});
+	EXPECT(!result.failed && result.values.size() == 3 && result.values.back()->integerValue == 333);
+}
+
+int main()
+{
+	return Test::run();
+}
@@ -0,0 +1,152 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+#include "Test.h"
+#include "Variables.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+/**
+ * Decodes the root lazily and compares it with JsonDecoder::decode() of the whole document. For valid JSON also all
+ * elements are compared. JsonDecoder accepts some broken literals and members without value, element access doesn't.
+ */
+void compare(const std::string& json, const Rpc::LazyJsonDocument& document, bool valid)
+{
+	PVariable expected;
+	try
+	{
+		expected = Rpc::JsonDecoder::decode(json);
+	}
+	catch(const std::exception&)
+	{
+	}
+
+	PVariable root;
+	try
+	{
+		root = document.getRoot().decode();
+	}
+	catch(const std::exception&)
+	{
+		return;
+	}
+	if(!root)
+	{
+		EXPECT_MESSAGE(json.find_first_not_of(" \n\r\t") == std::string::npos, json);
+		return;
+	}
+	EXPECT_MESSAGE(Test::equal(root, expected), json);
+	if(!expected || !valid) return;
+
+	if(expected->type == VariableType::tArray)
+	{
+		EXPECT_MESSAGE(document.getRoot().size() == expected->arrayValue->size(), json);
+		for(uint32_t i = 0; i < expected->arrayValue->size(); i++)
+		{
+			EXPECT_MESSAGE(Test::equal(document.getRoot().at(i).decode(), expected->arrayValue->at(i)), json);
+		}
+	}
+	else if(expected->type == VariableType::tStruct)
+	{
+		for(auto& member : *expected->structValue)
+		{
+			EXPECT_MESSAGE(Test::equal(document.getRoot().at(member.first).decode(), member.second), json);
+		}
+	}
+}
+
+void compare(const std::string& json, bool valid)
+{
+	std::unique_ptr<Rpc::LazyJsonDocument> fromString;
+	std::unique_ptr<Rpc::LazyJsonDocument> fromVector;
+	try
+	{
+		fromString.reset(new Rpc::LazyJsonDocument(json));
+	}
+	catch(const Rpc::JsonDecoderException&)
+	{
+	}
+	try
+	{
+		fromVector.reset(new Rpc::LazyJsonDocument(std::make_shared<const std::vector<char>>(json.begin(), json.end())));
+	}
+	catch(const Rpc::JsonDecoderException&)
+	{
+	}
+	EXPECT_MESSAGE((bool)fromString == (bool)fromVector, json);
+	if(fromString) compare(json, *fromString, valid);
+	if(fromVector) compare(json, *fromVector, valid);
+}
+
+}
+
+TEST(sameAsJsonDecoder)
+{
+	Test::RandomJson random(15);
+	for(int32_t i = 0; i < 3000; i++)
+	{
+		std::string json = random.document(3);
+		compare(json, true);
+		compare(random.mutate(json), false);
+	}
+}
+
+TEST(edgeCases)
+{
+	compare("", true);
+	compare("  ", true);
+	compare("123", true);
+	compare("-1.5e3 ", true);
+	compare("true", true);
+	compare("nul", false);
+	compare("[tru, 1]", false);
+	compare("[12abc, 1]", false);
+	compare("{\"a\":\"\\u00e4\",\"a\":2}", true);
+	compare("[\"\\u12\", \"a\"]", false);
+	compare("[[1,2],{\"b\":[3]}] trailing", true);
+}
+
+TEST(sharedBufferIsNotCopied)
+{
+	auto json = std::make_shared<const std::string>("{\"a\":[1,2,3],\"b\":\"text\"}");
+	Rpc::LazyJsonDocument document(json);
+	EXPECT(json.use_count() == 2);
+	EXPECT(document.at({"a", "2"}).decode()->integerValue == 3);
+	EXPECT(document.at({"b"}).decode()->stringValue == "text");
+}
+
+int main()
+{
+	return Test::run();
+}
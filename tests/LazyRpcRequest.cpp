@@ -0,0 +1,267 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+
+#include "Test.h"
+#include "Variables.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+PArray createParameters()
+{
+	auto parameters = std::make_shared<Array>();
+	parameters->push_back(std::make_shared<Variable>(5));
+	parameters->push_back(std::make_shared<Variable>("DEVICE:1"));
+
+	auto paramset = std::make_shared<Variable>(VariableType::tStruct);
+	PVariable& a = paramset->emplaceStructElement("a", VariableType::tArray);
+	a->emplaceArrayElement(1);
+	a->emplaceArrayElement(2.5);
+	PVariable& nested = a->emplaceArrayElement(VariableType::tStruct);
+	nested->emplaceStructElement("x", true);
+	nested->emplaceStructElement("y", "s");
+	paramset->emplaceStructElement("b", int64_t(1) << 40);
+	paramset->emplaceStructElement("c", std::vector<uint8_t>{0, 1, 2});
+	paramset->emplaceStructElement("d", VariableType::tStruct);
+	paramset->emplaceStructElement("e", VariableType::tArray);
+	paramset->emplaceStructElement("f", VariableType::tVoid);
+	parameters->push_back(paramset);
+
+	auto arrays = std::make_shared<Variable>(VariableType::tArray);
+	arrays->emplaceArrayElement(VariableType::tArray);
+	arrays->emplaceArrayElement(VariableType::tArray)->emplaceArrayElement(VariableType::tArray)->emplaceArrayElement(1);
+	arrays->emplaceArrayElement("z");
+	parameters->push_back(arrays);
+	return parameters;
+}
+
+std::shared_ptr<const std::vector<char>> encode(const PArray& parameters, const std::string& authorization = "")
+{
+	Rpc::RpcEncoder encoder(false, true);
+	auto packet = std::make_shared<std::vector<char>>();
+	auto header = std::make_shared<Rpc::RpcHeader>();
+	header->authorization = authorization;
+	encoder.encodeRequest("putParamset", parameters, *packet, header);
+	return packet;
+}
+
+/**
+ * Compares the lazy value element by element with the decoded variable.
+ */
+void compare(const Rpc::LazyRpcValue& value, const PVariable& expected, const std::string& path)
+{
+	EXPECT_MESSAGE(value.isValid(), path);
+	EXPECT_MESSAGE(Test::equal(value.decode(), expected), path);
+	if(expected->type == VariableType::tArray)
+	{
+		EXPECT_MESSAGE(value.size() == expected->arrayValue->size(), path);
+		for(size_t i = 0; i < expected->arrayValue->size(); i++)
+		{
+			compare(value.at(i), expected->arrayValue->at(i), path + "/" + std::to_string(i));
+		}
+		EXPECT_MESSAGE(!value.at(expected->arrayValue->size()).isValid(), path);
+	}
+	else if(expected->type == VariableType::tStruct)
+	{
+		EXPECT_MESSAGE(value.size() == expected->structValue->size(), path);
+		//Access by name in reverse order, so later members are indexed before earlier ones are accessed by index.
+		for(auto i = expected->structValue->rbegin(); i != expected->structValue->rend(); ++i)
+		{
+			compare(value.at(i->first), i->second, path + "/" + i->first);
+		}
+		uint32_t index = 0;
+		for(auto& element : *expected->structValue)
+		{
+			compare(value.at(index++), element.second, path + "/" + element.first);
+		}
+		EXPECT_MESSAGE(!value.at("missing").isValid(), path);
+		EXPECT_MESSAGE(!value.at(index).isValid(), path);
+	}
+	else EXPECT_MESSAGE(value.size() == 0, path);
+}
+
+void compare(const std::shared_ptr<const std::vector<char>>& packet, const std::string& name)
+{
+	Rpc::RpcDecoder decoder(false, true);
+	std::string methodName;
+	PArray expected = decoder.decodeRequest(*packet, methodName);
+
+	Rpc::LazyRpcRequest request(packet);
+	EXPECT_MESSAGE(request.getMethodName() == methodName, name);
+	EXPECT_MESSAGE(request.getParameterCount() == expected->size(), name);
+
+	PArray parameters = request.decodeParameters();
+	EXPECT_MESSAGE(parameters->size() == expected->size(), name);
+	for(size_t i = 0; i < expected->size() && i < parameters->size(); i++)
+	{
+		EXPECT_MESSAGE(Test::equal(parameters->at(i), expected->at(i)), name + ", parameter " + std::to_string(i));
+	}
+
+	//A new request, so elements are indexed by at() and not by decodeParameters().
+	Rpc::LazyRpcRequest elements(packet);
+	for(int32_t i = (int32_t)expected->size() - 1; i >= 0; i--)
+	{
+		compare(elements.getParameter(i), expected->at(i), name + ", parameter " + std::to_string(i));
+	}
+	EXPECT_MESSAGE(!elements.getParameter(expected->size()).isValid(), name);
+}
+
+/**
+ * Returns a request packet with the given bytes as parameters.
+ */
+std::shared_ptr<const std::vector<char>> createPacket(const std::string& parameters)
+{
+	std::string data = std::string("\0\0\0\x01" "m", 5) + parameters;
+	std::string packet = std::string("Bin\0", 4);
+	uint32_t size = data.size();
+	for(int32_t i = 3; i >= 0; i--) packet.push_back((char)(size >> (i * 8)));
+	packet.append(data);
+	return std::make_shared<const std::vector<char>>(packet.begin(), packet.end());
+}
+
+}
+
+TEST(sameAsRpcDecoder)
+{
+	compare(encode(createParameters()), "without header");
+	compare(encode(std::make_shared<Array>()), "without parameters");
+}
+
+TEST(withHeader)
+{
+	auto packet = encode(createParameters(), "Basic dXNlcjpwYXNzd29yZA==");
+	EXPECT(packet->at(3) == 0x40);
+	compare(packet, "0x40");
+
+	auto responseType = std::make_shared<std::vector<char>>(*packet);
+	responseType->at(3) = 0x41;
+	compare(responseType, "0x41");
+}
+
+TEST(truncated)
+{
+	auto packet = encode(createParameters(), "Basic x");
+	for(size_t size = 0; size < packet->size(); size++)
+	{
+		auto truncated = std::make_shared<const std::vector<char>>(packet->begin(), packet->begin() + size);
+		const std::string name = "size " + std::to_string(size);
+		PArray parameters;
+		try
+		{
+			Rpc::LazyRpcRequest request(truncated);
+			parameters = request.decodeParameters();
+		}
+		catch(const std::exception&)
+		{
+		}
+		//Integers cut short are read as digits (see BinaryDecoder::decodeInteger()), so not every truncation is
+		//detected. When it isn't, the result has to be the same as the one of RpcDecoder.
+		if(parameters)
+		{
+			Rpc::RpcDecoder decoder(false, true);
+			std::string methodName;
+			PArray expected;
+			try
+			{
+				expected = decoder.decodeRequest(*truncated, methodName);
+			}
+			catch(const std::exception&)
+			{
+			}
+			EXPECT_MESSAGE(expected && expected->size() == parameters->size(), name);
+			for(size_t i = 0; expected && i < expected->size() && i < parameters->size(); i++)
+			{
+				EXPECT_MESSAGE(Test::equal(parameters->at(i), expected->at(i)), name);
+			}
+		}
+
+		try
+		{
+			Rpc::LazyRpcRequest request(truncated);
+			for(uint32_t i = 0; i < request.getParameterCount(); i++)
+			{
+				try
+				{
+					Rpc::LazyRpcValue value = request.getParameter(i);
+					value.size();
+					value.at("a").at(2).at("y").decode();
+					value.at(1).at(0).decode();
+				}
+				catch(const std::exception&)
+				{
+				}
+			}
+		}
+		catch(const std::exception&)
+		{
+		}
+	}
+}
+
+TEST(invalidCounts)
+{
+	//Parameter counts
+	EXPECT_THROW(Rpc::LazyRpcRequest(createPacket(std::string("\0\0\0\x65", 4))));
+	EXPECT_THROW(Rpc::LazyRpcRequest(createPacket("\xFF\xFF\xFF\xFF")));
+	EXPECT_THROW(Rpc::LazyRpcRequest(std::make_shared<const std::vector<char>>(4, 'B')));
+
+	//Array with more elements than the packet can hold
+	Rpc::LazyRpcRequest array(createPacket(std::string("\0\0\0\x02" "\0\0\x01\0" "\x10\0\0\0" "\0\0\0\x01\0\0\0\x01", 16)));
+	EXPECT_THROW(array.getParameter(0).size());
+	EXPECT_THROW(array.getParameter(0).at(0));
+	EXPECT_THROW(array.getParameter(0).decode());
+	EXPECT_THROW(array.getParameter(1));
+	EXPECT_THROW(array.decodeParameters());
+
+	//Negative struct member count
+	Rpc::LazyRpcRequest structure(createPacket(std::string("\0\0\0\x01" "\0\0\x01\x01" "\xFF\xFF\xFF\xFF", 12)));
+	EXPECT_THROW(structure.getParameter(0).size());
+	EXPECT_THROW(structure.getParameter(0).at("a"));
+
+	//String longer than the packet
+	Rpc::LazyRpcRequest string(createPacket(std::string("\0\0\0\x02" "\0\0\0\x03" "\x7F\xFF\xFF\xFF" "ab" "\0\0\0\x01\0\0\0\x01", 18)));
+	EXPECT_THROW(string.getParameter(0).decode());
+	EXPECT_THROW(string.getParameter(1));
+
+	//Member name longer than the packet
+	Rpc::LazyRpcRequest name(createPacket(std::string("\0\0\0\x01" "\0\0\x01\x01" "\0\0\0\x01" "\0\0\x10\0" "a", 17)));
+	EXPECT(name.getParameter(0).size() == 1);
+	EXPECT_THROW(name.getParameter(0).at("a"));
+	EXPECT_THROW(name.getParameter(0).at(0));
+}
+
+int main()
+{
+	return Test::run();
+}
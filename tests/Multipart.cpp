@@ -0,0 +1,171 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+#include "Test.h"
+
+#include "BaseLib.h"
+
+#include <random>
+
+using namespace BaseLib;
+
+namespace
+{
+
+struct Part
+{
+	std::string name;
+	std::string filename;
+	std::string contentType;
+	std::string data;
+	bool complete = false;
+};
+
+const std::string boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+
+/**
+ * Data that contains everything the delimiter search must not stop at: line breaks, dashes and incomplete delimiters.
+ */
+std::string trickyData()
+{
+	std::string data = "line 1\r\nline 2\r\n--\r\n-" + boundary.substr(0, 10) + "\r\n--" + boundary.substr(0, boundary.size() - 1) + "x\r\r\n\r\n-";
+	std::mt19937 random(1);
+	for(int32_t i = 0; i < 300; i++) data.push_back((char)random());
+	return data + "\r";
+}
+
+std::string body()
+{
+	return "This is the preamble.\r\n"
+		"--" + boundary + "\r\n"
+		"Content-Disposition: form-data; name=\"text\"\r\n"
+		"\r\n"
+		"Some text\r\n"
+		"--" + boundary + "\r\n"
+		"Content-Disposition: form-data; name=\"file\"; filename=\"data.bin\"\r\n"
+		"Content-Type: application/octet-stream\r\n"
+		"\r\n" +
+		trickyData() + "\r\n"
+		"--" + boundary + "\r\n"
+		"Content-Disposition: form-data; name=\"empty\"\r\n"
+		"\r\n"
+		"\r\n"
+		"--" + boundary + "--\r\n"
+		"This is the epilogue.\r\n";
+}
+
+/**
+ * Passes "content" in pieces of the given sizes and returns the decoded parts. The last piece gets the rest.
+ */
+std::vector<Part> decode(const std::string& content, const std::vector<size_t>& pieceSizes, bool& finished)
+{
+	std::vector<Part> parts;
+	bool valid = true;
+	Http::MultipartDecoder decoder(boundary, [&](Http::MultipartDecoder::Event::Enum event, const Http::FormData& part, const char* data, size_t size)
+	{
+		if(event == Http::MultipartDecoder::Event::partBegin)
+		{
+			if(!parts.empty() && !parts.back().complete) valid = false;
+			parts.emplace_back();
+			parts.back().name = part.name;
+			parts.back().filename = part.filename;
+			parts.back().contentType = part.contentType;
+		}
+		else if(parts.empty() || parts.back().complete) valid = false;
+		else if(event == Http::MultipartDecoder::Event::partData)
+		{
+			if(size == 0) valid = false;
+			parts.back().data.append(data, size);
+		}
+		else parts.back().complete = true;
+	});
+
+	Test::feedPieces(content, pieceSizes, [&decoder](char* piece, size_t size) { decoder.decode(piece, size); });
+	finished = decoder.isFinished();
+	if(!valid) parts.clear();
+	return parts;
+}
+
+bool same(const std::vector<Part>& a, const std::vector<Part>& b)
+{
+	if(a.size() != b.size()) return false;
+	for(size_t i = 0; i < a.size(); i++)
+	{
+		if(a[i].name != b[i].name || a[i].filename != b[i].filename || a[i].contentType != b[i].contentType || a[i].data != b[i].data || a[i].complete != b[i].complete) return false;
+	}
+	return true;
+}
+
+}
+
+TEST(oneShot)
+{
+	bool finished = false;
+	std::vector<Part> parts = decode(body(), {}, finished);
+	EXPECT(finished);
+	EXPECT(parts.size() == 3);
+	if(parts.size() != 3) return;
+	EXPECT(parts[0].name == "text" && parts[0].filename.empty() && parts[0].data == "Some text" && parts[0].complete);
+	EXPECT(parts[1].name == "file" && parts[1].filename == "data.bin" && parts[1].contentType == "application/octet-stream");
+	EXPECT(parts[1].data == trickyData() && parts[1].complete);
+	EXPECT(parts[2].name == "empty" && parts[2].data.empty() && parts[2].complete);
+}
+
+TEST(splits)
+{
+	const std::string content = body();
+	bool finished = false;
+	const std::vector<Part> expected = decode(content, {}, finished);
+	//Random splits include empty pieces.
+	Test::forEachSplit(content.size(), [&](const std::vector<size_t>& pieceSizes, const std::string& description)
+	{
+		std::vector<Part> parts = decode(content, pieceSizes, finished);
+		EXPECT_MESSAGE(finished && same(parts, expected), description);
+	}, 1000, 63, 0);
+}
+
+TEST(withoutPreamble)
+{
+	//The first delimiter doesn't need a line break in front of it.
+	const std::string content = body().substr(body().find("--" + boundary));
+	bool finished = false;
+	const std::vector<Part> expected = decode(body(), {}, finished);
+	Test::forEachSplit(content.size(), [&](const std::vector<size_t>& pieceSizes, const std::string& description)
+	{
+		std::vector<Part> parts = decode(content, pieceSizes, finished);
+		EXPECT_MESSAGE(finished && same(parts, expected), description);
+	});
+}
+
+int main()
+{
+	return Test::run();
+}
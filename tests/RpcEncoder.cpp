@@ -0,0 +1,202 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+
+#include "Test.h"
+#include "BaseLib.h"
+
+#include <algorithm>
+
+using namespace BaseLib;
+
+namespace
+{
+
+/**
+ * Converts hex with optional spaces between the bytes to binary.
+ */
+template<typename Data>
+Data binary(std::string hex)
+{
+	hex.erase(std::remove(hex.begin(), hex.end(), ' '), hex.end());
+	std::vector<uint8_t> bytes = HelperFunctions::getUBinary(hex);
+	return Data(bytes.begin(), bytes.end());
+}
+
+template<typename Data>
+std::string hex(const Data& data)
+{
+	return HelperFunctions::getHexString(std::vector<uint8_t>(data.begin(), data.end()));
+}
+
+/**
+ * Encodes the response into a new vector and checks size, capacity and content.
+ */
+template<typename Data>
+void expectResponse(Rpc::RpcEncoder& encoder, const PVariable& variable, const std::string& expected, const std::string& name)
+{
+	Data packet;
+	encoder.encodeResponse(variable, packet);
+	EXPECT_MESSAGE(packet.size() == 8 + encoder.getEncodedSize(variable), name);
+	//The packet is allocated once with its final size. A reallocation would have grown the capacity beyond it.
+	EXPECT_MESSAGE(packet.capacity() == packet.size(), name);
+	EXPECT_MESSAGE(packet == binary<Data>(expected), name + ": " + hex(packet));
+}
+
+void expectResponse(Rpc::RpcEncoder& encoder, const PVariable& variable, const std::string& expected, const std::string& name)
+{
+	expectResponse<std::vector<char>>(encoder, variable, expected, name);
+	expectResponse<std::vector<uint8_t>>(encoder, variable, expected, name + " (uint8_t)");
+}
+
+template<typename Data, typename Parameters>
+void expectRequest(const Parameters& parameters, const std::shared_ptr<Rpc::RpcHeader>& header, const std::string& expected, const std::string& name)
+{
+	Rpc::RpcEncoder encoder;
+	Data packet;
+	encoder.encodeRequest("m", parameters, packet, header);
+	EXPECT_MESSAGE(packet.capacity() == packet.size(), name);
+	EXPECT_MESSAGE(packet == binary<Data>(expected), name + ": " + hex(packet));
+}
+
+void expectRequest(const std::shared_ptr<Rpc::RpcHeader>& header, const std::string& expected, const std::string& name)
+{
+	auto array = std::make_shared<Array>();
+	array->push_back(std::make_shared<Variable>(7));
+	auto list = std::make_shared<std::list<PVariable>>(array->begin(), array->end());
+	expectRequest<std::vector<char>>(array, header, expected, name);
+	expectRequest<std::vector<uint8_t>>(array, header, expected, name + " (uint8_t)");
+	expectRequest<std::vector<char>>(list, header, expected, name + " (list)");
+	expectRequest<std::vector<uint8_t>>(list, header, expected, name + " (list, uint8_t)");
+}
+
+}
+
+TEST(scalars)
+{
+	Rpc::RpcEncoder encoder;
+	expectResponse(encoder, std::make_shared<Variable>(), "42696e01 00000008 00000003 00000000", "void");
+	expectResponse(encoder, nullptr, "42696e01 00000008 00000003 00000000", "nullptr");
+	expectResponse(encoder, std::make_shared<Variable>(42), "42696e01 00000008 00000001 0000002a", "integer");
+	expectResponse(encoder, std::make_shared<Variable>(-2), "42696e01 00000008 00000001 fffffffe", "negative integer");
+	expectResponse(encoder, std::make_shared<Variable>(int64_t(1) << 40), "42696e01 0000000c 000000d1 00000100 00000000", "integer64");
+	expectResponse(encoder, std::make_shared<Variable>(0.0), "42696e01 0000000c 00000004 00000000 00000000", "float 0");
+	expectResponse(encoder, std::make_shared<Variable>(0.5), "42696e01 0000000c 00000004 20000000 00000000", "float 0.5");
+	expectResponse(encoder, std::make_shared<Variable>(-3.0), "42696e01 0000000c 00000004 d0000000 00000002", "float -3");
+	expectResponse(encoder, std::make_shared<Variable>(0.125), "42696e01 0000000c 00000004 20000000 fffffffe", "float 0.125");
+	expectResponse(encoder, std::make_shared<Variable>(true), "42696e01 00000005 00000002 01", "true");
+	expectResponse(encoder, std::make_shared<Variable>(false), "42696e01 00000005 00000002 00", "false");
+	expectResponse(encoder, std::make_shared<Variable>("abc"), "42696e01 0000000b 00000003 00000003 616263", "string");
+	expectResponse(encoder, std::make_shared<Variable>(""), "42696e01 00000008 00000003 00000000", "empty string");
+	auto base64 = std::make_shared<Variable>(VariableType::tBase64);
+	base64->stringValue = "YQ==";
+	expectResponse(encoder, base64, "42696e01 0000000c 00000011 00000004 59513d3d", "base64");
+	expectResponse(encoder, std::make_shared<Variable>(std::vector<uint8_t>{1, 2, 0xFF}), "42696e01 0000000b 000000d0 00000003 0102ff", "binary");
+}
+
+TEST(encoderOptions)
+{
+	Rpc::RpcEncoder encoder(true, true);
+	expectResponse(encoder, std::make_shared<Variable>(), "42696e01 00000004 00000000", "encoded void");
+	expectResponse(encoder, nullptr, "42696e01 00000004 00000000", "encoded nullptr");
+	expectResponse(encoder, std::make_shared<Variable>(-1), "42696e01 0000000c 000000d1 ffffffff ffffffff", "forced integer64");
+}
+
+TEST(containers)
+{
+	Rpc::RpcEncoder encoder;
+	expectResponse(encoder, std::make_shared<Variable>(VariableType::tArray), "42696e01 00000008 00000100 00000000", "empty array");
+	expectResponse(encoder, std::make_shared<Variable>(VariableType::tStruct), "42696e01 00000008 00000101 00000000", "empty struct");
+
+	auto array = std::make_shared<Variable>(VariableType::tArray);
+	array->emplaceArrayElement(1);
+	array->emplaceArrayElement("a");
+	array->arrayValue->push_back(nullptr);
+	expectResponse(encoder, array, "42696e01 00000021 00000100 00000003 00000001 00000001 00000003 00000001 61 00000003 00000000", "array");
+
+	//Empty names are encoded as "UNDEFINED", missing members as Void.
+	auto structure = std::make_shared<Variable>(VariableType::tStruct);
+	structure->emplaceStructElement("", true);
+	(*structure->structValue)["b"] = nullptr;
+	structure->emplaceStructElement("c", VariableType::tArray)->emplaceArrayElement(VariableType::tStruct);
+	expectResponse(encoder, structure, "42696e01 0000003c 00000101 00000003 "
+		"00000009 554e444546494e4544 00000002 01 "
+		"00000001 62 00000003 00000000 "
+		"00000001 63 00000100 00000001 00000101 00000000", "struct");
+
+	expectResponse(encoder, Variable::createError(-1, "x"), "42696eff 00000035 00000101 00000002 "
+		"00000009 6661756c74436f6465 00000001 ffffffff "
+		"0000000b 6661756c74537472696e67 00000003 00000001 78", "error");
+}
+
+TEST(requests)
+{
+	expectRequest(nullptr, "42696e00 00000011 00000001 6d 00000001 00000001 00000007", "without header");
+
+	auto header = std::make_shared<Rpc::RpcHeader>();
+	expectRequest(header, "42696e00 00000011 00000001 6d 00000001 00000001 00000007", "empty authorization");
+
+	header->authorization = "Basic x";
+	expectRequest(header, "42696e40 00000020 00000001 0000000d 417574686f72697a6174696f6e 00000007 4261736963 2078 "
+		"00000011 00000001 6d 00000001 00000001 00000007", "with header");
+
+	Rpc::RpcEncoder encoder;
+	std::vector<char> packet;
+	encoder.encodeRequest("m", PArray(), packet);
+	EXPECT(packet == binary<std::vector<char>>("42696e00 00000009 00000001 6d 00000000"));
+}
+
+TEST(insertHeader)
+{
+	Rpc::RpcEncoder encoder;
+	auto parameters = std::make_shared<Array>();
+	parameters->push_back(std::make_shared<Variable>(7));
+	auto header = std::make_shared<Rpc::RpcHeader>();
+	header->authorization = "Basic x";
+
+	std::vector<char> expected;
+	encoder.encodeRequest("m", parameters, expected, header);
+	std::vector<char> packet;
+	encoder.encodeRequest("m", parameters, packet);
+	Rpc::RpcEncoder::insertHeader(packet, *header);
+	EXPECT(packet == expected);
+
+	std::vector<char> withoutHeader;
+	encoder.encodeRequest("m", parameters, withoutHeader);
+	packet = withoutHeader;
+	Rpc::RpcEncoder::insertHeader(packet, Rpc::RpcHeader());
+	EXPECT(packet == withoutHeader);
+}
+
+int main()
+{
+	return Test::run();
+}
@@ -0,0 +1,235 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "Test.h"
+#include "BaseLib.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+struct Result
+{
+	bool failed = false;
+	std::string methodName;
+	PArray parameters;
+	PVariable response;
+};
+
+/**
+ * Feeds the packet to BinaryRpc in pieces of the given sizes. The last piece contains the rest of the packet.
+ */
+void feed(Rpc::BinaryRpc& binaryRpc, const std::vector<char>& packet, const std::vector<size_t>& pieces)
+{
+	Test::feedPieces(packet, pieces, [&binaryRpc](char* piece, size_t size) { binaryRpc.process(piece, (int32_t)size); });
+}
+
+Result decodeStored(const std::vector<char>& packet)
+{
+	Result result;
+	try
+	{
+		Rpc::BinaryRpc binaryRpc;
+		feed(binaryRpc, packet, {});
+		if(!binaryRpc.isFinished()) throw Exception("Packet is incomplete.");
+		Rpc::RpcDecoder decoder;
+		uint32_t offset = 0;
+		if(binaryRpc.hasHeader())
+		{
+			uint32_t position = 4;
+			offset = BinaryDecoder::decodeInteger(binaryRpc.getData(), position) + 4;
+		}
+		if(binaryRpc.getType() == Rpc::BinaryRpc::Type::request) result.parameters = decoder.decodeRequest(binaryRpc.getData(), result.methodName);
+		else result.response = decoder.decodeResponse(binaryRpc.getData(), offset);
+	}
+	catch(const std::exception&)
+	{
+		result.failed = true;
+	}
+	return result;
+}
+
+Result decodeStreamed(const std::vector<char>& packet, const std::vector<size_t>& pieces)
+{
+	Result result;
+	try
+	{
+		Rpc::BinaryRpc binaryRpc;
+		auto decoder = std::make_shared<Rpc::RpcStreamDecoder>();
+		binaryRpc.setStreamDecoder(decoder);
+		feed(binaryRpc, packet, pieces);
+		if(!binaryRpc.isFinished()) throw Exception("Packet is incomplete.");
+		if(binaryRpc.getType() == Rpc::BinaryRpc::Type::request)
+		{
+			result.methodName = decoder->getMethodName();
+			result.parameters = decoder->getParameters();
+		}
+		else result.response = decoder->getResponse();
+	}
+	catch(const std::exception&)
+	{
+		result.failed = true;
+	}
+	return result;
+}
+
+bool equal(const PVariable& a, const PVariable& b)
+{
+	if(!a || !b) return !a && !b;
+	if(a->type == VariableType::tVoid) return b->type == VariableType::tVoid; //Void is never equal in operator==
+	return *a == *b && a->errorStruct == b->errorStruct && a->integerValue == b->integerValue && a->booleanValue == b->booleanValue;
+}
+
+bool equal(const Result& a, const Result& b)
+{
+	if(a.failed || b.failed) return a.failed == b.failed;
+	if(a.methodName != b.methodName || !equal(a.response, b.response)) return false;
+	if(!a.parameters || !b.parameters) return !a.parameters && !b.parameters;
+	if(a.parameters->size() != b.parameters->size()) return false;
+	for(size_t i = 0; i < a.parameters->size(); i++)
+	{
+		if(!equal(a.parameters->at(i), b.parameters->at(i))) return false;
+	}
+	return true;
+}
+
+/**
+ * Decodes the packet with RpcDecoder and with RpcStreamDecoder fed in all splits of Test::forEachSplit(). All results
+ * need to be the same.
+ */
+void compare(const std::string& name, const std::vector<char>& packet, bool expectFailure = false)
+{
+	Result expected = decodeStored(packet);
+	EXPECT_MESSAGE(expected.failed == expectFailure, name);
+
+	Test::forEachSplit(packet.size(), [&](const std::vector<size_t>& pieceSizes, const std::string& description)
+	{
+		EXPECT_MESSAGE(equal(expected, decodeStreamed(packet, pieceSizes)), name + ", " + description);
+	});
+}
+
+std::vector<char> request(const std::string& methodName, const PArray& parameters)
+{
+	std::vector<char> packet;
+	Rpc::RpcEncoder encoder;
+	encoder.encodeRequest(methodName, parameters, packet);
+	return packet;
+}
+
+std::vector<char> response(const PVariable& value)
+{
+	std::vector<char> packet;
+	Rpc::RpcEncoder encoder;
+	encoder.encodeResponse(value, packet);
+	return packet;
+}
+
+PVariable nestedValue()
+{
+	PVariable inner = std::make_shared<Variable>(VariableType::tStruct);
+	inner->structValue->emplace("FLOAT", std::make_shared<Variable>(1.25));
+	inner->structValue->emplace("EMPTY_ARRAY", std::make_shared<Variable>(VariableType::tArray));
+	inner->structValue->emplace("EMPTY_STRING", std::make_shared<Variable>(std::string()));
+	PVariable array = std::make_shared<Variable>(VariableType::tArray);
+	array->arrayValue->push_back(std::make_shared<Variable>(std::string("Some string")));
+	array->arrayValue->push_back(std::make_shared<Variable>((int64_t)1 << 40));
+	array->arrayValue->push_back(std::make_shared<Variable>(false));
+	array->arrayValue->push_back(std::make_shared<Variable>(std::vector<uint8_t>{0, 1, 2, 255}));
+	array->arrayValue->push_back(inner);
+	PVariable outer = std::make_shared<Variable>(VariableType::tStruct);
+	outer->structValue->emplace("ARRAY", array);
+	outer->structValue->emplace("INTEGER", std::make_shared<Variable>(-17));
+	outer->structValue->emplace("VOID", std::make_shared<Variable>());
+	return outer;
+}
+
+std::vector<char> fromString(const std::string& data)
+{
+	return std::vector<char>(data.begin(), data.end());
+}
+
+}
+
+TEST(requests)
+{
+	PArray parameters = std::make_shared<Array>();
+	parameters->push_back(std::make_shared<Variable>(1234));
+	parameters->push_back(std::make_shared<Variable>(std::string("STATE")));
+	parameters->push_back(std::make_shared<Variable>(true));
+	parameters->push_back(nestedValue());
+	compare("setValue", request("setValue", parameters));
+	compare("no parameters", request("listDevices", std::make_shared<Array>()));
+}
+
+TEST(responses)
+{
+	compare("nested", response(nestedValue()));
+	compare("integer", response(std::make_shared<Variable>(42)));
+	compare("string", response(std::make_shared<Variable>(std::string("42 is the answer"))));
+
+	PVariable error = Variable::createError(-5, "Unknown parameter.");
+	std::vector<char> packet = response(error);
+	packet.at(3) = (char)0xFF;
+	compare("error", packet);
+}
+
+TEST(integerEncodedAsString)
+{
+	//IP-Symcon sends the value of integers as string. Type integer followed by "12" instead of four bytes.
+	compare("integer as string", fromString(std::string("Bin\x01\0\0\0\x06\0\0\0\x01" "12", 14)));
+	//Same with one and three digits.
+	compare("integer as string, 1 digit", fromString(std::string("Bin\x01\0\0\0\x05\0\0\0\x01" "7", 13)));
+	compare("integer as string, 3 digits", fromString(std::string("Bin\x01\0\0\0\x07\0\0\0\x01" "123", 15)));
+}
+
+TEST(emptyBody)
+{
+	//Response with header (4 bytes, no fields) and an empty body.
+	std::vector<char> packet = fromString(std::string("Bin\x41\0\0\0\x04\0\0\0\0\0\0\0\0", 16));
+	compare("empty body", packet);
+	Result result = decodeStreamed(packet, {});
+	EXPECT(!result.failed && result.response && result.response->type == VariableType::tVoid);
+}
+
+TEST(invalidPackets)
+{
+	std::vector<char> packet = response(nestedValue());
+	//Truncate the body, but keep the size field consistent.
+	std::vector<char> truncated(packet.begin(), packet.begin() + 20);
+	uint32_t size = truncated.size() - 8;
+	HelperFunctions::memcpyBigEndian(truncated.data() + 4, (char*)&size, 4);
+	compare("truncated", truncated, true);
+}
+
+int main()
+{
+	return Test::run();
+}
@@ -0,0 +1,166 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal test harness. Each test binary registers its cases with TEST(), checks with EXPECT() and returns
+ * Test::run() from main(). A binary fails (and with it ctest) when any check fails or a case throws.
+ */
+namespace Test
+{
+
+struct Case
+{
+	std::string name;
+	std::function<void()> function;
+};
+
+inline std::vector<Case>& cases()
+{
+	static std::vector<Case> cases;
+	return cases;
+}
+
+inline size_t& failures()
+{
+	static size_t failures = 0;
+	return failures;
+}
+
+struct Registration
+{
+	Registration(const std::string& name, const std::function<void()>& function) { cases().push_back(Case{name, function}); }
+};
+
+inline void check(bool condition, const char* expression, const std::string& message, const char* file, int line)
+{
+	if(condition) return;
+	failures()++;
+	printf("%s:%d: Check failed: %s%s%s\n", file, line, expression, message.empty() ? "" : " - ", message.c_str());
+}
+
+/**
+ * Passes "data" to "consume" in pieces of the given sizes. The last piece gets the rest. Every piece is copied into a
+ * buffer of its own, so reading behind it or keeping pointers into it is noticed by sanitizers.
+ */
+template<typename Data>
+void feedPieces(const Data& data, const std::vector<size_t>& pieceSizes, const std::function<void(char* piece, size_t size)>& consume)
+{
+	size_t position = 0;
+	for(size_t i = 0; i <= pieceSizes.size(); i++)
+	{
+		size_t pieceSize = i < pieceSizes.size() ? std::min(pieceSizes[i], data.size() - position) : data.size() - position;
+		if(i == pieceSizes.size() && pieceSize == 0) break;
+		std::vector<char> piece(data.begin() + position, data.begin() + position + pieceSize);
+		consume(piece.data(), piece.size());
+		position += pieceSize;
+	}
+}
+
+/**
+ * Calls "check" with the piece sizes of every way streaming decoders are fed in the tests: in one piece, split in two at
+ * every position, byte by byte and "randomSplits" times in random pieces of "minPieceSize" to "maxPieceSize" bytes.
+ * "description" names the split for failure messages.
+ */
+inline void forEachSplit(size_t size, const std::function<void(const std::vector<size_t>& pieceSizes, const std::string& description)>& check, size_t randomSplits = 100, size_t maxPieceSize = 20, size_t minPieceSize = 1)
+{
+	check({}, "One piece");
+	for(size_t i = 1; i < size; i++) check({i}, "Split at " + std::to_string(i));
+	check(std::vector<size_t>(size, 1), "Byte by byte");
+
+	std::mt19937 random((uint32_t)size);
+	std::uniform_int_distribution<size_t> pieceSize(minPieceSize, maxPieceSize);
+	for(size_t i = 0; i < randomSplits; i++)
+	{
+		std::vector<size_t> pieceSizes;
+		for(size_t position = 0; position < size; position += pieceSizes.back()) pieceSizes.push_back(pieceSize(random));
+		check(pieceSizes, "Random split " + std::to_string(i));
+	}
+}
+
+inline int run()
+{
+	for(auto& testCase : cases())
+	{
+		size_t failuresBefore = failures();
+		try
+		{
+			testCase.function();
+		}
+		catch(const std::exception& ex)
+		{
+			failures()++;
+			printf("%s: Unexpected exception: %s\n", testCase.name.c_str(), ex.what());
+		}
+		printf("%s %s\n", failures() == failuresBefore ? "[  OK  ]" : "[FAILED]", testCase.name.c_str());
+	}
+	return failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}
+
+#define TEST_CONCAT_(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_(a, b)
+
+/**
+ * Defines a test case: TEST(name) { ... }
+ */
+#define TEST(name) \
+	static void name(); \
+	static Test::Registration TEST_CONCAT(name, Registration)(#name, name); \
+	static void name()
+
+#define EXPECT(condition) Test::check((condition), #condition, std::string(), __FILE__, __LINE__)
+#define EXPECT_MESSAGE(condition, message) Test::check((condition), #condition, (message), __FILE__, __LINE__)
+
+/**
+ * Checks that "statement" throws an exception derived from std::exception.
+ */
+#define EXPECT_THROW(statement) \
+	do \
+	{ \
+		bool thrown = false; \
+		try { statement; } \
+		catch(const std::exception&) { thrown = true; } \
+		Test::check(thrown, #statement " throws", std::string(), __FILE__, __LINE__); \
+	} while(false)
+
+#endif
@@ -0,0 +1,310 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+
+#include "Test.h"
+#include "Variables.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+/**
+ * Returns {"a": 1, "b": [true, "x", {"c": 2.5}], "d": "text"}.
+ */
+PVariable createTree()
+{
+	auto tree = std::make_shared<Variable>(VariableType::tStruct);
+	tree->emplaceStructElement("a", 1);
+	PVariable& b = tree->emplaceStructElement("b", VariableType::tArray);
+	b->emplaceArrayElement(true);
+	b->emplaceArrayElement("x");
+	b->emplaceArrayElement(VariableType::tStruct)->emplaceStructElement("c", 2.5);
+	tree->emplaceStructElement("d", std::string("text"));
+	return tree;
+}
+
+}
+
+TEST(copyOnWriteSharesContainers)
+{
+	PVariable tree = createTree();
+	PVariable copy = tree->copyOnWrite();
+	EXPECT(copy->structValue.sharesContainerWith(tree->structValue));
+	EXPECT(copy->structValue->at("b") == tree->structValue->at("b"));
+	EXPECT(*copy == *tree);
+	EXPECT(copy->hash() == tree->hash());
+}
+
+TEST(mutableStructDoesNotChangeSource)
+{
+	PVariable tree = createTree();
+	PVariable reference = createTree();
+	PVariable copy = tree->copyOnWrite();
+
+	copy->mutableStruct().erase("a");
+	copy->mutableStruct()["e"] = std::make_shared<Variable>(3);
+	copy->mutableStructElement("d")->stringValue = "changed";
+
+	EXPECT(!copy->structValue.sharesContainerWith(tree->structValue));
+	EXPECT(*tree == *reference);
+	EXPECT(tree->structValue->at("d")->stringValue == "text");
+	EXPECT(copy->structValue->size() == 3);
+	EXPECT(copy->structValue->at("d")->stringValue == "changed");
+	EXPECT(copy->structValue->at("e")->integerValue == 3);
+	EXPECT(!(*copy == *tree));
+}
+
+TEST(mutableArrayDoesNotChangeSource)
+{
+	PVariable tree = createTree();
+	PVariable reference = createTree();
+	PVariable copy = tree->copyOnWrite();
+
+	//Two levels deep: The struct, the array and the element are copied, the rest stays shared.
+	PVariable& b = copy->mutableStructElement("b");
+	b->mutableArray().push_back(std::make_shared<Variable>(4));
+	b->mutableArrayElement(0)->booleanValue = false;
+	b->mutableArrayElement(2)->mutableStructElement("c")->floatValue = 3.5;
+
+	EXPECT(*tree == *reference);
+	EXPECT(tree->structValue->at("b")->arrayValue->size() == 3);
+	EXPECT(copy->structValue->at("b")->arrayValue->size() == 4);
+	EXPECT(copy->structValue->at("b")->arrayValue->at(0)->booleanValue == false);
+	EXPECT(copy->structValue->at("b")->arrayValue->at(2)->structValue->at("c")->floatValue == 3.5);
+	EXPECT(copy->structValue->at("a") == tree->structValue->at("a"));
+	EXPECT(copy->structValue->at("b")->arrayValue->at(1) == tree->structValue->at("b")->arrayValue->at(1));
+}
+
+TEST(elementObtainedBeforeKeepsPointingToSource)
+{
+	PVariable tree = createTree();
+	PVariable copy = tree->copyOnWrite();
+	PVariable d = copy->structValue->at("d");
+
+	copy->mutableStructElement("d")->stringValue = "changed";
+	EXPECT(d == tree->structValue->at("d"));
+	EXPECT(d->stringValue == "text");
+}
+
+TEST(mutableAccessWithoutSharingDoesNotCopy)
+{
+	PVariable tree = createTree();
+	const Struct* container = tree->structValue.get();
+	const Variable* a = tree->structValue->at("a").get();
+
+	tree->mutableStruct()["e"] = std::make_shared<Variable>(5);
+	tree->mutableStructElement("a")->integerValue = 2;
+	EXPECT(tree->structValue.get() == container);
+	EXPECT(tree->structValue->at("a").get() == a);
+	EXPECT(tree->structValue->at("a")->integerValue == 2);
+}
+
+TEST(detachCopiesSharedContainer)
+{
+	auto array = std::make_shared<Array>();
+	array->push_back(std::make_shared<Variable>(1));
+	LazySharedPointer<Array> first(array);
+	LazySharedPointer<Array> second(first);
+	EXPECT(second.sharesContainerWith(first));
+
+	second.detach().push_back(std::make_shared<Variable>(2));
+	EXPECT(!second.sharesContainerWith(first));
+	EXPECT(first->size() == 1);
+	EXPECT(second->size() == 2);
+	//Only the container is copied, not the elements.
+	EXPECT(second->at(0) == first->at(0));
+
+	Array* container = second.get();
+	second.detach().push_back(std::make_shared<Variable>(3));
+	EXPECT(second.get() == container);
+}
+
+TEST(plainWritesAreShared)
+{
+	//As documented for copyOnWrite(): Writing through arrayValue or structValue changes both variables.
+	PVariable tree = createTree();
+	PVariable copy = tree->copyOnWrite();
+
+	copy->structValue->at("b")->arrayValue->push_back(std::make_shared<Variable>(4));
+	copy->structValue->at("a")->integerValue = 2;
+	(*copy->structValue)["e"] = std::make_shared<Variable>(5);
+
+	EXPECT(tree->structValue->at("b")->arrayValue->size() == 4);
+	EXPECT(tree->structValue->at("a")->integerValue == 2);
+	EXPECT(tree->structValue->count("e") == 1);
+	EXPECT(*copy == *tree);
+}
+
+TEST(copyConstructorCopiesDeep)
+{
+	PVariable tree = createTree();
+	PVariable reference = createTree();
+	auto copy = std::make_shared<Variable>(*tree);
+	EXPECT(!copy->structValue.sharesContainerWith(tree->structValue));
+	EXPECT(*copy == *tree);
+
+	copy->structValue->at("b")->arrayValue->push_back(std::make_shared<Variable>(4));
+	copy->structValue->at("a")->integerValue = 2;
+	EXPECT(*tree == *reference);
+}
+
+TEST(lazyContainers)
+{
+	Variable array(VariableType::tArray);
+	EXPECT(!array.arrayValue.isAllocated());
+	EXPECT(array.arrayValue.isEmpty());
+	EXPECT((bool)array.arrayValue);
+	EXPECT(array.arrayValue.use_count() == 0);
+
+	//Copies of an unallocated holder get their own container on first access.
+	PVariable copy = array.copyOnWrite();
+	Variable deepCopy(array);
+	EXPECT(!copy->arrayValue.isAllocated());
+	EXPECT(!deepCopy.arrayValue.isAllocated());
+	copy->arrayValue->push_back(std::make_shared<Variable>(1));
+	EXPECT(!array.arrayValue.isAllocated());
+	EXPECT(array.arrayValue->empty());
+	EXPECT(array.arrayValue.isAllocated());
+	EXPECT(!copy->arrayValue.sharesContainerWith(array.arrayValue));
+
+	//Allocated but empty and unallocated containers are equal.
+	EXPECT(array == Variable(VariableType::tArray));
+	EXPECT(array.hash() == Variable(VariableType::tArray).hash());
+
+	array.arrayValue.reset();
+	EXPECT(!array.arrayValue);
+	EXPECT(array.arrayValue == nullptr);
+	EXPECT(array.arrayValue.isEmpty());
+
+	array.arrayValue.resetToEmpty();
+	EXPECT((bool)array.arrayValue);
+	EXPECT(!array.arrayValue.isAllocated());
+	EXPECT(array.arrayValue->empty());
+
+	PArray shared = copy->arrayValue;
+	EXPECT(copy->arrayValue == shared);
+	EXPECT(copy->arrayValue.use_count() == 2);
+}
+
+TEST(hashMatchesEquality)
+{
+	//Same content built in different order.
+	auto first = std::make_shared<Variable>(VariableType::tStruct);
+	first->emplaceStructElement("x", 1);
+	first->emplaceStructElement("y", std::string("a"));
+	auto second = std::make_shared<Variable>(VariableType::tStruct);
+	second->emplaceStructElement("y", std::string("a"));
+	second->emplaceStructElement("x", 1);
+	EXPECT(*first == *second);
+	EXPECT(first->hash() == second->hash());
+
+	EXPECT(Variable(0.0) == Variable(-0.0));
+	EXPECT(Variable(0.0).hash() == Variable(-0.0).hash());
+
+	std::vector<Variable> different;
+	different.emplace_back();
+	different.emplace_back(true);
+	different.emplace_back(false);
+	different.emplace_back(1);
+	different.emplace_back((int64_t)1);
+	different.emplace_back(1.0);
+	different.emplace_back("1");
+	different.emplace_back(std::vector<uint8_t>{'1'});
+	different.emplace_back(VariableType::tArray);
+	different.emplace_back(VariableType::tStruct);
+	different.back().emplaceStructElement("1", 1);
+	different.emplace_back(VariableType::tStruct);
+	different.back().emplaceStructElement("1", 2);
+	different.emplace_back(VariableType::tArray);
+	different.back().emplaceArrayElement(1);
+	different.emplace_back(VariableType::tArray);
+	different.back().emplaceArrayElement(1);
+	different.back().emplaceArrayElement(1);
+	for(size_t i = 0; i < different.size(); i++)
+	{
+		for(size_t j = 0; j < different.size(); j++)
+		{
+			if(i == j || different[i].type == VariableType::tVoid) continue;
+			EXPECT_MESSAGE(!(different[i] == different[j]), std::to_string(i) + " " + std::to_string(j));
+			EXPECT_MESSAGE(different[i].hash() != different[j].hash(), std::to_string(i) + " " + std::to_string(j));
+		}
+	}
+}
+
+TEST(hashOfCopies)
+{
+	Test::RandomJson random(17);
+	for(int32_t i = 0; i < 200; i++)
+	{
+		PVariable document = Rpc::JsonDecoder::decode(random.document());
+		auto copy = std::make_shared<Variable>(*document);
+		PVariable copyOnWrite = document->copyOnWrite();
+		//operator== is false for Void, which JSON null decodes to. Shared elements compare equal by pointer.
+		EXPECT(Test::equal(copy, document));
+		EXPECT(*copyOnWrite == *document);
+		EXPECT(copy->hash() == document->hash());
+		EXPECT(copyOnWrite->hash() == document->hash());
+	}
+}
+
+TEST(emplaceElements)
+{
+	Variable array(VariableType::tArray);
+	std::string string(100, 's');
+	const char* stringData = string.data();
+	array.emplaceArrayElement(std::move(string));
+	array.emplaceArrayElement(int64_t(1) << 40);
+	PVariable& last = array.emplaceArrayElement(VariableType::tStruct);
+	EXPECT(array.arrayValue->size() == 3);
+	EXPECT(&last == &array.arrayValue->back());
+	EXPECT(array.arrayValue->at(0)->type == VariableType::tString);
+	EXPECT(array.arrayValue->at(0)->stringValue == std::string(100, 's'));
+	EXPECT(array.arrayValue->at(0)->stringValue.data() == stringData);
+	EXPECT(array.arrayValue->at(1)->type == VariableType::tInteger64);
+	EXPECT(array.arrayValue->at(1)->integerValue64 == int64_t(1) << 40);
+	EXPECT(last->type == VariableType::tStruct);
+
+	Variable structure(VariableType::tStruct);
+	PVariable& member = structure.emplaceStructElement("a", 1);
+	EXPECT(member->type == VariableType::tInteger);
+	//An existing member is not replaced.
+	PVariable& existing = structure.emplaceStructElement("a", 2);
+	EXPECT(&existing == &member);
+	EXPECT(structure.structValue->size() == 1);
+	EXPECT(structure.structValue->at("a")->integerValue == 1);
+}
+
+int main()
+{
+	return Test::run();
+}
@@ -0,0 +1,217 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef TEST_VARIABLES_H_
+#define TEST_VARIABLES_H_
+
+#include "BaseLib.h"
+
+#include <random>
+
+/**
+ * Helpers shared by the encoder and decoder tests.
+ */
+namespace Test
+{
+
+/**
+ * Compares type and value recursively. Unlike Variable::operator==, two Void values are equal.
+ */
+inline bool equal(const BaseLib::PVariable& a, const BaseLib::PVariable& b)
+{
+	using namespace BaseLib;
+	if(!a || !b) return !a && !b;
+	if(a->type != b->type || a->errorStruct != b->errorStruct) return false;
+	switch(a->type)
+	{
+		case VariableType::tArray:
+			if(a->arrayValue->size() != b->arrayValue->size()) return false;
+			for(size_t i = 0; i < a->arrayValue->size(); i++)
+			{
+				if(!equal(a->arrayValue->at(i), b->arrayValue->at(i))) return false;
+			}
+			return true;
+		case VariableType::tStruct:
+		{
+			if(a->structValue->size() != b->structValue->size()) return false;
+			for(auto i = a->structValue->begin(), j = b->structValue->begin(); i != a->structValue->end(); ++i, ++j)
+			{
+				if(i->first != j->first || !equal(i->second, j->second)) return false;
+			}
+			return true;
+		}
+		case VariableType::tVoid:
+			return true;
+		case VariableType::tFloat:
+			return a->floatValue == b->floatValue || (std::isnan(a->floatValue) && std::isnan(b->floatValue));
+		case VariableType::tInteger:
+		case VariableType::tInteger64:
+			return a->integerValue == b->integerValue && a->integerValue64 == b->integerValue64;
+		default:
+			return *a == *b;
+	}
+}
+
+/**
+ * Generates random JSON documents with all value types, escapes, non-ASCII characters and random whitespace. mutate()
+ * damages a document the way broken or truncated input would.
+ */
+class RandomJson
+{
+public:
+	explicit RandomJson(uint32_t seed) : _random(seed) {}
+
+	std::string document(int32_t depth = 4)
+	{
+		std::string json;
+		whitespace(json);
+		if(number(2) == 0) array(json, depth);
+		else object(json, depth);
+		whitespace(json);
+		return json;
+	}
+
+	std::string mutate(std::string json)
+	{
+		static const std::string characters = "{}[]:,\"\\ \nu0-.eE";
+		const int32_t count = number(3) + 1;
+		for(int32_t i = 0; i < count && !json.empty(); i++)
+		{
+			const size_t position = number(json.size());
+			switch(number(4))
+			{
+				case 0:
+					json.erase(position, 1);
+					break;
+				case 1:
+					json.insert(json.begin() + position, characters.at(number(characters.size())));
+					break;
+				case 2:
+					json.at(position) = characters.at(number(characters.size()));
+					break;
+				default:
+					json.resize(position);
+					break;
+			}
+		}
+		return json;
+	}
+
+	size_t number(size_t range)
+	{
+		return std::uniform_int_distribution<size_t>(0, range - 1)(_random);
+	}
+private:
+	std::mt19937 _random;
+
+	void whitespace(std::string& json)
+	{
+		static const char characters[] = { ' ', '\n', '\t', '\r' };
+		if(number(3) != 0) return;
+		const size_t count = number(4) + 1;
+		for(size_t i = 0; i < count; i++) json.push_back(characters[number(4)]);
+	}
+
+	void value(std::string& json, int32_t depth)
+	{
+		whitespace(json);
+		switch(number(depth > 0 ? 8 : 6))
+		{
+			case 0:
+				json.append(number(2) ? "true" : "false");
+				break;
+			case 1:
+				json.append("null");
+				break;
+			case 2:
+				json.append(std::to_string((int64_t)number(2000000) - 1000000));
+				break;
+			case 3:
+				json.append(std::to_string(((double)number(2000000) - 1000000) / 1000));
+				break;
+			case 4:
+				json.append(std::to_string((int64_t)number(1ull << 40) << 20));
+				break;
+			case 5:
+				string(json);
+				break;
+			case 6:
+				array(json, depth - 1);
+				break;
+			default:
+				object(json, depth - 1);
+				break;
+		}
+		whitespace(json);
+	}
+
+	void string(std::string& json)
+	{
+		static const char* parts[] = { "a", "Some text ", "\\\"", "\\\\", "\\n", "\\t", "\\/", "\\u00e4", "\\u20AC", "\\ud83d\\ude00", "\xc3\xa4", "\xe2\x82\xac", "0123456789" };
+		json.push_back('"');
+		const size_t count = number(12);
+		for(size_t i = 0; i < count; i++) json.append(parts[number(sizeof(parts) / sizeof(parts[0]))]);
+		json.push_back('"');
+	}
+
+	void array(std::string& json, int32_t depth)
+	{
+		json.push_back('[');
+		const size_t count = number(8);
+		for(size_t i = 0; i < count; i++)
+		{
+			if(i > 0) json.push_back(',');
+			value(json, depth);
+		}
+		whitespace(json);
+		json.push_back(']');
+	}
+
+	void object(std::string& json, int32_t depth)
+	{
+		json.push_back('{');
+		const size_t count = number(8);
+		for(size_t i = 0; i < count; i++)
+		{
+			if(i > 0) json.push_back(',');
+			whitespace(json);
+			string(json);
+			whitespace(json);
+			json.push_back(':');
+			value(json, depth);
+		}
+		whitespace(json);
+		json.push_back('}');
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,218 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+
+#include "Test.h"
+#include "BaseLib.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+typedef WebSocket::Header::Opcode Opcode;
+
+struct Message
+{
+	Opcode::Enum opcode = Opcode::close;
+	bool close = false;
+	std::vector<char> content;
+};
+
+struct Fragment
+{
+	std::vector<char> payload;
+	std::vector<char> maskingKey;
+};
+
+const std::vector<std::vector<char>> maskingKeys{{0x12, 0x34, 0x56, 0x78}, {(char)0xA5, 0x5A, (char)0xFF, 0x00}, {0x01, (char)0x80, 0x7F, (char)0xC3}};
+
+std::vector<char> payload(size_t size, uint8_t seed)
+{
+	std::vector<char> data;
+	data.reserve(size);
+	for(size_t i = 0; i < size; i++) data.push_back((char)(uint8_t)(i * 31 + seed));
+	return data;
+}
+
+/**
+ * Encodes one frame as a client would send it: With the mask bit set and the payload XORed with the masking key.
+ */
+void appendFrame(std::vector<char>& packet, Opcode::Enum opcode, bool fin, const std::vector<char>& payload, const std::vector<char>& maskingKey)
+{
+	packet.push_back((char)((fin ? 0x80 : 0) | opcode));
+	if(payload.size() < 126) packet.push_back((char)(0x80 | payload.size()));
+	else
+	{
+		packet.push_back((char)(0x80 | 126));
+		packet.push_back((char)(payload.size() >> 8));
+		packet.push_back((char)(payload.size() & 0xFF));
+	}
+	packet.insert(packet.end(), maskingKey.begin(), maskingKey.end());
+	for(size_t i = 0; i < payload.size(); i++) packet.push_back(payload[i] ^ maskingKey[i & 3]);
+}
+
+/**
+ * Encodes a message as a sequence of masked frames. The first frame carries the opcode, all others are continuation frames.
+ */
+std::vector<char> maskedMessage(Opcode::Enum opcode, const std::vector<Fragment>& fragments)
+{
+	std::vector<char> packet;
+	for(size_t i = 0; i < fragments.size(); i++)
+	{
+		appendFrame(packet, i == 0 ? opcode : Opcode::continuation, i + 1 == fragments.size(), fragments[i].payload, fragments[i].maskingKey);
+	}
+	return packet;
+}
+
+/**
+ * Feeds the packet to WebSocket in pieces of the given sizes. process() handles at most one frame per call, so every
+ * piece is passed until it is consumed completely. Each finished message is collected before the next call resets it.
+ */
+std::vector<Message> decode(const std::vector<char>& packet, const std::vector<size_t>& pieceSizes)
+{
+	std::vector<Message> messages;
+	WebSocket webSocket;
+	Test::feedPieces(packet, pieceSizes, [&](char* piece, size_t size)
+	{
+		size_t processed = 0;
+		while(processed < size)
+		{
+			uint32_t bytes = webSocket.process(piece + processed, (int32_t)(size - processed));
+			EXPECT(bytes > 0);
+			if(bytes == 0) return;
+			processed += bytes;
+			if(webSocket.isFinished())
+			{
+				Message message;
+				message.opcode = webSocket.getHeader().opcode;
+				message.close = webSocket.getHeader().close;
+				message.content = webSocket.getContent();
+				messages.push_back(std::move(message));
+			}
+		}
+	});
+	return messages;
+}
+
+/**
+ * Decodes the packet in all splits of Test::forEachSplit() and compares the result with the expected messages.
+ */
+void check(const std::string& name, const std::vector<char>& packet, const std::vector<Message>& expected)
+{
+	Test::forEachSplit(packet.size(), [&](const std::vector<size_t>& pieceSizes, const std::string& description)
+	{
+		std::vector<Message> messages = decode(packet, pieceSizes);
+		bool equal = messages.size() == expected.size();
+		for(size_t i = 0; equal && i < messages.size(); i++)
+		{
+			equal = messages[i].close == expected[i].close && messages[i].content == expected[i].content && (expected[i].close || messages[i].opcode == expected[i].opcode);
+		}
+		EXPECT_MESSAGE(equal, name + ", " + description);
+	});
+}
+
+Message message(Opcode::Enum opcode, const std::vector<Fragment>& fragments)
+{
+	Message message;
+	message.opcode = fragments.size() > 1 ? Opcode::continuation : opcode;
+	for(auto& fragment : fragments) message.content.insert(message.content.end(), fragment.payload.begin(), fragment.payload.end());
+	return message;
+}
+
+}
+
+TEST(singleFrames)
+{
+	//Lengths up to 40 cover the 16 byte, the 8 byte and the bytewise loop of the unmasking and all combinations of them.
+	std::vector<size_t> lengths;
+	for(size_t length = 1; length <= 40; length++) lengths.push_back(length);
+	lengths.push_back(125);
+	lengths.push_back(126);
+	lengths.push_back(300);
+	for(size_t length : lengths)
+	{
+		std::vector<Fragment> fragments{{payload(length, (uint8_t)length), maskingKeys.at(length % maskingKeys.size())}};
+		check("length " + std::to_string(length), maskedMessage(Opcode::binary, fragments), {message(Opcode::binary, fragments)});
+	}
+}
+
+TEST(fragments)
+{
+	//Every fragment has its own key and starts at an offset in the content that is not a multiple of 4.
+	for(size_t length = 1; length <= 40; length++)
+	{
+		std::vector<Fragment> fragments{
+			{payload(length, 1), maskingKeys.at(0)},
+			{payload(41 - length, 2), maskingKeys.at(1)},
+			{payload(length % 7 + 1, 3), maskingKeys.at(2)},
+			{payload(length * 3 % 37 + 1, 4), maskingKeys.at(0)}
+		};
+		check("fragments " + std::to_string(length), maskedMessage(Opcode::text, fragments), {message(Opcode::text, fragments)});
+	}
+}
+
+TEST(consecutiveMessages)
+{
+	std::vector<Fragment> first{{payload(19, 5), maskingKeys.at(1)}, {payload(13, 6), maskingKeys.at(2)}};
+	std::vector<Fragment> second{{payload(27, 7), maskingKeys.at(0)}};
+	std::vector<char> packet = maskedMessage(Opcode::text, first);
+	std::vector<char> secondPacket = maskedMessage(Opcode::binary, second);
+	packet.insert(packet.end(), secondPacket.begin(), secondPacket.end());
+	check("consecutive messages", packet, {message(Opcode::text, first), message(Opcode::binary, second)});
+}
+
+TEST(emptyFrame)
+{
+	//A frame without payload is treated as close.
+	Message close;
+	close.close = true;
+	check("empty frame", maskedMessage(Opcode::binary, {{std::vector<char>(), maskingKeys.at(0)}}), {close});
+}
+
+TEST(unmaskedFrames)
+{
+	for(size_t length : {1, 17, 40, 200})
+	{
+		std::vector<char> data = payload(length, 8);
+		std::vector<char> packet;
+		WebSocket::encode(data, Opcode::text, packet);
+		Message expected;
+		expected.opcode = Opcode::text;
+		expected.content = data;
+		check("unmasked " + std::to_string(length), packet, {expected});
+	}
+}
+
+int main()
+{
+	return Test::run();
+}
@@ -0,0 +1,245 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+
+#include "Test.h"
+#include "Variables.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+/**
+ * Parse errors are logged through SharedObjects. Only errors of debug level 1 are printed, which the decoder doesn't use.
+ */
+SharedObjects& baseLib()
+{
+	static SharedObjects baseLib;
+	baseLib.debugLevel = 1;
+	return baseLib;
+}
+
+PVariable decodeResponse(const std::string& packet)
+{
+	Rpc::XmlrpcDecoder decoder(&baseLib());
+	return decoder.decodeResponse(std::vector<char>(packet.begin(), packet.end()));
+}
+
+std::string response(const std::string& value)
+{
+	return "<methodResponse><params><param>" + value + "</param></params></methodResponse>";
+}
+
+PVariable parseError(const std::string& message)
+{
+	return Variable::createError(-32700, "Parse error. Not well formed: " + message);
+}
+
+PVariable base64(const std::string& value)
+{
+	auto variable = std::make_shared<Variable>(VariableType::tBase64);
+	variable->stringValue = value;
+	return variable;
+}
+
+void expectResponse(const std::string& packet, const PVariable& expected, const std::string& name)
+{
+	PVariable result = decodeResponse(packet);
+	EXPECT_MESSAGE(Test::equal(result, expected), name + ": " + (result ? result->print(false, false, true) : std::string("nullptr")));
+}
+
+/**
+ * Returns the message rapidxml throws for the packet or an empty string if it is well formed.
+ */
+std::string rapidxmlError(const std::string& packet)
+{
+	std::vector<char> copy(packet.begin(), packet.end());
+	copy.push_back(0);
+	try
+	{
+		xml_document document;
+		document.parse<parse_no_entity_translation>(copy.data());
+	}
+	catch(const parse_error& ex)
+	{
+		return ex.what();
+	}
+	return "";
+}
+
+}
+
+TEST(values)
+{
+	expectResponse(response("<value><i4>-5</i4></value>"), std::make_shared<Variable>(-5), "i4");
+	expectResponse(response("<value><int>7</int></value>"), std::make_shared<Variable>(7), "int");
+	expectResponse(response("<value><i8>1099511627776</i8></value>"), std::make_shared<Variable>(int64_t(1) << 40), "i8");
+	expectResponse(response("<value><double>-1.5</double></value>"), std::make_shared<Variable>(-1.5), "double");
+	expectResponse(response("<value><boolean>1</boolean></value>"), std::make_shared<Variable>(true), "boolean");
+	expectResponse(response("<value><BOOLEAN>true</BOOLEAN></value>"), std::make_shared<Variable>(true), "type in upper case");
+	expectResponse(response("<value><string>text</string></value>"), std::make_shared<Variable>("text"), "string");
+	expectResponse(response("<value>text</value>"), std::make_shared<Variable>("text"), "untyped string");
+	expectResponse(response("<value><base64>YQ==</base64></value>"), base64("YQ=="), "base64");
+	expectResponse(response("<value><nil/></value>"), std::make_shared<Variable>(), "nil");
+
+	auto structure = std::make_shared<Variable>(VariableType::tStruct);
+	structure->emplaceStructElement("a", VariableType::tArray)->emplaceArrayElement(1);
+	structure->emplaceStructElement("b", "c");
+	expectResponse(response("<value><struct><member><name>a</name><value><array><data><value><i4>1</i4></value></data></array></value></member>"
+		"<member><name>b</name><value>c</value></member></struct></value>"), structure, "nested");
+}
+
+TEST(cdata)
+{
+	expectResponse(response("<value><![CDATA[a<b>&amp;]]></value>"), std::make_shared<Variable>("a<b>&amp;"), "untyped");
+	expectResponse(response("<value><![CDATA[]]></value>"), std::make_shared<Variable>(""), "empty");
+	//Like with rapidxml only data nodes are the value of typed elements, CDATA is not.
+	expectResponse(response("<value><string><![CDATA[x]]></string></value>"), std::make_shared<Variable>(""), "typed");
+	expectResponse(response("<value><string><![CDATA[x]]>y</string></value>"), std::make_shared<Variable>("y"), "typed with text");
+}
+
+TEST(skippedNodes)
+{
+	const std::string packet = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+		"<!DOCTYPE methodResponse [<!ELEMENT methodResponse (params)> <!ENTITY x \"y\">]>\n"
+		"<!-- comment -->\n"
+		"<methodResponse><?pi data?><params><!-- <value><i4>2</i4></value> -->"
+		"<param><!DOCTYPE x><value><i4>1<!-- x --></i4></value></param></params></methodResponse>\n"
+		"<!-- trailing comment -->";
+	expectResponse(packet, std::make_shared<Variable>(1), "declaration, DOCTYPE, comments and processing instructions");
+}
+
+TEST(untranslatedEntities)
+{
+	expectResponse(response("<value>a&amp;b&lt;&#65;&x;</value>"), std::make_shared<Variable>("a&amp;b&lt;&#65;&x;"), "untyped");
+	expectResponse(response("<value><string>&quot;</string></value>"), std::make_shared<Variable>("&quot;"), "string");
+
+	Rpc::XmlrpcDecoder decoder(&baseLib());
+	std::string request = "<methodCall><methodName>a&amp;b</methodName><params/></methodCall>";
+	std::string methodName;
+	auto parameters = decoder.decodeRequest(std::vector<char>(request.begin(), request.end()), methodName);
+	EXPECT(methodName == "a&amp;b");
+	EXPECT(parameters->empty());
+}
+
+TEST(textBeforeTypedNodes)
+{
+	//Text is the value when it comes first and keeps its whitespace. Whitespace-only text is dropped.
+	expectResponse(response("<value> text <i4>5</i4></value>"), std::make_shared<Variable>(" text "), "text first");
+	expectResponse(response("<value>\r\n\t <i4>5</i4>\n</value>"), std::make_shared<Variable>(5), "whitespace first");
+	expectResponse(response("<value><i4>5</i4> text</value>"), std::make_shared<Variable>(5), "text behind");
+	expectResponse(response("<value><string> a </string></value>"), std::make_shared<Variable>(" a "), "whitespace in string");
+
+	//Every child of "data" is an element of the array. Text has no children, so it becomes an empty string.
+	auto array = std::make_shared<Variable>(VariableType::tArray);
+	array->emplaceArrayElement("");
+	array->emplaceArrayElement(1);
+	expectResponse(response("<value><array><data>a<value><i4>1</i4></value></data></array></value>"), array, "text in data");
+}
+
+TEST(selfClosing)
+{
+	expectResponse(response("<value/>"), std::make_shared<Variable>(""), "value");
+	expectResponse(response("<value><string/></value>"), std::make_shared<Variable>(""), "string");
+	expectResponse(response("<value><i4/></value>"), std::make_shared<Variable>(0), "i4");
+	expectResponse(response("<value><struct/></value>"), std::make_shared<Variable>(VariableType::tStruct), "struct");
+	expectResponse(response("<value><array/></value>"), std::make_shared<Variable>(VariableType::tArray), "array");
+	expectResponse(response("<value><array><data/></array></value>"), std::make_shared<Variable>(VariableType::tArray), "data");
+	expectResponse("<methodResponse><params/></methodResponse>", std::make_shared<Variable>(), "params");
+
+	auto structure = std::make_shared<Variable>(VariableType::tStruct);
+	structure->emplaceStructElement("a", "");
+	expectResponse(response("<value><struct><member/><member><name/><value/></member><member><name>a</name><value/></member></struct></value>"), structure, "members");
+}
+
+TEST(byteOrderMark)
+{
+	expectResponse("\xEF\xBB\xBF" + response("<value><i4>1</i4></value>"), std::make_shared<Variable>(1), "response");
+
+	Rpc::XmlrpcDecoder decoder(&baseLib());
+	std::string request = "\xEF\xBB\xBF<methodCall><methodName>m</methodName><params><param><value>x</value></param></params></methodCall>";
+	std::string methodName;
+	auto parameters = decoder.decodeRequest(std::vector<char>(request.begin(), request.end()), methodName);
+	EXPECT(methodName == "m");
+	EXPECT(parameters->size() == 1 && Test::equal(parameters->at(0), std::make_shared<Variable>("x")));
+}
+
+TEST(nullCharacter)
+{
+	//The input ends at the first null character.
+	expectResponse(response("<value><i4>1</i4></value>") + std::string("\0garbage", 8), std::make_shared<Variable>(1), "behind document");
+	expectResponse(response("<value>a") + std::string("\0", 1) + "b</value>", parseError("unexpected end of data"), "inside value");
+	expectResponse(std::string("<methodResp\0onse/>", 18), parseError("expected >"), "inside name");
+}
+
+TEST(parseErrors)
+{
+	expectResponse("", Variable::createError(-32700, "Parse error. First root node has to be \"methodResponse\"."), "empty");
+	expectResponse("<", parseError("expected element name"), "<");
+	expectResponse("<methodResponse", parseError("expected >"), "open tag");
+	expectResponse("<methodResponse>", parseError("unexpected end of data"), "no closing tag");
+	expectResponse("<methodResponse></methodResponse", parseError("expected >"), "closing tag");
+	expectResponse("<methodResponse a", parseError("expected ="), "attribute name");
+	expectResponse("<methodResponse a=", parseError("expected ' or \""), "attribute value");
+	expectResponse("<methodResponse a='x", parseError("expected ' or \""), "unterminated attribute value");
+	expectResponse("<methodResponse><!-- x", parseError("unexpected end of data"), "comment");
+	expectResponse("<methodResponse><![CDATA[x", parseError("unexpected end of data"), "CDATA");
+	expectResponse("<?xml", parseError("unexpected end of data"), "declaration");
+	expectResponse("<!DOCTYPE x [", parseError("unexpected end of data"), "DOCTYPE");
+	expectResponse("<methodResponse/>x", parseError("expected <"), "text on document level");
+	//Errors behind the decoded part are reported as well.
+	expectResponse(response("<value/>") + "<", parseError("expected element name"), "behind document");
+}
+
+TEST(truncated)
+{
+	const std::string packet = "\xEF\xBB\xBF<?xml version=\"1.0\"?>\n<!DOCTYPE methodResponse>\n<methodResponse a=\"b\">\n"
+		"<params><param><value><struct><member><name>a</name><value><array><data><value><i4>1</i4></value><value/>"
+		"<value><![CDATA[c]]></value></data></array></value></member><!-- comment --><member><name>d</name>"
+		"<value><string>e&amp;</string></value></member></struct></value></param></params>\n</methodResponse >\n";
+	for(size_t size = 0; size <= packet.size(); size++)
+	{
+		std::string truncated = packet.substr(0, size);
+		std::string error = rapidxmlError(truncated);
+		PVariable result = decodeResponse(truncated);
+		if(error.empty())
+		{
+			EXPECT_MESSAGE(!result->errorStruct || result->structValue->at("faultString")->stringValue.find("Not well formed") == std::string::npos, std::to_string(size));
+		}
+		else EXPECT_MESSAGE(Test::equal(result, parseError(error)), std::to_string(size) + ": " + error);
+	}
+}
+
+int main()
+{
+	return Test::run();
+}
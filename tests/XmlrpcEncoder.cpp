@@ -0,0 +1,183 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+
+
+#include "Test.h"
+#include "BaseLib.h"
+
+using namespace BaseLib;
+
+namespace
+{
+
+/**
+ * Encodes the variable as response into both output types and compares the result with the expected value.
+ */
+void expectValue(const PVariable& variable, const std::string& expectedValue, const std::string& name)
+{
+	const std::string expected = variable && variable->errorStruct ?
+		"<methodResponse><fault>" + expectedValue + "</fault></methodResponse>" :
+		"<methodResponse><params><param>" + expectedValue + "</param></params></methodResponse>";
+	Rpc::XmlrpcEncoder encoder(nullptr);
+
+	std::vector<char> charData;
+	encoder.encodeResponse(variable, charData);
+	std::string charResult(charData.begin(), charData.end());
+	EXPECT_MESSAGE(charResult == expected, name + ": " + charResult);
+
+	std::vector<uint8_t> uint8Data;
+	encoder.encodeResponse(variable, uint8Data);
+	std::string uint8Result(uint8Data.begin(), uint8Data.end());
+	EXPECT_MESSAGE(uint8Result == expected, name + " (uint8_t): " + uint8Result);
+}
+
+PVariable base64(const std::string& value)
+{
+	auto variable = std::make_shared<Variable>(VariableType::tBase64);
+	variable->stringValue = value;
+	return variable;
+}
+
+}
+
+TEST(scalars)
+{
+	expectValue(std::make_shared<Variable>(), "<value/>", "void");
+	expectValue(std::make_shared<Variable>(42), "<value><i4>42</i4></value>", "integer");
+	expectValue(std::make_shared<Variable>(-7), "<value><i4>-7</i4></value>", "negative integer");
+	expectValue(std::make_shared<Variable>(int64_t(1) << 40), "<value><i8>1099511627776</i8></value>", "integer64");
+	expectValue(std::make_shared<Variable>(0.5), "<value><double>0.5</double></value>", "float");
+	expectValue(std::make_shared<Variable>(-2.0), "<value><double>-2</double></value>", "whole float");
+	expectValue(std::make_shared<Variable>(true), "<value><boolean>1</boolean></value>", "true");
+	expectValue(std::make_shared<Variable>(false), "<value><boolean>0</boolean></value>", "false");
+	expectValue(std::make_shared<Variable>("text"), "<value>text</value>", "string");
+	expectValue(base64("YQ=="), "<value><base64>YQ==</base64></value>", "base64");
+	//There is no XML-RPC type for binary data.
+	expectValue(std::make_shared<Variable>(std::vector<uint8_t>{1, 2}), "<value/>", "binary");
+}
+
+TEST(emptyValues)
+{
+	expectValue(std::make_shared<Variable>(""), "<value/>", "empty string");
+	expectValue(base64(""), "<value><base64/></value>", "empty base64");
+	expectValue(std::make_shared<Variable>(VariableType::tArray), "<value><array><data/></array></value>", "empty array");
+	expectValue(std::make_shared<Variable>(VariableType::tStruct), "<value><struct/></value>", "empty struct");
+
+	auto array = std::make_shared<Variable>(VariableType::tArray);
+	array->arrayValue->push_back(nullptr);
+	array->emplaceArrayElement(VariableType::tVoid);
+	array->emplaceArrayElement(VariableType::tArray);
+	array->emplaceArrayElement(VariableType::tStruct);
+	expectValue(array, "<value><array><data><value/><value/><value><array><data/></array></value><value><struct/></value></data></array></value>", "array of empty values");
+}
+
+TEST(nullCharacters)
+{
+	//Everything behind a null character is dropped.
+	expectValue(std::make_shared<Variable>(std::string("ab\0cd", 5)), "<value>ab</value>", "string");
+	expectValue(std::make_shared<Variable>(std::string("\0cd", 3)), "<value/>", "string starting with null");
+	expectValue(base64(std::string("YQ\0==", 5)), "<value><base64>YQ</base64></value>", "base64");
+
+	auto structure = std::make_shared<Variable>(VariableType::tStruct);
+	structure->emplaceStructElement(std::string("n\0x", 3), 1);
+	expectValue(structure, "<value><struct><member><name>n</name><value><i4>1</i4></value></member></struct></value>", "member name");
+}
+
+TEST(skippedMembers)
+{
+	auto structure = std::make_shared<Variable>(VariableType::tStruct);
+	structure->emplaceStructElement("", 1);
+	(*structure->structValue)["b"] = nullptr;
+	expectValue(structure, "<value><struct/></value>", "only skipped members");
+
+	structure->emplaceStructElement("a", VariableType::tVoid);
+	structure->emplaceStructElement("c", "x");
+	expectValue(structure, "<value><struct><member><name>a</name><value/></member><member><name>c</name><value>x</value></member></struct></value>", "skipped members");
+}
+
+TEST(escaping)
+{
+	expectValue(std::make_shared<Variable>("<>'\"&"), "<value>&lt;&gt;&apos;&quot;&amp;</value>", "only escaped characters");
+	expectValue(std::make_shared<Variable>("a<b>c'd\"e&f"), "<value>a&lt;b&gt;c&apos;d&quot;e&amp;f</value>", "mixed");
+	expectValue(std::make_shared<Variable>("&&"), "<value>&amp;&amp;</value>", "repeated");
+	expectValue(base64("a&b"), "<value><base64>a&amp;b</base64></value>", "base64");
+
+	auto structure = std::make_shared<Variable>(VariableType::tStruct);
+	structure->emplaceStructElement("<&>", true);
+	expectValue(structure, "<value><struct><member><name>&lt;&amp;&gt;</name><value><boolean>1</boolean></value></member></struct></value>", "member name");
+}
+
+TEST(nested)
+{
+	auto structure = std::make_shared<Variable>(VariableType::tStruct);
+	PVariable& array = structure->emplaceStructElement("a", VariableType::tArray);
+	array->emplaceArrayElement(1);
+	array->emplaceArrayElement(VariableType::tStruct)->emplaceStructElement("b", "c");
+	structure->emplaceStructElement("d", 1.5);
+	expectValue(structure, "<value><struct>"
+		"<member><name>a</name><value><array><data><value><i4>1</i4></value><value><struct><member><name>b</name><value>c</value></member></struct></value></data></array></value></member>"
+		"<member><name>d</name><value><double>1.5</double></value></member>"
+		"</struct></value>", "nested");
+
+	expectValue(Variable::createError(-1, "Unknown <method>"), "<value><struct>"
+		"<member><name>faultCode</name><value><i4>-1</i4></value></member>"
+		"<member><name>faultString</name><value>Unknown &lt;method&gt;</value></member>"
+		"</struct></value>", "fault");
+}
+
+TEST(requests)
+{
+	Rpc::XmlrpcEncoder encoder(nullptr);
+	auto parameters = std::make_shared<std::vector<PVariable>>();
+	parameters->push_back(std::make_shared<Variable>("a&b"));
+	parameters->push_back(nullptr);
+	parameters->push_back(std::make_shared<Variable>(VariableType::tArray));
+	const std::string expected = "<?xml version=\"1.0\"?>\r\n<methodCall><methodName>set&apos;Value</methodName><params>"
+		"<param><value>a&amp;b</value></param><param><value/></param><param><value><array><data/></array></value></param>"
+		"</params></methodCall>";
+
+	std::vector<char> data;
+	encoder.encodeRequest("set'Value", parameters, data);
+	EXPECT(std::string(data.begin(), data.end()) == expected);
+
+	data.clear();
+	encoder.encodeRequest("set'Value", std::make_shared<std::list<PVariable>>(parameters->begin(), parameters->end()), data);
+	EXPECT(std::string(data.begin(), data.end()) == expected);
+
+	data.clear();
+	encoder.encodeRequest("", std::make_shared<std::vector<PVariable>>(), data);
+	EXPECT(std::string(data.begin(), data.end()) == "<?xml version=\"1.0\"?>\r\n<methodCall><methodName/><params/></methodCall>");
+}
+
+int main()
+{
+	return Test::run();
+}